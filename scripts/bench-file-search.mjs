@@ -0,0 +1,276 @@
+#!/usr/bin/env node
+
+// File search index benchmark. Generates synthetic home directories, then
+// measures index build, watcher batch application and query latency through
+// the engine that backs searchIndexedFiles, and prints one JSON report so
+// numbers can be diffed between releases.
+//
+//   node --expose-gc scripts/bench-file-search.mjs [--profile shallow-wide,deep-monorepo]
+//     [--scale 1] [--iterations 15] [--out report.json] [--keep]
+//
+// The facade in file-search-index.ts runs the engine inside a worker thread
+// loaded from dist/; the benchmark calls the same engine entry points
+// directly so it needs neither Electron nor a build.
+
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { performance } from 'perf_hooks';
+import { createTsModuleLoader } from './lib/ts-module-loader.mjs';
+
+// `__dirname` points at dist/main so the native directory walker is used once
+// it has been built into dist/native (npm run build:native).
+const loadTsModule = createTsModuleLoader({ __dirname: path.resolve('dist/main') });
+
+const PROFILES = {
+  // Many top-level folders with a couple of levels of documents each.
+  'shallow-wide': { folders: 48, subfolders: 14, filesPerFolder: 36, depth: 2, packages: 0, nodeModules: 0 },
+  // One large monorepo with deep package source trees.
+  'deep-monorepo': { folders: 4, subfolders: 3, filesPerFolder: 8, depth: 2, packages: 140, nodeModules: 0 },
+  // Projects dominated by node_modules, which the walker must skip cheaply.
+  'node-modules-heavy': { folders: 6, subfolders: 4, filesPerFolder: 12, depth: 2, packages: 24, nodeModules: 900 },
+};
+
+const TOP_LEVEL_NAMES = ['Documents', 'Desktop', 'Downloads', 'Projects', 'Pictures', 'Music', 'Work', 'Notes'];
+const WORDS = [
+  'invoice', 'report', 'summary', 'draft', 'budget', 'meeting', 'notes', 'roadmap', 'design', 'resume',
+  'contract', 'receipt', 'photo', 'backup', 'config', 'server', 'client', 'utils', 'index', 'main',
+  'button', 'modal', 'launcher', 'search', 'settings', 'clipboard', 'parser', 'worker', 'schema', 'release',
+];
+const EXTENSIONS = ['.md', '.txt', '.pdf', '.ts', '.tsx', '.json', '.png', '.docx', '.csv', '.js'];
+
+// Fixed corpus: single terms, multi-term, short prefixes, misses and
+// path-like queries, so each code path in the engine gets timed.
+const QUERY_CORPUS = [
+  'invoice', 'report 2023', 'main', 'index ts', 'read', 'se', 'a', 'launcher settings', 'clip', 'schema json',
+  'budget draft', 'utils', 'button modal', 'zzzz-no-match', 'Projects/', '~/Documents/', 'src/index', 'packages/pkg1',
+  'config server', 'release notes',
+];
+// Keystroke-by-keystroke prefixes of one query, replayed with a shared
+// session context as the launcher does while typing.
+const TYPEAHEAD_QUERY = 'launcher settings report';
+
+function createRandom(seed) {
+  let state = seed >>> 0;
+  return () => {
+    state = (state + 0x6d2b79f5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+function pick(random, values) {
+  return values[Math.floor(random() * values.length)];
+}
+
+function makeFileName(random, index) {
+  const year = 2018 + Math.floor(random() * 8);
+  return `${pick(random, WORDS)}-${pick(random, WORDS)}-${year}-${index}${pick(random, EXTENSIONS)}`;
+}
+
+function writeFiles(random, dirPath, count) {
+  fs.mkdirSync(dirPath, { recursive: true });
+  for (let i = 0; i < count; i += 1) {
+    fs.writeFileSync(path.join(dirPath, makeFileName(random, i)), '');
+  }
+  return count;
+}
+
+function generateTree(homeDir, profile, scale, seed) {
+  const random = createRandom(seed);
+  let fileCount = 0;
+  const folders = Math.max(1, Math.round(profile.folders * scale));
+  for (let i = 0; i < folders; i += 1) {
+    const topLevel = path.join(homeDir, TOP_LEVEL_NAMES[i % TOP_LEVEL_NAMES.length], `${pick(random, WORDS)}-${i}`);
+    for (let j = 0; j < profile.subfolders; j += 1) {
+      let dirPath = topLevel;
+      for (let level = 0; level < profile.depth; level += 1) dirPath = path.join(dirPath, `${pick(random, WORDS)}-${j}-${level}`);
+      fileCount += writeFiles(random, dirPath, profile.filesPerFolder);
+    }
+  }
+
+  const packages = Math.round(profile.packages * scale);
+  const repoDir = path.join(homeDir, 'Projects', 'monorepo');
+  for (let i = 0; i < packages; i += 1) {
+    const packageDir = path.join(repoDir, 'packages', `pkg${i}`);
+    fs.mkdirSync(packageDir, { recursive: true });
+    fs.writeFileSync(path.join(packageDir, 'package.json'), '');
+    fs.writeFileSync(path.join(packageDir, 'README.md'), '');
+    fileCount += 2;
+    let dirPath = path.join(packageDir, 'src');
+    const depth = 3 + Math.floor(random() * 6);
+    for (let level = 0; level < depth; level += 1) {
+      dirPath = path.join(dirPath, pick(random, WORDS));
+      fileCount += writeFiles(random, dirPath, 4 + Math.floor(random() * 8));
+    }
+    const nodeModules = Math.round(profile.nodeModules / Math.max(1, profile.packages));
+    for (let k = 0; k < nodeModules; k += 1) {
+      const moduleDir = path.join(packageDir, 'node_modules', `${pick(random, WORDS)}-${k}`, 'lib');
+      fileCount += writeFiles(random, moduleDir, 6);
+    }
+  }
+  return fileCount;
+}
+
+function percentile(sortedValues, fraction) {
+  if (sortedValues.length === 0) return 0;
+  const index = Math.min(sortedValues.length - 1, Math.ceil(fraction * sortedValues.length) - 1);
+  return sortedValues[Math.max(0, index)];
+}
+
+function round(value) {
+  return Math.round(value * 100) / 100;
+}
+
+function summarizeLatencies(values) {
+  const sorted = [...values].sort((a, b) => a - b);
+  return {
+    samples: sorted.length,
+    p50Ms: round(percentile(sorted, 0.5)),
+    p99Ms: round(percentile(sorted, 0.99)),
+    maxMs: round(sorted[sorted.length - 1] || 0),
+  };
+}
+
+function heapUsedBytes() {
+  if (typeof global.gc === 'function') global.gc();
+  return process.memoryUsage().heapUsed;
+}
+
+// A batch shaped like a burst of real activity: new files, a deleted folder
+// and a new folder with contents.
+function mutateTree(homeDir, random) {
+  const changedPaths = [];
+  const targetDir = path.join(homeDir, 'Downloads', 'bench-batch');
+  fs.mkdirSync(targetDir, { recursive: true });
+  changedPaths.push(targetDir);
+  for (let i = 0; i < 400; i += 1) {
+    const filePath = path.join(targetDir, makeFileName(random, i));
+    fs.writeFileSync(filePath, '');
+    changedPaths.push(filePath);
+  }
+  const topLevelDir = path.join(homeDir, TOP_LEVEL_NAMES[0]);
+  const victim = fs.existsSync(topLevelDir) ? fs.readdirSync(topLevelDir).sort()[0] : null;
+  if (victim) {
+    const victimPath = path.join(topLevelDir, victim);
+    fs.rmSync(victimPath, { recursive: true, force: true });
+    changedPaths.push(victimPath);
+  }
+  return changedPaths;
+}
+
+async function benchProfile(engine, name, profile, options) {
+  const rootDir = fs.mkdtempSync(path.join(os.tmpdir(), `supercmd-bench-${name}-`));
+  const homeDir = path.join(rootDir, 'home');
+  fs.mkdirSync(homeDir, { recursive: true });
+  try {
+    const generatedFiles = generateTree(homeDir, profile, options.scale, 0x5eed);
+    const config = { homeDir, includeRoots: [homeDir], includeProtectedHomeRoots: true };
+
+    const heapBefore = heapUsedBytes();
+    const buildStartedAt = performance.now();
+    const snapshot = await engine.buildIndexSnapshot(config);
+    const buildMs = performance.now() - buildStartedAt;
+    const heapAfter = heapUsedBytes();
+    const memory = engine.getIndexMemoryReport(snapshot);
+
+    const queryLatencies = [];
+    const perQuery = {};
+    for (const query of QUERY_CORPUS) {
+      const latencies = [];
+      let resultCount = 0;
+      for (let i = 0; i < options.iterations; i += 1) {
+        const startedAt = performance.now();
+        const results = await engine.searchIndexSnapshot(snapshot, config, query, { limit: 80 });
+        latencies.push(performance.now() - startedAt);
+        resultCount = results.length;
+      }
+      queryLatencies.push(...latencies);
+      perQuery[query] = { ...summarizeLatencies(latencies), results: resultCount };
+    }
+
+    const typeaheadLatencies = [];
+    for (let i = 0; i < options.iterations; i += 1) {
+      const context = engine.createFileSearchQueryContext();
+      for (let end = 1; end <= TYPEAHEAD_QUERY.length; end += 1) {
+        const startedAt = performance.now();
+        await engine.searchIndexSnapshot(snapshot, config, TYPEAHEAD_QUERY.slice(0, end), { limit: 80, context });
+        typeaheadLatencies.push(performance.now() - startedAt);
+      }
+    }
+
+    const changedPaths = mutateTree(homeDir, createRandom(0xba7c4));
+    const batchStartedAt = performance.now();
+    await engine.applyWatchEventBatch(snapshot, config, changedPaths);
+    const batchMs = performance.now() - batchStartedAt;
+
+    return {
+      generatedFiles,
+      indexedEntries: engine.getIndexEntryCount(snapshot),
+      buildMs: round(buildMs),
+      heapAfterBuildBytes: heapAfter,
+      heapDeltaBytes: heapAfter - heapBefore,
+      indexBytes: memory.totalBytes,
+      bytesPerEntry: memory.bytesPerEntry,
+      query: summarizeLatencies(queryLatencies),
+      typeahead: summarizeLatencies(typeaheadLatencies),
+      watchBatch: { paths: changedPaths.length, ms: round(batchMs), tombstones: snapshot.tombstoneCount },
+      queries: perQuery,
+    };
+  } finally {
+    if (!options.keep) fs.rmSync(rootDir, { recursive: true, force: true });
+  }
+}
+
+function parseArgs(argv) {
+  const options = { profiles: Object.keys(PROFILES), scale: 1, iterations: 15, out: '', keep: false };
+  for (let i = 0; i < argv.length; i += 1) {
+    const arg = argv[i];
+    if (arg === '--profile') options.profiles = String(argv[++i] || '').split(',').map((value) => value.trim()).filter(Boolean);
+    else if (arg === '--scale') options.scale = Math.max(0.05, Number(argv[++i]) || 1);
+    else if (arg === '--iterations') options.iterations = Math.max(1, Math.floor(Number(argv[++i]) || 1));
+    else if (arg === '--out') options.out = String(argv[++i] || '');
+    else if (arg === '--keep') options.keep = true;
+    else throw new Error(`Unknown argument: ${arg}`);
+  }
+  for (const profile of options.profiles) {
+    if (!PROFILES[profile]) throw new Error(`Unknown profile: ${profile} (expected ${Object.keys(PROFILES).join(', ')})`);
+  }
+  return options;
+}
+
+async function main() {
+  const options = parseArgs(process.argv.slice(2));
+  const engine = loadTsModule('src/main/file-search-index-engine.ts');
+  // Keep the run quiet; the report is the only output.
+  const log = console.log;
+  console.log = () => {};
+
+  const report = {
+    node: process.version,
+    platform: `${process.platform}-${process.arch}`,
+    gcExposed: typeof global.gc === 'function',
+    scale: options.scale,
+    iterations: options.iterations,
+    queryCorpusSize: QUERY_CORPUS.length,
+    profiles: {},
+  };
+  try {
+    for (const name of options.profiles) {
+      report.profiles[name] = await benchProfile(engine, name, PROFILES[name], options);
+    }
+  } finally {
+    console.log = log;
+  }
+
+  const json = JSON.stringify(report, null, 2);
+  if (options.out) fs.writeFileSync(options.out, `${json}\n`);
+  console.log(json);
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
@@ -14,6 +14,26 @@ function run(cmd) {
   execSync(cmd, { stdio: 'inherit' });
 }
 
+function buildNodeAddon(dir, target) {
+  run(
+    `cd src/native/${dir} && ` +
+    `HOME=~/.electron-gyp npx node-gyp rebuild ` +
+    `--target=${electronVersion} --arch=${arch} ` +
+    `--dist-url=https://electronjs.org/headers && ` +
+    `cp build/Release/${target}.node ../../../dist/native/${target}.node`
+  );
+}
+
+// The Swift helpers are macOS-only. On Linux the native pieces are the
+// inotify watcher and native_helpers.node, which there carries the directory
+// walker used by the file search index, the X11 clipboard watcher and the
+// clipboard content hashes.
+if (process.platform === 'linux') {
+  buildNodeAddon('file-watcher-addon', 'file_watcher');
+  buildNodeAddon('native-helpers-addon', 'native_helpers');
+  process.exit(0);
+}
+
 const swift = [
   ['dist/native/get-selected-text', 'src/native/get-selected-text.swift',
     '-framework Foundation -framework ApplicationServices -framework AppKit'],
@@ -53,13 +73,7 @@ for (const [out, src, frameworks] of swift) {
 }
 
 // Build native Node addon (native_helpers.node)
-run(
-  `cd src/native/native-helpers-addon && ` +
-  `HOME=~/.electron-gyp npx node-gyp rebuild ` +
-  `--target=${electronVersion} --arch=${arch} ` +
-  `--dist-url=https://electronjs.org/headers && ` +
-  `cp build/Release/native_helpers.node ../../../dist/native/native_helpers.node`
-);
+buildNodeAddon('native-helpers-addon', 'native_helpers');
 
 run('node scripts/build-whispercpp.mjs');
 run('node scripts/build-parakeet.mjs');
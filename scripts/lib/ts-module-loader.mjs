@@ -0,0 +1,82 @@
+// Load main-process TypeScript modules from a test by transpiling them to
+// CommonJS with the TypeScript compiler and running them in a vm sandbox.
+// Unlike ts-import.mjs, relative imports are followed, so a module can be
+// tested together with the helpers it imports.
+//
+// Values created inside the sandbox (arrays from `.map()`, object literals)
+// belong to another realm: compare them with a host-realm copy, such as
+// `Array.from(...)`, since assert/strict's deepEqual checks prototypes.
+
+import fs from 'node:fs';
+import path from 'node:path';
+import vm from 'node:vm';
+import { createRequire } from 'node:module';
+
+const require = createRequire(import.meta.url);
+const ts = require('typescript');
+
+// Returns a loadTsModule with its own module cache. `globals` are added to
+// every sandbox, e.g. `__dirname` for modules that load native addons.
+export function createTsModuleLoader(globals = {}) {
+  const moduleCache = new Map();
+
+  function loadTsModule(filePath) {
+    const resolvedPath = path.resolve(filePath);
+    if (moduleCache.has(resolvedPath)) return moduleCache.get(resolvedPath).exports;
+
+    const source = fs.readFileSync(resolvedPath, 'utf8');
+    const transpiled = ts.transpileModule(source, {
+      compilerOptions: {
+        module: ts.ModuleKind.CommonJS,
+        target: ts.ScriptTarget.ES2022,
+        esModuleInterop: true,
+        importsNotUsedAsValues: ts.ImportsNotUsedAsValues.Remove,
+      },
+      fileName: resolvedPath,
+    });
+
+    const module = { exports: {} };
+    moduleCache.set(resolvedPath, module);
+    const localRequire = (request) => {
+      if (request.startsWith('.')) {
+        const candidate = path.resolve(path.dirname(resolvedPath), request);
+        for (const suffix of ['', '.ts', '.tsx', '.js', '.jsx', '/index.ts', '/index.tsx']) {
+          const nextPath = `${candidate}${suffix}`;
+          if (fs.existsSync(nextPath) && fs.statSync(nextPath).isFile()) {
+            if (nextPath.endsWith('.ts') || nextPath.endsWith('.tsx')) return loadTsModule(nextPath);
+            return require(nextPath);
+          }
+        }
+      }
+      return require(request);
+    };
+    const sandbox = {
+      module,
+      exports: module.exports,
+      require: localRequire,
+      console,
+      process,
+      Buffer,
+      setImmediate,
+      setTimeout,
+      clearTimeout,
+      URL,
+      Date,
+      Math,
+      String,
+      Number,
+      Set,
+      Map,
+      Object,
+      Array,
+      RegExp,
+      ...globals,
+    };
+    vm.runInNewContext(transpiled.outputText, sandbox, { filename: resolvedPath });
+    return module.exports;
+  }
+
+  return loadTsModule;
+}
+
+export const loadTsModule = createTsModuleLoader();
@@ -0,0 +1,165 @@
+#!/usr/bin/env node
+
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import assert from 'assert/strict';
+import { loadTsModule } from './lib/ts-module-loader.mjs';
+
+const { mergeBrowserHistoryRows } = loadTsModule('src/main/browser-history-import.ts');
+const { BrowserSearchStore } = loadTsModule('src/main/browser-search-store.ts');
+
+const tempDir = fs.mkdtempSync(path.join(os.tmpdir(), 'browser-history-import-'));
+let storeCounter = 0;
+let idCounter = 0;
+
+function createStore() {
+  return new BrowserSearchStore(path.join(tempDir, `history-${storeCounter++}.sqlite`));
+}
+
+function extractHost(url) {
+  try {
+    return new URL(url).host.toLowerCase();
+  } catch {
+    return '';
+  }
+}
+
+function mergeOptions(fields = {}) {
+  return {
+    source: 'chrome',
+    sourceProfileId: 'Default',
+    sourceProfileName: 'Personal',
+    makeId: () => `id-${idCounter++}`,
+    extractHost,
+    ...fields,
+  };
+}
+
+function syntheticRows(count) {
+  const rows = [];
+  for (let index = 0; index < count; index += 1) {
+    rows.push({
+      url: `https://site${index % 5000}.example/page/${index}`,
+      title: `Page ${index}`,
+      visitCount: 1 + (index % 7),
+      lastVisit: 1_700_000_000_000 + index,
+    });
+  }
+  return rows;
+}
+
+// Simple test runner to avoid adding a dependency on node:test
+// Using ✓ and ✗ here for consistency with the node:test output style.
+async function test(name, fn) {
+  try {
+    await fn();
+    console.log(`✓ ${name}`);
+  } catch (error) {
+    console.error(`✗ ${name}`);
+    throw error;
+  }
+}
+
+try {
+  await test('rows merge into the profile entry with the same URL', async () => {
+    const store = createStore();
+    store.put({
+      id: 'known',
+      type: 'url',
+      query: 'Known',
+      url: 'https://known.example/',
+      host: 'known.example',
+      lastUsedAt: 500,
+      useCount: 3,
+      source: 'chrome',
+      sourceProfileId: 'Default',
+    });
+    const result = await mergeBrowserHistoryRows(store, [
+      { url: 'https://KNOWN.example/', title: 'Known again', visitCount: 9, lastVisit: 900 },
+      { url: 'https://new.example/', title: '  ', visitCount: 0, lastVisit: 700 },
+      { url: 'https://new.example/', title: 'Dupe', visitCount: 2, lastVisit: 800 },
+      { url: 'not a url', visitCount: 1, lastVisit: 1 },
+      { url: '', visitCount: 1, lastVisit: 1 },
+    ], mergeOptions());
+
+    assert.equal(result.imported, 1);
+    assert.equal(result.skipped, 3);
+    assert.equal(result.changed, true);
+    assert.equal(store.count(), 2);
+    const known = store.getById('known');
+    assert.equal(known.useCount, 9);
+    assert.equal(known.lastUsedAt, 900);
+    assert.equal(known.query, 'Known');
+    assert.equal(known.sourceProfileName, 'Personal');
+    const added = store.findImported('url', 'chrome', 'Default', 'https://new.example/');
+    assert.equal(added.query, 'new.example');
+    assert.equal(added.useCount, 2);
+    assert.equal(added.lastUsedAt, 800);
+  });
+
+  await test('rows imported before profiles were tracked are claimed by the profile', async () => {
+    for (const rowCount of [1, 2000]) {
+      const store = createStore();
+      store.put({
+        id: 'legacy',
+        type: 'url',
+        query: 'Legacy',
+        url: 'https://legacy.example/',
+        host: 'legacy.example',
+        lastUsedAt: 100,
+        useCount: 1,
+        source: 'chrome',
+      });
+      const rows = syntheticRows(rowCount - 1);
+      rows.push({ url: 'https://legacy.example/', visitCount: 4, lastVisit: 200 });
+      const result = await mergeBrowserHistoryRows(store, rows, mergeOptions());
+      assert.equal(result.imported, rowCount - 1);
+      const legacy = store.getById('legacy');
+      assert.equal(legacy.sourceProfileId, 'Default');
+      assert.equal(legacy.useCount, 4);
+      assert.equal(store.count(), rowCount);
+    }
+  });
+
+  await test('a synthetic 200k-row history imports within the time budget', async () => {
+    const store = createStore();
+    const rows = syntheticRows(200_000);
+    const progress = [];
+    const startedAt = Date.now();
+    const first = await mergeBrowserHistoryRows(store, rows, mergeOptions({
+      onProgress: (update) => progress.push(update),
+    }));
+    const firstMs = Date.now() - startedAt;
+    assert.equal(first.imported, 200_000);
+    assert.equal(store.count(), 200_000);
+    assert.ok(firstMs < 20_000, `first import took ${firstMs}ms`);
+
+    assert.ok(progress.length > 1);
+    for (let index = 1; index < progress.length; index += 1) {
+      assert.ok(progress[index].processed > progress[index - 1].processed);
+    }
+    const last = progress[progress.length - 1];
+    assert.equal(last.processed, 200_000);
+    assert.equal(last.total, 200_000);
+    assert.equal(last.imported, 200_000);
+    assert.ok(last.rowsPerSecond > 0);
+
+    // Importing the same history again matches every row and writes nothing.
+    const againAt = Date.now();
+    const second = await mergeBrowserHistoryRows(store, rows, mergeOptions());
+    const secondMs = Date.now() - againAt;
+    assert.equal(second.imported, 0);
+    assert.equal(second.skipped, 200_000);
+    assert.equal(second.changed, false);
+    assert.equal(store.count(), 200_000);
+    assert.ok(secondMs < 20_000, `second import took ${secondMs}ms`);
+    console.log(`  200k rows: first import ${firstMs}ms, re-import ${secondMs}ms`);
+  });
+} finally {
+  fs.rmSync(tempDir, { recursive: true, force: true });
+}
+
+// All tests passed if we reach this point without throwing an error.
+// Using a ✓ here for consistency with the node:test output style.
+console.log('✓ All browser-history-import tests passed');
@@ -0,0 +1,206 @@
+#!/usr/bin/env node
+
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import assert from 'assert/strict';
+import { loadTsModule } from './lib/ts-module-loader.mjs';
+
+const {
+  BrowserSearchStore,
+  getBrowserSearchValueKey,
+  isBrowserSearchDatabaseCorrupt,
+  moveBrowserSearchDatabaseAside,
+  removeBrowserSearchDatabase,
+} = loadTsModule('src/main/browser-search-store.ts');
+
+const tempDir = fs.mkdtempSync(path.join(os.tmpdir(), 'browser-search-store-'));
+let storeCounter = 0;
+
+function createStore() {
+  const filePath = path.join(tempDir, `history-${storeCounter++}.sqlite`);
+  return { filePath, store: new BrowserSearchStore(filePath) };
+}
+
+// The store builds rows in the loader's sandbox, another realm: copy them into
+// this one before deepEqual compares prototypes.
+function plain(value) {
+  return value && { ...value };
+}
+
+function entry(id, fields = {}) {
+  const url = fields.url || `https://${id}.example/`;
+  return {
+    id,
+    type: 'url',
+    query: id,
+    url,
+    host: new URL(url).host,
+    lastUsedAt: 1000,
+    useCount: 1,
+    source: 'user',
+    ...fields,
+  };
+}
+
+// Simple test runner to avoid adding a dependency on node:test
+// Using ✓ and ✗ here for consistency with the node:test output style.
+function test(name, fn) {
+  try {
+    fn();
+    console.log(`✓ ${name}`);
+  } catch (error) {
+    console.error(`✗ ${name}`);
+    throw error;
+  }
+}
+
+try {
+  test('entries round-trip and persist across reopen', () => {
+    const { filePath, store } = createStore();
+    const bookmark = entry('docs', {
+      type: 'bookmark',
+      query: 'Docs',
+      source: 'chrome',
+      sourceProfileId: 'Default',
+      sourceProfileName: 'Personal',
+      bookmarkFolder: 'Bookmarks bar',
+      bookmarkOrder: 3,
+    });
+    store.put(entry('plain'));
+    store.put(bookmark);
+    store.put({ ...bookmark, query: 'Rust docs', useCount: 2 });
+    store.close();
+
+    const reopened = new BrowserSearchStore(filePath);
+    assert.equal(reopened.count(), 2);
+    assert.deepEqual(plain(reopened.getById('docs')), { ...bookmark, query: 'Rust docs', useCount: 2 });
+    assert.deepEqual(plain(reopened.getById('plain')), entry('plain'));
+    assert.equal(reopened.getById('missing'), null);
+    reopened.close();
+  });
+
+  test('lookups match by value, title and import key', () => {
+    const { store } = createStore();
+    store.put(entry('a', { url: 'https://Example.com/Path', query: 'Example Page' }));
+    store.put(entry('b', { url: 'https://example.com/path', source: 'chrome', sourceProfileId: 'Profile 1' }));
+    store.put(entry('c', { type: 'search', query: 'Weather Berlin', url: 'https://google.com/search?q=x' }));
+
+    assert.equal(getBrowserSearchValueKey({ type: 'search', query: 'Weather Berlin', url: '' }), 'weather berlin');
+    assert.equal(store.findByValue('url', 'https://example.com/path').id, 'a');
+    assert.equal(store.findByValue('search', 'weather berlin').id, 'c');
+    assert.equal(store.findByValue('search', 'https://example.com/path'), null);
+    assert.equal(store.findImported('url', 'chrome', 'Profile 1', 'https://example.com/path').id, 'b');
+    assert.equal(store.findImported('url', 'chrome', '', 'https://example.com/path'), null);
+    assert.deepEqual(Array.from(store.findByQuery('url', 'example page'), (e) => e.id), ['a']);
+    assert.deepEqual(Array.from(store.findByQuery('bookmark', 'example page')), []);
+    assert.deepEqual(Array.from(store.findByHosts(['example.com', 'example.com']), (e) => e.id).sort(), ['a', 'b']);
+    assert.deepEqual(Array.from(store.listForProfile('chrome', 'Profile 1', 'url'), (e) => e.id), ['b']);
+  });
+
+  test('prefix lookups return the best-ranked entry that extends the prefix', () => {
+    const { store } = createStore();
+    const now = 100 * 86400000;
+    store.put(entry('gh', { url: 'https://github.com/', useCount: 5, lastUsedAt: now }));
+    store.put(entry('gl', { url: 'https://www.gitlab.com/', useCount: 9, lastUsedAt: now }));
+    store.put(entry('gs', { type: 'search', query: 'gitlab', url: 'https://google.com/search?q=0', useCount: 50, lastUsedAt: now }));
+    store.put(entry('s1', { type: 'search', query: 'git rebase', url: 'https://google.com/search?q=1', useCount: 3, lastUsedAt: now }));
+    // More uses, but a long time ago.
+    store.put(entry('s2', { type: 'search', query: 'Gitignore syntax', url: 'https://google.com/search?q=2', useCount: 4, lastUsedAt: 0 }));
+    store.put(entry('s3', { type: 'search', query: 'git', url: 'https://google.com/search?q=3', useCount: 99, lastUsedAt: now }));
+    store.put(entry('u1', { url: 'https://example.org/', query: 'git rebase docs', useCount: 99, lastUsedAt: now }));
+
+    const host = store.bestByHostPrefix('git', now);
+    assert.equal(host.entry.id, 'gl');
+    assert.equal(host.completion, 'gitlab.com');
+    assert.equal(store.bestByHostPrefix('www.git', now).completion, 'www.gitlab.com');
+    assert.equal(store.bestByHostPrefix('github', now).completion, 'github.com');
+    assert.equal(store.bestByHostPrefix('github.com', now), null);
+    assert.equal(store.bestByHostPrefix('gitx', now), null);
+
+    assert.equal(store.bestByQueryPrefix('git', now).id, 'gs');
+    assert.equal(store.bestByQueryPrefix('git ', now).id, 's1');
+    assert.equal(store.bestByQueryPrefix('gitlab', now), null);
+    assert.equal(store.bestByQueryPrefix('giti', now).id, 's2');
+  });
+
+  test('retention deletes old history but keeps bookmarks', () => {
+    const { store } = createStore();
+    store.put(entry('old', { lastUsedAt: 10 }));
+    store.put(entry('new', { lastUsedAt: 5000 }));
+    store.put(entry('mark', { type: 'bookmark', lastUsedAt: 10 }));
+    assert.equal(store.deleteUsedBefore(1000), 1);
+    assert.deepEqual(Array.from(store.all(), (e) => e.id), ['new', 'mark']);
+  });
+
+  test('profiles are counted and removed by source and profile id', () => {
+    const { store } = createStore();
+    store.put(entry('h1', { source: 'chrome', sourceProfileId: 'Default', lastUsedAt: 300 }));
+    store.put(entry('h2', { source: 'chrome', sourceProfileId: 'Default', lastUsedAt: 700 }));
+    store.put(entry('b1', { type: 'bookmark', source: 'chrome', sourceProfileId: 'Default', lastUsedAt: 900 }));
+    store.put(entry('h3', { source: 'chrome', sourceProfileId: 'Work' }));
+    store.put(entry('h4', { source: 'user' }));
+
+    assert.equal(store.newestVisitAt('chrome', 'Default'), 700);
+    assert.equal(store.newestVisitAt('arc', 'Default'), 0);
+    const stats = store.stats();
+    assert.equal(stats.historyEntries, 4);
+    assert.equal(stats.bookmarkEntries, 1);
+    assert.deepEqual(
+      Array.from(stats.profileCounts, ({ type, profileId, count }) => `${type}:${profileId}:${count}`).sort(),
+      ['bookmark:Default:1', 'url:Default:2', 'url:Work:1']
+    );
+
+    assert.equal(store.deleteForProfile('chrome', ['Default', 'chrome:Default']), 3);
+    assert.deepEqual(Array.from(store.all(), (e) => e.id), ['h3', 'h4']);
+  });
+
+  test('a failed transaction writes nothing', () => {
+    const { store } = createStore();
+    assert.throws(() => store.transaction(() => {
+      store.put(entry('a'));
+      throw new Error('boom');
+    }), /boom/);
+    assert.equal(store.count(), 0);
+    store.transaction(() => store.put(entry('b')));
+    assert.equal(store.count(), 1);
+  });
+
+  test('removing a database deletes its WAL files', () => {
+    const { filePath, store } = createStore();
+    store.put(entry('a'));
+    assert.equal(fs.existsSync(`${filePath}-wal`), true);
+    store.close();
+    removeBrowserSearchDatabase(filePath);
+    assert.deepEqual(fs.readdirSync(tempDir).filter((name) => name.startsWith(path.basename(filePath))), []);
+  });
+
+  test('a damaged database is moved aside, not deleted', () => {
+    const filePath = path.join(tempDir, 'damaged.sqlite');
+    fs.writeFileSync(filePath, 'not a database '.repeat(100));
+    fs.writeFileSync(`${filePath}-wal`, '');
+    let openError = null;
+    try {
+      new BrowserSearchStore(filePath);
+    } catch (error) {
+      openError = error;
+    }
+    assert.equal(isBrowserSearchDatabaseCorrupt(openError), true);
+    assert.equal(isBrowserSearchDatabaseCorrupt(Object.assign(new Error('database is locked'), { errcode: 5 })), false);
+    assert.equal(isBrowserSearchDatabaseCorrupt(new Error('No such built-in module: node:sqlite')), false);
+
+    const movedPath = moveBrowserSearchDatabaseAside(filePath);
+    assert.equal(fs.existsSync(filePath), false);
+    assert.equal(fs.readFileSync(movedPath, 'utf8').startsWith('not a database'), true);
+    assert.equal(fs.existsSync(`${movedPath}-wal`), true);
+    const store = new BrowserSearchStore(filePath);
+    assert.equal(store.count(), 0);
+    store.close();
+  });
+} finally {
+  fs.rmSync(tempDir, { recursive: true, force: true });
+}
+
+// All tests passed if we reach this point without throwing an error.
+// Using a ✓ here for consistency with the node:test output style.
+console.log('✓ All browser-search-store tests passed');
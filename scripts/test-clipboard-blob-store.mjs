@@ -0,0 +1,112 @@
+#!/usr/bin/env node
+
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import assert from 'assert/strict';
+import { loadTsModule } from './lib/ts-module-loader.mjs';
+
+const { ClipboardBlobStore, getClipboardBlobRef, isClipboardBlobRef } = loadTsModule('src/main/clipboard-blob-store.ts');
+
+const tempDir = fs.mkdtempSync(path.join(os.tmpdir(), 'clipboard-blobs-'));
+let storeCounter = 0;
+
+function createStore() {
+  const dir = path.join(tempDir, `store-${storeCounter++}`);
+  return { dir, store: new ClipboardBlobStore(dir) };
+}
+
+// Simple test runner to avoid adding a dependency on node:test
+// Using ✓ and ✗ here for consistency with the node:test output style.
+async function test(name, fn) {
+  try {
+    await fn();
+    console.log(`✓ ${name}`);
+  } catch (error) {
+    console.error(`✗ ${name}`);
+    throw error;
+  }
+}
+
+try {
+  await test('blobs are named by content hash and extension', () => {
+    const ref = getClipboardBlobRef('hello', 'TXT');
+    assert.equal(ref, '2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824.txt');
+    assert.equal(isClipboardBlobRef(ref), true);
+    assert.equal(isClipboardBlobRef('../history.log'), false);
+    assert.equal(getClipboardBlobRef(Buffer.from('hello'), 'txt'), ref);
+  });
+
+  await test('identical payloads are stored once and counted per reference', async () => {
+    const { dir, store } = createStore();
+    const first = store.put(Buffer.from([1, 2, 3]), 'png');
+    const second = store.put(Buffer.from([1, 2, 3]), 'png');
+    assert.equal(first, second);
+    assert.deepEqual(fs.readdirSync(dir), [first]);
+    assert.equal(store.referenceCount(first), 2);
+
+    store.release(first);
+    assert.equal(fs.existsSync(store.pathOf(first)), true);
+    store.release(first);
+    await store.whenIdle();
+    assert.equal(fs.existsSync(store.pathOf(first)), false);
+    assert.equal(store.referenceCount(first), 0);
+  });
+
+  await test('texts read back in full', () => {
+    const { store } = createStore();
+    const text = 'ünïcödé '.repeat(1000);
+    const ref = store.put(text, 'txt');
+    assert.equal(store.readText(ref), text);
+  });
+
+  await test('reset rebuilds counts and deletes unreferenced blobs', () => {
+    const { dir, store } = createStore();
+    const kept = store.put('kept', 'txt');
+    const orphan = store.put('orphan', 'txt');
+    fs.writeFileSync(path.join(dir, `${kept}.123.tmp`), 'partial');
+    fs.writeFileSync(path.join(dir, 'notes.md'), 'not a blob');
+
+    const reopened = new ClipboardBlobStore(dir);
+    reopened.reset([kept, kept]);
+    assert.deepEqual(fs.readdirSync(dir).sort(), [kept, 'notes.md'].sort());
+    assert.equal(reopened.referenceCount(kept), 2);
+    assert.equal(reopened.referenceCount(orphan), 0);
+    // A payload deleted as an orphan is written again when it comes back.
+    const again = reopened.put('orphan', 'txt');
+    assert.equal(reopened.readText(again), 'orphan');
+  });
+
+  await test('released blobs are deleted in the background', async () => {
+    const { dir, store } = createStore();
+    const refs = [];
+    for (let index = 0; index < 150; index += 1) refs.push(store.put(`payload ${index}`, 'txt'));
+    for (const ref of refs) store.release(ref);
+    assert.equal(fs.readdirSync(dir).length, 150);
+    await store.whenIdle();
+    assert.deepEqual(fs.readdirSync(dir), []);
+  });
+
+  await test('a payload stored again before its blob is deleted keeps it', async () => {
+    const { store } = createStore();
+    const queued = store.put('queued', 'txt');
+    store.release(queued);
+    assert.equal(store.put('queued', 'txt'), queued);
+
+    const inFlight = store.put('in flight', 'txt');
+    store.release(inFlight);
+    // Let the unlink start, then store the payload again while it runs.
+    await new Promise((resolve) => setImmediate(resolve));
+    store.put('in flight', 'txt');
+    await store.whenIdle();
+    assert.equal(store.readText(queued), 'queued');
+    assert.equal(store.readText(inFlight), 'in flight');
+    assert.equal(store.referenceCount(inFlight), 1);
+  });
+} finally {
+  fs.rmSync(tempDir, { recursive: true, force: true });
+}
+
+// All tests passed if we reach this point without throwing an error.
+// Using a ✓ here for consistency with the node:test output style.
+console.log('✓ All clipboard-blob-store tests passed');
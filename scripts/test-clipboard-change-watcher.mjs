@@ -0,0 +1,135 @@
+#!/usr/bin/env node
+
+import assert from 'assert/strict';
+import { EventEmitter } from 'events';
+import { loadTsModule } from './lib/ts-module-loader.mjs';
+
+const { startClipboardChangeWatcher } = loadTsModule('src/main/clipboard-change-watcher.ts');
+
+function createFakeSpawn() {
+  const children = [];
+  const spawnProcess = (command, args) => {
+    const child = new EventEmitter();
+    child.command = [command, ...args].join(' ');
+    child.stdout = new EventEmitter();
+    child.killed = false;
+    child.kill = () => { child.killed = true; };
+    child.unref = () => {};
+    children.push(child);
+    return child;
+  };
+  return { spawnProcess, children };
+}
+
+function createFakeNative({ failWith } = {}) {
+  const instances = [];
+  class FakeClipboardWatcher {
+    constructor(onChange) {
+      if (failWith) throw new Error(failWith);
+      this.onChange = onChange;
+      this.closed = false;
+      instances.push(this);
+    }
+    close() { this.closed = true; }
+  }
+  return { NativeClipboardWatcher: FakeClipboardWatcher, instances };
+}
+
+function start(overrides) {
+  const events = { changes: 0, unavailable: 0 };
+  const watcher = startClipboardChangeWatcher({
+    onChange: () => { events.changes += 1; },
+    onUnavailable: () => { events.unavailable += 1; },
+    ...overrides,
+  });
+  return { watcher, events };
+}
+
+// Simple test runner to avoid adding a dependency on node:test
+// Using ✓ and ✗ here for consistency with the node:test output style.
+function test(name, fn) {
+  try {
+    fn();
+    console.log(`✓ ${name}`);
+  } catch (error) {
+    console.error(`✗ ${name}`);
+    throw error;
+  }
+}
+
+const originalWarn = console.warn;
+console.warn = () => {};
+try {
+  test('an X11 session uses XFixes notifications', () => {
+    const native = createFakeNative();
+    const { watcher, events } = start({ env: { DISPLAY: ':0' }, NativeClipboardWatcher: native.NativeClipboardWatcher });
+    assert.equal(watcher.backend, 'xfixes');
+    native.instances[0].onChange(2);
+    assert.equal(events.changes, 1);
+    watcher.stop();
+    assert.equal(native.instances[0].closed, true);
+    assert.equal(events.unavailable, 0);
+  });
+
+  test('a Wayland session prefers wl-paste --watch', () => {
+    const fake = createFakeSpawn();
+    const native = createFakeNative();
+    const { watcher, events } = start({
+      env: { WAYLAND_DISPLAY: 'wayland-0', DISPLAY: ':0' },
+      NativeClipboardWatcher: native.NativeClipboardWatcher,
+      spawnProcess: fake.spawnProcess,
+    });
+    assert.equal(watcher.backend, 'wl-data-control');
+    assert.equal(fake.children[0].command, 'wl-paste --watch echo');
+    assert.equal(native.instances.length, 0);
+    fake.children[0].stdout.emit('data', Buffer.from('\n'));
+    assert.equal(events.changes, 1);
+    watcher.stop();
+    assert.equal(fake.children[0].killed, true);
+    fake.children[0].emit('exit', null, 'SIGTERM');
+    assert.equal(events.unavailable, 0);
+  });
+
+  test('a wl-paste that cannot start falls back to XFixes', () => {
+    const fake = createFakeSpawn();
+    const native = createFakeNative();
+    const { watcher, events } = start({
+      env: { WAYLAND_DISPLAY: 'wayland-0', DISPLAY: ':0' },
+      NativeClipboardWatcher: native.NativeClipboardWatcher,
+      spawnProcess: fake.spawnProcess,
+    });
+    fake.children[0].emit('error', new Error('spawn wl-paste ENOENT'));
+    assert.equal(watcher.backend, 'xfixes');
+    assert.equal(native.instances.length, 1);
+    assert.equal(events.unavailable, 0);
+    watcher.stop();
+  });
+
+  test('without a working backend the caller is told to poll', () => {
+    const native = createFakeNative({ failWith: 'Cannot open the X display' });
+    const { watcher, events } = start({ env: { DISPLAY: ':0' }, NativeClipboardWatcher: native.NativeClipboardWatcher });
+    assert.equal(watcher.backend, null);
+    assert.equal(events.unavailable, 1);
+
+    const headless = start({ env: {}, NativeClipboardWatcher: null });
+    assert.equal(headless.watcher.backend, null);
+    assert.equal(headless.events.unavailable, 1);
+  });
+
+  test('losing the X connection hands back to polling once', () => {
+    const native = createFakeNative();
+    const { watcher, events } = start({ env: { DISPLAY: ':0' }, NativeClipboardWatcher: native.NativeClipboardWatcher });
+    native.instances[0].onChange(-1);
+    native.instances[0].onChange(-1);
+    assert.equal(events.unavailable, 1);
+    assert.equal(events.changes, 0);
+    assert.equal(watcher.backend, null);
+    assert.equal(native.instances[0].closed, true);
+  });
+} finally {
+  console.warn = originalWarn;
+}
+
+// All tests passed if we reach this point without throwing an error.
+// Using a ✓ here for consistency with the node:test output style.
+console.log('✓ All clipboard-change-watcher tests passed');
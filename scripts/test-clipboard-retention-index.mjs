@@ -0,0 +1,80 @@
+#!/usr/bin/env node
+
+import assert from 'assert/strict';
+import { loadTsModule } from './lib/ts-module-loader.mjs';
+
+const { ClipboardRetentionIndex } = loadTsModule('src/main/clipboard-retention-index.ts');
+
+const HOUR = 60 * 60 * 1000;
+
+function item(id, hours, pinned = false) {
+  return { id, timestamp: hours * HOUR, pinned };
+}
+
+// takeExpired() as an array of this realm: the index runs in the loader's
+// sandbox, and deepEqual would not match its arrays against literals here.
+function takeExpired(index, cutoff) {
+  return Array.from(index.takeExpired(cutoff));
+}
+
+// Simple test runner to avoid adding a dependency on node:test
+// Using ✓ and ✗ here for consistency with the node:test output style.
+function test(name, fn) {
+  try {
+    fn();
+    console.log(`✓ ${name}`);
+  } catch (error) {
+    console.error(`✗ ${name}`);
+    throw error;
+  }
+}
+
+test('whole buckets expire once they end before the cutoff', () => {
+  const index = new ClipboardRetentionIndex();
+  index.rebuild([item('a', 1), item('b', 1.5), item('c', 2.2), item('d', 5)]);
+  assert.deepEqual(takeExpired(index, 2.5 * HOUR).sort(), ['a', 'b']);
+  assert.deepEqual(takeExpired(index, 2.5 * HOUR), []);
+  assert.deepEqual(takeExpired(index, 3 * HOUR), ['c']);
+  assert.equal(index.size, 1);
+});
+
+test('pinned items are never indexed', () => {
+  const index = new ClipboardRetentionIndex();
+  index.upsert(item('pinned', 1, true));
+  index.upsert(item('kept', 1));
+  index.upsert(item('kept', 1, true));
+  assert.equal(index.size, 0);
+  assert.deepEqual(takeExpired(index, 100 * HOUR), []);
+});
+
+test('a new timestamp moves an item to its new bucket', () => {
+  const index = new ClipboardRetentionIndex();
+  index.upsert(item('a', 1));
+  index.upsert(item('b', 3));
+  index.upsert(item('a', 10));
+  assert.equal(index.nextExpiryAt(0), 4 * HOUR);
+  assert.deepEqual(takeExpired(index, 5 * HOUR), ['b']);
+  index.remove('a');
+  assert.equal(index.nextExpiryAt(0), null);
+});
+
+test('buckets inserted out of order still expire oldest first', () => {
+  const index = new ClipboardRetentionIndex();
+  for (const hours of [7, 3, 9, 1, 5]) index.upsert(item(`h${hours}`, hours));
+  assert.equal(index.nextExpiryAt(24 * HOUR), 26 * HOUR);
+  assert.deepEqual(takeExpired(index, 6 * HOUR), ['h1', 'h3', 'h5']);
+  assert.equal(index.nextExpiryAt(0), 8 * HOUR);
+});
+
+test('sweeping a year of items takes only the expired ones', () => {
+  const index = new ClipboardRetentionIndex();
+  const items = [];
+  for (let hour = 0; hour < 365 * 24; hour += 1) items.push(item(`i${hour}`, hour + 0.5));
+  index.rebuild(items);
+  assert.equal(index.takeExpired(48 * HOUR).length, 48);
+  assert.equal(index.size, 365 * 24 - 48);
+});
+
+// All tests passed if we reach this point without throwing an error.
+// Using a ✓ here for consistency with the node:test output style.
+console.log('✓ All clipboard-retention-index tests passed');
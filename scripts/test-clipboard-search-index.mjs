@@ -0,0 +1,145 @@
+#!/usr/bin/env node
+
+import assert from 'assert/strict';
+import { loadTsModule } from './lib/ts-module-loader.mjs';
+
+const { ClipboardSearchIndex, tokenizeClipboardText } = loadTsModule('src/main/clipboard-search-index.ts');
+
+const NOW = 1_700_000_000_000;
+const DAY = 24 * 60 * 60 * 1000;
+
+function item(id, content, options = {}) {
+  return { id, type: options.type || 'text', content, timestamp: NOW - (options.ageDays || 0) * DAY, metadata: options.metadata };
+}
+
+// Array.from rather than map: search() returns an array of the loader's
+// sandbox, which deepEqual would not match against literals here.
+function ids(index, query, options = {}) {
+  return Array.from(index.search(query, { now: NOW, ...options }), (hit) => hit.id);
+}
+
+// Simple test runner to avoid adding a dependency on node:test
+// Using ✓ and ✗ here for consistency with the node:test output style.
+function test(name, fn) {
+  try {
+    fn();
+    console.log(`✓ ${name}`);
+  } catch (error) {
+    console.error(`✗ ${name}`);
+    throw error;
+  }
+}
+
+test('urls and paths split into searchable terms', () => {
+  assert.deepEqual(
+    [...tokenizeClipboardText('https://GitHub.com/SuperCmd/issues?q=42')],
+    ['https', 'github', 'com', 'supercmd', 'issues', 'q', '42']
+  );
+  const index = new ClipboardSearchIndex();
+  index.rebuild([
+    item('url', 'https://github.com/SuperCmdLabs/SuperCmd/pull/17', { type: 'url' }),
+    item('file', '/Users/me/Documents/Quarterly Report.pdf', { type: 'file' }),
+  ]);
+  assert.deepEqual(ids(index, 'github pull'), ['url']);
+  assert.deepEqual(ids(index, 'quarterly pdf'), ['file']);
+  assert.deepEqual(ids(index, 'report github'), []);
+});
+
+test('exact terms outrank prefixes, prefixes outrank substrings', () => {
+  const index = new ClipboardSearchIndex();
+  index.rebuild([
+    item('substring', 'preconfigured value'),
+    item('prefix', 'configuration value'),
+    item('exact', 'config value'),
+  ]);
+  assert.deepEqual(ids(index, 'config'), ['exact', 'prefix', 'substring']);
+  // Short terms match term prefixes only.
+  assert.deepEqual(ids(index, 'co').sort(), ['exact', 'prefix']);
+});
+
+test('recency breaks ties between equally good matches', () => {
+  const index = new ClipboardSearchIndex();
+  index.rebuild([
+    item('old', 'deploy script', { ageDays: 30 }),
+    item('new', 'deploy notes', { ageDays: 1 }),
+  ]);
+  assert.deepEqual(ids(index, 'deploy'), ['new', 'old']);
+  assert.deepEqual(ids(index, 'deploy', { limit: 1 }), ['new']);
+});
+
+test('typos still find the term', () => {
+  const index = new ClipboardSearchIndex();
+  index.rebuild([item('a', 'kubernetes cluster credentials'), item('b', 'unrelated text')]);
+  assert.deepEqual(ids(index, 'kuberentes'), ['a']);
+  assert.deepEqual(ids(index, 'clustr creds'), ['a']);
+});
+
+test('updates and removals keep the index in step', () => {
+  const index = new ClipboardSearchIndex();
+  index.upsert(item('a', 'alpha beta'));
+  index.upsert(item('b', 'beta gamma'));
+  assert.deepEqual(ids(index, 'beta').sort(), ['a', 'b']);
+  index.upsert(item('a', 'delta'));
+  assert.deepEqual(ids(index, 'beta'), ['b']);
+  assert.deepEqual(ids(index, 'alpha'), []);
+  index.remove('b');
+  assert.deepEqual(ids(index, 'beta'), []);
+  assert.deepEqual(ids(index, 'gam'), []);
+  assert.equal(index.size, 1);
+  index.clear();
+  assert.deepEqual(ids(index, 'delta'), []);
+});
+
+test('images match on file name and dimensions', () => {
+  const index = new ClipboardSearchIndex();
+  index.upsert(item('img', '/tmp/clip.png', { type: 'image', metadata: { filename: 'Screenshot 2024.png', width: 1920, height: 1080 } }));
+  assert.deepEqual(ids(index, 'screenshot'), ['img']);
+  assert.deepEqual(ids(index, '1920'), ['img']);
+  assert.deepEqual(ids(index, 'tmp'), []);
+});
+
+test('queries the terms cannot answer fall back to substring matching', () => {
+  const index = new ClipboardSearchIndex();
+  index.rebuild([
+    item('arrow', 'a -> b', { ageDays: 1 }),
+    item('email', 'mail me@example.com'),
+    item('hello', 'hello world'),
+    item('cable', 'usb cable'),
+  ]);
+  // Punctuation only.
+  assert.deepEqual(ids(index, '->'), ['arrow']);
+  assert.deepEqual(ids(index, '@'), ['email']);
+  // Inside a term, and across a term boundary.
+  assert.deepEqual(ids(index, 'ab'), ['cable']);
+  assert.deepEqual(ids(index, 'lo wo'), ['hello']);
+  assert.deepEqual(ids(index, 'LO WO'), ['hello']);
+  assert.deepEqual(ids(index, '#'), []);
+  // Anything the terms do match skips the scan.
+  assert.deepEqual(ids(index, 'hel'), ['hello']);
+  index.upsert(item('hello', 'hello, world'));
+  assert.deepEqual(ids(index, 'lo wo'), []);
+  assert.deepEqual(ids(index, 'o, w'), ['hello']);
+});
+
+test('searching a full history stays fast', () => {
+  const words = ['invoice', 'meeting', 'password', 'deploy', 'kernel', 'rocket', 'window', 'garden', 'silver', 'coffee'];
+  const index = new ClipboardSearchIndex();
+  for (let n = 0; n < 5000; n += 1) {
+    const text = Array.from({ length: 40 }, (_, k) => `${words[(n * 7 + k * 3) % words.length]}${(n * 31 + k) % 997}`).join(' ');
+    index.upsert(item(`item-${n}`, text, { ageDays: n / 100 }));
+  }
+  const started = process.hrtime.bigint();
+  const runs = 50;
+  for (let run = 0; run < runs; run += 1) index.search('rocket12 coff', { now: NOW, limit: 50 });
+  const perSearchMs = Number(process.hrtime.bigint() - started) / 1e6 / runs;
+  assert.ok(perSearchMs < 5, `search took ${perSearchMs.toFixed(2)}ms`);
+
+  const scanStarted = process.hrtime.bigint();
+  for (let run = 0; run < runs; run += 1) index.search('12 rocket', { now: NOW, limit: 50 });
+  const perScanMs = Number(process.hrtime.bigint() - scanStarted) / 1e6 / runs;
+  assert.ok(perScanMs < 20, `substring fallback took ${perScanMs.toFixed(2)}ms`);
+});
+
+// All tests passed if we reach this point without throwing an error.
+// Using a ✓ here for consistency with the node:test output style.
+console.log('✓ All clipboard-search-index tests passed');
@@ -0,0 +1,104 @@
+#!/usr/bin/env node
+
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import assert from 'assert/strict';
+import { loadTsModule } from './lib/ts-module-loader.mjs';
+
+const {
+  applyWatchEventBatch,
+  buildIndexSnapshot,
+  compactIndexSnapshot,
+  createFileSearchQueryContext,
+  getIndexEntryCount,
+  searchIndexSnapshot,
+} = loadTsModule('src/main/file-search-index-engine.ts');
+
+const QUERIES = ['report', 'notes 2', 'main ts', 'invoice', 'app', 'ext:md', 'kind:folder src', '~/Projects/app/src'];
+
+// Simple test runner to avoid adding a dependency on node:test
+// Using ✓ and ✗ here for consistency with the node:test output style.
+async function test(name, fn) {
+  try {
+    await fn();
+    console.log(`✓ ${name}`);
+  } catch (error) {
+    console.error(`✗ ${name}`);
+    throw error;
+  }
+}
+
+function write(filePath) {
+  fs.mkdirSync(path.dirname(filePath), { recursive: true });
+  fs.writeFileSync(filePath, '');
+}
+
+function createHome() {
+  const home = fs.mkdtempSync(path.join(fs.realpathSync(os.tmpdir()), 'file-search-compaction-'));
+  for (let n = 0; n < 40; n += 1) {
+    write(path.join(home, 'Documents', `folder-${n % 8}`, `report-${n}.pdf`));
+    write(path.join(home, 'Documents', `folder-${n % 8}`, `notes ${n}.md`));
+    write(path.join(home, 'Downloads', `invoice-${n}.pdf`));
+  }
+  for (const name of ['main.ts', 'app.ts', 'report.ts', 'notes.md']) {
+    write(path.join(home, 'Projects', 'app', 'src', name));
+    write(path.join(home, 'Projects', 'old-app', 'src', name));
+  }
+  return home;
+}
+
+// Results as plain host-realm values: the engine builds them in the loader's
+// sandbox.
+async function search(snapshot, config, query, context) {
+  const results = await searchIndexSnapshot(snapshot, config, query, { limit: 50, context });
+  return JSON.parse(JSON.stringify(results.map((result) => [result.path, result.score, result.matchKind])));
+}
+
+await test('a compacted snapshot answers queries like the one it replaces', async () => {
+  const home = createHome();
+  try {
+    const config = { homeDir: home, includeRoots: [home], includeProtectedHomeRoots: true };
+    const snapshot = await buildIndexSnapshot(config);
+
+    // Tombstones: single files, and a directory whose subtree goes with it.
+    const deleted = [path.join(home, 'Projects', 'old-app')];
+    for (let n = 0; n < 40; n += 3) deleted.push(path.join(home, 'Documents', `folder-${n % 8}`, `report-${n}.pdf`));
+    for (let n = 0; n < 40; n += 2) deleted.push(path.join(home, 'Downloads', `invoice-${n}.pdf`));
+    for (const deletedPath of deleted) fs.rmSync(deletedPath, { recursive: true, force: true });
+    write(path.join(home, 'Documents', 'report-added.pdf'));
+    await applyWatchEventBatch(snapshot, config, [...deleted, path.join(home, 'Documents', 'report-added.pdf')]);
+    assert.ok(snapshot.tombstoneCount > 0);
+
+    const compacted = compactIndexSnapshot(snapshot);
+    assert.equal(compacted.tombstoneCount, 0);
+    assert.equal(getIndexEntryCount(compacted), getIndexEntryCount(snapshot) - snapshot.tombstoneCount);
+    for (const query of QUERIES) {
+      assert.deepEqual(await search(compacted, config, query), await search(snapshot, config, query), query);
+    }
+    assert.ok((await search(compacted, config, 'report-added')).length === 1);
+    assert.deepEqual(await search(compacted, config, 'old-app'), []);
+
+    // A session context started on the old snapshot is not reused on the copy.
+    const context = createFileSearchQueryContext();
+    await search(snapshot, config, 'rep', context);
+    assert.deepEqual(await search(compacted, config, 'report', context), await search(snapshot, config, 'report'));
+
+    // Later watch batches land on the compacted copy.
+    write(path.join(home, 'Projects', 'app', 'src', 'report-later.ts'));
+    fs.rmSync(path.join(home, 'Downloads', 'invoice-1.pdf'));
+    await applyWatchEventBatch(compacted, config, [
+      path.join(home, 'Projects', 'app', 'src', 'report-later.ts'),
+      path.join(home, 'Downloads', 'invoice-1.pdf'),
+    ]);
+    const paths = (await search(compacted, config, 'report')).map(([resultPath]) => resultPath);
+    assert.ok(paths.includes(path.join(home, 'Projects', 'app', 'src', 'report-later.ts')));
+    assert.ok(!(await search(compacted, config, 'invoice')).some(([resultPath]) => resultPath.endsWith('invoice-1.pdf')));
+  } finally {
+    fs.rmSync(home, { recursive: true, force: true });
+  }
+});
+
+// All tests passed if we reach this point without throwing an error.
+// Using a ✓ here for consistency with the node:test output style.
+console.log('✓ All file-search-compaction tests passed');
@@ -0,0 +1,125 @@
+#!/usr/bin/env node
+
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import assert from 'assert/strict';
+import { loadTsModule } from './lib/ts-module-loader.mjs';
+
+const { IgnoreRules, IgnoreRulesCache } = loadTsModule('src/main/file-search-index-ignore.ts');
+
+const base = '/home/user/project';
+
+function rules(source, parent = null, baseDir = base) {
+  return IgnoreRules.compile(baseDir, [source], parent);
+}
+
+function ignored(chain, relativePath, isDirectory = false) {
+  const absolutePath = `${base}/${relativePath}`;
+  return chain.isIgnored(absolutePath, relativePath.split('/').pop(), isDirectory);
+}
+
+// Simple test runner to avoid adding a dependency on node:test
+// Using ✓ and ✗ here for consistency with the node:test output style.
+async function test(name, fn) {
+  try {
+    await fn();
+    console.log(`✓ ${name}`);
+  } catch (error) {
+    console.error(`✗ ${name}`);
+    throw error;
+  }
+}
+
+test('comments and blank lines compile to no rules', () => {
+  assert.equal(rules('# build output\n\n   \n'), null);
+});
+
+test('bare names match at any depth', () => {
+  const chain = rules('dist\nnode_modules/\n');
+  assert.equal(ignored(chain, 'dist', true), true);
+  assert.equal(ignored(chain, 'packages/app/dist', true), true);
+  assert.equal(ignored(chain, 'dist'), true);
+  assert.equal(ignored(chain, 'node_modules', true), true);
+  assert.equal(ignored(chain, 'node_modules'), false, 'trailing slash only matches directories');
+  assert.equal(ignored(chain, 'distance.txt'), false);
+});
+
+test('wildcards stay within one path segment', () => {
+  const chain = rules('*.pyc\nbuild-*\ncache?.db\n');
+  assert.equal(ignored(chain, 'src/module.pyc'), true);
+  assert.equal(ignored(chain, 'build-arm64', true), true);
+  assert.equal(ignored(chain, 'cache1.db'), true);
+  assert.equal(ignored(chain, 'cache12.db'), false);
+});
+
+test('patterns with a slash are anchored to the ignore file directory', () => {
+  const chain = rules('/out\ndocs/generated/\nsrc/*.gen.ts\n');
+  assert.equal(ignored(chain, 'out', true), true);
+  assert.equal(ignored(chain, 'packages/out', true), false);
+  assert.equal(ignored(chain, 'docs/generated', true), true);
+  assert.equal(ignored(chain, 'api/docs/generated', true), false);
+  assert.equal(ignored(chain, 'src/schema.gen.ts'), true);
+  assert.equal(ignored(chain, 'src/nested/schema.gen.ts'), false);
+});
+
+test('double stars match any number of directories', () => {
+  const chain = rules('**/fixtures/large\nlogs/**\na/**/z\n');
+  assert.equal(ignored(chain, 'fixtures/large', true), true);
+  assert.equal(ignored(chain, 'test/unit/fixtures/large', true), true);
+  assert.equal(ignored(chain, 'logs/today.txt'), true);
+  assert.equal(ignored(chain, 'logs', true), false, 'trailing /** matches inside the directory only');
+  assert.equal(ignored(chain, 'a/z', true), true);
+  assert.equal(ignored(chain, 'a/b/c/z', true), true);
+});
+
+test('character classes and escapes', () => {
+  const chain = rules('[Tt]emp\nfile[!0-9]\n\\#notes\n\\!important\ntrailing\\ \n');
+  assert.equal(ignored(chain, 'Temp', true), true);
+  assert.equal(ignored(chain, 'temp', true), true);
+  assert.equal(ignored(chain, 'filea'), true);
+  assert.equal(ignored(chain, 'file1'), false);
+  assert.equal(ignored(chain, '#notes'), true);
+  assert.equal(ignored(chain, '!important'), true);
+  assert.equal(ignored(chain, 'trailing '), true);
+});
+
+test('the last matching rule in a file wins', () => {
+  const chain = rules('*.log\n!keep.log\nbuild/\n!build/\n');
+  assert.equal(ignored(chain, 'debug.log'), true);
+  assert.equal(ignored(chain, 'keep.log'), false);
+  assert.equal(ignored(chain, 'build', true), false);
+});
+
+test('deeper ignore files override their parents', () => {
+  const parent = rules('*.csv\nvendor/\n');
+  const child = rules('!data.csv\n', parent, `${base}/reports`);
+  assert.equal(ignored(child, 'reports/data.csv'), false);
+  assert.equal(ignored(child, 'reports/other.csv'), true);
+  assert.equal(ignored(child, 'reports/vendor', true), true);
+});
+
+test('anchored rules of a nested ignore file are relative to that file', () => {
+  const parent = rules('/build\n');
+  const child = rules('/build\n', parent, `${base}/packages/web`);
+  assert.equal(ignored(child, 'packages/web/build', true), true);
+  assert.equal(ignored(child, 'packages/web/src/build', true), false);
+});
+
+await test('only the home root skips its own ignore files', async () => {
+  const root = fs.mkdtempSync(path.join(fs.realpathSync(os.tmpdir()), 'ignore-root-'));
+  try {
+    fs.writeFileSync(path.join(root, '.gitignore'), '*\n');
+    fs.mkdirSync(path.join(root, 'src'));
+    const project = new IgnoreRulesCache(root, true);
+    assert.equal(await project.isIgnored(path.join(root, 'src'), true), true);
+    const home = new IgnoreRulesCache(root, false);
+    assert.equal(await home.isIgnored(path.join(root, 'src'), true), false);
+  } finally {
+    fs.rmSync(root, { recursive: true, force: true });
+  }
+});
+
+// All tests passed if we reach this point without throwing an error.
+// Using a ✓ here for consistency with the node:test output style.
+console.log('✓ All file-search-ignore tests passed');
@@ -0,0 +1,94 @@
+#!/usr/bin/env node
+
+import assert from 'assert/strict';
+import { loadTsModule } from './lib/ts-module-loader.mjs';
+
+const {
+  isWatchablePath,
+  mergeFileSearchResults,
+  shouldSkipDirectory,
+} = loadTsModule('src/main/file-search-index-engine.ts');
+
+const home = '/home/user';
+const homeShard = { homeDir: home, includeRoots: [home], includeProtectedHomeRoots: false };
+const dataShard = { homeDir: home, includeRoots: ['/data'], includeProtectedHomeRoots: false };
+
+function result(name, score) {
+  return { path: `/r/${name}`, name, parentPath: '/r', displayPath: '/r', isDirectory: false, score };
+}
+
+// Names of merged results as an array of this realm: the merge runs in the
+// loader's sandbox, and deepEqual would not match its arrays against literals.
+function names(results) {
+  return Array.from(results, (entry) => entry.name);
+}
+
+// Simple test runner to avoid adding a dependency on node:test
+// Using ✓ and ✗ here for consistency with the node:test output style.
+function test(name, fn) {
+  try {
+    fn();
+    console.log(`✓ ${name}`);
+  } catch (error) {
+    console.error(`✗ ${name}`);
+    throw error;
+  }
+}
+
+test('home top-level rules only apply inside the home folder', () => {
+  assert.equal(shouldSkipDirectory(`${home}/Library`, 'Library', homeShard), true);
+  assert.equal(shouldSkipDirectory('/data/Library', 'Library', dataShard), false);
+  assert.equal(shouldSkipDirectory('/data/projects', 'projects', dataShard), false);
+});
+
+test('name rules apply in every root', () => {
+  assert.equal(shouldSkipDirectory('/data/app/node_modules', 'node_modules', dataShard), true);
+  assert.equal(shouldSkipDirectory('/data/.cache', '.cache', dataShard), true);
+});
+
+test('a shard skips everything outside its own root', () => {
+  assert.equal(shouldSkipDirectory('/data', 'data', dataShard), true);
+  assert.equal(shouldSkipDirectory('/database/x', 'x', dataShard), true);
+  assert.equal(shouldSkipDirectory(`${home}/Documents`, 'Documents', dataShard), true);
+  assert.equal(shouldSkipDirectory('/data/x', 'x', homeShard), true);
+});
+
+test('watchable paths are scoped to the shard root', () => {
+  assert.equal(isWatchablePath('/data/projects/app/main.c', dataShard), true);
+  assert.equal(isWatchablePath('/data/Library/notes.md', dataShard), true);
+  assert.equal(isWatchablePath('/data/app/.git/HEAD', dataShard), false);
+  assert.equal(isWatchablePath('/data', dataShard), false);
+  assert.equal(isWatchablePath(`${home}/Documents/a.txt`, dataShard), false);
+  assert.equal(isWatchablePath(`${home}/code/a.txt`, homeShard), true);
+  assert.equal(isWatchablePath(`${home}/Library/a.txt`, homeShard), false);
+});
+
+test('shard results merge by score', () => {
+  const merged = mergeFileSearchResults([
+    [result('a', 900), result('b', 400)],
+    [result('c', 700), result('d', 100)],
+  ]);
+  assert.deepEqual(names(merged), ['a', 'c', 'b', 'd']);
+});
+
+test('equal scores keep each shard\'s order and alternate shards', () => {
+  const merged = mergeFileSearchResults([
+    [result('home-newest', 500), result('home-older', 500)],
+    [result('data-newest', 500), result('data-older', 500)],
+  ]);
+  assert.deepEqual(names(merged), ['home-newest', 'data-newest', 'home-older', 'data-older']);
+});
+
+test('merged results respect the limit', () => {
+  const merged = mergeFileSearchResults([
+    [result('a', 3), result('b', 2)],
+    [],
+    [result('c', 1)],
+  ], 2);
+  assert.deepEqual(names(merged), ['a', 'b']);
+  assert.deepEqual(names(mergeFileSearchResults([[result('a', 1), result('b', 1)]], 1)), ['a']);
+});
+
+// All tests passed if we reach this point without throwing an error.
+// Using a ✓ here for consistency with the node:test output style.
+console.log('✓ All file-search-shards tests passed');
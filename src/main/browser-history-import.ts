@@ -0,0 +1,185 @@
+import type { BrowserSearchEntry, BrowserSearchSource } from './browser-search-history';
+import type { BrowserSearchStore, BrowserSearchVisit } from './browser-search-store';
+
+// Merges rows read from a browser's history database into the search store.
+//
+// Each row is matched against the profile's stored history by lowercased
+// URL in a map, so the merge is linear in the number of rows. A large import
+// reads the profile's visits (id, URL key and counters, not whole entries)
+// into the map once up front; a small refresh (only visits newer than the
+// last import) looks rows up through the store's source-profile index
+// instead. A matched row updates just the visit columns.
+//
+// Rows are written in batches, one transaction each, and the event loop gets
+// a turn between batches, so a first import of a long history neither holds
+// one huge transaction nor stalls the main process.
+
+export interface RawHistoryRow {
+  url: string;
+  title?: string;
+  visitCount: number;
+  lastVisit: number; // unix epoch ms
+}
+
+export interface BrowserHistoryImportProgress {
+  processed: number;
+  total: number;
+  imported: number;
+  rowsPerSecond: number;
+}
+
+export interface BrowserHistoryImportResult {
+  imported: number;
+  skipped: number;
+  changed: boolean;
+  elapsedMs: number;
+}
+
+// Each batch commits to the WAL; much smaller batches spend their time
+// checkpointing.
+export const HISTORY_IMPORT_BATCH_SIZE = 10000;
+
+// Below this many rows, per-row index lookups beat reading the profile.
+const KEYED_PRELOAD_MIN_ROWS = 1000;
+
+export async function mergeBrowserHistoryRows(
+  store: BrowserSearchStore,
+  rows: RawHistoryRow[],
+  options: {
+    source: BrowserSearchSource;
+    sourceProfileId?: string;
+    sourceProfileName?: string;
+    makeId: () => string;
+    extractHost: (url: string) => string;
+    batchSize?: number;
+    onProgress?: (progress: BrowserHistoryImportProgress) => void;
+  }
+): Promise<BrowserHistoryImportResult> {
+  const { source, sourceProfileId, sourceProfileName } = options;
+  const batchSize = Math.max(1, options.batchSize || HISTORY_IMPORT_BATCH_SIZE);
+  const startedAt = Date.now();
+  const lookup = createVisitLookup(store, source, sourceProfileId, rows.length >= KEYED_PRELOAD_MIN_ROWS);
+  let imported = 0;
+  let skipped = 0;
+  let changed = false;
+
+  for (let start = 0; start < rows.length; start += batchSize) {
+    const end = Math.min(rows.length, start + batchSize);
+    store.transaction(() => {
+      for (let index = start; index < end; index += 1) {
+        const row = rows[index];
+        if (!row.url) continue;
+        const host = options.extractHost(row.url);
+        if (!host) {
+          skipped += 1;
+          continue;
+        }
+        const valueKey = row.url.toLowerCase();
+        const ex = lookup.find(valueKey);
+        if (ex) {
+          let entryChanged = false;
+          const nextUseCount = Math.max(ex.useCount, row.visitCount);
+          if (nextUseCount !== ex.useCount) {
+            ex.useCount = nextUseCount;
+            entryChanged = true;
+          }
+          if (row.lastVisit > ex.lastUsedAt) {
+            ex.lastUsedAt = row.lastVisit;
+            entryChanged = true;
+          }
+          if (sourceProfileId && ex.sourceProfileId !== sourceProfileId) {
+            // Claims a row imported before profiles were tracked.
+            ex.sourceProfileId = sourceProfileId;
+            lookup.adopt(valueKey, ex);
+            entryChanged = true;
+          }
+          if (sourceProfileName && ex.sourceProfileName !== sourceProfileName) {
+            ex.sourceProfileName = sourceProfileName;
+            entryChanged = true;
+          }
+          if (entryChanged) {
+            store.updateVisit(ex);
+            changed = true;
+          }
+          skipped += 1;
+          continue;
+        }
+        const entry: BrowserSearchEntry = {
+          id: options.makeId(),
+          type: 'url',
+          query: row.title?.trim() || host,
+          url: row.url,
+          host,
+          lastUsedAt: row.lastVisit,
+          useCount: Math.max(1, row.visitCount),
+          source,
+          sourceProfileId,
+          sourceProfileName,
+        };
+        store.put(entry);
+        lookup.adopt(valueKey, {
+          id: entry.id,
+          valueKey,
+          useCount: entry.useCount,
+          lastUsedAt: entry.lastUsedAt,
+          sourceProfileId: sourceProfileId || '',
+          sourceProfileName,
+        });
+        imported += 1;
+        changed = true;
+      }
+    });
+    if (options.onProgress) {
+      const elapsedMs = Math.max(1, Date.now() - startedAt);
+      options.onProgress({
+        processed: end,
+        total: rows.length,
+        imported,
+        rowsPerSecond: Math.round((end * 1000) / elapsedMs),
+      });
+    }
+    if (end < rows.length) await new Promise<void>((resolve) => setImmediate(resolve));
+  }
+
+  return { imported, skipped, changed, elapsedMs: Date.now() - startedAt };
+}
+
+// Finds the stored visit a row merges into: the profile's own row for the
+// URL, else one imported before profiles were tracked (no profile id), which
+// the merge then claims for the profile with `adopt`.
+function createVisitLookup(
+  store: BrowserSearchStore,
+  source: BrowserSearchSource,
+  sourceProfileId: string | undefined,
+  preload: boolean
+): {
+  find: (valueKey: string) => BrowserSearchVisit | null;
+  adopt: (valueKey: string, visit: BrowserSearchVisit) => void;
+} {
+  const profileId = sourceProfileId || '';
+  if (!preload) {
+    return {
+      find: (valueKey) => store.findVisit(source, profileId, valueKey) ||
+        (profileId ? store.findVisit(source, '', valueKey) : null),
+      adopt: () => {},
+    };
+  }
+
+  const byKey = new Map<string, BrowserSearchVisit>();
+  const legacyByKey = new Map<string, BrowserSearchVisit>();
+  for (const visit of store.listVisits(source, profileId)) {
+    if (!byKey.has(visit.valueKey)) byKey.set(visit.valueKey, visit);
+  }
+  if (profileId) {
+    for (const visit of store.listVisits(source, '')) {
+      if (!legacyByKey.has(visit.valueKey)) legacyByKey.set(visit.valueKey, visit);
+    }
+  }
+  return {
+    find: (valueKey) => byKey.get(valueKey) || legacyByKey.get(valueKey) || null,
+    adopt: (valueKey, visit) => {
+      if (legacyByKey.get(valueKey) === visit) legacyByKey.delete(valueKey);
+      if (!byKey.has(valueKey)) byKey.set(valueKey, visit);
+    },
+  };
+}
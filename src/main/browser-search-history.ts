@@ -3,7 +3,8 @@
  *
  * Tracks URL opens and web searches issued from the launcher (Cmd+Enter)
  * and provides frecency-ranked autocomplete suggestions for the search input.
- * History is JSON-backed in userData and pruned by the retention setting.
+ * History lives in a SQLite database in userData (see browser-search-store.ts)
+ * and is pruned by the retention setting.
  *
  * Imports from installed browsers' SQLite history DBs via the system
  * `sqlite3` CLI (same pattern as `run-sqlite-query` in main.ts) so we
@@ -19,6 +20,13 @@ import * as path from 'path';
 import { promisify } from 'util';
 
 import { resolveBrowserInput } from './browser-input-resolver';
+import { mergeBrowserHistoryRows, type RawHistoryRow } from './browser-history-import';
+import {
+  BrowserSearchStore,
+  getBrowserSearchValueKey,
+  isBrowserSearchDatabaseCorrupt,
+  moveBrowserSearchDatabaseAside,
+} from './browser-search-store';
 import { loadSettings } from './settings-store';
 
 const execFileAsync = promisify(execFile);
@@ -73,7 +81,9 @@ export interface AutocompleteSuggestion {
   entry: BrowserSearchEntry;
 }
 
-let cache: BrowserSearchEntry[] | null = null;
+let store: BrowserSearchStore | null = null;
+// While the database cannot be opened, getStore() returns null until this time.
+let storeRetryAt = 0;
 let browserSearchRevision = 1;
 
 // ─── Paths ──────────────────────────────────────────────────────────
@@ -84,36 +94,66 @@ function getHistoryDir(): string {
   return dir;
 }
 
-function getHistoryPath(): string {
+function getDatabasePath(): string {
+  return path.join(getHistoryDir(), 'history.sqlite');
+}
+
+// The JSON file history was kept in before the database; migrated on open.
+function getLegacyHistoryPath(): string {
   return path.join(getHistoryDir(), 'history.json');
 }
 
 // ─── Persistence ────────────────────────────────────────────────────
 
-function load(): BrowserSearchEntry[] {
-  if (cache) return cache;
+const STORE_RETRY_DELAY_MS = 60_000;
+
+// The store, or null while the database cannot be opened (another instance
+// holds it, say): history then reads as empty and nothing is recorded, and the
+// database is opened again a minute later.
+function getStore(): BrowserSearchStore | null {
+  if (store) return store;
+  if (Date.now() < storeRetryAt) return null;
   try {
-    const raw = fs.readFileSync(getHistoryPath(), 'utf-8');
-    const parsed = JSON.parse(raw);
-    if (Array.isArray(parsed)) {
-      cache = parsed
-        .map((entry) => sanitizeEntry(entry))
-        .filter((entry): entry is BrowserSearchEntry => entry !== null);
-    } else {
-      cache = [];
-    }
-  } catch {
-    cache = [];
+    store = openStore(getDatabasePath());
+  } catch (e) {
+    storeRetryAt = Date.now() + STORE_RETRY_DELAY_MS;
+    console.error('Failed to open browser-search database:', e);
+    return null;
+  }
+  migrateLegacyHistory(store);
+  return store;
+}
+
+function openStore(dbPath: string): BrowserSearchStore {
+  try {
+    return new BrowserSearchStore(dbPath);
+  } catch (e) {
+    if (!isBrowserSearchDatabaseCorrupt(e)) throw e;
+    // Moved aside rather than deleted: typed searches and URLs exist nowhere else.
+    const movedPath = moveBrowserSearchDatabaseAside(dbPath);
+    console.error(`browser-search database is damaged; moved it to ${movedPath} and starting over:`, e);
+    return new BrowserSearchStore(dbPath);
   }
-  return cache!;
 }
 
-function save(): void {
-  if (!cache) return;
+function migrateLegacyHistory(target: BrowserSearchStore): void {
+  const legacyPath = getLegacyHistoryPath();
+  if (!fs.existsSync(legacyPath)) return;
   try {
-    fs.writeFileSync(getHistoryPath(), JSON.stringify(cache, null, 2));
+    const parsed = JSON.parse(fs.readFileSync(legacyPath, 'utf-8'));
+    const entries = Array.isArray(parsed)
+      ? parsed
+        .map((entry) => sanitizeEntry(entry))
+        .filter((entry): entry is BrowserSearchEntry => entry !== null)
+      : [];
+    // Puts are keyed by id, so a migration cut short is simply redone.
+    target.transaction(() => {
+      for (const entry of entries) target.put(entry);
+    });
+    fs.unlinkSync(legacyPath);
+    console.log(`Moved ${entries.length} browser-search entries into SQLite`);
   } catch (e) {
-    console.error('Failed to save browser-search history:', e);
+    console.error('Failed to migrate browser-search history:', e);
   }
 }
 
@@ -206,34 +246,29 @@ function extractHost(url: string): string {
 // ─── Public API ─────────────────────────────────────────────────────
 
 export function listEntries(): BrowserSearchEntry[] {
-  return load().slice();
+  return getStore()?.all() || [];
 }
 
 export function getBrowserSearchRevision(): number {
-  load();
+  getStore();
   return browserSearchRevision;
 }
 
 export function getBrowserSearchStats(): BrowserSearchStats {
-  const entries = load();
+  const entries = getStore();
+  const { historyEntries, bookmarkEntries, profileCounts } = entries
+    ? entries.stats()
+    : { historyEntries: 0, bookmarkEntries: 0, profileCounts: [] };
   const history: Record<string, number> = {};
   const bookmark: Record<string, number> = {};
-  let historyEntries = 0;
-  let bookmarkEntries = 0;
-  for (const entry of entries) {
-    if (entry.type !== 'url' && entry.type !== 'bookmark') continue;
-    const profileId = entry.sourceProfileId ? `${entry.source}:${entry.sourceProfileId}` : '';
-    if (entry.type === 'url') {
-      historyEntries += 1;
-      if (profileId) history[profileId] = (history[profileId] || 0) + 1;
-    } else {
-      bookmarkEntries += 1;
-      if (profileId) bookmark[profileId] = (bookmark[profileId] || 0) + 1;
-    }
+  for (const { type, source, profileId, count } of profileCounts) {
+    const counts = type === 'url' ? history : bookmark;
+    const key = `${source}:${profileId}`;
+    counts[key] = (counts[key] || 0) + count;
   }
   return {
     revision: browserSearchRevision,
-    totalEntries: entries.length,
+    totalEntries: entries ? entries.count() : 0,
     historyEntries,
     bookmarkEntries,
     profileCountsByKind: { history, bookmark },
@@ -244,18 +279,10 @@ export function removeEntriesForProfile(profileSourceId: string): number {
   const [source, ...profileParts] = String(profileSourceId || '').trim().split(':');
   const profileId = profileParts.join(':');
   if (!source || !profileId) return 0;
-  const entries = load();
-  const before = entries.length;
-  const next = entries.filter((entry) => {
-    if (entry.source !== source) return true;
-    const entryProfile = String(entry.sourceProfileId || '');
-    return entryProfile !== profileId && entryProfile !== profileSourceId;
-  });
-  if (next.length === before) return 0;
-  cache = next;
+  const removed = getStore()?.deleteForProfile(source, [profileId, profileSourceId]) || 0;
+  if (removed === 0) return 0;
   bumpBrowserSearchRevision();
-  save();
-  return before - next.length;
+  return removed;
 }
 
 export async function openInDefaultBrowser(rawInput: string): Promise<{
@@ -291,20 +318,22 @@ export function recordResolvedInput(rawInput: string, resolved: ResolvedInput):
 
 function findProfileEntryForInput(rawInput: string): BrowserSearchEntry | null {
   const trimmed = String(rawInput || '').trim();
-  if (!trimmed) return null;
+  const history = getStore();
+  if (!trimmed || !history) return null;
 
-  const bookmarkMatches = load().filter((entry) =>
-    entry.type === 'bookmark' &&
+  const bookmarkMatches = history.findByQuery('bookmark', trimmed.toLowerCase()).filter((entry) =>
     entry.sourceProfileId &&
-    Boolean(CHROMIUM_PROFILE_OPEN_APPS[entry.source]) &&
-    entry.query.toLowerCase() === trimmed.toLowerCase()
+    Boolean(CHROMIUM_PROFILE_OPEN_APPS[entry.source])
   );
   if (bookmarkMatches.length > 0) return bestByFrecency(bookmarkMatches);
 
   const resolved = resolveInput(trimmed);
   if (!resolved || resolved.type !== 'url') return null;
 
-  const entries = load().filter((entry) =>
+  // An exact URL match has the same host, and a host match the same host
+  // give or take "www.", so only entries for those hosts are candidates.
+  const host = stripWww(resolved.host);
+  const entries = history.findByHosts([host, `www.${host}`]).filter((entry) =>
     (entry.type === 'url' || entry.type === 'bookmark') &&
     entry.sourceProfileId &&
     Boolean(CHROMIUM_PROFILE_OPEN_APPS[entry.source])
@@ -315,7 +344,6 @@ function findProfileEntryForInput(rawInput: string): BrowserSearchEntry | null {
   const exactMatches = entries.filter((entry) => normalizeUrlForMatch(entry.url) === normalizedTarget);
   if (exactMatches.length > 0) return bestByFrecency(exactMatches);
 
-  const host = stripWww(resolved.host);
   const inputWithoutProtocol = trimmed.replace(/^https?:\/\//i, '');
   const isHostOnlyInput = !inputWithoutProtocol.includes('/') && !inputWithoutProtocol.includes('?') && !inputWithoutProtocol.includes('#');
   if (!host || !isHostOnlyInput) return null;
@@ -368,33 +396,34 @@ async function openEntryUrl(entry: BrowserSearchEntry): Promise<void> {
 }
 
 function recordEntryUse(entry: BrowserSearchEntry): void {
-  const entries = load();
-  const existing = entries.find((candidate) => candidate.id === entry.id) ||
-    entries.find((candidate) => importEntryKey(candidate) === importEntryKey(entry));
-  const now = Date.now();
+  const entries = getStore();
+  if (!entries) return;
+  const existing = entries.getById(entry.id) ||
+    entries.findImported(entry.type, entry.source || 'user', entry.sourceProfileId || '', getBrowserSearchValueKey(entry));
   if (existing) {
     existing.useCount += 1;
-    existing.lastUsedAt = now;
+    existing.lastUsedAt = Date.now();
+    entries.put(existing);
     bumpBrowserSearchRevision();
   }
-  pruneByRetentionInPlace(entries);
-  trimToCapInPlace(entries);
-  cache = entries;
-  save();
+  if (pruneByRetention() > 0) bumpBrowserSearchRevision();
 }
 
 function recordEntry(query: string, resolved: ResolvedInput, source: BrowserSearchSource = 'user'): void {
-  if (!query) return;
-  const entries = load();
-  const dedupeKey = entryKey(resolved.type, resolved.type === 'search' ? query : resolved.url);
-  const existing = entries.find((e) => entryKey(e.type, e.type === 'search' ? e.query : e.url) === dedupeKey);
+  const entries = getStore();
+  if (!query || !entries) return;
+  const existing = entries.findByValue(
+    resolved.type,
+    getBrowserSearchValueKey({ type: resolved.type, query, url: resolved.url })
+  );
   const now = Date.now();
   if (existing) {
     existing.useCount += 1;
     existing.lastUsedAt = now;
     if (resolved.type === 'url' && !existing.host) existing.host = resolved.host;
+    entries.put(existing);
   } else {
-    entries.push({
+    entries.put({
       id: makeId(),
       type: resolved.type,
       query,
@@ -405,15 +434,8 @@ function recordEntry(query: string, resolved: ResolvedInput, source: BrowserSear
       source,
     });
   }
-  pruneByRetentionInPlace(entries);
-  trimToCapInPlace(entries);
-  cache = entries;
+  pruneByRetention();
   bumpBrowserSearchRevision();
-  save();
-}
-
-function entryKey(type: BrowserSearchEntryType, value: string): string {
-  return `${type}:${value.toLowerCase()}`;
 }
 
 function importEntryKey(entry: Pick<BrowserSearchEntry, 'type' | 'url' | 'query' | 'source'> & {
@@ -426,36 +448,25 @@ function importEntryKey(entry: Pick<BrowserSearchEntry, 'type' | 'url' | 'query'
 }
 
 export function clearHistory(): void {
-  const hadEntries = load().length > 0;
-  cache = [];
-  if (hadEntries) bumpBrowserSearchRevision();
-  save();
+  const entries = getStore();
+  if (!entries || entries.count() === 0) return;
+  entries.clear();
+  bumpBrowserSearchRevision();
 }
 
 export function pruneByRetentionNow(): void {
-  const entries = load();
-  const before = entries.length;
-  pruneByRetentionInPlace(entries);
-  cache = entries;
-  if (entries.length !== before) bumpBrowserSearchRevision();
-  save();
+  if (pruneByRetention() > 0) bumpBrowserSearchRevision();
 }
 
-function pruneByRetentionInPlace(entries: BrowserSearchEntry[]): void {
+// Browser imports intentionally keep every retained row: retention prunes old
+// entries, but there is no fixed count cap. Returns the number removed.
+function pruneByRetention(): number {
   const days = loadSettings().browserSearch.historyRetentionDays;
-  if (!days || days <= 0) return;
-  const cutoff = Date.now() - days * 24 * 60 * 60 * 1000;
-  for (let i = entries.length - 1; i >= 0; i--) {
-    if (entries[i].type === 'bookmark') continue;
-    if (entries[i].lastUsedAt < cutoff) entries.splice(i, 1);
-  }
-}
-
-function trimToCapInPlace(entries: BrowserSearchEntry[]): void {
-  // Browser imports intentionally keep every retained row. Retention settings
-  // still prune old entries, but there is no fixed count cap.
+  if (!days || days <= 0) return 0;
+  return getStore()?.deleteUsedBefore(Date.now() - days * 24 * 60 * 60 * 1000) || 0;
 }
 
+// Mirrored by frecencySql() in browser-search-store.ts for autocomplete.
 function frecency(entry: BrowserSearchEntry): number {
   const ageDays = Math.max(0, (Date.now() - entry.lastUsedAt) / (24 * 60 * 60 * 1000));
   // log-style decay: a year-old visit is worth ~30% of a fresh one.
@@ -475,63 +486,33 @@ function frecency(entry: BrowserSearchEntry): number {
 export function getAutocomplete(rawInput: string): AutocompleteSuggestion | null {
   const input = String(rawInput || '');
   const lower = input.toLowerCase();
-  if (!lower.trim()) return null;
-  // Don't autocomplete inputs that already contain whitespace at a "URL-ish" position
-  // unless the user is clearly typing a search query.
-  const entries = load();
-  if (entries.length === 0) return null;
+  const entries = getStore();
+  if (!lower.trim() || !entries) return null;
 
   // Strip a leading "https://" or "http://" so typing a host alone matches.
   const stripped = lower.replace(/^https?:\/\//, '');
   const hasProtocol = stripped !== lower;
 
-  // Pass 1: URL-host prefix match (highest priority).
-  const urlCandidates = entries
-    .filter((e) => (e.type === 'url' || e.type === 'bookmark') && e.host)
-    .map((e) => {
-      const host = e.host;
-      const fullPrefixOptions = [host];
-      // Allow matches like "git" → host "github.com" — match against host and host without "www.".
-      if (host.startsWith('www.')) fullPrefixOptions.push(host.slice(4));
-      return { entry: e, options: fullPrefixOptions };
-    })
-    .map(({ entry, options }) => {
-      for (const opt of options) {
-        if (opt.startsWith(stripped) && opt.length > stripped.length) {
-          return { entry, completion: opt, score: frecency(entry) };
-        }
-      }
-      return null;
-    })
-    .filter((x): x is { entry: BrowserSearchEntry; completion: string; score: number } => x !== null);
-
-  if (urlCandidates.length > 0) {
-    urlCandidates.sort((a, b) => b.score - a.score);
-    const best = urlCandidates[0];
+  // Pass 1: URL-host prefix match (highest priority), against the host and
+  // the host without "www.", so "git" → "github.com". Ranked by frecency.
+  const now = Date.now();
+  const hostMatch = entries.bestByHostPrefix(stripped, now);
+  if (hostMatch) {
     // Reconstruct the completion text in the user's casing where possible.
     const completionDisplay = (hasProtocol ? input.slice(0, input.length - stripped.length) : '') +
-      preserveLeadingCase(input.replace(/^https?:\/\//, ''), best.completion);
+      preserveLeadingCase(input.replace(/^https?:\/\//, ''), hostMatch.completion);
     return {
       completion: completionDisplay,
       suffix: completionDisplay.slice(input.length),
-      entry: best.entry,
+      entry: hostMatch.entry,
     };
   }
 
   // Pass 2: bookmark-title and search-query prefix match.
-  const searchCandidates = entries
-    .filter((e) =>
-      (e.type === 'search' || e.type === 'bookmark') &&
-      e.query.toLowerCase().startsWith(lower) &&
-      e.query.length > input.length
-    )
-    .map((entry) => ({ entry, score: frecency(entry) }));
-
-  if (searchCandidates.length > 0) {
-    searchCandidates.sort((a, b) => b.score - a.score);
-    const best = searchCandidates[0];
-    const completion = input + best.entry.query.slice(input.length);
-    return { completion, suffix: completion.slice(input.length), entry: best.entry };
+  const queryMatch = entries.bestByQueryPrefix(lower, now);
+  if (queryMatch) {
+    const completion = input + queryMatch.query.slice(input.length);
+    return { completion, suffix: completion.slice(input.length), entry: queryMatch };
   }
 
   return null;
@@ -696,13 +677,6 @@ export function listImportableBrowsers(): ImportableBrowser[] {
   return out;
 }
 
-interface RawHistoryRow {
-  url: string;
-  title?: string;
-  visitCount: number;
-  lastVisit: number; // unix epoch ms
-}
-
 interface RawBookmarkRow {
   url: string;
   title: string;
@@ -780,14 +754,27 @@ async function importFromProfiles(
   };
 }
 
-async function importFromSource(
+// The merge yields between batches; running imports one at a time keeps two
+// imports of the same profile from merging into each other's stale view.
+let importQueue: Promise<unknown> = Promise.resolve();
+
+function importFromSource(
+  browser: ImportableBrowser | ImportableBrowserProfile
+): Promise<{ imported: number; skipped: number; total: number; reason?: string }> {
+  const run = importQueue.then(() => importFromSourceNow(browser));
+  importQueue = run.catch(() => {});
+  return run;
+}
+
+async function importFromSourceNow(
   browser: ImportableBrowser | ImportableBrowserProfile
 ): Promise<{ imported: number; skipped: number; total: number; reason?: string }> {
   const browserId = 'browserId' in browser ? browser.browserId : browser.id;
   const sourceProfileId = 'profileId' in browser ? browser.profileId : undefined;
   const sourceProfileName = 'profileName' in browser ? browser.profileName : undefined;
-  const entries = load();
-  const since = getNewestStoredVisitAt(entries, browserId, sourceProfileId);
+  const entries = getStore();
+  if (!entries) return { imported: 0, skipped: 0, total: 0, reason: 'Browser search history is unavailable' };
+  const since = entries.newestVisitAt(browserId, sourceProfileId || '');
   let rows: RawHistoryRow[] = [];
   try {
     rows = await readBrowserHistoryRows(browser, since);
@@ -798,195 +785,113 @@ async function importFromSource(
     ? readChromiumBookmarks(browser.bookmarksPath)
     : [];
 
-  const existingKeys = new Set(entries.map((e) => importEntryKey(e)));
-  let changed = false;
-  let imported = 0;
-  let skipped = 0;
-  for (const row of rows) {
-    if (!row.url) continue;
-    const host = extractHost(row.url);
-    if (!host) {
-      skipped += 1;
-      continue;
-    }
-    const query = row.title?.trim() || host;
-    const key = importEntryKey({
-      type: 'url',
-      url: row.url,
-      query,
-      source: browserId,
-      sourceProfileId,
-    });
-    const legacyKey = sourceProfileId
-      ? importEntryKey({
-          type: 'url',
-          url: row.url,
+  const merged = await mergeBrowserHistoryRows(entries, rows, {
+    source: browserId,
+    sourceProfileId,
+    sourceProfileName,
+    makeId,
+    extractHost,
+  });
+  if (rows.length > 0) {
+    const rate = Math.round((rows.length * 1000) / Math.max(1, merged.elapsedMs));
+    console.log(`Merged ${rows.length} ${browserId} history rows (${merged.imported} new) in ${merged.elapsedMs}ms, ${rate} rows/s`);
+  }
+  let { changed, imported, skipped } = merged;
+
+  entries.transaction(() => {
+    if (sourceProfileId) {
+      const seenBookmarkKeys = new Set<string>();
+      const existingBookmarkByKey = new Map<string, BrowserSearchEntry>();
+      const existingBookmarks = entries.listForProfile(browserId, sourceProfileId, 'bookmark');
+      for (const entry of existingBookmarks) existingBookmarkByKey.set(importEntryKey(entry), entry);
+
+      for (const bookmark of bookmarkRows) {
+        const host = extractHost(bookmark.url);
+        if (!host) {
+          skipped += 1;
+          continue;
+        }
+        const query = bookmark.title || host;
+        const key = importEntryKey({
+          type: 'bookmark',
           query,
+          url: bookmark.url,
           source: browserId,
-        })
-      : key;
-    const matchedKey = existingKeys.has(key) ? key : existingKeys.has(legacyKey) ? legacyKey : null;
-    if (matchedKey) {
-      const ex = entries.find((e) => importEntryKey(e) === matchedKey);
-      if (ex) {
-        const nextUseCount = Math.max(ex.useCount, row.visitCount);
-        if (nextUseCount !== ex.useCount) {
-          ex.useCount = nextUseCount;
-          changed = true;
-        }
-        if (row.lastVisit > ex.lastUsedAt) {
-          ex.lastUsedAt = row.lastVisit;
-          changed = true;
-        }
-        if (sourceProfileId && ex.sourceProfileId !== sourceProfileId) {
-          ex.sourceProfileId = sourceProfileId;
-          changed = true;
-        }
-        if (sourceProfileName && ex.sourceProfileName !== sourceProfileName) {
-          ex.sourceProfileName = sourceProfileName;
-          changed = true;
+          sourceProfileId,
+        });
+        seenBookmarkKeys.add(key);
+        const existingBookmark = existingBookmarkByKey.get(key);
+        if (existingBookmark) {
+          let entryChanged = false;
+          const nextLastUsedAt = bookmark.dateAdded || existingBookmark.lastUsedAt || Date.now();
+          if (existingBookmark.query !== query) {
+            existingBookmark.query = query;
+            entryChanged = true;
+          }
+          if (existingBookmark.host !== host) {
+            existingBookmark.host = host;
+            entryChanged = true;
+          }
+          if (existingBookmark.lastUsedAt !== nextLastUsedAt) {
+            existingBookmark.lastUsedAt = nextLastUsedAt;
+            entryChanged = true;
+          }
+          if (existingBookmark.useCount !== 1) {
+            existingBookmark.useCount = 1;
+            entryChanged = true;
+          }
+          if (existingBookmark.sourceProfileName !== sourceProfileName) {
+            existingBookmark.sourceProfileName = sourceProfileName;
+            entryChanged = true;
+          }
+          if (existingBookmark.bookmarkFolder !== bookmark.folder) {
+            existingBookmark.bookmarkFolder = bookmark.folder;
+            entryChanged = true;
+          }
+          if (existingBookmark.bookmarkOrder !== bookmark.order) {
+            existingBookmark.bookmarkOrder = bookmark.order;
+            entryChanged = true;
+          }
+          if (entryChanged) {
+            entries.put(existingBookmark);
+            changed = true;
+          }
+          skipped += 1;
+          continue;
         }
-        existingKeys.add(importEntryKey(ex));
+        const entry = {
+          id: makeId(),
+          type: 'bookmark' as const,
+          query,
+          url: bookmark.url,
+          host,
+          lastUsedAt: bookmark.dateAdded || Date.now(),
+          useCount: 1,
+          source: browserId,
+          sourceProfileId,
+          sourceProfileName,
+          bookmarkFolder: bookmark.folder,
+          bookmarkOrder: bookmark.order,
+        };
+        entries.put(entry);
+        imported += 1;
+        changed = true;
       }
-      skipped += 1;
-      continue;
-    }
-    entries.push({
-      id: makeId(),
-      type: 'url',
-      query,
-      url: row.url,
-      host,
-      lastUsedAt: row.lastVisit,
-      useCount: Math.max(1, row.visitCount),
-      source: browserId,
-      sourceProfileId,
-      sourceProfileName,
-    });
-    existingKeys.add(key);
-    imported += 1;
-    changed = true;
-  }
-
-  if (sourceProfileId) {
-    const seenBookmarkKeys = new Set<string>();
-    const existingBookmarkByKey = new Map<string, BrowserSearchEntry>();
-    for (const entry of entries) {
-      if (entry.type !== 'bookmark') continue;
-      if (entry.source !== browserId) continue;
-      if ((entry.sourceProfileId || '') !== sourceProfileId) continue;
-      existingBookmarkByKey.set(importEntryKey(entry), entry);
-    }
 
-    for (const bookmark of bookmarkRows) {
-      const host = extractHost(bookmark.url);
-      if (!host) {
-        skipped += 1;
-        continue;
-      }
-      const query = bookmark.title || host;
-      const key = importEntryKey({
-        type: 'bookmark',
-        query,
-        url: bookmark.url,
-        source: browserId,
-        sourceProfileId,
-      });
-      seenBookmarkKeys.add(key);
-      const existingBookmark = existingBookmarkByKey.get(key);
-      if (existingBookmark) {
-        const nextLastUsedAt = bookmark.dateAdded || existingBookmark.lastUsedAt || Date.now();
-        if (existingBookmark.query !== query) {
-          existingBookmark.query = query;
-          changed = true;
-        }
-        if (existingBookmark.host !== host) {
-          existingBookmark.host = host;
-          changed = true;
-        }
-        if (existingBookmark.lastUsedAt !== nextLastUsedAt) {
-          existingBookmark.lastUsedAt = nextLastUsedAt;
-          changed = true;
-        }
-        if (existingBookmark.useCount !== 1) {
-          existingBookmark.useCount = 1;
-          changed = true;
-        }
-        if (existingBookmark.sourceProfileName !== sourceProfileName) {
-          existingBookmark.sourceProfileName = sourceProfileName;
-          changed = true;
-        }
-        if (existingBookmark.bookmarkFolder !== bookmark.folder) {
-          existingBookmark.bookmarkFolder = bookmark.folder;
-          changed = true;
-        }
-        if (existingBookmark.bookmarkOrder !== bookmark.order) {
-          existingBookmark.bookmarkOrder = bookmark.order;
-          changed = true;
-        }
-        skipped += 1;
-        continue;
+      for (const entry of existingBookmarks) {
+        if (seenBookmarkKeys.has(importEntryKey(entry))) continue;
+        entries.delete(entry.id);
+        changed = true;
       }
-      const entry = {
-        id: makeId(),
-        type: 'bookmark' as const,
-        query,
-        url: bookmark.url,
-        host,
-        lastUsedAt: bookmark.dateAdded || Date.now(),
-        useCount: 1,
-        source: browserId,
-        sourceProfileId,
-        sourceProfileName,
-        bookmarkFolder: bookmark.folder,
-        bookmarkOrder: bookmark.order,
-      };
-      entries.push(entry);
-      existingKeys.add(importEntryKey(entry));
-      imported += 1;
-      changed = true;
-    }
-
-    for (let i = entries.length - 1; i >= 0; i--) {
-      const entry = entries[i];
-      if (entry.type !== 'bookmark') continue;
-      if (entry.source !== browserId) continue;
-      if ((entry.sourceProfileId || '') !== sourceProfileId) continue;
-      if (seenBookmarkKeys.has(importEntryKey(entry))) continue;
-      existingKeys.delete(importEntryKey(entry));
-      entries.splice(i, 1);
-      changed = true;
     }
-  }
 
-  const beforePruneLength = entries.length;
-  pruneByRetentionInPlace(entries);
-  trimToCapInPlace(entries);
-  if (entries.length !== beforePruneLength) changed = true;
-  cache = entries;
-  if (changed) {
-    bumpBrowserSearchRevision();
-    save();
-  }
+    if (pruneByRetention() > 0) changed = true;
+  });
+  if (changed) bumpBrowserSearchRevision();
 
   return { imported, skipped, total: rows.length + bookmarkRows.length };
 }
 
-function getNewestStoredVisitAt(
-  entries: BrowserSearchEntry[],
-  source: BrowserSearchSource,
-  sourceProfileId?: string
-): number {
-  let newest = 0;
-  for (const entry of entries) {
-    if (entry.type !== 'url') continue;
-    if (entry.source !== source) continue;
-    if ((entry.sourceProfileId || '') !== (sourceProfileId || '')) continue;
-    if (entry.lastUsedAt > newest) newest = entry.lastUsedAt;
-  }
-  return newest;
-}
-
 async function readBrowserHistoryRows(
   browser: ImportableBrowser | ImportableBrowserProfile,
   afterVisitAt = 0
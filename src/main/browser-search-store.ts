@@ -0,0 +1,380 @@
+import * as fs from 'fs';
+
+import type { BrowserSearchEntry, BrowserSearchEntryType, BrowserSearchSource } from './browser-search-history';
+
+// SQLite storage for browser search history and bookmarks, through the
+// node:sqlite module bundled with Electron's Node (no native dependency).
+// The database runs in WAL mode so a write appends to the log instead of
+// rewriting the file, and every lookup the launcher makes has an index:
+//
+//   - host               host matches (opening an entry in its profile)
+//   - type host          (type, host, use_count, last_used_at): host-prefix
+//                        autocomplete, ranked from the index alone
+//   - type query         (type, query_lower, use_count, last_used_at): exact
+//                        bookmark titles and query-prefix autocomplete
+//   - last_used_at       retention pruning
+//   - source profile     (source, source_profile_id, type, value_key): an
+//                        imported profile's rows, and the import dedupe key
+//   - value              (type, value_key): launcher entries deduped by URL
+//                        or search text
+//
+// `value_key` is the lowercased URL, or the lowercased query for searches.
+
+type SqliteValue = string | number | bigint | null | Uint8Array;
+type SqliteRow = Record<string, SqliteValue>;
+type SqliteStatement = {
+  run: (...params: SqliteValue[]) => { changes: number | bigint };
+  get: (...params: SqliteValue[]) => SqliteRow | undefined;
+  all: (...params: SqliteValue[]) => SqliteRow[];
+};
+type SqliteDatabase = {
+  exec: (sql: string) => void;
+  prepare: (sql: string) => SqliteStatement;
+  close: () => void;
+};
+
+const SCHEMA_VERSION = 2;
+
+// SQLite primary result codes.
+const SQLITE_CORRUPT = 11;
+const SQLITE_NOTADB = 26;
+
+// Sorts after any text that starts with the same prefix, so `>= prefix AND
+// < prefix + PREFIX_END` is an index range scan.
+const PREFIX_END = '\u{10FFFF}';
+
+// frecency() in browser-search-history.ts, for ranking in SQL: use count
+// times a log-style decay in days since last use. `now` names the parameter
+// holding the current time.
+function frecencySql(now: string): string {
+  return `use_count / (1 + log10(1 + max(0, (${now} - last_used_at) / 86400000.0)))`;
+}
+
+const ENTRY_COLUMNS = `id, type, query, url, host, last_used_at, use_count, source,
+  source_profile_id, source_profile_name, bookmark_folder, bookmark_order`;
+
+// The fields a history import merges into, without the rest of the entry.
+export interface BrowserSearchVisit {
+  id: string;
+  valueKey: string;
+  useCount: number;
+  lastUsedAt: number;
+  sourceProfileId: string;
+  sourceProfileName?: string;
+}
+
+export function getBrowserSearchValueKey(entry: Pick<BrowserSearchEntry, 'type' | 'query' | 'url'>): string {
+  return (entry.type === 'search' ? entry.query : entry.url).toLowerCase();
+}
+
+export class BrowserSearchStore {
+  private readonly db: SqliteDatabase;
+  private readonly statements = new Map<string, SqliteStatement>();
+
+  constructor(filePath: string) {
+    const { DatabaseSync } = require('node:sqlite') as { DatabaseSync: new (location: string) => SqliteDatabase };
+    this.db = new DatabaseSync(filePath);
+    try {
+      this.db.exec('PRAGMA journal_mode = WAL');
+      this.db.exec('PRAGMA synchronous = NORMAL');
+      this.migrate();
+    } catch (error) {
+      this.db.close();
+      throw error;
+    }
+  }
+
+  close(): void {
+    this.statements.clear();
+    this.db.close();
+  }
+
+  // Runs `fn` in one transaction: one WAL commit however many rows it writes.
+  transaction<T>(fn: () => T): T {
+    this.db.exec('BEGIN');
+    try {
+      const result = fn();
+      this.db.exec('COMMIT');
+      return result;
+    } catch (error) {
+      this.db.exec('ROLLBACK');
+      throw error;
+    }
+  }
+
+  count(): number {
+    return Number(this.statement('SELECT COUNT(*) AS n FROM entries').get()?.n || 0);
+  }
+
+  all(): BrowserSearchEntry[] {
+    return this.statement(`SELECT ${ENTRY_COLUMNS} FROM entries ORDER BY rowid`).all().map(toEntry);
+  }
+
+  getById(id: string): BrowserSearchEntry | null {
+    const row = this.statement(`SELECT ${ENTRY_COLUMNS} FROM entries WHERE id = ?`).get(id);
+    return row ? toEntry(row) : null;
+  }
+
+  // The entry an import of `source`/`profileId` would merge into.
+  findImported(
+    type: BrowserSearchEntryType,
+    source: BrowserSearchSource,
+    profileId: string,
+    valueKey: string
+  ): BrowserSearchEntry | null {
+    const row = this.statement(`SELECT ${ENTRY_COLUMNS} FROM entries
+      WHERE source = ? AND source_profile_id = ? AND type = ? AND value_key = ? LIMIT 1`)
+      .get(source, profileId, type, valueKey);
+    return row ? toEntry(row) : null;
+  }
+
+  findByValue(type: BrowserSearchEntryType, valueKey: string): BrowserSearchEntry | null {
+    const row = this.statement(`SELECT ${ENTRY_COLUMNS} FROM entries WHERE type = ? AND value_key = ? LIMIT 1`)
+      .get(type, valueKey);
+    return row ? toEntry(row) : null;
+  }
+
+  findByHosts(hosts: string[]): BrowserSearchEntry[] {
+    const out: BrowserSearchEntry[] = [];
+    const statement = this.statement(`SELECT ${ENTRY_COLUMNS} FROM entries WHERE host = ?`);
+    for (const host of new Set(hosts)) {
+      for (const row of statement.all(host)) out.push(toEntry(row));
+    }
+    return out;
+  }
+
+  findByQuery(type: BrowserSearchEntryType, queryLower: string): BrowserSearchEntry[] {
+    return this.statement(`SELECT ${ENTRY_COLUMNS} FROM entries WHERE type = ? AND query_lower = ?`)
+      .all(type, queryLower)
+      .map(toEntry);
+  }
+
+  // The url or bookmark entry with the highest frecency whose host, or host
+  // without "www.", strictly extends `prefix`, with that completed host.
+  bestByHostPrefix(prefix: string, now: number): { entry: BrowserSearchEntry; completion: string } | null {
+    // A host extending the prefix itself wins over its "www."-less form.
+    const row = this.statement(`SELECT id,
+        CASE WHEN host > ?1 AND host < ?2 THEN host ELSE substr(host, 5) END AS completion
+      FROM entries
+      WHERE type IN ('url', 'bookmark') AND ((host > ?1 AND host < ?2) OR (host > ?3 AND host < ?4))
+      ORDER BY ${frecencySql('?5')} DESC LIMIT 1`)
+      .get(prefix, prefix + PREFIX_END, `www.${prefix}`, `www.${prefix}${PREFIX_END}`, now);
+    const entry = row ? this.getById(String(row.id)) : null;
+    return entry ? { entry, completion: String(row?.completion) } : null;
+  }
+
+  // The search or bookmark entry with the highest frecency whose lowercased
+  // query strictly extends `prefixLower`.
+  bestByQueryPrefix(prefixLower: string, now: number): BrowserSearchEntry | null {
+    const row = this.statement(`SELECT id FROM entries
+      WHERE type IN ('search', 'bookmark') AND query_lower > ?1 AND query_lower < ?2
+      ORDER BY ${frecencySql('?3')} DESC LIMIT 1`)
+      .get(prefixLower, prefixLower + PREFIX_END, now);
+    return row ? this.getById(String(row.id)) : null;
+  }
+
+  listForProfile(source: BrowserSearchSource, profileId: string, type: BrowserSearchEntryType): BrowserSearchEntry[] {
+    return this.statement(`SELECT ${ENTRY_COLUMNS} FROM entries
+      WHERE source = ? AND source_profile_id = ? AND type = ?`)
+      .all(source, profileId, type)
+      .map(toEntry);
+  }
+
+  // The history rows of `source`/`profileId` as visits, for an import to
+  // merge into; much cheaper to read than whole entries.
+  listVisits(source: BrowserSearchSource, profileId: string): BrowserSearchVisit[] {
+    return this.statement(`SELECT id, value_key, use_count, last_used_at, source_profile_id, source_profile_name
+      FROM entries WHERE source = ? AND source_profile_id = ? AND type = 'url'`)
+      .all(source, profileId)
+      .map(toVisit);
+  }
+
+  findVisit(source: BrowserSearchSource, profileId: string, valueKey: string): BrowserSearchVisit | null {
+    const row = this.statement(`SELECT id, value_key, use_count, last_used_at, source_profile_id, source_profile_name
+      FROM entries WHERE source = ? AND source_profile_id = ? AND type = 'url' AND value_key = ? LIMIT 1`)
+      .get(source, profileId, valueKey);
+    return row ? toVisit(row) : null;
+  }
+
+  updateVisit(visit: BrowserSearchVisit): void {
+    this.statement(`UPDATE entries SET use_count = ?, last_used_at = ?, source_profile_id = ?, source_profile_name = ?
+      WHERE id = ?`).run(visit.useCount, visit.lastUsedAt, visit.sourceProfileId, visit.sourceProfileName ?? null, visit.id);
+  }
+
+  newestVisitAt(source: BrowserSearchSource, profileId: string): number {
+    const row = this.statement(`SELECT MAX(last_used_at) AS newest FROM entries
+      WHERE source = ? AND source_profile_id = ? AND type = 'url'`).get(source, profileId);
+    return Number(row?.newest || 0);
+  }
+
+  // Inserts `entry`, or replaces the stored entry with the same id.
+  put(entry: BrowserSearchEntry): void {
+    this.statement(`INSERT INTO entries (id, type, query, query_lower, url, value_key, host, last_used_at,
+        use_count, source, source_profile_id, source_profile_name, bookmark_folder, bookmark_order)
+      VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+      ON CONFLICT(id) DO UPDATE SET type = excluded.type, query = excluded.query,
+        query_lower = excluded.query_lower, url = excluded.url, value_key = excluded.value_key,
+        host = excluded.host, last_used_at = excluded.last_used_at, use_count = excluded.use_count,
+        source = excluded.source, source_profile_id = excluded.source_profile_id,
+        source_profile_name = excluded.source_profile_name, bookmark_folder = excluded.bookmark_folder,
+        bookmark_order = excluded.bookmark_order`).run(
+      entry.id,
+      entry.type,
+      entry.query,
+      entry.query.toLowerCase(),
+      entry.url,
+      getBrowserSearchValueKey(entry),
+      entry.host,
+      entry.lastUsedAt,
+      entry.useCount,
+      entry.source,
+      entry.sourceProfileId || '',
+      entry.sourceProfileName ?? null,
+      entry.bookmarkFolder ?? null,
+      entry.bookmarkOrder ?? null
+    );
+  }
+
+  delete(id: string): void {
+    this.statement('DELETE FROM entries WHERE id = ?').run(id);
+  }
+
+  deleteForProfile(source: BrowserSearchSource | string, profileIds: string[]): number {
+    const statement = this.statement('DELETE FROM entries WHERE source = ? AND source_profile_id = ?');
+    let removed = 0;
+    for (const profileId of new Set(profileIds)) removed += Number(statement.run(source, profileId).changes);
+    return removed;
+  }
+
+  // Drops everything but bookmarks last used before `cutoff`.
+  deleteUsedBefore(cutoff: number): number {
+    return Number(this.statement("DELETE FROM entries WHERE last_used_at < ? AND type != 'bookmark'").run(cutoff).changes);
+  }
+
+  clear(): void {
+    this.statement('DELETE FROM entries').run();
+  }
+
+  stats(): {
+    historyEntries: number;
+    bookmarkEntries: number;
+    profileCounts: Array<{ type: BrowserSearchEntryType; source: string; profileId: string; count: number }>;
+  } {
+    let historyEntries = 0;
+    let bookmarkEntries = 0;
+    const profileCounts: Array<{ type: BrowserSearchEntryType; source: string; profileId: string; count: number }> = [];
+    const rows = this.statement(`SELECT type, source, source_profile_id, COUNT(*) AS n FROM entries
+      WHERE type IN ('url', 'bookmark') GROUP BY source, source_profile_id, type`).all();
+    for (const row of rows) {
+      const type = row.type as BrowserSearchEntryType;
+      const count = Number(row.n);
+      if (type === 'url') historyEntries += count;
+      else bookmarkEntries += count;
+      if (row.source_profile_id) {
+        profileCounts.push({ type, source: String(row.source), profileId: String(row.source_profile_id), count });
+      }
+    }
+    return { historyEntries, bookmarkEntries, profileCounts };
+  }
+
+  private statement(sql: string): SqliteStatement {
+    let statement = this.statements.get(sql);
+    if (!statement) {
+      statement = this.db.prepare(sql);
+      this.statements.set(sql, statement);
+    }
+    return statement;
+  }
+
+  private migrate(): void {
+    const version = Number(this.db.prepare('PRAGMA user_version').get()?.user_version || 0);
+    if (version >= SCHEMA_VERSION) return;
+    this.transaction(() => {
+      if (version < 1) {
+        this.db.exec(`CREATE TABLE IF NOT EXISTS entries (
+          id TEXT PRIMARY KEY,
+          type TEXT NOT NULL,
+          query TEXT NOT NULL,
+          query_lower TEXT NOT NULL,
+          url TEXT NOT NULL,
+          value_key TEXT NOT NULL,
+          host TEXT NOT NULL,
+          last_used_at INTEGER NOT NULL,
+          use_count INTEGER NOT NULL,
+          source TEXT NOT NULL,
+          source_profile_id TEXT NOT NULL DEFAULT '',
+          source_profile_name TEXT,
+          bookmark_folder TEXT,
+          bookmark_order INTEGER
+        )`);
+        this.db.exec('CREATE INDEX IF NOT EXISTS entries_host ON entries(host)');
+        this.db.exec('CREATE INDEX IF NOT EXISTS entries_last_used_at ON entries(last_used_at)');
+        this.db.exec('CREATE INDEX IF NOT EXISTS entries_source_profile ON entries(source, source_profile_id, type, value_key)');
+        this.db.exec('CREATE INDEX IF NOT EXISTS entries_value ON entries(type, value_key)');
+      }
+      if (version < 2) {
+        // Autocomplete ranks prefix matches by frecency; with the type and
+        // ranking columns in the index it never reads the table for them.
+        this.db.exec('DROP INDEX IF EXISTS entries_query_lower');
+        this.db.exec('CREATE INDEX IF NOT EXISTS entries_type_query ON entries(type, query_lower, use_count, last_used_at)');
+        this.db.exec('CREATE INDEX IF NOT EXISTS entries_type_host ON entries(type, host, use_count, last_used_at)');
+      }
+      this.db.exec(`PRAGMA user_version = ${SCHEMA_VERSION}`);
+    });
+  }
+}
+
+function toEntry(row: SqliteRow): BrowserSearchEntry {
+  const entry: BrowserSearchEntry = {
+    id: String(row.id),
+    type: row.type as BrowserSearchEntryType,
+    query: String(row.query),
+    url: String(row.url),
+    host: String(row.host),
+    lastUsedAt: Number(row.last_used_at),
+    useCount: Number(row.use_count),
+    source: row.source as BrowserSearchSource,
+  };
+  if (row.source_profile_id) entry.sourceProfileId = String(row.source_profile_id);
+  if (row.source_profile_name != null) entry.sourceProfileName = String(row.source_profile_name);
+  if (row.bookmark_folder != null) entry.bookmarkFolder = String(row.bookmark_folder);
+  if (row.bookmark_order != null) entry.bookmarkOrder = Number(row.bookmark_order);
+  return entry;
+}
+
+function toVisit(row: SqliteRow): BrowserSearchVisit {
+  const visit: BrowserSearchVisit = {
+    id: String(row.id),
+    valueKey: String(row.value_key),
+    useCount: Number(row.use_count),
+    lastUsedAt: Number(row.last_used_at),
+    sourceProfileId: String(row.source_profile_id),
+  };
+  if (row.source_profile_name != null) visit.sourceProfileName = String(row.source_profile_name);
+  return visit;
+}
+
+// Whether opening a database failed because the file itself is damaged, as
+// opposed to busy, locked or unreadable for the moment. node:sqlite reports
+// the SQLite result code in `errcode`, possibly extended.
+export function isBrowserSearchDatabaseCorrupt(error: unknown): boolean {
+  const code = Number((error as { errcode?: unknown } | null)?.errcode) & 0xff;
+  return code === SQLITE_CORRUPT || code === SQLITE_NOTADB;
+}
+
+// Moves a damaged database and its WAL and shared-memory files aside, next to
+// where they were, and returns the path the database now has.
+export function moveBrowserSearchDatabaseAside(filePath: string): string {
+  const movedPath = `${filePath}.corrupt-${Date.now()}`;
+  for (const suffix of ['', '-wal', '-shm']) {
+    try { fs.renameSync(filePath + suffix, movedPath + suffix); } catch {}
+  }
+  return movedPath;
+}
+
+// Removes a database and its WAL and shared-memory files.
+export function removeBrowserSearchDatabase(filePath: string): void {
+  for (const suffix of ['', '-wal', '-shm']) {
+    try { fs.unlinkSync(filePath + suffix); } catch {}
+  }
+}
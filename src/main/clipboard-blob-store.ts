@@ -0,0 +1,174 @@
+import * as crypto from 'crypto';
+import * as fs from 'fs';
+import * as path from 'path';
+
+// Content-addressed storage for clipboard payloads: images and texts too long
+// to keep inline in a history record. A blob is named after the SHA-256 of its
+// bytes plus an extension (`<hash>.png`, `<hash>.txt`), and that file name is
+// the reference an item stores. The same payload copied again lands on the
+// same file, so it is stored once however many items point at it.
+//
+// Reference counts are not persisted: the owner rebuilds them from its items
+// on load with `reset()`, which also deletes blobs nothing refers to (left
+// behind by a crash between writing a blob and journaling its item). A blob
+// is deleted when its last reference is released.
+//
+// Deletions are queued and unlinked in batches on the libuv thread pool, so
+// dropping hundreds of images at once (a retention sweep, clearing the
+// history) costs the main thread nothing per file. A payload stored again
+// before its blob is gone takes the blob back instead.
+
+const DELETE_BATCH_SIZE = 64;
+
+const BLOB_REF_REGEX = /^[0-9a-f]{64}\.[a-z0-9]{1,10}$/;
+
+export function isClipboardBlobRef(value: unknown): value is string {
+  return typeof value === 'string' && BLOB_REF_REGEX.test(value);
+}
+
+export function getClipboardBlobRef(data: Buffer | string, ext: string): string {
+  const hash = crypto.createHash('sha256').update(data).digest('hex');
+  return `${hash}.${sanitizeExtension(ext)}`;
+}
+
+function sanitizeExtension(ext: string): string {
+  return String(ext || '').toLowerCase().replace(/[^a-z0-9]/g, '').slice(0, 10) || 'bin';
+}
+
+export class ClipboardBlobStore {
+  private readonly dir: string;
+  private readonly refCounts = new Map<string, number>();
+  private dirReady = false;
+  // Paths queued for deletion.
+  private readonly pendingDeletes = new Set<string>();
+  // Paths being unlinked, with the payload to write back once they are, if
+  // it was stored again meanwhile.
+  private readonly deleting = new Map<string, Buffer | string | null>();
+  private draining: Promise<void> | null = null;
+
+  constructor(dir: string) {
+    this.dir = dir;
+  }
+
+  pathOf(ref: string): string {
+    return path.join(this.dir, ref);
+  }
+
+  // Stores `data` unless an identical blob already exists, and takes a
+  // reference to it. Returns the blob's reference. `ref` skips hashing `data`
+  // again when the caller already has getClipboardBlobRef(data, ext).
+  put(data: Buffer | string, ext: string, ref = getClipboardBlobRef(data, ext)): string {
+    const filePath = this.pathOf(ref);
+    if (this.pendingDeletes.delete(filePath)) {
+      // Still on disk; keep it.
+    } else if (this.deleting.has(filePath)) {
+      this.deleting.set(filePath, data);
+    } else if (!this.refCounts.has(ref) && !fs.existsSync(filePath)) {
+      this.writeBlob(filePath, data);
+    }
+    this.retain(ref);
+    return ref;
+  }
+
+  retain(ref: string): void {
+    this.refCounts.set(ref, (this.refCounts.get(ref) || 0) + 1);
+  }
+
+  release(ref: string): void {
+    const count = this.refCounts.get(ref) || 0;
+    if (count > 1) {
+      this.refCounts.set(ref, count - 1);
+      return;
+    }
+    this.refCounts.delete(ref);
+    this.deleteLater(this.pathOf(ref));
+  }
+
+  // Queues any file for deletion along with released blobs; used for image
+  // files stored before the blob store.
+  deleteLater(filePath: string): void {
+    this.pendingDeletes.add(filePath);
+    if (!this.draining) this.draining = this.drainDeletes();
+  }
+
+  // Resolves once every queued deletion has run.
+  whenIdle(): Promise<void> {
+    return this.draining || Promise.resolve();
+  }
+
+  readText(ref: string): string {
+    return fs.readFileSync(this.pathOf(ref), 'utf8');
+  }
+
+  referenceCount(ref: string): number {
+    return this.refCounts.get(ref) || 0;
+  }
+
+  // Replaces the reference counts with one per entry of `refs` and deletes
+  // blobs (and stray temp files) that none of them name.
+  reset(refs: Iterable<string>): void {
+    this.refCounts.clear();
+    for (const ref of refs) this.retain(ref);
+    for (const ref of this.refCounts.keys()) this.pendingDeletes.delete(this.pathOf(ref));
+    let names: string[];
+    try {
+      names = fs.readdirSync(this.dir);
+    } catch {
+      return;
+    }
+    let removed = 0;
+    for (const name of names) {
+      if (this.refCounts.has(name)) continue;
+      if (!isClipboardBlobRef(name) && !name.endsWith('.tmp')) continue;
+      try {
+        fs.unlinkSync(this.pathOf(name));
+        removed += 1;
+      } catch {}
+    }
+    if (removed > 0) console.log(`[Clipboard] Deleted ${removed} unreferenced blob${removed === 1 ? '' : 's'}`);
+  }
+
+  private async drainDeletes(): Promise<void> {
+    // Let a burst of releases queue up first.
+    await new Promise<void>((resolve) => setImmediate(resolve));
+    while (this.pendingDeletes.size > 0) {
+      const batch: string[] = [];
+      for (const filePath of this.pendingDeletes) {
+        batch.push(filePath);
+        if (batch.length === DELETE_BATCH_SIZE) break;
+      }
+      for (const filePath of batch) {
+        this.pendingDeletes.delete(filePath);
+        this.deleting.set(filePath, null);
+      }
+      await Promise.all(batch.map((filePath) => fs.promises.unlink(filePath).catch((error: any) => {
+        if (error?.code !== 'ENOENT') console.warn(`[Clipboard] Failed to delete ${path.basename(filePath)}:`, error);
+      })));
+      for (const filePath of batch) {
+        const restored = this.deleting.get(filePath);
+        this.deleting.delete(filePath);
+        if (restored == null) continue;
+        try {
+          this.writeBlob(filePath, restored);
+        } catch (error) {
+          console.warn(`[Clipboard] Failed to restore ${path.basename(filePath)}:`, error);
+        }
+      }
+    }
+    this.draining = null;
+  }
+
+  private writeBlob(filePath: string, data: Buffer | string): void {
+    this.ensureDir();
+    // Written aside and renamed so a reader never sees a partial blob.
+    const tempPath = `${filePath}.${process.pid}.tmp`;
+    fs.writeFileSync(tempPath, data);
+    fs.renameSync(tempPath, filePath);
+  }
+
+  private ensureDir(): void {
+    if (this.dirReady) return;
+    fs.mkdirSync(this.dir, { recursive: true });
+    this.dirReady = true;
+  }
+}
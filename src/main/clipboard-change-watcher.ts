@@ -0,0 +1,141 @@
+import { spawn } from 'child_process';
+
+// Clipboard change notifications on Linux, so the clipboard manager reads the
+// clipboard when it changes instead of on every one-second poll tick.
+//
+// Two backends, tried in order:
+//   - `wl-data-control`: on a Wayland session, `wl-paste --watch` (from
+//     wl-clipboard) runs a command on every selection change through the
+//     data-control protocol, which sees copies from Wayland and XWayland
+//     clients alike. Unsupported on compositors without data-control (GNOME).
+//   - `xfixes`: the native helpers addon's ClipboardWatcher, which asks the X
+//     server for CLIPBOARD owner-change events. Covers X11 sessions, and
+//     XWayland where the compositor mirrors the clipboard into it.
+// When neither starts, or a running one dies, `onUnavailable` fires once and
+// the caller goes back to polling.
+
+export type ClipboardChangeBackend = 'wl-data-control' | 'xfixes';
+
+// Native constructor from native_helpers.node. The callback gets the number
+// of owner changes in a burst, or -1 once the X connection is lost.
+export type NativeClipboardWatcherConstructor = new (onChange: (count: number) => void) => { close: () => void };
+
+export type ClipboardChangeWatcher = {
+  readonly backend: ClipboardChangeBackend | null;
+  stop: () => void;
+};
+
+type BackendHandle = { stop: () => void };
+
+// How long wl-paste must survive before an exit counts as losing a working
+// watcher rather than the backend being unavailable.
+const WL_PASTE_STARTUP_GRACE_MS = 2000;
+
+export function startClipboardChangeWatcher(options: {
+  onChange: () => void;
+  onUnavailable: () => void;
+  NativeClipboardWatcher?: NativeClipboardWatcherConstructor | null;
+  env?: NodeJS.ProcessEnv;
+  spawnProcess?: typeof spawn;
+}): ClipboardChangeWatcher {
+  const env = options.env || process.env;
+  const backends: ClipboardChangeBackend[] = [];
+  if (env.WAYLAND_DISPLAY) backends.push('wl-data-control');
+  if (env.DISPLAY && options.NativeClipboardWatcher) backends.push('xfixes');
+
+  let stopped = false;
+  let current: BackendHandle | null = null;
+  const watcher = {
+    backend: null as ClipboardChangeBackend | null,
+    stop: () => {
+      stopped = true;
+      current?.stop();
+      current = null;
+    },
+  };
+
+  const lose = () => {
+    if (stopped) return;
+    stopped = true;
+    current?.stop();
+    current = null;
+    watcher.backend = null;
+    options.onUnavailable();
+  };
+
+  const startNext = (index: number) => {
+    for (let next = index; next < backends.length; next += 1) {
+      if (stopped) return;
+      const backend = backends[next];
+      try {
+        current = backend === 'xfixes'
+          ? startXFixesBackend(options.NativeClipboardWatcher as NativeClipboardWatcherConstructor, options.onChange, lose)
+          : startWlPasteBackend(options.spawnProcess || spawn, env, options.onChange, lose, (reason) => {
+            console.warn(`[Clipboard] wl-paste --watch unavailable (${reason}); trying the next change source`);
+            current = null;
+            startNext(next + 1);
+          });
+        watcher.backend = backend;
+        return;
+      } catch (error: any) {
+        console.warn(`[Clipboard] ${backend} change notifications unavailable: ${error?.message || error}`);
+      }
+    }
+    lose();
+  };
+
+  startNext(0);
+  return watcher;
+}
+
+function startXFixesBackend(
+  NativeClipboardWatcher: NativeClipboardWatcherConstructor,
+  onChange: () => void,
+  onLost: () => void
+): BackendHandle {
+  const native = new NativeClipboardWatcher((count) => {
+    if (count < 0) {
+      console.warn('[Clipboard] Lost the X display connection; falling back to polling');
+      onLost();
+      return;
+    }
+    onChange();
+  });
+  return { stop: () => native.close() };
+}
+
+function startWlPasteBackend(
+  spawnProcess: typeof spawn,
+  env: NodeJS.ProcessEnv,
+  onChange: () => void,
+  onLost: () => void,
+  onUnavailable: (reason: string) => void
+): BackendHandle {
+  // `echo` prints an empty line per change; the clipboard itself is still
+  // read through Electron.
+  const child = spawnProcess('wl-paste', ['--watch', 'echo'], { env, stdio: ['ignore', 'pipe', 'ignore'] });
+  const startedAt = Date.now();
+  let stopping = false;
+  let settled = false;
+  const fail = (reason: string) => {
+    if (settled || stopping) return;
+    settled = true;
+    if (Date.now() - startedAt < WL_PASTE_STARTUP_GRACE_MS) onUnavailable(reason);
+    else onLost();
+  };
+
+  child.stdout?.on('data', (chunk: Buffer) => {
+    if (chunk.indexOf(0x0a) >= 0) onChange();
+  });
+  child.on('error', (error) => fail(error.message));
+  child.on('exit', (code, signal) => fail(signal ? `killed by ${signal}` : `exited with code ${code}`));
+  child.unref();
+  (child.stdout as any)?.unref?.();
+
+  return {
+    stop: () => {
+      stopping = true;
+      child.kill();
+    },
+  };
+}
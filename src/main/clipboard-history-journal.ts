@@ -0,0 +1,190 @@
+import * as fs from 'fs';
+
+// Append-only storage for clipboard history. Every change appends one JSON
+// line describing just that change (the changed item, or the ids removed), so
+// a copy, pin or delete costs I/O proportional to one item rather than to the
+// whole history.
+//
+// Once the log has grown well past the live items it is compacted: the live
+// items are written to a temp file asynchronously, anything appended in the
+// meantime is carried over, and a rename swaps it in. Loading replays the
+// log; a crash can at worst leave a torn last line, which is dropped and
+// truncated away, and any other unreadable line is skipped.
+
+export type ClipboardJournalRecord<T> =
+  | { op: 'put'; item: T }
+  | { op: 'remove'; ids: string[] }
+  | { op: 'clear' };
+
+// Appended records tolerated beyond the live item count before compacting.
+const COMPACT_MIN_RECORDS = 256;
+// Compaction waits for a quiet spell rather than running mid-burst.
+const COMPACT_DELAY_MS = 10_000;
+const NEWLINE = 0x0a;
+
+export class ClipboardHistoryJournal<T extends { id: string }> {
+  private readonly filePath: string;
+  private readonly getLiveItems: () => T[];
+  private fd: number | null = null;
+  private recordsSinceCompaction = 0;
+  private compactTimer: NodeJS.Timeout | null = null;
+  private compaction: Promise<void> | null = null;
+  // Lines appended while a compaction is writing, replayed onto its output.
+  private linesDuringCompaction: string[] | null = null;
+  // How many records those lines hold; one append can write several.
+  private recordsDuringCompaction = 0;
+
+  constructor(filePath: string, getLiveItems: () => T[]) {
+    this.filePath = filePath;
+    this.getLiveItems = getLiveItems;
+  }
+
+  // Replays the log into the items it describes, in last-written order, or
+  // returns null when there is no log yet.
+  load(): T[] | null {
+    let buffer: Buffer;
+    try {
+      buffer = fs.readFileSync(this.filePath);
+    } catch (error: any) {
+      if (error?.code === 'ENOENT') return null;
+      throw error;
+    }
+
+    const items = new Map<string, T>();
+    let offset = 0;
+    let records = 0;
+    let skipped = 0;
+    while (offset < buffer.length) {
+      const newline = buffer.indexOf(NEWLINE, offset);
+      // A line without its newline is a write cut short by a crash.
+      if (newline < 0) break;
+      const line = buffer.toString('utf8', offset, newline);
+      offset = newline + 1;
+      let record: ClipboardJournalRecord<T>;
+      try {
+        record = JSON.parse(line);
+      } catch {
+        skipped += 1;
+        continue;
+      }
+      records += 1;
+      applyRecord(items, record);
+    }
+
+    if (offset < buffer.length) {
+      console.warn(`[Clipboard] Dropping ${buffer.length - offset} bytes of a torn journal write`);
+      fs.truncateSync(this.filePath, offset);
+    }
+    if (skipped > 0) console.warn(`[Clipboard] Skipped ${skipped} unreadable journal records`);
+    this.recordsSinceCompaction = Math.max(0, records - items.size);
+    return [...items.values()];
+  }
+
+  put(items: T[]): void {
+    this.append(items.map((item) => ({ op: 'put', item })));
+  }
+
+  remove(ids: string[]): void {
+    if (ids.length > 0) this.append([{ op: 'remove', ids }]);
+  }
+
+  clear(): void {
+    this.append([{ op: 'clear' }]);
+  }
+
+  // Rewrites the log from the live items now rather than after the next
+  // quiet spell. Resolves once the new log is in place.
+  compactNow(): Promise<void> {
+    if (this.compactTimer) {
+      clearTimeout(this.compactTimer);
+      this.compactTimer = null;
+    }
+    if (!this.compaction) {
+      this.compaction = this.compact().finally(() => {
+        this.compaction = null;
+      });
+    }
+    return this.compaction;
+  }
+
+  close(): void {
+    if (this.compactTimer) {
+      clearTimeout(this.compactTimer);
+      this.compactTimer = null;
+    }
+    this.closeFile();
+  }
+
+  private append(records: ClipboardJournalRecord<T>[]): void {
+    if (records.length === 0) return;
+    const lines = records.map((record) => `${JSON.stringify(record)}\n`).join('');
+    if (this.fd === null) this.fd = fs.openSync(this.filePath, 'a');
+    fs.writeSync(this.fd, lines);
+    if (this.linesDuringCompaction) {
+      this.linesDuringCompaction.push(lines);
+      this.recordsDuringCompaction += records.length;
+    }
+    this.recordsSinceCompaction += records.length;
+    this.scheduleCompaction();
+  }
+
+  private scheduleCompaction(): void {
+    if (this.compactTimer || this.compaction) return;
+    const threshold = Math.max(COMPACT_MIN_RECORDS, this.getLiveItems().length);
+    if (this.recordsSinceCompaction < threshold) return;
+    this.compactTimer = setTimeout(() => {
+      this.compactTimer = null;
+      void this.compactNow();
+    }, COMPACT_DELAY_MS);
+    this.compactTimer.unref?.();
+  }
+
+  private async compact(): Promise<void> {
+    const tempPath = `${this.filePath}.${process.pid}.tmp`;
+    const body = this.getLiveItems().map((item) => `${JSON.stringify({ op: 'put', item })}\n`).join('');
+    this.linesDuringCompaction = [];
+    this.recordsDuringCompaction = 0;
+    try {
+      const handle = await fs.promises.open(tempPath, 'w');
+      try {
+        await handle.writeFile(body);
+        await handle.sync();
+      } finally {
+        await handle.close();
+      }
+      // From here on nothing can interleave: carry over what was appended
+      // during the write, then swap the files.
+      const appended = this.linesDuringCompaction;
+      if (appended.length > 0) fs.appendFileSync(tempPath, appended.join(''));
+      this.closeFile();
+      fs.renameSync(tempPath, this.filePath);
+      this.recordsSinceCompaction = this.recordsDuringCompaction;
+    } catch (error) {
+      console.error('[Clipboard] Failed to compact history journal:', error);
+      try { fs.unlinkSync(tempPath); } catch {}
+    } finally {
+      this.linesDuringCompaction = null;
+    }
+  }
+
+  private closeFile(): void {
+    if (this.fd === null) return;
+    try { fs.closeSync(this.fd); } catch {}
+    this.fd = null;
+  }
+}
+
+function applyRecord<T extends { id: string }>(items: Map<string, T>, record: ClipboardJournalRecord<T>): void {
+  if (!record || typeof record !== 'object') return;
+  if (record.op === 'put') {
+    if (!record.item || typeof record.item.id !== 'string') return;
+    // Re-inserted so the map keeps last-written order.
+    items.delete(record.item.id);
+    items.set(record.item.id, record.item);
+  } else if (record.op === 'remove') {
+    if (!Array.isArray(record.ids)) return;
+    for (const id of record.ids) items.delete(id);
+  } else if (record.op === 'clear') {
+    items.clear();
+  }
+}
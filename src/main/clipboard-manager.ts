@@ -4,7 +4,8 @@
  * Monitors macOS clipboard and stores history of text, images, and URLs.
  * - Polls clipboard every 1 second
  * - Stores up to 1000 items
- * - Persists to disk (JSON for metadata, separate files for images)
+ * - Persists to disk (an append-only JSON-lines journal for metadata,
+ *   separate files for images)
  * - Supports text, images (png/jpg/gif/webp), URLs, and file paths
  */
 
@@ -13,11 +14,27 @@ import { execFileSync } from 'child_process';
 import * as fs from 'fs';
 import * as path from 'path';
 import * as crypto from 'crypto';
+import { ClipboardHistoryJournal } from './clipboard-history-journal';
+import { ClipboardSearchIndex } from './clipboard-search-index';
+import { ClipboardRetentionIndex } from './clipboard-retention-index';
+import { ClipboardBlobStore, getClipboardBlobRef, isClipboardBlobRef } from './clipboard-blob-store';
+import {
+  startClipboardChangeWatcher,
+  type ClipboardChangeWatcher,
+  type NativeClipboardWatcherConstructor,
+} from './clipboard-change-watcher';
 
 // Lazy-loaded native addon — provides getPasteboardChangeCount() which returns
 // NSPasteboard.general.changeCount (an integer that increments on every write).
 // Checking this is O(1) and avoids all pasteboard data reads when nothing changed.
-type NativeHelpersAddon = { getPasteboardChangeCount?: () => number };
+// On Linux it provides ClipboardWatcher instead (see clipboard-change-watcher.ts).
+// On both it provides the content hashes used to fingerprint and dedupe images.
+type NativeHelpersAddon = {
+  getPasteboardChangeCount?: () => number;
+  ClipboardWatcher?: NativeClipboardWatcherConstructor;
+  hashBuffer?: (data: Buffer) => string;
+  imageDifferenceHash?: (bitmap: Buffer, width: number, height: number) => Promise<string>;
+};
 let _nativeHelpersAddon: NativeHelpersAddon | null = null;
 let _nativeHelpersAddonLoaded = false;
 function getNativeHelpersAddon(): NativeHelpersAddon | null {
@@ -64,6 +81,10 @@ export interface ClipboardItem {
   id: string;
   type: 'text' | 'image' | 'url' | 'file';
   content: string; // For text/url/file: the actual content. For images: file path
+  /** Blob store reference holding the payload, for images and for texts
+   * longer than INLINE_TEXT_LIMIT. A blob-backed text keeps only its first
+   * INLINE_TEXT_LIMIT characters in `content`; see getItemText(). */
+  blob?: string;
   preview?: string; // Short preview for display
   timestamp: number;
   pinned?: boolean;
@@ -77,6 +98,9 @@ export interface ClipboardItem {
     height?: number;
     size?: number; // bytes
     format?: string;
+    // Difference hash of the decoded image; equal for visually identical
+    // images whatever their encoding. See addImageItem().
+    dhash?: string;
     // For files
     filename?: string;
     // Original file path at the moment of copy — used as a fallback preview
@@ -87,17 +111,41 @@ export interface ClipboardItem {
 
 const MAX_ITEMS = 1000;
 const POLL_INTERVAL = 1000; // 1 second
+// Change notifications arrive when the owner claims the clipboard; a short
+// settle also folds a burst of claims into one read.
+const CHANGE_SETTLE_MS = 30;
 const MAX_TEXT_LENGTH = 100_000; // Don't store huge text items
 const MAX_IMAGE_SIZE = 10 * 1024 * 1024; // 10MB max per image
+// The difference hash samples a 17x16 grid; smaller images are deduped by bytes only.
+const DHASH_MIN_WIDTH = 17;
+const DHASH_MIN_HEIGHT = 16;
+// Longer texts live in the blob store rather than in the history record.
+const INLINE_TEXT_LIMIT = 2048;
+const DAY_MS = 24 * 60 * 60 * 1000;
+// Timers cannot wait longer than about 24.8 days.
+const MAX_RETENTION_SLEEP_MS = DAY_MS;
 const INTERNAL_CLIPBOARD_PROBE_REGEX = /^__supercmd_[a-z0-9_]+_probe__\d+_[a-z0-9]+$/i;
 
 let clipboardHistory: ClipboardItem[] = [];
+let historyJournal: ClipboardHistoryJournal<ClipboardItem> | null = null;
+let blobStore: ClipboardBlobStore | null = null;
+const searchIndex = new ClipboardSearchIndex();
+const retentionIndex = new ClipboardRetentionIndex();
+// How long unpinned items are kept; null keeps them forever.
+let retentionWindowMs: number | null = null;
+let retentionTimer: NodeJS.Timeout | null = null;
+let retentionSweepAt = 0;
+// Bumped on every change, so a view can tell whether its pages are stale.
+let historyRevision = 0;
 let lastClipboardText = '';
 // Store a hash of the last-seen image rather than the full buffer.
 // This avoids re-hashing megabytes of PNG data on every poll tick.
 let lastClipboardImageHash = '';
 let lastClipboardFilePath = '';
 let pollInterval: NodeJS.Timeout | null = null;
+// Linux only: pushes clipboard changes, replacing the poll while it runs.
+let changeWatcher: ClipboardChangeWatcher | null = null;
+let changeSettleTimer: NodeJS.Timeout | null = null;
 let isEnabled = true;
 // Last-seen NSPasteboard changeCount. -1 = not yet read.
 // When changeCount hasn't changed, the pasteboard is identical to the last poll
@@ -117,33 +165,49 @@ function getClipboardDir(): string {
   return dir;
 }
 
-function getImagesDir(): string {
-  const dir = path.join(getClipboardDir(), 'images');
-  if (!fs.existsSync(dir)) {
-    fs.mkdirSync(dir, { recursive: true });
-  }
-  return dir;
+// Images and long texts, content-addressed. Items captured before the blob
+// store keep their image files in images/ until they are removed.
+function getBlobStore(): ClipboardBlobStore {
+  if (!blobStore) blobStore = new ClipboardBlobStore(path.join(getClipboardDir(), 'blobs'));
+  return blobStore;
 }
 
-function getHistoryFilePath(): string {
+// Pre-journal history, migrated into the journal on first load.
+function getLegacyHistoryFilePath(): string {
   return path.join(getClipboardDir(), 'history.json');
 }
 
+function getHistoryJournal(): ClipboardHistoryJournal<ClipboardItem> {
+  if (!historyJournal) {
+    historyJournal = new ClipboardHistoryJournal(
+      path.join(getClipboardDir(), 'history.log'),
+      () => clipboardHistory
+    );
+  }
+  return historyJournal;
+}
+
+type ClipboardSortKey = Pick<ClipboardItem, 'id' | 'timestamp' | 'pinned' | 'pinnedOrder'>;
+
+// Display order. Ties fall back to the id so that the order is total, which
+// history page cursors rely on.
+function compareClipboardItems(a: ClipboardSortKey, b: ClipboardSortKey): number {
+  if (Boolean(a.pinned) !== Boolean(b.pinned)) {
+    return a.pinned ? -1 : 1;
+  }
+  // Pinned items keep an explicit, recency-independent order so that using a
+  // pinned item never rearranges the pinned group.
+  if (a.pinned && b.pinned) {
+    const ao = Number.isFinite(a.pinnedOrder) ? (a.pinnedOrder as number) : Number.MAX_SAFE_INTEGER;
+    const bo = Number.isFinite(b.pinnedOrder) ? (b.pinnedOrder as number) : Number.MAX_SAFE_INTEGER;
+    if (ao !== bo) return ao - bo;
+  }
+  if (a.timestamp !== b.timestamp) return b.timestamp - a.timestamp;
+  return a.id < b.id ? -1 : a.id > b.id ? 1 : 0;
+}
+
 function sortClipboardHistory(): void {
-  clipboardHistory.sort((a, b) => {
-    if (Boolean(a.pinned) !== Boolean(b.pinned)) {
-      return a.pinned ? -1 : 1;
-    }
-    // Pinned items keep an explicit, recency-independent order so that using a
-    // pinned item never rearranges the pinned group.
-    if (a.pinned && b.pinned) {
-      const ao = Number.isFinite(a.pinnedOrder) ? (a.pinnedOrder as number) : Number.MAX_SAFE_INTEGER;
-      const bo = Number.isFinite(b.pinnedOrder) ? (b.pinnedOrder as number) : Number.MAX_SAFE_INTEGER;
-      if (ao !== bo) return ao - bo;
-      return b.timestamp - a.timestamp;
-    }
-    return b.timestamp - a.timestamp;
-  });
+  clipboardHistory.sort(compareClipboardItems);
 }
 
 /** Largest pinnedOrder currently assigned, or -1 when no pinned items have one. */
@@ -174,74 +238,192 @@ function ensurePinnedOrder(): void {
 
 // ─── Persistence ────────────────────────────────────────────────────
 
+function readLegacyHistory(): any[] {
+  const historyPath = getLegacyHistoryFilePath();
+  if (!fs.existsSync(historyPath)) return [];
+  const parsed = JSON.parse(fs.readFileSync(historyPath, 'utf-8'));
+  return Array.isArray(parsed) ? parsed : [];
+}
+
 function loadHistory(): void {
   try {
-    const historyPath = getHistoryFilePath();
-    if (fs.existsSync(historyPath)) {
-      const data = fs.readFileSync(historyPath, 'utf-8');
-      const parsed = JSON.parse(data);
-      if (Array.isArray(parsed)) {
-        // Verify image files still exist and drop internal probe artifacts.
-        const filtered = parsed.filter((item) => {
-          if (item.type === 'image') {
-            return fs.existsSync(item.content);
-          }
-          if (item.type === 'text' || item.type === 'url' || item.type === 'file') {
-            const normalized = normalizeTextForComparison(item.content);
-            if (!normalized) return false;
-            if (INTERNAL_CLIPBOARD_PROBE_REGEX.test(normalized)) return false;
-          }
-          return true;
-        });
-        // Dedupe text-like entries on load while preserving newest-first ordering.
-        const dedupeKeys = new Set<string>();
-        clipboardHistory = filtered.filter((item) => {
-          if (item.type !== 'text' && item.type !== 'url' && item.type !== 'file') return true;
-          const key = `${item.type}:${normalizeTextForComparison(item.content).toLowerCase()}`;
-          if (dedupeKeys.has(key)) return false;
-          dedupeKeys.add(key);
-          return true;
-        }).map((item) => ({
-          ...item,
-          pinned: Boolean(item?.pinned),
-        }));
-        ensurePinnedOrder();
-        console.log(`Loaded ${clipboardHistory.length} clipboard items from disk`);
+    const journal = getHistoryJournal();
+    const journaled = journal.load();
+    const migrating = journaled === null;
+    const parsed: any[] = migrating ? readLegacyHistory() : journaled;
+    // Verify image files still exist and drop internal probe artifacts.
+    const filtered = parsed.filter((item) => {
+      if (item.blob !== undefined
+        && (!isClipboardBlobRef(item.blob) || !fs.existsSync(getBlobStore().pathOf(item.blob)))) {
+        return false;
+      }
+      if (item.type === 'image') {
+        return fs.existsSync(item.content);
+      }
+      if (item.type === 'text' || item.type === 'url' || item.type === 'file') {
+        const normalized = normalizeTextForComparison(item.content);
+        if (!normalized) return false;
+        if (INTERNAL_CLIPBOARD_PROBE_REGEX.test(normalized)) return false;
       }
+      return true;
+    });
+    // The journal replays in write order; dedupe in display order (pinned
+    // first, then newest), which is how the legacy file was saved.
+    if (!migrating) {
+      filtered.sort((a, b) => (Number(Boolean(b.pinned)) - Number(Boolean(a.pinned)))
+        || ((b.timestamp || 0) - (a.timestamp || 0)));
+    }
+    // Dedupe text-like entries on load while preserving newest-first ordering.
+    const dedupeKeys = new Set<string>();
+    clipboardHistory = filtered.filter((item) => {
+      if (item.type !== 'text' && item.type !== 'url' && item.type !== 'file') return true;
+      const key = item.blob
+        ? `${item.type}:blob:${item.blob}`
+        : `${item.type}:${normalizeTextForComparison(item.content).toLowerCase()}`;
+      if (dedupeKeys.has(key)) return false;
+      dedupeKeys.add(key);
+      return true;
+    }).map((item) => ({
+      ...item,
+      pinned: Boolean(item?.pinned),
+    }));
+    ensurePinnedOrder();
+    sortClipboardHistory();
+    getBlobStore().reset(clipboardHistory.filter((item) => item.blob).map((item) => item.blob as string));
+    // Texts saved inline before the blob store move into it.
+    const movedToBlobs = clipboardHistory.filter((item) => isTextLikeItem(item) && !item.blob
+      && item.content.length > INLINE_TEXT_LIMIT);
+    for (const item of movedToBlobs) setItemText(item, item.content);
+    searchIndex.rebuild(clipboardHistory.map(toFullItem));
+    retentionIndex.rebuild(clipboardHistory);
+    historyRevision += 1;
+    console.log(`Loaded ${clipboardHistory.length} clipboard items from disk`);
+    sweepExpiredClipboardItems();
+
+    if (migrating) {
+      // The legacy file goes only once the journal holding its items is on disk.
+      void journal.compactNow().then(() => {
+        try { fs.unlinkSync(getLegacyHistoryFilePath()); } catch {}
+      });
+    } else if (clipboardHistory.length !== parsed.length || movedToBlobs.length > 0) {
+      void journal.compactNow();
     }
   } catch (e) {
     console.error('Failed to load clipboard history:', e);
     clipboardHistory = [];
+    searchIndex.clear();
+    retentionIndex.clear();
+  }
+}
+
+// Each change is journaled on its own: the items it touched, or the ids it
+// removed. Never rewrites the whole history. The search and retention
+// indexes are updated alongside, so every mutation of clipboardHistory goes
+// through these.
+function saveItems(items: ClipboardItem[]): void {
+  historyRevision += 1;
+  for (const item of items) {
+    searchIndex.upsert(toFullItem(item));
+    retentionIndex.upsert(item);
+  }
+  scheduleRetentionSweep();
+  try {
+    getHistoryJournal().put(items);
+  } catch (e) {
+    console.error('Failed to save clipboard history:', e);
   }
 }
 
-function saveHistory(): void {
+function saveRemovals(ids: string[]): void {
+  historyRevision += 1;
+  for (const id of ids) {
+    searchIndex.remove(id);
+    retentionIndex.remove(id);
+  }
   try {
-    const historyPath = getHistoryFilePath();
-    fs.writeFileSync(historyPath, JSON.stringify(clipboardHistory, null, 2));
+    getHistoryJournal().remove(ids);
   } catch (e) {
     console.error('Failed to save clipboard history:', e);
   }
 }
 
+function saveCleared(): void {
+  historyRevision += 1;
+  searchIndex.clear();
+  retentionIndex.clear();
+  try {
+    getHistoryJournal().clear();
+  } catch (e) {
+    console.error('Failed to save clipboard history:', e);
+  }
+}
+
+// ─── Payloads ───────────────────────────────────────────────────────
+
+function isTextLikeItem(item: ClipboardItem): boolean {
+  return item.type === 'text' || item.type === 'url' || item.type === 'file';
+}
+
+// The full text of a text-like item, read from the blob store when it is too
+// long to be kept inline.
+function getItemText(item: ClipboardItem): string {
+  if (!item.blob || !isTextLikeItem(item)) return item.content;
+  try {
+    return getBlobStore().readText(item.blob);
+  } catch (e) {
+    console.error('[Clipboard] Failed to read clipboard text blob:', e);
+    return item.content;
+  }
+}
+
+// Sets a text-like item's text, moving it into or out of the blob store.
+function setItemText(item: ClipboardItem, text: string): void {
+  const previousBlob = item.blob;
+  item.metadata = { ...(item.metadata || {}), size: Buffer.byteLength(text) };
+  if (text.length > INLINE_TEXT_LIMIT) {
+    item.blob = getBlobStore().put(text, 'txt');
+    item.content = text.slice(0, INLINE_TEXT_LIMIT);
+  } else {
+    delete item.blob;
+    item.content = text;
+  }
+  if (previousBlob) getBlobStore().release(previousBlob);
+}
+
+// Drops what an item holds on disk once it has left the history.
+function releaseItemPayload(item: ClipboardItem): void {
+  if (item.blob) {
+    getBlobStore().release(item.blob);
+  } else if (item.type === 'image' && item.content) {
+    getBlobStore().deleteLater(item.content);
+  }
+}
+
+// The item as callers outside this module expect it: full text in `content`.
+function toFullItem(item: ClipboardItem): ClipboardItem {
+  return item.blob && isTextLikeItem(item) ? { ...item, content: getItemText(item) } : item;
+}
+
+// Stores image bytes in the blob store and returns the reference and path
+// the item records.
+function storeImagePayload(data: Buffer, ext: string, ref?: string): { blob: string; imagePath: string } {
+  const blob = getBlobStore().put(data, ext, ref);
+  return { blob, imagePath: getBlobStore().pathOf(blob) };
+}
+
 // ─── Clipboard Monitoring ───────────────────────────────────────────
 
+// Hashes every byte: XXH3-64 from the native helpers addon (a 40 MB
+// screenshot takes under 10 ms), or MD5 without it. Two images that differ
+// anywhere never share a fingerprint.
 function hashBuffer(buf: Buffer): string {
+  const addon = getNativeHelpersAddon();
+  if (addon?.hashBuffer) return addon.hashBuffer(buf);
   return crypto.createHash('md5').update(buf).digest('hex');
 }
 
-// Sample start + middle + end of a buffer so that two same-size images differing
-// only in the lower portion (e.g. same-dimension TIFF screenshots) still produce
-// different fingerprints, without reading the entire (potentially 48MB) buffer.
-function sampleBuffer(buf: Buffer): Buffer {
-  const CHUNK = 4096;
-  if (buf.length <= CHUNK * 3) return buf;
-  const mid = Math.floor((buf.length - CHUNK) / 2);
-  return Buffer.concat([buf.slice(0, CHUNK), buf.slice(mid, mid + CHUNK), buf.slice(-CHUNK)]);
-}
-
 function buildImageFingerprint(prefix: string, buf: Buffer): string {
-  return `${prefix}:${buf.length}:${hashBuffer(sampleBuffer(buf))}`;
+  return `${prefix}:${buf.length}:${hashBuffer(buf)}`;
 }
 
 function getCurrentFrontmostBundleId(): string | undefined {
@@ -349,9 +531,12 @@ function normalizeTextForComparison(text: string): string {
 function findComparableTextItemIndex(type: ClipboardItem['type'], normalizedContent: string): number {
   if (!normalizedContent) return -1;
   // Text-like dedupe: text/url/file entries with same normalized content.
+  // Long texts compare by blob reference, which is their content hash.
+  const blob = normalizedContent.length > INLINE_TEXT_LIMIT ? getClipboardBlobRef(normalizedContent, 'txt') : null;
   return clipboardHistory.findIndex((item) => {
-    if (item.type !== 'text' && item.type !== 'url' && item.type !== 'file') return false;
+    if (!isTextLikeItem(item)) return false;
     if (item.type !== type) return false;
+    if (blob || item.blob) return item.blob === blob;
     return normalizeTextForComparison(item.content) === normalizedContent;
   });
 }
@@ -382,7 +567,7 @@ function addTextItem(text: string): void {
     const existing = clipboardHistory[existingIndex];
     existing.timestamp = Date.now();
     existing.preview = preview;
-    existing.content = normalizedResolved;
+    setItemText(existing, normalizedResolved);
     if (type === 'file') {
       const filename = path.basename(normalizedResolved);
       existing.metadata = {
@@ -392,21 +577,23 @@ function addTextItem(text: string): void {
       };
     }
     sortClipboardHistory();
-    saveHistory();
+    saveItems([existing]);
     return;
   }
 
   const item: ClipboardItem = {
     id: crypto.randomUUID(),
     type,
-    content: normalizedResolved,
+    content: '',
     preview,
     timestamp: Date.now(),
   };
+  setItemText(item, normalizedResolved);
 
   if (type === 'file') {
     const filename = path.basename(normalizedResolved);
     item.metadata = {
+      ...(item.metadata || {}),
       filename,
       ...(resolvedFilePath ? { sourcePath: resolvedFilePath } : {}),
     };
@@ -414,13 +601,24 @@ function addTextItem(text: string): void {
 
   clipboardHistory.unshift(item);
   sortClipboardHistory();
+  saveItems([item]);
   if (clipboardHistory.length > MAX_ITEMS) {
-    clipboardHistory.pop();
+    const removed = clipboardHistory.pop();
+    if (removed) {
+      saveRemovals([removed.id]);
+      releaseItemPayload(removed);
+    }
   }
-
-  saveHistory();
 }
 
+// Images are deduped twice. The same bytes again (by blob reference) only
+// bring the existing item back to the top. Otherwise, with the native helpers
+// addon, a difference hash of the decoded image is computed off the main
+// thread first, and a visually identical image of the same size (the same
+// screenshot re-encoded by another app, say) collapses into the item that is
+// already there, which takes the new bytes: the hash cannot tell a re-encode
+// from a small edit, and the copy just made is the one to keep. GIFs are only
+// deduped by bytes: one frame does not stand for an animation.
 function addImageItem(
   image: ReturnType<typeof nativeImage.createFromDataURL>,
   rawGifData?: Buffer,
@@ -435,44 +633,122 @@ function addImageItem(
     if (dataToSave.length === 0 || dataToSave.length > MAX_IMAGE_SIZE) return;
 
     const ext = isGif ? 'gif' : 'png';
+    const blob = getClipboardBlobRef(dataToSave, ext);
+    if (promoteDuplicateImageItem(blob)) return;
 
-    // Save image to disk
-    const imageId = crypto.randomUUID();
-    const imagePath = path.join(getImagesDir(), `${imageId}.${ext}`);
-    fs.writeFileSync(imagePath, dataToSave);
-
-    const item: ClipboardItem = {
-      id: imageId,
-      type: 'image',
-      content: imagePath,
-      timestamp: Date.now(),
-      metadata: {
-        width: size.width,
-        height: size.height,
-        size: dataToSave.length,
-        format: ext,
-        ...(sourceFilename ? { filename: sourceFilename } : {}),
-      },
-    };
-
-    clipboardHistory.unshift(item);
-    sortClipboardHistory();
-    if (clipboardHistory.length > MAX_ITEMS) {
-      const removed = clipboardHistory.pop();
-      // Delete old image file
-      if (removed && removed.type === 'image' && fs.existsSync(removed.content)) {
-        try {
-          fs.unlinkSync(removed.content);
-        } catch {}
-      }
+    const addon = getNativeHelpersAddon();
+    if (isGif || !addon?.imageDifferenceHash || size.width < DHASH_MIN_WIDTH || size.height < DHASH_MIN_HEIGHT) {
+      insertImageItem(dataToSave, ext, blob, size, sourceFilename);
+      return;
     }
-
-    saveHistory();
+    // The bitmap is a copy, so the worker can read it while the clipboard
+    // moves on. The addon throws for a bitmap it cannot hash rather than
+    // rejecting; either way the image is saved without a hash.
+    new Promise<string>((resolve) => resolve(addon.imageDifferenceHash(image.toBitmap(), size.width, size.height)))
+      .catch((error: any) => {
+        console.warn('[Clipboard] Failed to compute image difference hash:', error?.message || error);
+        return undefined;
+      })
+      .then((dhash) => {
+        if (promoteDuplicateImageItem(blob)) return;
+        const similar = dhash ? findSimilarImageItem(dhash, size) : undefined;
+        if (similar) {
+          replaceImageItemPayload(similar, dataToSave, ext, blob, dhash as string, sourceFilename);
+          return;
+        }
+        insertImageItem(dataToSave, ext, blob, size, sourceFilename, dhash);
+      })
+      .catch((e) => console.error('Failed to save clipboard image:', e));
   } catch (e) {
     console.error('Failed to save clipboard image:', e);
   }
 }
 
+// Moves the image item holding `blob` to the top. Returns false when there
+// is none.
+function promoteDuplicateImageItem(blob: string): boolean {
+  const existing = clipboardHistory.find((entry) => entry.type === 'image' && entry.blob === blob);
+  if (!existing) return false;
+  existing.timestamp = Date.now();
+  sortClipboardHistory();
+  saveItems([existing]);
+  return true;
+}
+
+function findSimilarImageItem(dhash: string, size: { width: number; height: number }): ClipboardItem | undefined {
+  return clipboardHistory.find((entry) => (
+    entry.type === 'image' &&
+    entry.metadata?.dhash === dhash &&
+    entry.metadata.width === size.width &&
+    entry.metadata.height === size.height
+  ));
+}
+
+// Points `item` at new image bytes, releasing the old ones, and moves it to
+// the top.
+function replaceImageItemPayload(
+  item: ClipboardItem,
+  data: Buffer,
+  ext: string,
+  blobRef: string,
+  dhash: string,
+  sourceFilename?: string
+): void {
+  // Stored before the old payload is released, in case they share a blob.
+  const { blob, imagePath } = storeImagePayload(data, ext, blobRef);
+  releaseItemPayload(item);
+  item.blob = blob;
+  item.content = imagePath;
+  item.timestamp = Date.now();
+  item.metadata = {
+    ...item.metadata,
+    size: data.length,
+    format: ext,
+    dhash,
+    ...(sourceFilename ? { filename: sourceFilename } : {}),
+  };
+  sortClipboardHistory();
+  saveItems([item]);
+}
+
+function insertImageItem(
+  data: Buffer,
+  ext: string,
+  blobRef: string,
+  size: { width: number; height: number },
+  sourceFilename?: string,
+  dhash?: string
+): void {
+  const { blob, imagePath } = storeImagePayload(data, ext, blobRef);
+
+  const item: ClipboardItem = {
+    id: crypto.randomUUID(),
+    type: 'image',
+    content: imagePath,
+    blob,
+    timestamp: Date.now(),
+    metadata: {
+      width: size.width,
+      height: size.height,
+      size: data.length,
+      format: ext,
+      ...(dhash ? { dhash } : {}),
+      ...(sourceFilename ? { filename: sourceFilename } : {}),
+    },
+  };
+
+  clipboardHistory.unshift(item);
+  sortClipboardHistory();
+  saveItems([item]);
+  if (clipboardHistory.length > MAX_ITEMS) {
+    const removed = clipboardHistory.pop();
+    if (removed) {
+      saveRemovals([removed.id]);
+      releaseItemPayload(removed);
+    }
+  }
+}
+
 function decodeFileUrlCandidate(raw: string): string | null {
   const trimmed = String(raw || '').trim();
   if (!trimmed) return null;
@@ -799,14 +1075,12 @@ function handleClipboardFileCopy(filePath: string): boolean {
         return false;
       }
 
-      // Copy the file as-is into our images dir. Going through
+      // Copy the file as-is into the blob store. Going through
       // nativeImage.createFromBuffer() drops unsupported formats (HEIC, SVG,
       // some WebP), so keep the original bytes and let the renderer <img>
       // tag — which uses the system image decoder via file:// — render it.
-      const imageId = crypto.randomUUID();
       const ext = path.extname(filePath).toLowerCase().replace(/^\./, '') || 'bin';
-      const imagePath = path.join(getImagesDir(), `${imageId}.${ext}`);
-      fs.copyFileSync(filePath, imagePath);
+      const { blob, imagePath } = storeImagePayload(fs.readFileSync(filePath), ext);
       console.log(`[Clipboard] Copied image file → ${imagePath} (filename=${filename}, size=${stat.size})`);
 
       let width = 0;
@@ -821,9 +1095,10 @@ function handleClipboardFileCopy(filePath: string): boolean {
       } catch {}
 
       const item: ClipboardItem = {
-        id: imageId,
+        id: crypto.randomUUID(),
         type: 'image',
         content: imagePath,
+        blob,
         timestamp: Date.now(),
         metadata: {
           width,
@@ -837,13 +1112,14 @@ function handleClipboardFileCopy(filePath: string): boolean {
 
       clipboardHistory.unshift(item);
       sortClipboardHistory();
+      saveItems([item]);
       if (clipboardHistory.length > MAX_ITEMS) {
         const removed = clipboardHistory.pop();
-        if (removed && removed.type === 'image' && fs.existsSync(removed.content)) {
-          try { fs.unlinkSync(removed.content); } catch {}
+        if (removed) {
+          saveRemovals([removed.id]);
+          releaseItemPayload(removed);
         }
       }
-      saveHistory();
       return true;
     } catch (e) {
       console.error('[Clipboard] Failed to capture image file, falling back to file entry:', e);
@@ -877,76 +1153,256 @@ export function startClipboardMonitor(): void {
     }
   } catch {}
 
-  // Start polling
-  if (pollInterval) {
-    clearInterval(pollInterval);
-  }
+  stopWatchingClipboard();
   // Run one poll immediately so changes right after startup are captured.
   pollClipboard();
-  pollInterval = setInterval(pollClipboard, POLL_INTERVAL);
-  
-  console.log('Clipboard monitor started');
+  if (process.platform === 'linux') {
+    changeWatcher = startClipboardChangeWatcher({
+      onChange: scheduleChangedClipboardRead,
+      onUnavailable: () => {
+        changeWatcher = null;
+        startPolling();
+      },
+      NativeClipboardWatcher: getNativeHelpersAddon()?.ClipboardWatcher,
+    });
+  }
+  if (!changeWatcher?.backend) startPolling();
+
+  console.log(`Clipboard monitor started (${changeWatcher?.backend || 'polling'})`);
 }
 
-export function stopClipboardMonitor(): void {
+function startPolling(): void {
+  if (!pollInterval) pollInterval = setInterval(pollClipboard, POLL_INTERVAL);
+}
+
+function scheduleChangedClipboardRead(): void {
+  if (changeSettleTimer) return;
+  changeSettleTimer = setTimeout(() => {
+    changeSettleTimer = null;
+    pollClipboard();
+  }, CHANGE_SETTLE_MS);
+}
+
+function stopWatchingClipboard(): void {
   if (pollInterval) {
     clearInterval(pollInterval);
     pollInterval = null;
   }
+  if (changeWatcher) {
+    changeWatcher.stop();
+    changeWatcher = null;
+  }
+  if (changeSettleTimer) {
+    clearTimeout(changeSettleTimer);
+    changeSettleTimer = null;
+  }
+}
+
+export function stopClipboardMonitor(): void {
+  stopWatchingClipboard();
   console.log('Clipboard monitor stopped');
 }
 
+// Blob-backed texts are read back in full; the rest are the live records.
 export function getClipboardHistory(): ClipboardItem[] {
-  return clipboardHistory;
+  return clipboardHistory.map(toFullItem);
+}
+
+// ─── Paged Summaries ────────────────────────────────────────────────
+
+/** What the clipboard view lists: enough to draw a row, without the payload.
+ * The full item is fetched with getClipboardItemById() once selected. */
+export interface ClipboardItemSummary {
+  id: string;
+  type: ClipboardItem['type'];
+  preview: string;
+  /** Payload size in bytes. */
+  size: number;
+  timestamp: number;
+  pinned: boolean;
+  pinnedOrder?: number;
+  source?: string;
+  /** Images only: the stored file, for thumbnails. */
+  imagePath?: string;
+  metadata?: ClipboardItem['metadata'];
+}
+
+export interface ClipboardHistoryPage {
+  items: ClipboardItemSummary[];
+  /** Pass back to get the next page; null on the last page. */
+  nextCursor: string | null;
+  revision: number;
+}
+
+const DEFAULT_PAGE_SIZE = 50;
+const MAX_PAGE_SIZE = 500;
+const SUMMARY_PREVIEW_LENGTH = 200;
+
+function getItemSize(item: ClipboardItem): number {
+  if (Number.isFinite(item.metadata?.size)) return item.metadata?.size as number;
+  if (item.blob) {
+    try { return fs.statSync(getBlobStore().pathOf(item.blob)).size; } catch { return 0; }
+  }
+  return isTextLikeItem(item) ? Buffer.byteLength(item.content) : 0;
+}
+
+function toItemSummary(item: ClipboardItem): ClipboardItemSummary {
+  const preview = item.type === 'image'
+    ? (item.metadata?.filename || 'Image')
+    : (item.preview || item.content.slice(0, SUMMARY_PREVIEW_LENGTH));
+  return {
+    id: item.id,
+    type: item.type,
+    preview,
+    size: getItemSize(item),
+    timestamp: item.timestamp,
+    pinned: Boolean(item.pinned),
+    ...(item.pinned && Number.isFinite(item.pinnedOrder) ? { pinnedOrder: item.pinnedOrder } : {}),
+    ...(item.source ? { source: item.source } : {}),
+    ...(item.type === 'image' ? { imagePath: item.content } : {}),
+    ...(item.metadata ? { metadata: item.metadata } : {}),
+  };
+}
+
+// Browsing cursors name the last item returned by its sort key, so a page
+// continues after it even when newer copies have arrived on top since.
+// Search cursors are offsets into the ranked results.
+function encodeBrowseCursor(item: ClipboardItem): string {
+  const key: ClipboardSortKey = {
+    id: item.id,
+    timestamp: item.timestamp,
+    pinned: Boolean(item.pinned),
+    pinnedOrder: item.pinnedOrder,
+  };
+  return `k:${Buffer.from(JSON.stringify(key)).toString('base64')}`;
 }
 
+function decodeBrowseCursor(cursor: string): ClipboardSortKey | null {
+  if (!cursor.startsWith('k:')) return null;
+  try {
+    const key = JSON.parse(Buffer.from(cursor.slice(2), 'base64').toString('utf8'));
+    if (typeof key?.id !== 'string' || typeof key?.timestamp !== 'number') return null;
+    return key;
+  } catch {
+    return null;
+  }
+}
+
+/** One page of the history as summaries, in display order or, with a query,
+ * ranked by searchClipboardHistory(). `type` narrows to one kind of item. */
+export function getClipboardHistoryPage(options?: {
+  cursor?: string | null;
+  limit?: number;
+  type?: ClipboardItem['type'] | 'all';
+  query?: string;
+}): ClipboardHistoryPage {
+  const limit = Math.min(MAX_PAGE_SIZE, Math.max(1, Number(options?.limit) || DEFAULT_PAGE_SIZE));
+  const type = options?.type && options.type !== 'all' ? options.type : null;
+  const cursor = String(options?.cursor || '');
+  const query = String(options?.query || '').trim();
+  const matchesType = (item: ClipboardItem) => !type || item.type === type;
+
+  if (query) {
+    const offset = cursor.startsWith('o:') ? Math.max(0, parseInt(cursor.slice(2), 10) || 0) : 0;
+    const hits = searchIndex.search(query, { limit: MAX_ITEMS });
+    const itemsById = new Map(clipboardHistory.map((item) => [item.id, item]));
+    const matches: ClipboardItem[] = [];
+    for (const hit of hits) {
+      const item = itemsById.get(hit.id);
+      if (item && matchesType(item)) matches.push(item);
+    }
+    const page = matches.slice(offset, offset + limit);
+    return {
+      items: page.map(toItemSummary),
+      nextCursor: offset + limit < matches.length ? `o:${offset + limit}` : null,
+      revision: historyRevision,
+    };
+  }
+
+  const after = decodeBrowseCursor(cursor);
+  let start = 0;
+  if (after) {
+    start = clipboardHistory.findIndex((item) => compareClipboardItems(item, after) > 0);
+    if (start < 0) start = clipboardHistory.length;
+  }
+  const page: ClipboardItem[] = [];
+  let index = start;
+  for (; index < clipboardHistory.length && page.length < limit; index += 1) {
+    if (matchesType(clipboardHistory[index])) page.push(clipboardHistory[index]);
+  }
+  let hasMore = false;
+  for (; index < clipboardHistory.length && !hasMore; index += 1) hasMore = matchesType(clipboardHistory[index]);
+  return {
+    items: page.map(toItemSummary),
+    nextCursor: hasMore && page.length > 0 ? encodeBrowseCursor(page[page.length - 1]) : null,
+    revision: historyRevision,
+  };
+}
+
+export function getClipboardHistoryRevision(): number {
+  return historyRevision;
+}
+
+// ─── Retention ──────────────────────────────────────────────────────
+
 /**
- * Drop non-pinned entries whose timestamp is older than `retentionDays`.
- * `null` / undefined / non-positive = no-op (keep forever).
- * Returns the number of entries removed.
+ * Keep non-pinned entries for `retentionDays` days: expired ones are dropped
+ * now, and later ones in the background as they age out.
+ * `null` / undefined / non-positive = keep forever.
  */
-export function pruneClipboardHistoryOlderThan(retentionDays: number | null | undefined): number {
-  if (retentionDays == null) return 0;
+export function setClipboardHistoryRetentionDays(retentionDays: number | null | undefined): void {
   const days = Number(retentionDays);
-  if (!Number.isFinite(days) || days <= 0) return 0;
+  retentionWindowMs = retentionDays != null && Number.isFinite(days) && days > 0 ? days * DAY_MS : null;
+  sweepExpiredClipboardItems();
+}
 
-  const cutoff = Date.now() - days * 24 * 60 * 60 * 1000;
-  const before = clipboardHistory.length;
-  const kept: ClipboardItem[] = [];
-  for (const item of clipboardHistory) {
-    if (item.pinned) {
-      kept.push(item);
-      continue;
-    }
-    if (typeof item.timestamp !== 'number' || item.timestamp >= cutoff) {
-      kept.push(item);
-      continue;
-    }
-    if (item.type === 'image' && fs.existsSync(item.content)) {
-      try { fs.unlinkSync(item.content); } catch {}
+function sweepExpiredClipboardItems(): void {
+  if (retentionTimer) clearTimeout(retentionTimer);
+  retentionTimer = null;
+  if (retentionWindowMs === null) return;
+
+  const expiredIds = retentionIndex.takeExpired(Date.now() - retentionWindowMs);
+  if (expiredIds.length > 0) {
+    const expired = new Set(expiredIds);
+    // Expired items are the oldest unpinned ones, which sort last, so they
+    // come off the end of the history.
+    let kept = clipboardHistory.length;
+    while (kept > 0 && expired.has(clipboardHistory[kept - 1].id)) kept -= 1;
+    let removed: ClipboardItem[];
+    if (clipboardHistory.length - kept === expired.size) {
+      removed = clipboardHistory.splice(kept);
+    } else {
+      removed = clipboardHistory.filter((item) => expired.has(item.id));
+      clipboardHistory = clipboardHistory.filter((item) => !expired.has(item.id));
     }
+    saveRemovals(removed.map((item) => item.id));
+    for (const item of removed) releaseItemPayload(item);
+    const days = Math.round((retentionWindowMs / DAY_MS) * 100) / 100;
+    console.log(`Pruned ${removed.length} clipboard item${removed.length === 1 ? '' : 's'} older than ${days} day${days === 1 ? '' : 's'}`);
   }
-  const removed = before - kept.length;
-  if (removed > 0) {
-    clipboardHistory = kept;
-    saveHistory();
-    console.log(`Pruned ${removed} clipboard item${removed === 1 ? '' : 's'} older than ${days} day${days === 1 ? '' : 's'}`);
-  }
-  return removed;
+  scheduleRetentionSweep();
+}
+
+// Arms the sweep for when the oldest indexed item expires, unless it is
+// already due by then.
+function scheduleRetentionSweep(): void {
+  if (retentionWindowMs === null) return;
+  const expiresAt = retentionIndex.nextExpiryAt(retentionWindowMs);
+  if (expiresAt === null) return;
+  if (retentionTimer && retentionSweepAt <= expiresAt) return;
+  if (retentionTimer) clearTimeout(retentionTimer);
+  const delay = Math.min(Math.max(expiresAt - Date.now(), 0), MAX_RETENTION_SLEEP_MS);
+  retentionSweepAt = Date.now() + delay;
+  retentionTimer = setTimeout(sweepExpiredClipboardItems, delay);
+  retentionTimer.unref?.();
 }
 
 export function clearClipboardHistory(): void {
-  // Delete all image files
-  for (const item of clipboardHistory) {
-    if (item.type === 'image' && fs.existsSync(item.content)) {
-      try {
-        fs.unlinkSync(item.content);
-      } catch {}
-    }
-  }
-  
+  // Delete all image files and text blobs
+  for (const item of clipboardHistory) releaseItemPayload(item);
+
   clipboardHistory = [];
-  saveHistory();
+  saveCleared();
   console.log('Clipboard history cleared');
 }
 
@@ -956,22 +1412,18 @@ export function deleteClipboardItem(id: string): boolean {
   
   const item = clipboardHistory[index];
   
-  // Delete image file if it exists
-  if (item.type === 'image' && fs.existsSync(item.content)) {
-    try {
-      fs.unlinkSync(item.content);
-    } catch {}
-  }
-  
+  // Delete its image file or text blob once nothing else uses it
+  releaseItemPayload(item);
+
   clipboardHistory.splice(index, 1);
-  saveHistory();
+  saveRemovals([id]);
   
   return true;
 }
 
 export function getClipboardItemById(id: string): ClipboardItem | null {
   const item = clipboardHistory.find((i) => i.id === id);
-  return item ? { ...item } : null;
+  return item ? { ...toFullItem(item) } : null;
 }
 
 export function togglePinClipboardItem(id: string): ClipboardItem | null {
@@ -986,8 +1438,8 @@ export function togglePinClipboardItem(id: string): ClipboardItem | null {
     delete item.pinnedOrder;
   }
   sortClipboardHistory();
-  saveHistory();
-  return { ...item };
+  saveItems([item]);
+  return { ...toFullItem(item) };
 }
 
 /** Move a pinned item up or down within the pinned group by swapping its
@@ -1010,7 +1462,8 @@ export function moveClipboardPinnedItem(id: string, direction: 'up' | 'down'): b
   b.pinnedOrder = tmp;
 
   sortClipboardHistory();
-  saveHistory();
+  // ensurePinnedOrder may have renumbered the whole (small) pinned group.
+  saveItems(pinned);
   return true;
 }
 
@@ -1084,14 +1537,15 @@ export function copyItemToClipboard(id: string): boolean {
         }
       }
     } else {
-      clipboard.writeText(item.content);
-      lastClipboardText = item.content;
+      const text = getItemText(item);
+      clipboard.writeText(text);
+      lastClipboardText = text;
     }
 
     // Bump recency for sorting; pinned items still stay grouped above non-pinned.
     item.timestamp = Date.now();
     sortClipboardHistory();
-    saveHistory();
+    saveItems([item]);
     
     // Seed the changeCount so the next poll recognises our write as "already seen"
     // and doesn't create a duplicate entry. This works even if the poll fires
@@ -1129,21 +1583,27 @@ export function setClipboardAppBlacklist(bundleIds: string[] | null | undefined)
 
 export function setClipboardMonitorEnabled(enabled: boolean): void {
   isEnabled = enabled;
-  if (enabled && !pollInterval) {
+  const running = Boolean(pollInterval || changeWatcher);
+  if (enabled && !running) {
     startClipboardMonitor();
-  } else if (!enabled && pollInterval) {
+  } else if (!enabled && running) {
     stopClipboardMonitor();
   }
 }
 
-export function searchClipboardHistory(query: string): ClipboardItem[] {
-  if (!query) return clipboardHistory;
-  
-  const lowerQuery = query.toLowerCase();
-  return clipboardHistory.filter((item) => {
-    if (item.type === 'text' || item.type === 'url' || item.type === 'file') {
-      return item.content.toLowerCase().includes(lowerQuery);
-    }
-    return false;
-  });
+// Ranked by how well the query terms match, then by recency; see
+// clipboard-search-index.ts. An empty query lists the history as displayed.
+export function searchClipboardHistory(query: string, options?: { limit?: number }): ClipboardItem[] {
+  const limit = Math.max(1, Number(options?.limit) || MAX_ITEMS);
+  if (!String(query || '').trim()) return clipboardHistory.slice(0, limit).map(toFullItem);
+
+  const hits = searchIndex.search(query, { limit });
+  if (hits.length === 0) return [];
+  const itemsById = new Map(clipboardHistory.map((item) => [item.id, item]));
+  const results: ClipboardItem[] = [];
+  for (const hit of hits) {
+    const item = itemsById.get(hit.id);
+    if (item) results.push(toFullItem(item));
+  }
+  return results;
 }
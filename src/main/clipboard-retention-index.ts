@@ -0,0 +1,124 @@
+// Clipboard items grouped by the hour they were copied, for retention. The
+// sweeper drops whole buckets once they have fallen out of the retention
+// window, so expiring items costs time in the number expired rather than in
+// the size of the history. Pinned items are never indexed: they never expire.
+//
+// A bucket expires when its last moment does, so an item can outlive the
+// window by up to one bucket (an hour) — nothing for a window counted in days.
+
+export const RETENTION_BUCKET_MS = 60 * 60 * 1000;
+
+export type ClipboardRetentionEntry = {
+  id: string;
+  timestamp: number;
+  pinned?: boolean;
+};
+
+export class ClipboardRetentionIndex {
+  private readonly bucketMs: number;
+  private readonly buckets = new Map<number, Set<string>>();
+  // Keys of `buckets`, ascending.
+  private bucketKeys: number[] = [];
+  private readonly bucketById = new Map<string, number>();
+
+  constructor(bucketMs = RETENTION_BUCKET_MS) {
+    this.bucketMs = bucketMs;
+  }
+
+  get size(): number {
+    return this.bucketById.size;
+  }
+
+  upsert(item: ClipboardRetentionEntry): void {
+    if (item.pinned || typeof item.timestamp !== 'number' || !Number.isFinite(item.timestamp)) {
+      this.remove(item.id);
+      return;
+    }
+    const key = Math.floor(item.timestamp / this.bucketMs);
+    const current = this.bucketById.get(item.id);
+    if (current === key) return;
+    if (current !== undefined) this.removeFromBucket(item.id, current);
+    this.bucketById.set(item.id, key);
+    let bucket = this.buckets.get(key);
+    if (!bucket) {
+      bucket = new Set();
+      this.buckets.set(key, bucket);
+      this.insertKey(key);
+    }
+    bucket.add(item.id);
+  }
+
+  remove(id: string): void {
+    const key = this.bucketById.get(id);
+    if (key === undefined) return;
+    this.bucketById.delete(id);
+    this.removeFromBucket(id, key);
+  }
+
+  clear(): void {
+    this.buckets.clear();
+    this.bucketKeys = [];
+    this.bucketById.clear();
+  }
+
+  rebuild(items: Iterable<ClipboardRetentionEntry>): void {
+    this.clear();
+    for (const item of items) this.upsert(item);
+  }
+
+  // Removes and returns the ids in every bucket that ends at or before
+  // `cutoff`, oldest first.
+  takeExpired(cutoff: number): string[] {
+    const expired: string[] = [];
+    let dropped = 0;
+    while (dropped < this.bucketKeys.length && (this.bucketKeys[dropped] + 1) * this.bucketMs <= cutoff) {
+      const key = this.bucketKeys[dropped];
+      for (const id of this.buckets.get(key) as Set<string>) {
+        expired.push(id);
+        this.bucketById.delete(id);
+      }
+      this.buckets.delete(key);
+      dropped += 1;
+    }
+    if (dropped > 0) this.bucketKeys.splice(0, dropped);
+    return expired;
+  }
+
+  // When the oldest bucket leaves a window of `windowMs`; null when empty.
+  nextExpiryAt(windowMs: number): number | null {
+    if (this.bucketKeys.length === 0) return null;
+    return (this.bucketKeys[0] + 1) * this.bucketMs + windowMs;
+  }
+
+  private removeFromBucket(id: string, key: number): void {
+    const bucket = this.buckets.get(key);
+    if (!bucket) return;
+    bucket.delete(id);
+    if (bucket.size > 0) return;
+    this.buckets.delete(key);
+    const index = this.findKey(key);
+    if (this.bucketKeys[index] === key) this.bucketKeys.splice(index, 1);
+  }
+
+  private insertKey(key: number): void {
+    // New items land in the newest bucket, so this is almost always a push.
+    const last = this.bucketKeys.length - 1;
+    if (last < 0 || this.bucketKeys[last] < key) {
+      this.bucketKeys.push(key);
+      return;
+    }
+    this.bucketKeys.splice(this.findKey(key), 0, key);
+  }
+
+  // Index of the first key >= `key`.
+  private findKey(key: number): number {
+    let low = 0;
+    let high = this.bucketKeys.length;
+    while (low < high) {
+      const mid = (low + high) >>> 1;
+      if (this.bucketKeys[mid] < key) low = mid + 1;
+      else high = mid;
+    }
+    return low;
+  }
+}
@@ -0,0 +1,387 @@
+// Incrementally maintained search index over clipboard history.
+//
+// Item text is split into terms (runs of letters and digits, lowercased), so
+// URLs and file paths index by their host, segment and name parts. Terms are
+// kept once in a shared vocabulary, each with the set of items containing it,
+// and the vocabulary itself is indexed by trigram (and by one- and
+// two-character prefix for short query terms). A query term is resolved
+// against the vocabulary (exact, prefix, substring, then typo-tolerant) and
+// the matching terms' item sets are merged, so a search touches only the
+// vocabulary entries it matches and the items that contain them, not the
+// item text.
+//
+// Multi-term queries match items containing every term. Results are ranked
+// by how well the terms matched, then by recency.
+//
+// Terms only see letters and digits, and short query terms only match term
+// prefixes, so a query the terms cannot answer ("->", "@", "ab" for "cable",
+// "ld wo" for "hello world") falls back to a plain substring scan of each
+// item's lowercased text, as the history search did before the index.
+
+export type ClipboardSearchDocument = {
+  id: string;
+  type: string;
+  content: string;
+  timestamp: number;
+  metadata?: { filename?: string; width?: number; height?: number };
+};
+
+export type ClipboardSearchHit = {
+  id: string;
+  score: number;
+};
+
+// Quality of the best vocabulary match for a query term.
+const MATCH_EXACT = 1;
+const MATCH_PREFIX = 0.8;
+const MATCH_SUBSTRING = 0.6;
+const MATCH_FUZZY = 0.35;
+// Share of the score that comes from recency rather than match quality.
+const RECENCY_WEIGHT = 0.2;
+const RECENCY_HALF_LIFE_MS = 7 * 24 * 60 * 60 * 1000;
+// Long pastes are indexed by their leading text only.
+const MAX_INDEXED_TEXT_LENGTH = 32_768;
+const MAX_TERM_LENGTH = 64;
+const MIN_FUZZY_TERM_LENGTH = 4;
+const DEFAULT_LIMIT = 200;
+const TERM_SPLIT_REGEX = /[^\p{L}\p{N}]+/u;
+
+type IndexedDocument = {
+  id: string;
+  timestamp: number;
+  termIds: number[];
+  // Lowercased search text, for the substring fallback.
+  text: string;
+};
+
+export function tokenizeClipboardText(text: string): string[] {
+  return String(text || '')
+    .toLowerCase()
+    .split(TERM_SPLIT_REGEX)
+    .filter((term) => term.length > 0 && term.length <= MAX_TERM_LENGTH);
+}
+
+// Mirrors what the clipboard view shows for an item: the text itself, or an
+// image's file name and dimensions.
+export function getClipboardSearchText(document: ClipboardSearchDocument): string {
+  if (document.type === 'image') {
+    const title = document.metadata?.filename || 'Image';
+    const width = document.metadata?.width;
+    const height = document.metadata?.height;
+    return width && height ? `${title} ${width}x${height} ${width} ${height}` : title;
+  }
+  return String(document.content || '').slice(0, MAX_INDEXED_TEXT_LENGTH);
+}
+
+function getTrigrams(term: string): string[] {
+  const trigrams: string[] = [];
+  for (let index = 0; index + 3 <= term.length; index += 1) trigrams.push(term.slice(index, index + 3));
+  return trigrams;
+}
+
+// Damerau-Levenshtein distance (adjacent transpositions count once), giving
+// up once it exceeds `maxDistance`. Rows are reused across calls.
+const editRows = [new Int32Array(MAX_TERM_LENGTH + 1), new Int32Array(MAX_TERM_LENGTH + 1), new Int32Array(MAX_TERM_LENGTH + 1)];
+function isWithinEditDistance(a: string, b: string, maxDistance: number): boolean {
+  if (Math.abs(a.length - b.length) > maxDistance) return false;
+  let [previousPrevious, previous, current] = editRows;
+  for (let j = 0; j <= b.length; j += 1) previous[j] = j;
+  for (let i = 1; i <= a.length; i += 1) {
+    current[0] = i;
+    let rowMin = i;
+    for (let j = 1; j <= b.length; j += 1) {
+      const cost = a.charCodeAt(i - 1) === b.charCodeAt(j - 1) ? 0 : 1;
+      let value = Math.min(previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost);
+      if (i > 1 && j > 1 && a.charCodeAt(i - 1) === b.charCodeAt(j - 2) && a.charCodeAt(i - 2) === b.charCodeAt(j - 1)) {
+        value = Math.min(value, previousPrevious[j - 2] + 1);
+      }
+      current[j] = value;
+      if (value < rowMin) rowMin = value;
+    }
+    if (rowMin > maxDistance) return false;
+    const recycled = previousPrevious;
+    previousPrevious = previous;
+    previous = current;
+    current = recycled;
+  }
+  return previous[b.length] <= maxDistance;
+}
+
+export class ClipboardSearchIndex {
+  // Items by dense key; keys of removed items are reused.
+  private readonly documents: Array<IndexedDocument | null> = [];
+  private readonly freeDocumentKeys: number[] = [];
+  private readonly documentKeyById = new Map<string, number>();
+  private readonly termIdByText = new Map<string, number>();
+  private readonly termText: Array<string | null> = [];
+  private readonly termDocuments: Array<Set<number> | null> = [];
+  private readonly freeTermIds: number[] = [];
+  private readonly termsByTrigram = new Map<string, Set<number>>();
+  private readonly termsByShortPrefix = new Map<string, Set<number>>();
+  // Per-key scratch for one search, reset for the keys it touched.
+  private termsMatched = new Uint16Array(0);
+  private bestQuality = new Float64Array(0);
+  private totalQuality = new Float64Array(0);
+
+  get size(): number {
+    return this.documentKeyById.size;
+  }
+
+  rebuild(documents: ClipboardSearchDocument[]): void {
+    this.clear();
+    for (const document of documents) this.upsert(document);
+  }
+
+  clear(): void {
+    this.documents.length = 0;
+    this.freeDocumentKeys.length = 0;
+    this.documentKeyById.clear();
+    this.termIdByText.clear();
+    this.termText.length = 0;
+    this.termDocuments.length = 0;
+    this.freeTermIds.length = 0;
+    this.termsByTrigram.clear();
+    this.termsByShortPrefix.clear();
+  }
+
+  // Adds an item or re-indexes it after its text or timestamp changed.
+  upsert(document: ClipboardSearchDocument): void {
+    const existingKey = this.documentKeyById.get(document.id);
+    const text = getClipboardSearchText(document).toLowerCase();
+    const terms = new Set(tokenizeClipboardText(text));
+    if (existingKey !== undefined) {
+      const existing = this.documents[existingKey] as IndexedDocument;
+      existing.timestamp = document.timestamp;
+      existing.text = text;
+      // A timestamp bump with unchanged text is the common update.
+      if (existing.termIds.length === terms.size
+        && existing.termIds.every((termId) => terms.has(this.termText[termId] as string))) {
+        return;
+      }
+      this.remove(document.id);
+    }
+
+    const key = this.freeDocumentKeys.length > 0 ? this.freeDocumentKeys.pop() as number : this.documents.length;
+    const termIds: number[] = [];
+    for (const term of terms) {
+      const termId = this.internTerm(term);
+      (this.termDocuments[termId] as Set<number>).add(key);
+      termIds.push(termId);
+    }
+    this.documents[key] = { id: document.id, timestamp: document.timestamp, termIds, text };
+    this.documentKeyById.set(document.id, key);
+  }
+
+  remove(id: string): void {
+    const key = this.documentKeyById.get(id);
+    if (key === undefined) return;
+    const document = this.documents[key] as IndexedDocument;
+    for (const termId of document.termIds) {
+      const termDocuments = this.termDocuments[termId] as Set<number>;
+      termDocuments.delete(key);
+      if (termDocuments.size === 0) this.releaseTerm(termId);
+    }
+    this.documents[key] = null;
+    this.freeDocumentKeys.push(key);
+    this.documentKeyById.delete(id);
+  }
+
+  search(query: string, options?: { limit?: number; now?: number }): ClipboardSearchHit[] {
+    const now = options?.now ?? Date.now();
+    const limit = Math.max(1, Number(options?.limit) || DEFAULT_LIMIT);
+    const hits = this.searchTerms(query, now, limit);
+    return hits.length > 0 ? hits : this.searchSubstring(query, now, limit);
+  }
+
+  private searchTerms(query: string, now: number, limit: number): ClipboardSearchHit[] {
+    const queryTerms = [...new Set(tokenizeClipboardText(query))];
+    if (queryTerms.length === 0) return [];
+    // Resolve every term first: one without vocabulary matches fails the
+    // whole query before any item is touched.
+    const vocabularyMatches = queryTerms.map((queryTerm) => this.resolveVocabulary(queryTerm));
+    if (vocabularyMatches.some((matches) => matches.size === 0)) return [];
+    this.ensureScratchCapacity();
+
+    // An item stays a candidate while it has matched every term so far;
+    // termsMatched counts how many, and each term adds its best quality.
+    const touched: number[] = [];
+    for (let termIndex = 0; termIndex < vocabularyMatches.length; termIndex += 1) {
+      for (const [termId, quality] of vocabularyMatches[termIndex]) {
+        for (const key of this.termDocuments[termId] as Set<number>) {
+          const matched = this.termsMatched[key];
+          if (matched === termIndex) {
+            if (termIndex === 0) touched.push(key);
+            this.termsMatched[key] = termIndex + 1;
+            this.bestQuality[key] = quality;
+            this.totalQuality[key] += quality;
+          } else if (matched === termIndex + 1 && quality > this.bestQuality[key]) {
+            this.totalQuality[key] += quality - this.bestQuality[key];
+            this.bestQuality[key] = quality;
+          }
+        }
+      }
+    }
+
+    // The best `limit` hits are kept in a min-heap, so a broad query over a
+    // long history does not sort every match.
+    const heap: ClipboardSearchHit[] = [];
+    for (const key of touched) {
+      if (this.termsMatched[key] === queryTerms.length) {
+        const document = this.documents[key] as IndexedDocument;
+        pushHit(heap, limit, document.id, scoreHit(this.totalQuality[key] / queryTerms.length, document, now));
+      }
+      this.termsMatched[key] = 0;
+      this.totalQuality[key] = 0;
+    }
+    return heap.sort((a, b) => b.score - a.score);
+  }
+
+  // Scans every item's text; history is capped at about a thousand items.
+  private searchSubstring(query: string, now: number, limit: number): ClipboardSearchHit[] {
+    const needle = String(query || '').trim().toLowerCase();
+    if (!needle) return [];
+    const heap: ClipboardSearchHit[] = [];
+    for (const document of this.documents) {
+      if (!document || !document.text.includes(needle)) continue;
+      pushHit(heap, limit, document.id, scoreHit(MATCH_SUBSTRING, document, now));
+    }
+    return heap.sort((a, b) => b.score - a.score);
+  }
+
+  private ensureScratchCapacity(): void {
+    if (this.termsMatched.length >= this.documents.length) return;
+    const capacity = Math.max(64, this.documents.length * 2);
+    this.termsMatched = new Uint16Array(capacity);
+    this.bestQuality = new Float64Array(capacity);
+    this.totalQuality = new Float64Array(capacity);
+  }
+
+  // Vocabulary terms matching `queryTerm`, with their match quality.
+  private resolveVocabulary(queryTerm: string): Map<number, number> {
+    const qualityByTerm = new Map<number, number>();
+    const exactId = this.termIdByText.get(queryTerm);
+    if (exactId !== undefined) qualityByTerm.set(exactId, MATCH_EXACT);
+
+    if (queryTerm.length < 3) {
+      for (const termId of this.termsByShortPrefix.get(queryTerm) || []) {
+        if (termId !== exactId) qualityByTerm.set(termId, MATCH_PREFIX);
+      }
+      return qualityByTerm;
+    }
+
+    const trigrams = getTrigrams(queryTerm);
+    const trigramSets = trigrams.map((trigram) => this.termsByTrigram.get(trigram));
+    if (trigramSets.every(Boolean)) {
+      const sets = (trigramSets as Set<number>[]).sort((a, b) => a.size - b.size);
+      for (const termId of sets[0]) {
+        if (termId === exactId) continue;
+        if (!sets.every((set) => set.has(termId))) continue;
+        const term = this.termText[termId] as string;
+        const position = term.indexOf(queryTerm);
+        if (position === 0) qualityByTerm.set(termId, MATCH_PREFIX);
+        else if (position > 0) qualityByTerm.set(termId, MATCH_SUBSTRING);
+      }
+    }
+    if (qualityByTerm.size > 0 || queryTerm.length < MIN_FUZZY_TERM_LENGTH) return qualityByTerm;
+
+    // No term contains the query term: allow a typo or two against whole
+    // terms and term prefixes that share a trigram or the first two letters
+    // with it (a transposition can break every trigram of a short word).
+    const maxDistance = queryTerm.length <= 5 ? 1 : 2;
+    const checked = new Set<number>();
+    const candidateSets = trigrams.map((trigram) => this.termsByTrigram.get(trigram));
+    candidateSets.push(this.termsByShortPrefix.get(queryTerm.slice(0, 2)));
+    for (const candidates of candidateSets) {
+      for (const termId of candidates || []) {
+        if (checked.has(termId)) continue;
+        checked.add(termId);
+        const term = this.termText[termId] as string;
+        if (
+          isWithinEditDistance(queryTerm, term, maxDistance)
+          || (term.length > queryTerm.length && isWithinEditDistance(queryTerm, term.slice(0, queryTerm.length), maxDistance))
+        ) {
+          qualityByTerm.set(termId, MATCH_FUZZY);
+        }
+      }
+    }
+    return qualityByTerm;
+  }
+
+  private internTerm(term: string): number {
+    const existing = this.termIdByText.get(term);
+    if (existing !== undefined) return existing;
+    const termId = this.freeTermIds.length > 0 ? this.freeTermIds.pop() as number : this.termText.length;
+    this.termIdByText.set(term, termId);
+    this.termText[termId] = term;
+    this.termDocuments[termId] = new Set();
+    for (const trigram of getTrigrams(term)) addToSetMap(this.termsByTrigram, trigram, termId);
+    addToSetMap(this.termsByShortPrefix, term.slice(0, 1), termId);
+    if (term.length >= 2) addToSetMap(this.termsByShortPrefix, term.slice(0, 2), termId);
+    return termId;
+  }
+
+  private releaseTerm(termId: number): void {
+    const term = this.termText[termId] as string;
+    this.termIdByText.delete(term);
+    for (const trigram of getTrigrams(term)) removeFromSetMap(this.termsByTrigram, trigram, termId);
+    removeFromSetMap(this.termsByShortPrefix, term.slice(0, 1), termId);
+    if (term.length >= 2) removeFromSetMap(this.termsByShortPrefix, term.slice(0, 2), termId);
+    this.termText[termId] = null;
+    this.termDocuments[termId] = null;
+    this.freeTermIds.push(termId);
+  }
+}
+
+function addToSetMap(map: Map<string, Set<number>>, key: string, value: number): void {
+  let set = map.get(key);
+  if (!set) {
+    set = new Set();
+    map.set(key, set);
+  }
+  set.add(value);
+}
+
+function removeFromSetMap(map: Map<string, Set<number>>, key: string, value: number): void {
+  const set = map.get(key);
+  if (!set) return;
+  set.delete(value);
+  if (set.size === 0) map.delete(key);
+}
+
+function scoreHit(matchScore: number, document: IndexedDocument, now: number): number {
+  const age = Math.max(0, now - document.timestamp);
+  const recency = Math.pow(0.5, age / RECENCY_HALF_LIFE_MS);
+  return (1 - RECENCY_WEIGHT) * matchScore + RECENCY_WEIGHT * recency;
+}
+
+function pushHit(heap: ClipboardSearchHit[], limit: number, id: string, score: number): void {
+  if (heap.length < limit) {
+    heap.push({ id, score });
+    siftUp(heap, heap.length - 1);
+  } else if (score > heap[0].score) {
+    heap[0] = { id, score };
+    siftDown(heap, 0);
+  }
+}
+
+function siftUp(heap: ClipboardSearchHit[], index: number): void {
+  while (index > 0) {
+    const parent = (index - 1) >> 1;
+    if (heap[parent].score <= heap[index].score) return;
+    [heap[parent], heap[index]] = [heap[index], heap[parent]];
+    index = parent;
+  }
+}
+
+function siftDown(heap: ClipboardSearchHit[], index: number): void {
+  for (;;) {
+    const left = index * 2 + 1;
+    const right = left + 1;
+    let smallest = index;
+    if (left < heap.length && heap[left].score < heap[smallest].score) smallest = left;
+    if (right < heap.length && heap[right].score < heap[smallest].score) smallest = right;
+    if (smallest === index) return;
+    [heap[smallest], heap[index]] = [heap[index], heap[smallest]];
+    index = smallest;
+  }
+}
@@ -0,0 +1,552 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { StringDecoder } from 'string_decoder';
+import {
+  buildFileSearchResult,
+  intersectCandidates,
+  isWatchablePath,
+  shouldSkipDirectory,
+  throwIfCancelled,
+  yieldToEventLoop,
+  type FileSearchIndexConfig,
+  type IndexJobOptions,
+  type IndexedFileSearchResult,
+} from './file-search-index-engine';
+import { readContentIndexFile, writeContentIndexFile } from './file-search-index-persistence';
+import { GrowableColumn, PostingIndex, StringTable, TopKSelector } from './file-search-index-store';
+
+// Opt-in full-text index over text-like files under user-chosen roots, which
+// answers `content:` queries from the file index worker. Files are tokenized
+// as a stream and never read whole; each document's distinct terms are
+// appended to term -> document posting lists. Like entries in the name index,
+// a changed file is tombstoned and appended again under a new id rather than
+// edited in place, so posting lists stay ascending and append-only.
+
+export const CONTENT_QUERY_PREFIX = 'content:';
+
+export type ContentIndex = {
+  roots: string[];
+  paths: string[];
+  documentIdByPath: Map<string, number>;
+  mtimes: GrowableColumn<Float64Array>;
+  sizes: GrowableColumn<Float64Array>;
+  flags: GrowableColumn<Uint8Array>;
+  terms: StringTable;
+  postings: PostingIndex;
+  builtAt: number;
+  tombstoneCount: number;
+};
+
+type ContentFileCandidate = { path: string; mtimeMs: number; size: number };
+
+const CONTENT_FILE_EXTENSIONS = new Set([
+  '.txt', '.md', '.markdown', '.mdx', '.rst', '.org', '.tex', '.csv', '.tsv',
+  '.json', '.jsonc', '.json5', '.yaml', '.yml', '.toml', '.ini', '.cfg', '.conf', '.env', '.xml', '.plist',
+  '.ts', '.tsx', '.js', '.jsx', '.mjs', '.cjs', '.vue', '.svelte', '.astro',
+  '.html', '.htm', '.css', '.scss', '.sass', '.less',
+  '.py', '.rb', '.php', '.pl', '.lua', '.r', '.jl', '.dart', '.ex', '.exs', '.erl', '.clj', '.hs', '.ml', '.elm',
+  '.go', '.rs', '.java', '.kt', '.kts', '.scala', '.swift', '.m', '.mm', '.c', '.h', '.cc', '.cpp', '.cxx', '.hpp', '.cs', '.zig',
+  '.sh', '.bash', '.zsh', '.fish', '.ps1', '.sql', '.graphql', '.proto', '.gradle', '.cmake',
+]);
+const CONTENT_FILE_NAMES = new Set([
+  'readme', 'license', 'changelog', 'makefile', 'dockerfile', 'gemfile', 'rakefile', 'procfile', 'justfile',
+]);
+export const MAX_CONTENT_FILE_BYTES = 1024 * 1024;
+const MAX_CONTENT_DOCUMENTS = 100_000;
+// Caps the terms kept per file so one huge generated file cannot dominate.
+const MAX_TERMS_PER_DOCUMENT = 20_000;
+const MIN_TERM_LENGTH = 2;
+const MAX_TERM_LENGTH = 40;
+// Longer runs are hashes, base64 or minified code; none of it is searchable.
+const MAX_TOKEN_LENGTH = MAX_TERM_LENGTH * 4;
+const DEFAULT_MAX_RESULTS = 80;
+const MAX_QUERY_RESULTS = 1_000;
+const CONTENT_READ_CHUNK_BYTES = 64 * 1024;
+const CONTENT_TOKENIZE_CONCURRENCY = 4;
+const CONTENT_STAT_CONCURRENCY = 32;
+const CONTENT_WALK_YIELD_EVERY_DIRECTORIES = 80;
+const MIN_TOMBSTONES_BEFORE_COMPACTION = 1_024;
+const TOMBSTONE_COMPACTION_RATIO = 0.25;
+const RECENTLY_MODIFIED_MS = 7 * 24 * 60 * 60 * 1000;
+
+const DOCUMENT_FLAG_DELETED = 1 << 0;
+const TERM_CHARACTER_REGEX = /[\p{L}\p{N}_]/u;
+const NON_TERM_RUN_REGEX = /[^\p{L}\p{N}_]+/u;
+const CAMEL_CASE_BOUNDARY_REGEX = /([\p{Ll}\p{N}])(\p{Lu})/gu;
+
+function isPathWithin(candidatePath: string, rootDir: string): boolean {
+  return candidatePath === rootDir || candidatePath.startsWith(`${rootDir}${path.sep}`);
+}
+
+// Resolved roots that the name index would also index, with nested roots
+// folded into their ancestors.
+export function normalizeContentRoots(roots: string[], config: FileSearchIndexConfig): string[] {
+  const resolved = roots
+    .map((root) => String(root || '').trim())
+    .filter(Boolean)
+    .map((root) => (root === '~' || root.startsWith('~/') ? path.join(config.homeDir, root.slice(1)) : root))
+    .map((root) => path.resolve(root))
+    .filter((root) => isWatchablePath(root, config))
+    .sort();
+  const normalized: string[] = [];
+  for (const root of resolved) {
+    if (normalized.some((existing) => isPathWithin(root, existing))) continue;
+    normalized.push(root);
+  }
+  return normalized;
+}
+
+export function isContentIndexCandidate(fileName: string): boolean {
+  const lowerName = String(fileName || '').toLowerCase();
+  const extension = path.extname(lowerName);
+  if (CONTENT_FILE_EXTENSIONS.has(extension)) return true;
+  return CONTENT_FILE_NAMES.has(extension ? lowerName.slice(0, -extension.length) : lowerName);
+}
+
+export function createEmptyContentIndex(roots: string[]): ContentIndex {
+  return {
+    roots: [...roots],
+    paths: [],
+    documentIdByPath: new Map<string, number>(),
+    mtimes: new GrowableColumn(Float64Array),
+    sizes: new GrowableColumn(Float64Array),
+    flags: new GrowableColumn(Uint8Array),
+    terms: new StringTable(),
+    postings: new PostingIndex(),
+    builtAt: 0,
+    tombstoneCount: 0,
+  };
+}
+
+export function getContentDocumentCount(index: ContentIndex): number {
+  return index.paths.length - index.tombstoneCount;
+}
+
+function isDocumentDeleted(index: ContentIndex, documentId: number): boolean {
+  return (index.flags.values[documentId] & DOCUMENT_FLAG_DELETED) !== 0;
+}
+
+function tombstoneDocument(index: ContentIndex, documentId: number): void {
+  if (isDocumentDeleted(index, documentId)) return;
+  index.flags.values[documentId] |= DOCUMENT_FLAG_DELETED;
+  index.tombstoneCount += 1;
+  if (index.documentIdByPath.get(index.paths[documentId]) === documentId) {
+    index.documentIdByPath.delete(index.paths[documentId]);
+  }
+}
+
+function appendDocument(index: ContentIndex, file: ContentFileCandidate, terms: Set<string>): void {
+  const documentId = index.paths.length;
+  index.paths.push(file.path);
+  index.mtimes.push(file.mtimeMs);
+  index.sizes.push(file.size);
+  index.flags.push(0);
+  index.documentIdByPath.set(file.path, documentId);
+  for (const term of terms) index.postings.add(index.terms.intern(term), documentId);
+}
+
+// Whole token plus its snake_case / camelCase parts, so `parseConfig` is
+// found by `parseconfig`, `parse` and `config`.
+function addTokenTerms(token: string, terms: Set<string>): void {
+  if (token.length < MIN_TERM_LENGTH || token.length > MAX_TOKEN_LENGTH) return;
+  const lowerToken = token.toLowerCase();
+  if (lowerToken.length <= MAX_TERM_LENGTH) terms.add(lowerToken);
+  const parts = token.replace(CAMEL_CASE_BOUNDARY_REGEX, '$1_$2').toLowerCase().split('_');
+  if (parts.length < 2) return;
+  for (const part of parts) {
+    if (part.length >= MIN_TERM_LENGTH && part.length <= MAX_TERM_LENGTH) terms.add(part);
+  }
+}
+
+function addTextTerms(text: string, terms: Set<string>): void {
+  for (const token of text.split(NON_TERM_RUN_REGEX)) {
+    if (token) addTokenTerms(token, terms);
+  }
+}
+
+// Start of the token running up to the end of `text`, which may continue in
+// the next chunk. Runs already too long to index are not carried over.
+function getTrailingTokenStart(text: string): number {
+  let start = text.length;
+  while (start > 0 && TERM_CHARACTER_REGEX.test(text[start - 1])) {
+    start -= 1;
+    if (text.length - start > MAX_TOKEN_LENGTH) return text.length;
+  }
+  return start;
+}
+
+// Distinct terms of the first MAX_CONTENT_FILE_BYTES of a file, or null when
+// it turns out to be binary or unreadable.
+async function readDocumentTerms(filePath: string): Promise<Set<string> | null> {
+  const terms = new Set<string>();
+  const decoder = new StringDecoder('utf8');
+  const stream = fs.createReadStream(filePath, {
+    start: 0,
+    end: MAX_CONTENT_FILE_BYTES - 1,
+    highWaterMark: CONTENT_READ_CHUNK_BYTES,
+  });
+  let carry = '';
+  try {
+    for await (const chunk of stream) {
+      const bytes = chunk as Buffer;
+      // A NUL byte means binary data behind a text-like name.
+      if (bytes.indexOf(0) !== -1) return null;
+      const text = carry + decoder.write(bytes);
+      const tokenStart = getTrailingTokenStart(text);
+      addTextTerms(text.slice(0, tokenStart), terms);
+      carry = text.slice(tokenStart);
+      if (terms.size >= MAX_TERMS_PER_DOCUMENT) {
+        carry = '';
+        break;
+      }
+    }
+  } catch {
+    return null;
+  } finally {
+    stream.destroy();
+  }
+  addTextTerms(carry + decoder.end(), terms);
+  return terms;
+}
+
+async function statContentFile(filePath: string): Promise<ContentFileCandidate | null> {
+  try {
+    const stats = await fs.promises.stat(filePath);
+    if (!stats.isFile()) return null;
+    return { path: filePath, mtimeMs: stats.mtimeMs, size: stats.size };
+  } catch {
+    return null;
+  }
+}
+
+function isDocumentCurrent(index: ContentIndex, file: ContentFileCandidate): boolean {
+  const documentId = index.documentIdByPath.get(file.path);
+  if (documentId === undefined) return false;
+  return index.mtimes.values[documentId] === file.mtimeMs && index.sizes.values[documentId] === file.size;
+}
+
+// Stats `filePaths`, then re-tokenizes the ones that are new or changed.
+// Tombstone and append happen together once a file's terms are in hand, so a
+// batch and a refresh touching the same file cannot leave two live documents.
+async function indexContentFiles(index: ContentIndex, filePaths: string[], options?: IndexJobOptions): Promise<number> {
+  const changed: ContentFileCandidate[] = [];
+  for (let start = 0; start < filePaths.length; start += CONTENT_STAT_CONCURRENCY) {
+    throwIfCancelled(options);
+    const files = await Promise.all(filePaths.slice(start, start + CONTENT_STAT_CONCURRENCY).map(statContentFile));
+    for (let i = 0; i < files.length; i += 1) {
+      const file = files[i];
+      if (!file) {
+        const documentId = index.documentIdByPath.get(filePaths[start + i]);
+        if (documentId !== undefined) tombstoneDocument(index, documentId);
+        continue;
+      }
+      if (!isDocumentCurrent(index, file)) changed.push(file);
+    }
+  }
+
+  let changedCount = 0;
+  for (let start = 0; start < changed.length; start += CONTENT_TOKENIZE_CONCURRENCY) {
+    throwIfCancelled(options);
+    const group = changed.slice(start, start + CONTENT_TOKENIZE_CONCURRENCY);
+    const groupTerms = await Promise.all(group.map((file) =>
+      file.size > MAX_CONTENT_FILE_BYTES ? Promise.resolve(null) : readDocumentTerms(file.path)
+    ));
+    for (let i = 0; i < group.length; i += 1) {
+      const existingId = index.documentIdByPath.get(group[i].path);
+      if (existingId !== undefined) tombstoneDocument(index, existingId);
+      const terms = groupTerms[i];
+      if (!terms || getContentDocumentCount(index) >= MAX_CONTENT_DOCUMENTS) continue;
+      appendDocument(index, group[i], terms);
+      changedCount += 1;
+    }
+  }
+  return changedCount;
+}
+
+async function collectContentFiles(
+  config: FileSearchIndexConfig,
+  dirPath: string,
+  options?: IndexJobOptions
+): Promise<string[]> {
+  const filePaths: string[] = [];
+  const queue = [dirPath];
+  for (let index = 0; index < queue.length; index += 1) {
+    if ((index + 1) % CONTENT_WALK_YIELD_EVERY_DIRECTORIES === 0) {
+      await yieldToEventLoop();
+      throwIfCancelled(options);
+    }
+    let dirents: fs.Dirent[] = [];
+    try {
+      dirents = await fs.promises.readdir(queue[index], { withFileTypes: true });
+    } catch {
+      continue;
+    }
+    for (const dirent of dirents) {
+      const childPath = path.join(queue[index], dirent.name);
+      if (dirent.isDirectory()) {
+        if (!shouldSkipDirectory(childPath, dirent.name, config)) queue.push(childPath);
+      } else if (dirent.isFile() && isContentIndexCandidate(dirent.name)) {
+        filePaths.push(childPath);
+      }
+    }
+  }
+  return filePaths;
+}
+
+// Brings everything under `dirPath` up to date: walks it, re-tokenizes new and
+// changed files and tombstones documents whose files are gone. Documents
+// appended while the walk was running are left alone.
+export async function refreshContentSubtree(
+  index: ContentIndex,
+  config: FileSearchIndexConfig,
+  dirPath: string,
+  options?: IndexJobOptions
+): Promise<number> {
+  const documentCountAtStart = index.paths.length;
+  const filePaths = await collectContentFiles(config, dirPath, options);
+  const seenPaths = new Set(filePaths);
+  let changedCount = 0;
+  for (let documentId = 0; documentId < documentCountAtStart; documentId += 1) {
+    if (isDocumentDeleted(index, documentId)) continue;
+    const documentPath = index.paths[documentId];
+    if (!isPathWithin(documentPath, dirPath) || seenPaths.has(documentPath)) continue;
+    tombstoneDocument(index, documentId);
+    changedCount += 1;
+  }
+  changedCount += await indexContentFiles(index, filePaths, options);
+  return changedCount;
+}
+
+export async function refreshContentIndex(
+  index: ContentIndex,
+  config: FileSearchIndexConfig,
+  options?: IndexJobOptions
+): Promise<number> {
+  let changedCount = 0;
+  for (const root of index.roots) {
+    changedCount += await refreshContentSubtree(index, config, root, options);
+  }
+  index.builtAt = Date.now();
+  return changedCount;
+}
+
+// Applies a watcher batch: changed files are re-tokenized, directories are
+// refreshed as subtrees and deleted paths drop every document under them.
+export async function applyContentIndexBatch(
+  index: ContentIndex,
+  config: FileSearchIndexConfig,
+  paths: string[],
+  options?: IndexJobOptions
+): Promise<number> {
+  const filePaths: string[] = [];
+  const directoryPaths: string[] = [];
+  const deletedPaths = new Set<string>();
+  for (const candidatePath of new Set(paths)) {
+    if (!index.roots.some((root) => isPathWithin(candidatePath, root))) {
+      // A change above the roots (an overflow rescan of a parent) refreshes
+      // every root underneath it.
+      for (const root of index.roots) {
+        if (isPathWithin(root, candidatePath)) directoryPaths.push(root);
+      }
+      continue;
+    }
+    if (!isWatchablePath(candidatePath, config)) continue;
+    let stats: fs.Stats;
+    try {
+      stats = await fs.promises.stat(candidatePath);
+    } catch {
+      if (index.documentIdByPath.has(candidatePath)) filePaths.push(candidatePath);
+      else deletedPaths.add(candidatePath);
+      continue;
+    }
+    if (stats.isDirectory()) directoryPaths.push(candidatePath);
+    else if (stats.isFile() && isContentIndexCandidate(path.basename(candidatePath))) filePaths.push(candidatePath);
+  }
+
+  let changedCount = 0;
+  if (deletedPaths.size > 0) {
+    for (let documentId = 0; documentId < index.paths.length; documentId += 1) {
+      if (isDocumentDeleted(index, documentId)) continue;
+      let ancestor = path.dirname(index.paths[documentId]);
+      while (!deletedPaths.has(ancestor)) {
+        const parent = path.dirname(ancestor);
+        if (parent === ancestor) break;
+        ancestor = parent;
+      }
+      if (!deletedPaths.has(ancestor)) continue;
+      tombstoneDocument(index, documentId);
+      changedCount += 1;
+    }
+  }
+  changedCount += await indexContentFiles(index, filePaths, options);
+  for (const directoryPath of directoryPaths) {
+    changedCount += await refreshContentSubtree(index, config, directoryPath, options);
+  }
+  return changedCount;
+}
+
+export function shouldCompactContentIndex(index: ContentIndex): boolean {
+  return index.tombstoneCount >= MIN_TOMBSTONES_BEFORE_COMPACTION
+    && index.tombstoneCount >= index.paths.length * TOMBSTONE_COMPACTION_RATIO;
+}
+
+// Copy without tombstoned documents or terms only they used.
+export function compactContentIndex(index: ContentIndex): ContentIndex {
+  const compacted = createEmptyContentIndex(index.roots);
+  compacted.builtAt = index.builtAt;
+  const documentRemap = new Int32Array(index.paths.length).fill(-1);
+  for (let documentId = 0; documentId < index.paths.length; documentId += 1) {
+    if (isDocumentDeleted(index, documentId)) continue;
+    const nextId = compacted.paths.length;
+    documentRemap[documentId] = nextId;
+    compacted.paths.push(index.paths[documentId]);
+    compacted.mtimes.push(index.mtimes.values[documentId]);
+    compacted.sizes.push(index.sizes.values[documentId]);
+    compacted.flags.push(0);
+    compacted.documentIdByPath.set(index.paths[documentId], nextId);
+  }
+
+  const termRemap = new Int32Array(index.terms.size).fill(-1);
+  for (let termId = 0; termId < index.terms.size; termId += 1) {
+    const documentIds = index.postings.get(termId);
+    for (let i = 0; i < documentIds.length; i += 1) {
+      if (documentRemap[documentIds[i]] < 0) continue;
+      termRemap[termId] = compacted.terms.intern(index.terms.get(termId));
+      break;
+    }
+  }
+  compacted.postings = index.postings.remap(termRemap, documentRemap, compacted.terms.size);
+  return compacted;
+}
+
+function tokenizeContentQuery(query: string): string[] {
+  const terms = new Set<string>();
+  for (const token of query.split(NON_TERM_RUN_REGEX)) {
+    if (token.length >= MIN_TERM_LENGTH) terms.add(token.toLowerCase());
+  }
+  return [...terms];
+}
+
+// The query text after a `content:` prefix, or null for a name query.
+export function parseContentQuery(rawQuery: string): string | null {
+  const trimmed = String(rawQuery || '').trim();
+  if (trimmed.slice(0, CONTENT_QUERY_PREFIX.length).toLowerCase() !== CONTENT_QUERY_PREFIX) return null;
+  return trimmed.slice(CONTENT_QUERY_PREFIX.length).trim();
+}
+
+// Files containing every query term. Terms matched exactly, so ranking only
+// breaks ties: terms that also appear in the file name, shallow paths and
+// recent edits go first.
+export function searchContentIndex(
+  index: ContentIndex | null,
+  config: FileSearchIndexConfig,
+  query: string,
+  options?: { limit?: number } & IndexJobOptions
+): IndexedFileSearchResult[] {
+  const terms = tokenizeContentQuery(query);
+  if (!index || terms.length === 0) return [];
+  if (terms.some((term) => term.length > MAX_TERM_LENGTH)) return [];
+
+  const lists: Uint32Array[] = [];
+  for (const term of terms) {
+    const documentIds = index.postings.get(index.terms.lookup(term));
+    if (documentIds.length === 0) return [];
+    lists.push(documentIds);
+  }
+  const candidateIds = intersectCandidates(lists);
+  throwIfCancelled(options);
+
+  const limit = Math.max(1, Math.min(MAX_QUERY_RESULTS, Number(options?.limit) || DEFAULT_MAX_RESULTS));
+  const now = Date.now();
+  const selector = new TopKSelector<{ documentId: number; score: number }>(limit, (a, b) => {
+    if (b.score !== a.score) return b.score - a.score;
+    return index.paths[a.documentId].localeCompare(index.paths[b.documentId]) || a.documentId - b.documentId;
+  });
+  for (let i = 0; i < candidateIds.length; i += 1) {
+    const documentId = candidateIds[i];
+    if (isDocumentDeleted(index, documentId)) continue;
+    const documentPath = index.paths[documentId];
+    const lowerName = path.basename(documentPath).toLowerCase();
+    let score = 500;
+    for (const term of terms) {
+      if (lowerName.includes(term)) score += 60;
+    }
+    score -= Math.min(40, documentPath.split(path.sep).length * 2);
+    if (now - index.mtimes.values[documentId] < RECENTLY_MODIFIED_MS) score += 30;
+    selector.push({ documentId, score });
+  }
+
+  return selector.toSortedArray().map(({ documentId, score }) => {
+    const documentPath = index.paths[documentId];
+    return buildFileSearchResult(
+      {
+        path: documentPath,
+        name: path.basename(documentPath),
+        parentPath: path.dirname(documentPath),
+        isDirectory: false,
+      },
+      score,
+      'content',
+      config.homeDir
+    );
+  });
+}
+
+export async function persistContentIndex(filePath: string, index: ContentIndex): Promise<void> {
+  const { offsets, postings } = index.postings.sealedArrays();
+  await writeContentIndexFile(filePath, {
+    builtAt: index.builtAt,
+    roots: index.roots,
+    paths: index.paths,
+    mtimes: index.mtimes.view(),
+    sizes: index.sizes.view(),
+    documentFlags: index.flags.view(),
+    terms: index.terms.toArray(),
+    postingOffsets: offsets,
+    postings,
+  });
+}
+
+export async function restoreContentIndex(
+  filePath: string,
+  roots: string[],
+  options?: IndexJobOptions
+): Promise<ContentIndex | null> {
+  let persisted: Awaited<ReturnType<typeof readContentIndexFile>> = null;
+  try {
+    persisted = await readContentIndexFile(filePath);
+  } catch (error) {
+    console.warn('[FileIndex] Ignoring unreadable content index:', error);
+    return null;
+  }
+  if (!persisted) return null;
+  if (persisted.roots.join('\0') !== roots.join('\0')) return null;
+
+  const terms = new StringTable();
+  for (let i = 0; i < persisted.terms.length; i += 1) {
+    if (terms.intern(persisted.terms[i]) !== i) {
+      console.warn('[FileIndex] Ignoring content index with duplicate terms');
+      return null;
+    }
+  }
+  await yieldToEventLoop();
+  throwIfCancelled(options);
+
+  const index: ContentIndex = {
+    roots: persisted.roots,
+    paths: [...persisted.paths],
+    documentIdByPath: new Map<string, number>(),
+    mtimes: new GrowableColumn(Float64Array, persisted.mtimes),
+    sizes: new GrowableColumn(Float64Array, persisted.sizes),
+    flags: new GrowableColumn(Uint8Array, persisted.documentFlags),
+    terms,
+    postings: PostingIndex.fromSealed(persisted.postingOffsets, persisted.postings),
+    builtAt: persisted.builtAt,
+    tombstoneCount: 0,
+  };
+  for (let documentId = 0; documentId < index.paths.length; documentId += 1) {
+    if (isDocumentDeleted(index, documentId)) index.tombstoneCount += 1;
+    else index.documentIdByPath.set(index.paths[documentId], documentId);
+  }
+  return index;
+}
@@ -0,0 +1,151 @@
+import * as fs from 'fs';
+import * as path from 'path';
+
+// Directory listings for the file search index walk. With the native helpers
+// addon, a batch of directories is listed in one call on a libuv worker
+// thread (getdents64 on Linux, readdir on macOS), with excluded names dropped
+// and every kept entry already stat'ed, and comes back as a few typed arrays.
+// Without it (Windows, or a missing build) each directory is one
+// fs.promises.readdir and the walk stats entries itself.
+
+export const DIRECTORY_ENTRY_FILE = 1;
+export const DIRECTORY_ENTRY_DIRECTORY = 2;
+export const DIRECTORY_ENTRY_SYMLINK = 3;
+
+export type DirectoryListing = {
+  names: string[];
+  // DIRECTORY_ENTRY_* per name; other kinds of entries are left out.
+  types: Uint8Array;
+  // Size and mtime of each entry, following symlinks; -1 where the stat
+  // failed. Null when the lister does not stat entries.
+  sizes: Float64Array | null;
+  mtimesMs: Float64Array | null;
+  // "device:inode" of the listed directory, so the walk can detect cycles
+  // without a realpath per directory. Null when unknown.
+  identity: string | null;
+};
+
+// Names a listing may leave out. The walk applies its own rules to whatever
+// is listed, so these are only a shortcut and must not drop anything the walk
+// would keep.
+export type DirectoryListingFilter = {
+  // Lowercased.
+  excludedDirectoryNames: string[];
+  skipHiddenDirectories: boolean;
+  // Exact names.
+  excludedFileNames: string[];
+  // Lowercased, with the leading dot.
+  excludedFileExtensions: string[];
+};
+
+export type DirectoryLister = {
+  // How many directories one list() call should be given.
+  batchSize: number;
+  // One listing per path, or null where the directory could not be read.
+  list: (paths: string[]) => Promise<Array<DirectoryListing | null>>;
+};
+
+type NativeDirectoryBatch = {
+  entryCounts: Uint32Array;
+  errors: Int32Array;
+  identities: string[];
+  // NUL-terminated UTF-8 names of every listed entry.
+  names: Buffer;
+  types: Uint8Array;
+  sizes: Float64Array;
+  mtimesMs: Float64Array;
+};
+
+type NativeHelpersAddon = {
+  listDirectories?: (paths: string[], filter: DirectoryListingFilter) => Promise<NativeDirectoryBatch>;
+};
+
+const NATIVE_LIST_BATCH_SIZE = 64;
+
+let nativeHelpersAddon: NativeHelpersAddon | null = null;
+let nativeHelpersAddonLoaded = false;
+
+function loadNativeHelpersAddon(): NativeHelpersAddon | null {
+  if (nativeHelpersAddonLoaded) return nativeHelpersAddon;
+  nativeHelpersAddonLoaded = true;
+  if (process.platform !== 'linux' && process.platform !== 'darwin') return null;
+  try {
+    nativeHelpersAddon = require(path.join(__dirname, '..', 'native', 'native_helpers.node'));
+  } catch (error: any) {
+    console.warn('[FileIndex] native directory walker unavailable:', error?.message);
+    nativeHelpersAddon = null;
+  }
+  return nativeHelpersAddon;
+}
+
+async function readDirectoryListing(dirPath: string): Promise<DirectoryListing | null> {
+  let dirents: fs.Dirent[];
+  try {
+    dirents = await fs.promises.readdir(dirPath, { withFileTypes: true });
+  } catch {
+    return null;
+  }
+  const names: string[] = [];
+  const types = new Uint8Array(dirents.length);
+  for (const dirent of dirents) {
+    const type = dirent.isDirectory()
+      ? DIRECTORY_ENTRY_DIRECTORY
+      : dirent.isSymbolicLink()
+        ? DIRECTORY_ENTRY_SYMLINK
+        : dirent.isFile() ? DIRECTORY_ENTRY_FILE : 0;
+    if (!type) continue;
+    types[names.length] = type;
+    names.push(dirent.name);
+  }
+  return { names, types: types.subarray(0, names.length), sizes: null, mtimesMs: null, identity: null };
+}
+
+const readdirLister: DirectoryLister = {
+  batchSize: 1,
+  list: (paths) => Promise.all(paths.map(readDirectoryListing)),
+};
+
+export function decodeNativeDirectoryBatch(batch: NativeDirectoryBatch): Array<DirectoryListing | null> {
+  // Names cannot contain NUL, so one decode and split covers the whole batch.
+  const names = batch.names.length > 0 ? batch.names.toString('utf8', 0, batch.names.length - 1).split('\0') : [];
+  const listings: Array<DirectoryListing | null> = [];
+  let offset = 0;
+  for (let index = 0; index < batch.entryCounts.length; index += 1) {
+    if (batch.errors[index] !== 0) {
+      listings.push(null);
+      continue;
+    }
+    const end = offset + batch.entryCounts[index];
+    listings.push({
+      names: names.slice(offset, end),
+      types: batch.types.subarray(offset, end),
+      sizes: batch.sizes.subarray(offset, end),
+      mtimesMs: batch.mtimesMs.subarray(offset, end),
+      identity: batch.identities[index] || null,
+    });
+    offset = end;
+  }
+  return listings;
+}
+
+// The native lister when the addon is available, readdir otherwise. A batch
+// the addon rejects is listed again with readdir.
+export function createDirectoryLister(filter: DirectoryListingFilter): DirectoryLister {
+  const listDirectories = loadNativeHelpersAddon()?.listDirectories;
+  if (!listDirectories) return readdirLister;
+  return {
+    batchSize: NATIVE_LIST_BATCH_SIZE,
+    list: async (paths) => {
+      try {
+        return decodeNativeDirectoryBatch(await listDirectories(paths, filter));
+      } catch (error) {
+        console.warn('[FileIndex] native directory listing failed:', error);
+        return readdirLister.list(paths);
+      }
+    },
+  };
+}
+
+export function createReaddirDirectoryLister(): DirectoryLister {
+  return readdirLister;
+}
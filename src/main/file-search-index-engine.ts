@@ -0,0 +1,2400 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { execFile } from 'child_process';
+import { promisify } from 'util';
+import { readIndexSnapshotFile, writeIndexSnapshotFile } from './file-search-index-persistence';
+import { GrowableColumn, PostingIndex, StringTable, TopKSelector, estimateStringBytes } from './file-search-index-store';
+import { ScanThrottle } from './file-search-index-throttle';
+import {
+  DIRECTORY_ENTRY_DIRECTORY,
+  DIRECTORY_ENTRY_FILE,
+  DIRECTORY_ENTRY_SYMLINK,
+  createDirectoryLister,
+  type DirectoryLister,
+  type DirectoryListingFilter,
+} from './file-search-index-directory-lister';
+import {
+  IGNORE_FILE_NAMES,
+  IgnoreRules,
+  IgnoreRulesCache,
+  isIgnoreFileName,
+  loadDirectoryIgnoreRules,
+} from './file-search-index-ignore';
+import {
+  SIZE_BUCKET_UNKNOWN,
+  getFileNameExtension,
+  getKindExtensions,
+  getSizeBucket,
+  parseFileSearchFilters,
+  type FileSearchFilters,
+} from './file-search-index-filters';
+
+// Index data structures, directory walking and query execution for file
+// search. Everything here is free of Electron and module-level state so it can
+// run inside the file index worker thread (and be driven directly by scripts).
+
+export type IndexedFileSearchResult = {
+  path: string;
+  name: string;
+  parentPath: string;
+  displayPath: string;
+  isDirectory: boolean;
+  score?: number;
+  matchKind?: string;
+  depth?: number;
+  homeRelativeDepth?: number;
+  topLevelRoot?: string;
+  noisyPathSegmentCount?: number;
+  mtimeMs?: number;
+  birthtimeMs?: number;
+  atimeMs?: number;
+};
+
+export type IndexedFileSearchMetadata = Pick<IndexedFileSearchResult, 'path' | 'mtimeMs' | 'birthtimeMs' | 'atimeMs'>;
+
+export type FileSearchIndexConfig = {
+  homeDir: string;
+  includeRoots: string[];
+  includeProtectedHomeRoots: boolean;
+};
+
+// Entries are stored column-wise and addressed by id. Names and prefix keys
+// live once in the shared string table; an entry's path is recovered by
+// walking `parentRefs`, where a negative ref `-1 - i` points at `roots[i]`.
+// Parents are always indexed before their children, so parent ids are
+// strictly smaller than child ids.
+export type IndexSnapshot = {
+  roots: string[];
+  strings: StringTable;
+  nameIds: GrowableColumn<Uint32Array>;
+  normalizedNameIds: GrowableColumn<Uint32Array>;
+  parentRefs: GrowableColumn<Int32Array>;
+  flags: GrowableColumn<Uint8Array>;
+  prefixIndex: PostingIndex;
+  // Trigrams of each entry's path-normalized name, plus PATH_PREFIX_MARKER
+  // keys for its first one and two characters, for path-like queries.
+  trigramIndex: PostingIndex;
+  // (parentRef, nameId) -> entry id; replaces a path -> id map.
+  childIndex: Map<number, number>;
+  // Intrusive child lists for subtree enumeration; -1 terminates a list.
+  firstChildIds: GrowableColumn<Int32Array>;
+  nextSiblingIds: GrowableColumn<Int32Array>;
+  rootFirstChildIds: number[];
+  // Attribute columns for query filters, read from the stat taken during the
+  // walk or watch batch: the string id of the lowercased extension
+  // (NO_EXTENSION_ID for folders and extensionless names), a size bucket
+  // (see getSizeBucket) and the mtime in whole seconds (0 when unknown).
+  extensionIds: GrowableColumn<Uint32Array>;
+  sizeBuckets: GrowableColumn<Uint8Array>;
+  mtimes: GrowableColumn<Uint32Array>;
+  builtAt: number;
+  // Bumped whenever a published snapshot is mutated, so cached query state
+  // derived from it can tell it is stale.
+  generation: number;
+  // Deleted entries still holding ids and postings, recounted after each
+  // watch batch; compactIndexSnapshot drops them.
+  tombstoneCount: number;
+};
+
+// Remembers a session's last term query so a query that only extends it
+// ("rep" -> "repo", "rep" -> "rep main") narrows the previous matches instead
+// of starting again from the full posting lists.
+export type FileSearchQueryContext = {
+  snapshot: IndexSnapshot | null;
+  generation: number;
+  terms: string[];
+  matchedIds: Uint32Array;
+};
+
+export type FileSearchIndexMemoryReport = {
+  entryCount: number;
+  liveEntryCount: number;
+  stringCount: number;
+  postingKeyCount: number;
+  postingCount: number;
+  trigramPostingCount: number;
+  columnBytes: number;
+  stringTableBytes: number;
+  postingBytes: number;
+  childIndexBytes: number;
+  totalBytes: number;
+  bytesPerEntry: number;
+  // Estimated cost of the same tree in the previous object-per-entry layout
+  // (path strings, token arrays and Map<string, number[]> prefix buckets).
+  legacyLayoutBytes: number;
+  legacyBytesPerEntry: number;
+};
+
+export type IndexJobOptions = {
+  isCancelled?: () => boolean;
+  // Paces directory walks; a default (machine-load aware) throttle is used
+  // when omitted.
+  throttle?: ScanThrottle;
+};
+
+export type BuildIndexOptions = IndexJobOptions & {
+  // Called with the snapshot under construction at increasing intervals, so
+  // it can be queried before the walk finishes. The snapshot keeps growing
+  // after the callback returns.
+  onCheckpoint?: (snapshot: IndexSnapshot) => void;
+  // Lists directories for the walk; the native lister when the addon is
+  // available, readdir otherwise.
+  directoryLister?: DirectoryLister;
+};
+
+export class FileSearchIndexCancelledError extends Error {
+  constructor() {
+    super('File search index request cancelled');
+    this.name = 'FileSearchIndexCancelledError';
+  }
+}
+
+const SEARCH_TOKEN_SPLIT_REGEX = /[^a-z0-9]+/g;
+const MAX_PREFIX_LENGTH = 12;
+export const MAX_INDEX_ENTRIES = 1_200_000;
+const DEFAULT_MAX_RESULTS = 80;
+const MAX_QUERY_RESULTS = 5_000;
+export const MAX_FILE_METADATA_STAT_RESULTS = 240;
+const MAX_SPOTLIGHT_CANDIDATES = 10_000;
+const SPOTLIGHT_SEARCH_TIMEOUT_MS = 2_400;
+// The walk visits the first levels of these home folders, and of recently
+// modified folders near the top of the home directory, before anything else.
+const PRIORITY_HOME_TOP_LEVEL_DIRECTORIES = new Set(['desktop', 'documents', 'downloads']);
+const PRIORITY_WALK_MAX_DEPTH = 4;
+const RECENT_DIRECTORY_MAX_DEPTH = 2;
+const RECENT_DIRECTORY_WINDOW_MS = 14 * 24 * 60 * 60 * 1000;
+const FIRST_CHECKPOINT_DELAY_MS = 500;
+const MAX_CHECKPOINT_INTERVAL_MS = 8_000;
+const QUERY_YIELD_EVERY_ENTRIES = 25_000;
+const FILTER_MATCH_SCORE = 100;
+const SNAPSHOT_HYDRATE_CHUNK_SIZE = 20_000;
+const RECONCILE_STAT_CONCURRENCY = 32;
+// Directory mtimes only have filesystem timestamp granularity; treat anything
+// modified shortly before the snapshot was taken as possibly changed.
+const RECONCILE_MTIME_SLACK_MS = 2_000;
+// Compact once tombstones are both numerous and a sizeable share of entries,
+// so a steady trickle of deletes does not rewrite the index over and over.
+const MIN_TOMBSTONES_BEFORE_COMPACTION = 4_096;
+const TOMBSTONE_COMPACTION_RATIO = 0.2;
+const ATTRIBUTE_STAT_CONCURRENCY = 32;
+const MAX_PENDING_ATTRIBUTE_READS = 8;
+const NO_EXTENSION_ID = 0xffffffff;
+const MAX_MTIME_SECONDS = 0xffffffff;
+
+const ENTRY_FLAG_DIRECTORY = 1 << 0;
+const ENTRY_FLAG_DELETED = 1 << 1;
+// Child keys pack (parentRef, nameId) into one double-safe integer.
+const MAX_INDEX_ROOTS = 1024;
+const CHILD_KEY_NAME_RADIX = 2 ** 27;
+const PATH_TRIGRAM_LENGTH = 3;
+// Marks anchored name-prefix keys in the trigram index; cannot occur in names.
+const PATH_PREFIX_MARKER = '\u0000';
+
+const execFileAsync = promisify(execFile);
+
+export const FILE_SEARCH_INDEX_NOISY_DIRECTORY_NAMES = [
+  'node_modules',
+  'dist',
+  'build',
+  'out',
+  '.next',
+  '.nuxt',
+  '.turbo',
+  '.cache',
+  'coverage',
+  'target',
+  'vendor',
+  '__pycache__',
+  '.venv',
+  'venv',
+  'tmp',
+  'temp',
+  'logs',
+  'log',
+  'deriveddata',
+  '.terraform',
+  '.pnpm-store',
+  '.npm',
+] as const;
+
+// Skip VCS internals and high-churn generated/dependency trees. The file
+// search index starts at launch, so walking node_modules/build output can pin
+// the Electron main process on developer machines.
+export const FILE_SEARCH_INDEX_EXCLUDED_DIRECTORY_NAMES = [
+  '.git',
+  '.hg',
+  '.svn',
+] as const;
+
+// Keep indexing inside user content areas and avoid macOS/system-heavy trees.
+export const FILE_SEARCH_INDEX_EXCLUDED_HOME_TOP_LEVEL_DIRECTORIES = [
+  '.Trash',
+  'Library',
+  'Music',
+  'Pictures',
+] as const;
+export const FILE_SEARCH_INDEX_PROTECTED_HOME_TOP_LEVEL_DIRECTORIES = [
+  'Desktop',
+  'Documents',
+  'Downloads',
+  'Movies',
+] as const;
+
+const EXCLUDED_DIRECTORY_NAME_SET = new Set(
+  FILE_SEARCH_INDEX_EXCLUDED_DIRECTORY_NAMES.map((name) => name.toLowerCase())
+);
+const NOISY_DIRECTORY_NAME_SET = new Set(
+  FILE_SEARCH_INDEX_NOISY_DIRECTORY_NAMES.map((name) => name.toLowerCase())
+);
+const EXCLUDED_TOP_LEVEL_SET = new Set(
+  FILE_SEARCH_INDEX_EXCLUDED_HOME_TOP_LEVEL_DIRECTORIES.map((name) => name.toLowerCase())
+);
+const PROTECTED_TOP_LEVEL_SET = new Set(
+  FILE_SEARCH_INDEX_PROTECTED_HOME_TOP_LEVEL_DIRECTORIES.map((name) => name.toLowerCase())
+);
+const EXCLUDED_FILE_EXTENSIONS = new Set(['.tmp', '.temp', '.log', '.cache', '.crdownload', '.download']);
+// The part of shouldSkipDirectory and shouldSkipFile that depends on the name
+// alone, applied by the native lister before entries reach JS.
+const DIRECTORY_LISTING_FILTER: DirectoryListingFilter = {
+  excludedDirectoryNames: [...EXCLUDED_DIRECTORY_NAME_SET, ...NOISY_DIRECTORY_NAME_SET, '.trash'],
+  skipHiddenDirectories: true,
+  excludedFileNames: ['.DS_Store'],
+  excludedFileExtensions: [...EXCLUDED_FILE_EXTENSIONS],
+};
+
+type DirectoryQueueEntry = {
+  scanPath: string;
+  displayPath: string;
+  resolvedPath?: string;
+  ref: number;
+  // Interned 2..12 char prefixes of every path token above this directory's
+  // children, shared by every child instead of re-tokenizing their paths.
+  pathKeyIds: number[];
+  depth: number;
+  priority: boolean;
+  // `.gitignore` / `.ignore` rules that apply to this directory's entries,
+  // before its own ignore files are read.
+  ignoreRules: IgnoreRules | null;
+};
+
+// Directories waiting to be walked, in buckets by walk order: priority
+// directories by depth first, then everything else by depth. Each bucket is
+// FIFO, so the walk stays breadth-first within a bucket.
+class DirectoryWalkQueue {
+  private readonly buckets: Array<Array<DirectoryQueueEntry | null>> = [];
+  private readonly cursors: number[] = [];
+  private lowestBucket = 0;
+
+  push(entry: DirectoryQueueEntry): void {
+    const bucket = entry.priority && entry.depth <= PRIORITY_WALK_MAX_DEPTH
+      ? entry.depth
+      : PRIORITY_WALK_MAX_DEPTH + 1 + entry.depth;
+    while (this.buckets.length <= bucket) {
+      this.buckets.push([]);
+      this.cursors.push(0);
+    }
+    this.buckets[bucket].push(entry);
+    if (bucket < this.lowestBucket) this.lowestBucket = bucket;
+  }
+
+  // Up to `limit` entries, all from the first non-empty bucket, so a batch
+  // never runs ahead of a bucket that comes before the rest of it.
+  shiftBatch(limit: number): DirectoryQueueEntry[] {
+    const batch: DirectoryQueueEntry[] = [];
+    for (; this.lowestBucket < this.buckets.length; this.lowestBucket += 1) {
+      const bucket = this.buckets[this.lowestBucket];
+      let cursor = this.cursors[this.lowestBucket];
+      while (cursor < bucket.length && batch.length < limit) {
+        batch.push(bucket[cursor] as DirectoryQueueEntry);
+        // Drop the slot so per-directory key lists do not outlive their visit.
+        bucket[cursor] = null;
+        cursor += 1;
+      }
+      if (cursor >= bucket.length) {
+        bucket.length = 0;
+        cursor = 0;
+      }
+      this.cursors[this.lowestBucket] = cursor;
+      if (batch.length > 0) break;
+    }
+    return batch;
+  }
+}
+
+function normalizeSearchText(value: string): string {
+  return String(value || '')
+    .normalize('NFKD')
+    .toLowerCase()
+    .replace(SEARCH_TOKEN_SPLIT_REGEX, ' ')
+    .trim();
+}
+
+function normalizePathSearchText(value: string): string {
+  return String(value || '')
+    .normalize('NFKD')
+    .toLowerCase()
+    .replace(/\\/g, '/')
+    .trim();
+}
+
+function isPathLikeQuery(rawQuery: string): boolean {
+  const trimmed = String(rawQuery || '').trim();
+  return trimmed.includes('/') || trimmed.startsWith('~');
+}
+
+function tokenizeSearchText(value: string): string[] {
+  const normalized = normalizeSearchText(value);
+  return normalized ? normalized.split(/\s+/).filter(Boolean) : [];
+}
+
+function asTildePath(value: string, homeDir: string): string {
+  if (!homeDir) return value;
+  if (value === homeDir) return '~';
+  if (value.startsWith(`${homeDir}${path.sep}`)) {
+    return `~${value.slice(homeDir.length)}`;
+  }
+  return value;
+}
+
+function isPathWithinRoot(candidatePath: string, rootDir: string): boolean {
+  const relative = path.relative(rootDir, candidatePath);
+  return Boolean(relative === '' || (!relative.startsWith('..') && !path.isAbsolute(relative)));
+}
+
+function isPathWithinAnyRoot(candidatePath: string, roots: string[]): boolean {
+  return roots.some((root) => isPathWithinRoot(candidatePath, root));
+}
+
+// Strictly inside one of the configured roots; a root itself is never an entry.
+function isBelowIncludeRoot(candidatePath: string, config: FileSearchIndexConfig): boolean {
+  return config.includeRoots.some((root) => {
+    const relative = path.relative(root, candidatePath);
+    return Boolean(relative) && !relative.startsWith('..') && !path.isAbsolute(relative);
+  });
+}
+
+// Path segments below the home folder, or none for paths outside it. The
+// top-level home rules (Library, protected folders) only apply to these, so
+// roots on other volumes are indexed whole.
+function getHomeRelativeSegments(candidatePath: string, homeDir: string): string[] {
+  if (!homeDir) return [];
+  const relative = path.relative(homeDir, candidatePath);
+  if (!relative || relative.startsWith('..') || path.isAbsolute(relative)) return [];
+  return relative.split(path.sep).filter(Boolean);
+}
+
+// Segments below whichever configured root contains the path.
+function getRootRelativeSegments(candidatePath: string, config: FileSearchIndexConfig): string[] {
+  for (const root of config.includeRoots) {
+    const relative = path.relative(root, candidatePath);
+    if (relative && !relative.startsWith('..') && !path.isAbsolute(relative)) {
+      return relative.split(path.sep).filter(Boolean);
+    }
+  }
+  return [];
+}
+
+function isSubsequenceMatch(needle: string, haystack: string): boolean {
+  if (!needle) return true;
+  if (!haystack) return false;
+  let needleIndex = 0;
+  for (let i = 0; i < haystack.length && needleIndex < needle.length; i += 1) {
+    if (haystack[i] === needle[needleIndex]) needleIndex += 1;
+  }
+  return needleIndex === needle.length;
+}
+
+export function yieldToEventLoop(): Promise<void> {
+  return new Promise<void>((resolve) => setImmediate(resolve));
+}
+
+export function throwIfCancelled(options?: IndexJobOptions): void {
+  if (options?.isCancelled?.()) throw new FileSearchIndexCancelledError();
+}
+
+export function shouldSkipDirectory(absolutePath: string, dirName: string, config: FileSearchIndexConfig): boolean {
+  const trimmedName = String(dirName || '').trim();
+  if (!trimmedName) return true;
+
+  const lowerName = trimmedName.toLowerCase();
+  if (EXCLUDED_DIRECTORY_NAME_SET.has(lowerName)) return true;
+  if (NOISY_DIRECTORY_NAME_SET.has(lowerName)) return true;
+  if (lowerName === '.trash') return true;
+  if (trimmedName.startsWith('.')) return true;
+
+  if (!isBelowIncludeRoot(absolutePath, config)) return true;
+  const segments = getHomeRelativeSegments(absolutePath, config.homeDir);
+  if (segments.length > 0 && EXCLUDED_TOP_LEVEL_SET.has(segments[0].toLowerCase())) return true;
+  if (segments.length > 0 && PROTECTED_TOP_LEVEL_SET.has(segments[0].toLowerCase()) && !config.includeProtectedHomeRoots) {
+    return true;
+  }
+  return false;
+}
+
+function shouldSkipFile(fileName: string): boolean {
+  const trimmedName = String(fileName || '').trim();
+  if (!trimmedName) return true;
+  if (trimmedName === '.DS_Store') return true;
+  const extension = path.extname(trimmedName).toLowerCase();
+  if (EXCLUDED_FILE_EXTENSIONS.has(extension)) return true;
+  return false;
+}
+
+function shouldSkipPathForSearch(candidatePath: string, config: FileSearchIndexConfig): boolean {
+  const { homeDir } = config;
+  if (!isPathWithinRoot(candidatePath, homeDir)) return true;
+  const relative = path.relative(homeDir, candidatePath);
+  if (!relative || relative.startsWith('..') || path.isAbsolute(relative)) return true;
+  const segments = relative.split(path.sep).filter(Boolean);
+  if (segments.length === 0) return true;
+  if (EXCLUDED_TOP_LEVEL_SET.has(segments[0].toLowerCase())) return true;
+  if (PROTECTED_TOP_LEVEL_SET.has(segments[0].toLowerCase()) && !config.includeProtectedHomeRoots) return true;
+  for (const segment of segments) {
+    const lowerSegment = segment.toLowerCase();
+    if (EXCLUDED_DIRECTORY_NAME_SET.has(lowerSegment)) return true;
+    if (NOISY_DIRECTORY_NAME_SET.has(lowerSegment)) return true;
+    if (segment.startsWith('.')) return true;
+  }
+  return false;
+}
+
+export function isWatchablePath(absolutePath: string, config: FileSearchIndexConfig): boolean {
+  const segments = getRootRelativeSegments(absolutePath, config);
+  if (segments.length === 0) return false;
+
+  const homeSegments = getHomeRelativeSegments(absolutePath, config.homeDir);
+  if (homeSegments.length > 0) {
+    const topLevel = homeSegments[0].toLowerCase();
+    if (EXCLUDED_TOP_LEVEL_SET.has(topLevel)) return false;
+    if (PROTECTED_TOP_LEVEL_SET.has(topLevel) && !config.includeProtectedHomeRoots) return false;
+  }
+
+  for (const segment of segments) {
+    if (!segment) continue;
+    const lowerSegment = segment.toLowerCase();
+    if (EXCLUDED_DIRECTORY_NAME_SET.has(lowerSegment)) return false;
+    if (NOISY_DIRECTORY_NAME_SET.has(lowerSegment)) return false;
+    if (segment.startsWith('.')) return false;
+  }
+  return true;
+}
+
+function getChildKey(parentRef: number, nameId: number): number {
+  return (parentRef + MAX_INDEX_ROOTS) * CHILD_KEY_NAME_RADIX + nameId;
+}
+
+export function getIndexEntryCount(snapshot: IndexSnapshot): number {
+  return snapshot.flags.length;
+}
+
+function isEntryDeleted(snapshot: IndexSnapshot, entryId: number): boolean {
+  return (snapshot.flags.values[entryId] & ENTRY_FLAG_DELETED) !== 0;
+}
+
+function isEntryDirectory(snapshot: IndexSnapshot, entryId: number): boolean {
+  return (snapshot.flags.values[entryId] & ENTRY_FLAG_DIRECTORY) !== 0;
+}
+
+function getEntryName(snapshot: IndexSnapshot, entryId: number): string {
+  return snapshot.strings.get(snapshot.nameIds.values[entryId]);
+}
+
+function getEntryNormalizedName(snapshot: IndexSnapshot, entryId: number): string {
+  return snapshot.strings.get(snapshot.normalizedNameIds.values[entryId]);
+}
+
+function getFirstChildId(snapshot: IndexSnapshot, ref: number): number {
+  if (ref < 0) {
+    const rootFirstChildId = snapshot.rootFirstChildIds[-1 - ref];
+    return rootFirstChildId === undefined ? -1 : rootFirstChildId;
+  }
+  return snapshot.firstChildIds.values[ref];
+}
+
+function linkChild(snapshot: IndexSnapshot, parentRef: number, entryId: number): void {
+  snapshot.nextSiblingIds.values[entryId] = getFirstChildId(snapshot, parentRef);
+  if (parentRef < 0) {
+    snapshot.rootFirstChildIds[-1 - parentRef] = entryId;
+  } else {
+    snapshot.firstChildIds.values[parentRef] = entryId;
+  }
+}
+
+function getRefPath(snapshot: IndexSnapshot, ref: number): string {
+  const segments: string[] = [];
+  let current = ref;
+  while (current >= 0) {
+    segments.push(getEntryName(snapshot, current));
+    current = snapshot.parentRefs.values[current];
+  }
+  segments.reverse();
+  return path.join(snapshot.roots[-1 - current] || '', ...segments);
+}
+
+function describeEntry(snapshot: IndexSnapshot, entryId: number): Pick<IndexedFileSearchResult, 'path' | 'name' | 'parentPath' | 'isDirectory'> {
+  const parentPath = getRefPath(snapshot, snapshot.parentRefs.values[entryId]);
+  const name = getEntryName(snapshot, entryId);
+  return {
+    path: path.join(parentPath, name),
+    name,
+    parentPath,
+    isDirectory: isEntryDirectory(snapshot, entryId),
+  };
+}
+
+function findChildId(snapshot: IndexSnapshot, parentRef: number, name: string): number {
+  const nameId = snapshot.strings.lookup(name);
+  if (nameId < 0) return -1;
+  const childId = snapshot.childIndex.get(getChildKey(parentRef, nameId));
+  return childId === undefined ? -1 : childId;
+}
+
+function findRootIndex(snapshot: IndexSnapshot, absolutePath: string): number {
+  for (let rootIndex = 0; rootIndex < snapshot.roots.length; rootIndex += 1) {
+    if (isPathWithinRoot(absolutePath, snapshot.roots[rootIndex])) return rootIndex;
+  }
+  return -1;
+}
+
+// Resolves a directory path to its ref (entry id, or negative root ref).
+function findDirectoryRef(snapshot: IndexSnapshot, dirPath: string): number | null {
+  const rootIndex = findRootIndex(snapshot, dirPath);
+  if (rootIndex < 0) return null;
+  let ref = -1 - rootIndex;
+  for (const segment of path.relative(snapshot.roots[rootIndex], dirPath).split(path.sep)) {
+    if (!segment) continue;
+    const childId = findChildId(snapshot, ref, segment);
+    if (childId < 0) return null;
+    ref = childId;
+  }
+  return ref;
+}
+
+function findEntryId(snapshot: IndexSnapshot, absolutePath: string): number {
+  const parentRef = findDirectoryRef(snapshot, path.dirname(absolutePath));
+  if (parentRef === null) return -1;
+  return findChildId(snapshot, parentRef, path.basename(absolutePath));
+}
+
+function addTokenPrefixKeyIds(snapshot: IndexSnapshot, keyIds: Set<number>, normalizedText: string, minLength: number): void {
+  if (!normalizedText) return;
+  for (const token of normalizedText.split(' ')) {
+    const maxLen = Math.min(MAX_PREFIX_LENGTH, token.length);
+    for (let length = minLength; length <= maxLen; length += 1) {
+      keyIds.add(snapshot.strings.intern(token.slice(0, length)));
+    }
+  }
+}
+
+function extendPathKeyIds(snapshot: IndexSnapshot, parentPathKeyIds: number[], normalizedName: string): number[] {
+  const keyIds = new Set(parentPathKeyIds);
+  addTokenPrefixKeyIds(snapshot, keyIds, normalizedName, 2);
+  return [...keyIds];
+}
+
+function getDirectoryPathKeyIds(snapshot: IndexSnapshot, ref: number, cache: Map<number, number[]>): number[] {
+  const cached = cache.get(ref);
+  if (cached) return cached;
+  const keyIds = ref < 0
+    ? extendPathKeyIds(snapshot, [], normalizeSearchText(snapshot.roots[-1 - ref] || ''))
+    : extendPathKeyIds(
+        snapshot,
+        getDirectoryPathKeyIds(snapshot, snapshot.parentRefs.values[ref], cache),
+        getEntryNormalizedName(snapshot, ref)
+      );
+  cache.set(ref, keyIds);
+  return keyIds;
+}
+
+// Adds (or revives) the entry `name` under `parentRef` and returns its id, or
+// -1 when it cannot be indexed.
+function indexEntry(
+  snapshot: IndexSnapshot,
+  parentRef: number,
+  name: string,
+  isDirectory: boolean,
+  parentPathKeyIds: number[]
+): number {
+  const existingId = findChildId(snapshot, parentRef, name);
+  if (existingId >= 0) {
+    snapshot.flags.values[existingId] = isDirectory ? ENTRY_FLAG_DIRECTORY : 0;
+    return existingId;
+  }
+
+  if (getIndexEntryCount(snapshot) >= MAX_INDEX_ENTRIES) return -1;
+
+  const normalizedName = normalizeSearchText(name);
+  if (!normalizedName) return -1;
+
+  const nameId = snapshot.strings.intern(name);
+  const entryId = snapshot.nameIds.push(nameId);
+  snapshot.normalizedNameIds.push(snapshot.strings.intern(normalizedName));
+  snapshot.parentRefs.push(parentRef);
+  snapshot.flags.push(isDirectory ? ENTRY_FLAG_DIRECTORY : 0);
+  snapshot.childIndex.set(getChildKey(parentRef, nameId), entryId);
+  snapshot.firstChildIds.push(-1);
+  snapshot.nextSiblingIds.push(-1);
+  const extension = isDirectory ? '' : getFileNameExtension(name);
+  snapshot.extensionIds.push(extension ? snapshot.strings.intern(extension) : NO_EXTENSION_ID);
+  snapshot.sizeBuckets.push(SIZE_BUCKET_UNKNOWN);
+  snapshot.mtimes.push(0);
+  linkChild(snapshot, parentRef, entryId);
+  // A build publishes its snapshot before the walk ends; entries appended
+  // after a query ran must invalidate its cached matches.
+  snapshot.generation += 1;
+
+  // Name token prefixes from length 1, path token prefixes (inherited from the
+  // parent) from length 2, plus compact-name prefixes that run past the first
+  // token. Every prefix of an indexed key is then indexed too, which keeps a
+  // longer term's posting list a subset of a shorter term's.
+  const keyIds = new Set(parentPathKeyIds);
+  addTokenPrefixKeyIds(snapshot, keyIds, normalizedName, 1);
+  const compactName = normalizedName.replace(/\s+/g, '');
+  const firstTokenLength = normalizedName.indexOf(' ') < 0 ? normalizedName.length : normalizedName.indexOf(' ');
+  for (let length = firstTokenLength + 1; length <= Math.min(MAX_PREFIX_LENGTH, compactName.length); length += 1) {
+    keyIds.add(snapshot.strings.intern(compactName.slice(0, length)));
+  }
+
+  for (const keyId of keyIds) {
+    snapshot.prefixIndex.add(keyId, entryId);
+  }
+
+  const pathSegment = normalizePathSegment(name);
+  const trigramKeyIds = new Set<number>();
+  for (let start = 0; start + PATH_TRIGRAM_LENGTH <= pathSegment.length; start += 1) {
+    trigramKeyIds.add(snapshot.strings.intern(pathSegment.slice(start, start + PATH_TRIGRAM_LENGTH)));
+  }
+  for (let length = 1; length < PATH_TRIGRAM_LENGTH && length <= pathSegment.length; length += 1) {
+    trigramKeyIds.add(snapshot.strings.intern(PATH_PREFIX_MARKER + pathSegment.slice(0, length)));
+  }
+  for (const keyId of trigramKeyIds) {
+    snapshot.trigramIndex.add(keyId, entryId);
+  }
+  return entryId;
+}
+
+function setEntryAttributes(snapshot: IndexSnapshot, entryId: number, stats: fs.Stats): void {
+  setEntryAttributeValues(snapshot, entryId, stats.isDirectory(), stats.size, stats.mtimeMs);
+}
+
+function setEntryAttributeValues(
+  snapshot: IndexSnapshot,
+  entryId: number,
+  isDirectory: boolean,
+  size: number,
+  mtimeMs: number
+): void {
+  snapshot.sizeBuckets.values[entryId] = isDirectory ? SIZE_BUCKET_UNKNOWN : getSizeBucket(size);
+  snapshot.mtimes.values[entryId] = Math.max(0, Math.min(MAX_MTIME_SECONDS, Math.floor(mtimeMs / 1000)));
+}
+
+// Stats freshly indexed entries to fill their attribute columns. Entries that
+// vanish in between keep unknown attributes until the watcher catches up.
+async function readEntryAttributes(
+  snapshot: IndexSnapshot,
+  targets: Array<{ entryId: number; path: string }>
+): Promise<void> {
+  for (let offset = 0; offset < targets.length; offset += ATTRIBUTE_STAT_CONCURRENCY) {
+    await Promise.all(targets.slice(offset, offset + ATTRIBUTE_STAT_CONCURRENCY).map(async (target) => {
+      try {
+        setEntryAttributes(snapshot, target.entryId, await fs.promises.stat(target.path));
+      } catch {}
+    }));
+  }
+}
+
+async function resolveRealPath(candidatePath: string): Promise<string | null> {
+  try {
+    return await fs.promises.realpath(candidatePath);
+  } catch {
+    return null;
+  }
+}
+
+export function createEmptyIndexSnapshot(roots: string[] = []): IndexSnapshot {
+  return {
+    roots: roots.slice(0, MAX_INDEX_ROOTS),
+    strings: new StringTable(),
+    nameIds: new GrowableColumn(Uint32Array),
+    normalizedNameIds: new GrowableColumn(Uint32Array),
+    parentRefs: new GrowableColumn(Int32Array),
+    flags: new GrowableColumn(Uint8Array),
+    prefixIndex: new PostingIndex(),
+    trigramIndex: new PostingIndex(),
+    childIndex: new Map<number, number>(),
+    firstChildIds: new GrowableColumn(Int32Array),
+    nextSiblingIds: new GrowableColumn(Int32Array),
+    rootFirstChildIds: roots.slice(0, MAX_INDEX_ROOTS).map(() => -1),
+    extensionIds: new GrowableColumn(Uint32Array),
+    sizeBuckets: new GrowableColumn(Uint8Array),
+    mtimes: new GrowableColumn(Uint32Array),
+    builtAt: Date.now(),
+    generation: 0,
+    tombstoneCount: 0,
+  };
+}
+
+function sealIndexSnapshot(snapshot: IndexSnapshot): void {
+  snapshot.prefixIndex.seal();
+  snapshot.trigramIndex.seal();
+  snapshot.nameIds.trim();
+  snapshot.normalizedNameIds.trim();
+  snapshot.parentRefs.trim();
+  snapshot.flags.trim();
+  snapshot.firstChildIds.trim();
+  snapshot.nextSiblingIds.trim();
+  snapshot.extensionIds.trim();
+  snapshot.sizeBuckets.trim();
+  snapshot.mtimes.trim();
+}
+
+async function isRecentlyModifiedDirectory(dirPath: string, now: number): Promise<boolean> {
+  try {
+    const stats = await fs.promises.stat(dirPath);
+    return now - stats.mtimeMs <= RECENT_DIRECTORY_WINDOW_MS;
+  } catch {
+    return false;
+  }
+}
+
+// Walks the roots, high-value directories first (see DirectoryWalkQueue), and
+// hands the growing snapshot to `onCheckpoint` along the way so a first index
+// can answer queries within seconds instead of after the full crawl.
+export async function buildIndexSnapshot(
+  config: FileSearchIndexConfig,
+  options?: BuildIndexOptions
+): Promise<IndexSnapshot> {
+  const snapshot = createEmptyIndexSnapshot(config.includeRoots);
+  const startedAt = Date.now();
+
+  const walkQueue = new DirectoryWalkQueue();
+  snapshot.roots.forEach((root, rootIndex) => walkQueue.push({
+    scanPath: root,
+    displayPath: root,
+    ref: -1 - rootIndex,
+    pathKeyIds: extendPathKeyIds(snapshot, [], normalizeSearchText(root)),
+    depth: 0,
+    priority: true,
+    ignoreRules: null,
+  }));
+  // Real paths, or device:inode identities when the lister reports them.
+  const visitedDirectories = new Set<string>();
+  const throttle = options?.throttle || new ScanThrottle();
+  const lister = options?.directoryLister || createDirectoryLister(DIRECTORY_LISTING_FILTER);
+  const attributeReads: Array<Promise<void>> = [];
+  let checkpointInterval = FIRST_CHECKPOINT_DELAY_MS;
+  let nextCheckpointAt = startedAt + checkpointInterval;
+
+  for (;;) {
+    if (getIndexEntryCount(snapshot) >= MAX_INDEX_ENTRIES) {
+      break;
+    }
+    throwIfCancelled(options);
+
+    const batch = walkQueue.shiftBatch(lister.batchSize);
+    if (batch.length === 0) break;
+    const listings = await lister.list(batch.map((entry) => entry.scanPath));
+
+    for (let batchIndex = 0; batchIndex < batch.length; batchIndex += 1) {
+      if (getIndexEntryCount(snapshot) >= MAX_INDEX_ENTRIES) break;
+      throwIfCancelled(options);
+
+      if (options?.onCheckpoint && Date.now() >= nextCheckpointAt) {
+        snapshot.prefixIndex.seal();
+        snapshot.trigramIndex.seal();
+        options.onCheckpoint(snapshot);
+        checkpointInterval = Math.min(MAX_CHECKPOINT_INTERVAL_MS, checkpointInterval * 2);
+        nextCheckpointAt = Date.now() + checkpointInterval;
+      }
+
+      const currentEntry = batch[batchIndex];
+      const listing = listings[batchIndex];
+      if (!currentEntry.scanPath || !listing) continue;
+
+      const currentDir = currentEntry.scanPath;
+      const currentDisplayPath = currentEntry.displayPath || currentDir;
+      // With a directory identity only roots need a realpath: anything else
+      // was reached from an in-root parent, or through a symlink whose target
+      // was checked when it was queued.
+      let visitKey = listing.identity;
+      if (!visitKey || currentEntry.depth === 0) {
+        const currentRealPath = currentEntry.resolvedPath || (await resolveRealPath(currentDir)) || currentDir;
+        if (!isPathWithinAnyRoot(currentRealPath, snapshot.roots)) {
+          continue;
+        }
+        visitKey = visitKey || currentRealPath;
+      }
+      if (visitedDirectories.has(visitKey)) {
+        continue;
+      }
+      visitedDirectories.add(visitKey);
+
+      const { names, types, sizes, mtimesMs } = listing;
+      const ignoreRules = currentEntry.depth > 0 || readsRootIgnoreFiles(currentDir, config)
+        ? await loadDirectoryIgnoreRules(currentDir, currentEntry.ignoreRules, names)
+        : currentEntry.ignoreRules;
+      const childDepth = currentEntry.depth + 1;
+      // Entries whose attributes are read in one batch once the listing is
+      // done, when the listing did not carry them.
+      const attributeTargets: Array<{ entryId: number; path: string }> = [];
+      const setListedAttributes = (entryId: number, index: number, isDirectory: boolean) => {
+        if (!sizes || !mtimesMs) return false;
+        if (mtimesMs[index] >= 0) setEntryAttributeValues(snapshot, entryId, isDirectory, sizes[index], mtimesMs[index]);
+        return true;
+      };
+      const enqueueDirectory = (
+        name: string,
+        index: number,
+        absoluteScanPath: string,
+        absoluteDisplayPath: string,
+        priority: boolean,
+        resolvedPath?: string
+      ) => {
+        const entryId = indexEntry(snapshot, currentEntry.ref, name, true, currentEntry.pathKeyIds);
+        if (entryId < 0) return;
+        if (!setListedAttributes(entryId, index, true)) attributeTargets.push({ entryId, path: absoluteScanPath });
+        walkQueue.push({
+          scanPath: absoluteScanPath,
+          displayPath: absoluteDisplayPath,
+          resolvedPath,
+          ref: entryId,
+          pathKeyIds: extendPathKeyIds(snapshot, currentEntry.pathKeyIds, getEntryNormalizedName(snapshot, entryId)),
+          depth: childDepth,
+          priority,
+          ignoreRules,
+        });
+      };
+      // Near the top, folders are prioritized for being one of the priority
+      // home folders (or inside one) or for recent activity; deeper down they
+      // inherit.
+      const inPriorityFolder = childDepth === 2
+        && PRIORITY_HOME_TOP_LEVEL_DIRECTORIES.has(path.basename(currentDir).toLowerCase());
+      const isPriorityChild = (name: string) => childDepth > RECENT_DIRECTORY_MAX_DEPTH
+        ? currentEntry.priority
+        : inPriorityFolder || (childDepth === 1 && PRIORITY_HOME_TOP_LEVEL_DIRECTORIES.has(name.toLowerCase()));
+      // The rest of the shallow directories are checked for recent activity
+      // together once the listing has been read.
+      const recencyCandidates: Array<{ name: string; index: number; scanPath: string; displayPath: string }> = [];
+
+      for (let index = 0; index < names.length; index += 1) {
+        const name = names[index];
+        const type = types[index];
+        const absoluteScanPath = path.join(currentDir, name);
+        const absoluteDisplayPath = path.join(currentDisplayPath, name);
+
+        if (type === DIRECTORY_ENTRY_DIRECTORY) {
+          if (shouldSkipDirectory(absoluteDisplayPath, name, config)) continue;
+          if (ignoreRules?.isIgnored(absoluteScanPath, name, true)) continue;
+          if (!isPriorityChild(name) && childDepth <= RECENT_DIRECTORY_MAX_DEPTH) {
+            recencyCandidates.push({ name, index, scanPath: absoluteScanPath, displayPath: absoluteDisplayPath });
+            continue;
+          }
+          enqueueDirectory(name, index, absoluteScanPath, absoluteDisplayPath, isPriorityChild(name));
+          continue;
+        }
+
+        if (type === DIRECTORY_ENTRY_SYMLINK) {
+          const resolvedPath = await resolveRealPath(absoluteScanPath);
+          if (!resolvedPath || !isPathWithinAnyRoot(resolvedPath, snapshot.roots)) {
+            continue;
+          }
+
+          let stats: fs.Stats | null = null;
+          try {
+            stats = await fs.promises.stat(absoluteScanPath);
+          } catch {
+            continue;
+          }
+
+          if (stats.isDirectory()) {
+            if (shouldSkipDirectory(absoluteDisplayPath, name, config)) continue;
+            if (ignoreRules?.isIgnored(absoluteScanPath, name, true)) continue;
+            enqueueDirectory(name, index, absoluteScanPath, absoluteDisplayPath, false, resolvedPath);
+            continue;
+          }
+
+          if (stats.isFile()) {
+            if (shouldSkipFile(name) || ignoreRules?.isIgnored(absoluteScanPath, name, false)) continue;
+            const entryId = indexEntry(snapshot, currentEntry.ref, name, false, currentEntry.pathKeyIds);
+            if (entryId >= 0) setEntryAttributes(snapshot, entryId, stats);
+          }
+          continue;
+        }
+
+        if (type !== DIRECTORY_ENTRY_FILE) {
+          continue;
+        }
+
+        if (shouldSkipFile(name) || ignoreRules?.isIgnored(absoluteScanPath, name, false)) continue;
+        const entryId = indexEntry(snapshot, currentEntry.ref, name, false, currentEntry.pathKeyIds);
+        if (entryId >= 0 && !setListedAttributes(entryId, index, false)) {
+          attributeTargets.push({ entryId, path: absoluteScanPath });
+        }
+      }
+
+      if (recencyCandidates.length > 0) {
+        const now = Date.now();
+        const recent = await Promise.all(recencyCandidates.map((candidate) => mtimesMs
+          ? mtimesMs[candidate.index] >= 0 && now - mtimesMs[candidate.index] <= RECENT_DIRECTORY_WINDOW_MS
+          : isRecentlyModifiedDirectory(candidate.scanPath, now)));
+        recencyCandidates.forEach((candidate, index) => {
+          enqueueDirectory(candidate.name, candidate.index, candidate.scanPath, candidate.displayPath, recent[index]);
+        });
+      }
+      if (attributeTargets.length > 0) {
+        // Attribute stats overlap with listing the next directories.
+        attributeReads.push(readEntryAttributes(snapshot, attributeTargets));
+        if (attributeReads.length > MAX_PENDING_ATTRIBUTE_READS) await attributeReads.shift();
+      }
+
+      await throttle.pace();
+    }
+  }
+
+  await Promise.all(attributeReads);
+  sealIndexSnapshot(snapshot);
+  snapshot.builtAt = Date.now();
+  return snapshot;
+}
+
+// Resolves `dirPath` to a directory ref, indexing any missing or tombstoned
+// directories along the way so new entries always hang off a live parent.
+function ensureDirectoryRef(
+  snapshot: IndexSnapshot,
+  config: FileSearchIndexConfig,
+  dirPath: string,
+  pathKeyCache: Map<number, number[]>
+): number | null {
+  const rootIndex = findRootIndex(snapshot, dirPath);
+  if (rootIndex < 0) return null;
+  let ref = -1 - rootIndex;
+  let currentPath = snapshot.roots[rootIndex];
+  for (const segment of path.relative(currentPath, dirPath).split(path.sep)) {
+    if (!segment) continue;
+    currentPath = path.join(currentPath, segment);
+    const childId = findChildId(snapshot, ref, segment);
+    if (childId >= 0 && snapshot.flags.values[childId] === ENTRY_FLAG_DIRECTORY) {
+      ref = childId;
+      continue;
+    }
+    if (shouldSkipDirectory(currentPath, segment, config)) return null;
+    const entryId = indexEntry(snapshot, ref, segment, true, getDirectoryPathKeyIds(snapshot, ref, pathKeyCache));
+    if (entryId < 0) return null;
+    ref = entryId;
+  }
+  return ref;
+}
+
+export function createFileSearchQueryContext(): FileSearchQueryContext {
+  return { snapshot: null, generation: -1, terms: [], matchedIds: new Uint32Array(0) };
+}
+
+export async function applyWatchEventBatch(
+  snapshot: IndexSnapshot,
+  config: FileSearchIndexConfig,
+  paths: string[],
+  options?: IndexJobOptions
+): Promise<void> {
+  // Bumped on entry and exit: queries that interleave with the batch's awaits
+  // must not cache results against either generation.
+  snapshot.generation += 1;
+  try {
+    await applyWatchEventBatchToSnapshot(snapshot, config, paths, options?.throttle || new ScanThrottle());
+  } finally {
+    snapshot.generation += 1;
+    snapshot.tombstoneCount = countTombstones(snapshot);
+  }
+}
+
+function countTombstones(snapshot: IndexSnapshot): number {
+  const flags = snapshot.flags.values;
+  let count = 0;
+  for (let entryId = 0; entryId < snapshot.flags.length; entryId += 1) {
+    if ((flags[entryId] & ENTRY_FLAG_DELETED) !== 0) count += 1;
+  }
+  return count;
+}
+
+export function shouldCompactIndexSnapshot(snapshot: IndexSnapshot): boolean {
+  return snapshot.tombstoneCount >= MIN_TOMBSTONES_BEFORE_COMPACTION
+    && snapshot.tombstoneCount >= getIndexEntryCount(snapshot) * TOMBSTONE_COMPACTION_RATIO;
+}
+
+// Returns a copy of `snapshot` without its tombstones: live entries are
+// renumbered in order (parents still precede children), posting lists are
+// filtered and remapped, and strings no live entry or key uses are dropped.
+// The source snapshot is left intact for queries still running against it.
+export function compactIndexSnapshot(snapshot: IndexSnapshot): IndexSnapshot {
+  const entryCount = getIndexEntryCount(snapshot);
+  const parentRefs = snapshot.parentRefs.values;
+  const entryRemap = new Int32Array(entryCount);
+  let liveEntryCount = 0;
+  for (let entryId = 0; entryId < entryCount; entryId += 1) {
+    const parentRef = parentRefs[entryId];
+    if (isEntryDeleted(snapshot, entryId) || (parentRef >= 0 && entryRemap[parentRef] < 0)) {
+      entryRemap[entryId] = -1;
+      continue;
+    }
+    entryRemap[entryId] = liveEntryCount;
+    liveEntryCount += 1;
+  }
+
+  const usedStrings = new Uint8Array(snapshot.strings.size);
+  for (let entryId = 0; entryId < entryCount; entryId += 1) {
+    if (entryRemap[entryId] < 0) continue;
+    usedStrings[snapshot.nameIds.values[entryId]] = 1;
+    usedStrings[snapshot.normalizedNameIds.values[entryId]] = 1;
+    const extensionId = snapshot.extensionIds.values[entryId];
+    if (extensionId !== NO_EXTENSION_ID) usedStrings[extensionId] = 1;
+  }
+  for (const index of [snapshot.prefixIndex, snapshot.trigramIndex]) {
+    const { offsets, postings } = index.sealedArrays();
+    for (let keyId = 0; keyId + 1 < offsets.length; keyId += 1) {
+      for (let i = offsets[keyId]; i < offsets[keyId + 1]; i += 1) {
+        if (entryRemap[postings[i]] < 0) continue;
+        usedStrings[keyId] = 1;
+        break;
+      }
+    }
+  }
+
+  const compacted = createEmptyIndexSnapshot(snapshot.roots);
+  const stringRemap = new Int32Array(usedStrings.length).fill(-1);
+  for (let stringId = 0; stringId < usedStrings.length; stringId += 1) {
+    if (usedStrings[stringId]) stringRemap[stringId] = compacted.strings.intern(snapshot.strings.get(stringId));
+  }
+
+  for (let entryId = 0; entryId < entryCount; entryId += 1) {
+    if (entryRemap[entryId] < 0) continue;
+    const parentRef = parentRefs[entryId] < 0 ? parentRefs[entryId] : entryRemap[parentRefs[entryId]];
+    const nameId = stringRemap[snapshot.nameIds.values[entryId]];
+    const nextId = compacted.nameIds.push(nameId);
+    compacted.normalizedNameIds.push(stringRemap[snapshot.normalizedNameIds.values[entryId]]);
+    compacted.parentRefs.push(parentRef);
+    compacted.flags.push(snapshot.flags.values[entryId]);
+    compacted.firstChildIds.push(-1);
+    compacted.nextSiblingIds.push(-1);
+    const extensionId = snapshot.extensionIds.values[entryId];
+    compacted.extensionIds.push(extensionId === NO_EXTENSION_ID ? NO_EXTENSION_ID : stringRemap[extensionId]);
+    compacted.sizeBuckets.push(snapshot.sizeBuckets.values[entryId]);
+    compacted.mtimes.push(snapshot.mtimes.values[entryId]);
+    compacted.childIndex.set(getChildKey(parentRef, nameId), nextId);
+    linkChild(compacted, parentRef, nextId);
+  }
+
+  compacted.prefixIndex = snapshot.prefixIndex.remap(stringRemap, entryRemap, compacted.strings.size);
+  compacted.trigramIndex = snapshot.trigramIndex.remap(stringRemap, entryRemap, compacted.strings.size);
+  sealIndexSnapshot(compacted);
+  compacted.builtAt = snapshot.builtAt;
+  return compacted;
+}
+
+async function applyWatchEventBatchToSnapshot(
+  snapshot: IndexSnapshot,
+  config: FileSearchIndexConfig,
+  paths: string[],
+  throttle: ScanThrottle
+): Promise<void> {
+  const stated = await Promise.all(
+    paths.map(async (absolutePath) => {
+      try {
+        const stats = await fs.promises.stat(absolutePath);
+        return { absolutePath, stats, exists: true as const };
+      } catch {
+        return { absolutePath, exists: false as const };
+      }
+    })
+  );
+
+  const deletePaths: string[] = [];
+  const newDirectoriesToWalk: Array<{ ref: number; path: string }> = [];
+  const pathKeyCache = new Map<number, number[]>();
+  // Directories whose ignore files changed in this batch: their rules are
+  // read from disk rather than trusted from the index, and re-applied below.
+  const ignoreChangedDirectories = new Set<string>();
+  for (const absolutePath of paths) {
+    if (isIgnoreFileName(path.basename(absolutePath))) ignoreChangedDirectories.add(path.dirname(absolutePath));
+  }
+  const ignoreCaches = new Map<number, IgnoreRulesCache>();
+  const getIgnoreCache = (absolutePath: string) => {
+    const rootIndex = findRootIndex(snapshot, absolutePath);
+    if (rootIndex < 0) return null;
+    let cache = ignoreCaches.get(rootIndex);
+    if (!cache) {
+      const root = snapshot.roots[rootIndex];
+      cache = new IgnoreRulesCache(root, readsRootIgnoreFiles(root, config), (dirPath) => ignoreChangedDirectories.has(dirPath)
+        ? null
+        : listIndexedIgnoreFiles(snapshot, dirPath));
+      ignoreCaches.set(rootIndex, cache);
+    }
+    return cache;
+  };
+
+  for (const result of stated) {
+    if (!result.exists) {
+      deletePaths.push(result.absolutePath);
+      continue;
+    }
+    const { absolutePath, stats } = result;
+    const name = path.basename(absolutePath);
+    const isDirectory = stats.isDirectory();
+
+    if (isDirectory) {
+      if (shouldSkipDirectory(absolutePath, name, config)) continue;
+    } else if (stats.isFile()) {
+      if (shouldSkipFile(name)) continue;
+    } else {
+      continue;
+    }
+    if (await getIgnoreCache(absolutePath)?.isIgnored(absolutePath, isDirectory)) continue;
+
+    const parentRef = ensureDirectoryRef(snapshot, config, path.dirname(absolutePath), pathKeyCache);
+    if (parentRef === null) continue;
+    const existingId = findChildId(snapshot, parentRef, name);
+    const isFresh = existingId < 0 || isEntryDeleted(snapshot, existingId);
+    const entryId = indexEntry(snapshot, parentRef, name, isDirectory, getDirectoryPathKeyIds(snapshot, parentRef, pathKeyCache));
+    if (entryId < 0) continue;
+    setEntryAttributes(snapshot, entryId, stats);
+    if (isDirectory && isFresh) newDirectoriesToWalk.push({ ref: entryId, path: absolutePath });
+  }
+
+  if (deletePaths.length > 0) {
+    tombstoneDeletedPaths(snapshot, deletePaths);
+  }
+
+  for (const directory of newDirectoriesToWalk) {
+    if (getIndexEntryCount(snapshot) >= MAX_INDEX_ENTRIES) break;
+    const parentIgnoreRules = await getIgnoreCache(directory.path)?.getRules(path.dirname(directory.path));
+    await walkAddedDirectory(snapshot, config, directory.ref, directory.path, parentIgnoreRules || null, pathKeyCache, throttle);
+  }
+
+  for (const dirPath of ignoreChangedDirectories) {
+    const ignoreCache = getIgnoreCache(dirPath);
+    if (ignoreCache) await reapplyIgnoreRules(snapshot, config, dirPath, ignoreCache, pathKeyCache, throttle);
+  }
+}
+
+// Ignore files the index holds for `dirPath`, or null when the directory is
+// not indexed, so watch batches only open ignore files that exist.
+function listIndexedIgnoreFiles(snapshot: IndexSnapshot, dirPath: string): string[] | null {
+  const ref = findDirectoryRef(snapshot, dirPath);
+  if (ref === null || (ref >= 0 && isEntryDeleted(snapshot, ref))) return null;
+  return IGNORE_FILE_NAMES.filter((fileName) => {
+    const entryId = findChildId(snapshot, ref, fileName);
+    return entryId >= 0 && !isEntryDeleted(snapshot, entryId);
+  });
+}
+
+// An ignore file in `dirPath` changed: drop the indexed entries below it that
+// are now ignored, then re-walk it for entries that no longer are.
+async function reapplyIgnoreRules(
+  snapshot: IndexSnapshot,
+  config: FileSearchIndexConfig,
+  dirPath: string,
+  ignoreCache: IgnoreRulesCache,
+  pathKeyCache: Map<number, number[]>,
+  throttle: ScanThrottle
+): Promise<void> {
+  const ref = findDirectoryRef(snapshot, dirPath);
+  if (ref === null) return;
+  if (ref < 0 ? !readsRootIgnoreFiles(dirPath, config) : isEntryDeleted(snapshot, ref) || !isEntryDirectory(snapshot, ref)) return;
+  if (await ignoreCache.isIgnored(dirPath, true)) return;
+
+  const ignoredPaths: string[] = [];
+  const stack = [{ ref, path: dirPath }];
+  while (stack.length > 0) {
+    const directory = stack.pop() as { ref: number; path: string };
+    const rules = await ignoreCache.getRules(directory.path);
+    for (let childId = getFirstChildId(snapshot, directory.ref); childId >= 0; childId = snapshot.nextSiblingIds.values[childId]) {
+      if (isEntryDeleted(snapshot, childId)) continue;
+      const name = getEntryName(snapshot, childId);
+      const childPath = path.join(directory.path, name);
+      const isDirectory = isEntryDirectory(snapshot, childId);
+      if (rules?.isIgnored(childPath, name, isDirectory)) {
+        ignoredPaths.push(childPath);
+      } else if (isDirectory) {
+        stack.push({ ref: childId, path: childPath });
+      }
+    }
+  }
+  if (ignoredPaths.length > 0) tombstoneDeletedPaths(snapshot, ignoredPaths);
+
+  const parentIgnoreRules = await ignoreCache.getRules(path.dirname(dirPath));
+  await walkAddedDirectory(snapshot, config, ref, dirPath, parentIgnoreRules, pathKeyCache, throttle);
+}
+
+function tombstoneDeletedPaths(snapshot: IndexSnapshot, deletePaths: string[]): void {
+  const flags = snapshot.flags.values;
+  let deletedDirectory = false;
+  for (const deletedPath of deletePaths) {
+    const entryId = findEntryId(snapshot, deletedPath);
+    if (entryId < 0 || isEntryDeleted(snapshot, entryId)) continue;
+    if (isEntryDirectory(snapshot, entryId)) deletedDirectory = true;
+    flags[entryId] |= ENTRY_FLAG_DELETED;
+  }
+  if (!deletedDirectory) return;
+
+  // Parents precede children, so a single forward pass cascades subtrees.
+  const parentRefs = snapshot.parentRefs.values;
+  for (let entryId = 0; entryId < snapshot.flags.length; entryId += 1) {
+    const parentRef = parentRefs[entryId];
+    if (parentRef >= 0 && (flags[parentRef] & ENTRY_FLAG_DELETED) !== 0) {
+      flags[entryId] |= ENTRY_FLAG_DELETED;
+    }
+  }
+}
+
+// Whether the ignore files directly in index root `root` are honored: all but
+// the home folder's (see file-search-index-ignore).
+function readsRootIgnoreFiles(root: string, config: FileSearchIndexConfig): boolean {
+  return root !== config.homeDir;
+}
+
+async function walkAddedDirectory(
+  snapshot: IndexSnapshot,
+  config: FileSearchIndexConfig,
+  dirRef: number,
+  dirPath: string,
+  parentIgnoreRules: IgnoreRules | null,
+  pathKeyCache: Map<number, number[]>,
+  throttle: ScanThrottle
+): Promise<void> {
+  let dirents: fs.Dirent[] = [];
+  try {
+    dirents = await fs.promises.readdir(dirPath, { withFileTypes: true });
+  } catch {
+    return;
+  }
+  await throttle.pace();
+  const ignoreRules = dirRef < 0 && !readsRootIgnoreFiles(dirPath, config)
+    ? parentIgnoreRules
+    : await loadDirectoryIgnoreRules(dirPath, parentIgnoreRules, dirents.map((dirent) => dirent.name));
+
+  const pathKeyIds = getDirectoryPathKeyIds(snapshot, dirRef, pathKeyCache);
+  const attributeTargets: Array<{ entryId: number; path: string }> = [];
+  const childDirectories: Array<{ entryId: number; path: string }> = [];
+  for (const dirent of dirents) {
+    if (getIndexEntryCount(snapshot) >= MAX_INDEX_ENTRIES) break;
+    const name = dirent.name;
+    const childPath = path.join(dirPath, name);
+    if (!isWatchablePath(childPath, config)) continue;
+
+    if (dirent.isDirectory()) {
+      if (shouldSkipDirectory(childPath, name, config) || ignoreRules?.isIgnored(childPath, name, true)) continue;
+      const entryId = indexEntry(snapshot, dirRef, name, true, pathKeyIds);
+      if (entryId < 0) continue;
+      attributeTargets.push({ entryId, path: childPath });
+      childDirectories.push({ entryId, path: childPath });
+    } else if (dirent.isFile()) {
+      if (shouldSkipFile(name) || ignoreRules?.isIgnored(childPath, name, false)) continue;
+      const entryId = indexEntry(snapshot, dirRef, name, false, pathKeyIds);
+      if (entryId >= 0) attributeTargets.push({ entryId, path: childPath });
+    }
+  }
+  await readEntryAttributes(snapshot, attributeTargets);
+
+  for (const child of childDirectories) {
+    if (getIndexEntryCount(snapshot) >= MAX_INDEX_ENTRIES) return;
+    await walkAddedDirectory(snapshot, config, child.entryId, child.path, ignoreRules, pathKeyCache, throttle);
+  }
+}
+
+export async function persistIndexSnapshot(
+  filePath: string,
+  snapshot: IndexSnapshot,
+  config: FileSearchIndexConfig
+): Promise<void> {
+  const { offsets, postings } = snapshot.prefixIndex.sealedArrays();
+  const trigramArrays = snapshot.trigramIndex.sealedArrays();
+  await writeIndexSnapshotFile(filePath, {
+    homeDir: config.homeDir,
+    includeProtectedHomeRoots: config.includeProtectedHomeRoots,
+    builtAt: snapshot.builtAt,
+    roots: snapshot.roots,
+    strings: snapshot.strings.toArray(),
+    nameIds: snapshot.nameIds.view(),
+    normalizedNameIds: snapshot.normalizedNameIds.view(),
+    parentRefs: snapshot.parentRefs.view(),
+    entryFlags: snapshot.flags.view(),
+    extensionIds: snapshot.extensionIds.view(),
+    sizeBuckets: snapshot.sizeBuckets.view(),
+    mtimes: snapshot.mtimes.view(),
+    postingOffsets: offsets,
+    postings,
+    trigramOffsets: trigramArrays.offsets,
+    trigrams: trigramArrays.postings,
+  });
+}
+
+export async function restoreIndexSnapshot(
+  filePath: string,
+  config: FileSearchIndexConfig,
+  options?: IndexJobOptions
+): Promise<IndexSnapshot | null> {
+  let persisted: Awaited<ReturnType<typeof readIndexSnapshotFile>> = null;
+  try {
+    persisted = await readIndexSnapshotFile(filePath);
+  } catch (error) {
+    console.warn('[FileIndex] Ignoring unreadable snapshot:', error);
+    return null;
+  }
+  if (!persisted) return null;
+  if (persisted.homeDir !== config.homeDir) return null;
+  if (persisted.includeProtectedHomeRoots !== config.includeProtectedHomeRoots) return null;
+  if (persisted.roots.join('\0') !== config.includeRoots.join('\0')) return null;
+
+  const strings = new StringTable();
+  for (let i = 0; i < persisted.strings.length; i += 1) {
+    if (strings.intern(persisted.strings[i]) !== i) {
+      console.warn('[FileIndex] Ignoring snapshot with duplicate string table entries');
+      return null;
+    }
+    if ((i + 1) % SNAPSHOT_HYDRATE_CHUNK_SIZE === 0) {
+      await yieldToEventLoop();
+      throwIfCancelled(options);
+    }
+  }
+
+  // Typed sections are views over the file buffer; the columns copy on first growth.
+  const entryCount = persisted.nameIds.length;
+  const snapshot: IndexSnapshot = {
+    roots: persisted.roots,
+    strings,
+    nameIds: new GrowableColumn(Uint32Array, persisted.nameIds),
+    normalizedNameIds: new GrowableColumn(Uint32Array, persisted.normalizedNameIds),
+    parentRefs: new GrowableColumn(Int32Array, persisted.parentRefs),
+    flags: new GrowableColumn(Uint8Array, persisted.entryFlags),
+    prefixIndex: PostingIndex.fromSealed(persisted.postingOffsets, persisted.postings),
+    trigramIndex: PostingIndex.fromSealed(persisted.trigramOffsets, persisted.trigrams),
+    childIndex: new Map<number, number>(),
+    firstChildIds: new GrowableColumn(Int32Array, new Int32Array(entryCount).fill(-1)),
+    nextSiblingIds: new GrowableColumn(Int32Array, new Int32Array(entryCount)),
+    rootFirstChildIds: persisted.roots.map(() => -1),
+    extensionIds: new GrowableColumn(Uint32Array, persisted.extensionIds),
+    sizeBuckets: new GrowableColumn(Uint8Array, persisted.sizeBuckets),
+    mtimes: new GrowableColumn(Uint32Array, persisted.mtimes),
+    builtAt: persisted.builtAt,
+    generation: 0,
+    tombstoneCount: 0,
+  };
+  for (let entryId = 0; entryId < entryCount; entryId += 1) {
+    snapshot.childIndex.set(getChildKey(persisted.parentRefs[entryId], persisted.nameIds[entryId]), entryId);
+    linkChild(snapshot, persisted.parentRefs[entryId], entryId);
+    if (isEntryDeleted(snapshot, entryId)) snapshot.tombstoneCount += 1;
+    if ((entryId + 1) % SNAPSHOT_HYDRATE_CHUNK_SIZE === 0) {
+      await yieldToEventLoop();
+      throwIfCancelled(options);
+    }
+  }
+  return snapshot;
+}
+
+// Bring a restored snapshot up to date without re-walking the tree: only
+// directories whose mtime moved since the snapshot was taken are re-listed,
+// and the differences are fed through the same path as watcher batches.
+export async function reconcileIndexSnapshot(
+  snapshot: IndexSnapshot,
+  config: FileSearchIndexConfig,
+  options?: IndexJobOptions
+): Promise<number> {
+  const startedAt = Date.now();
+  const directories: Array<{ ref: number; path: string }> = snapshot.roots.map((root, rootIndex) => ({
+    ref: -1 - rootIndex,
+    path: root,
+  }));
+  for (let entryId = 0; entryId < getIndexEntryCount(snapshot); entryId += 1) {
+    if (isEntryDeleted(snapshot, entryId) || !isEntryDirectory(snapshot, entryId)) continue;
+    directories.push({ ref: entryId, path: getRefPath(snapshot, entryId) });
+  }
+
+  const changedPaths = await collectChangedPaths(snapshot, directories, snapshot.builtAt - RECONCILE_MTIME_SLACK_MS, options);
+  if (changedPaths.size > 0) {
+    await applyWatchEventBatch(snapshot, config, [...changedPaths], options);
+  }
+  snapshot.builtAt = startedAt;
+  return changedPaths.size;
+}
+
+// Reconciles one directory subtree after the watcher lost events for it
+// (e.g. an inotify queue overflow), re-listing only directories whose mtime
+// moved since `changedSince`.
+export async function rescanIndexSubtree(
+  snapshot: IndexSnapshot,
+  config: FileSearchIndexConfig,
+  dirPath: string,
+  changedSince: number,
+  options?: IndexJobOptions
+): Promise<number> {
+  const ref = findDirectoryRef(snapshot, dirPath);
+  if (ref === null || (ref >= 0 && (isEntryDeleted(snapshot, ref) || !isEntryDirectory(snapshot, ref)))) {
+    // Not indexed as a live directory: let the batch path stat and walk it.
+    await applyWatchEventBatch(snapshot, config, [dirPath], options);
+    return 1;
+  }
+
+  const directories: Array<{ ref: number; path: string }> = [];
+  const stack = [{ ref, path: dirPath }];
+  while (stack.length > 0) {
+    const directory = stack.pop() as { ref: number; path: string };
+    directories.push(directory);
+    for (let childId = getFirstChildId(snapshot, directory.ref); childId >= 0; childId = snapshot.nextSiblingIds.values[childId]) {
+      if (isEntryDeleted(snapshot, childId) || !isEntryDirectory(snapshot, childId)) continue;
+      stack.push({ ref: childId, path: path.join(directory.path, getEntryName(snapshot, childId)) });
+    }
+  }
+
+  const changedPaths = await collectChangedPaths(snapshot, directories, changedSince - RECONCILE_MTIME_SLACK_MS, options);
+  if (changedPaths.size > 0) {
+    await applyWatchEventBatch(snapshot, config, [...changedPaths], options);
+  }
+  return changedPaths.size;
+}
+
+// Stats `directories` and diffs the listing of every one modified since
+// `changedSince` against its indexed children.
+async function collectChangedPaths(
+  snapshot: IndexSnapshot,
+  directories: Array<{ ref: number; path: string }>,
+  changedSince: number,
+  options?: IndexJobOptions
+): Promise<Set<string>> {
+  const changedPaths = new Set<string>();
+  for (let offset = 0; offset < directories.length; offset += RECONCILE_STAT_CONCURRENCY) {
+    throwIfCancelled(options);
+    const stated = await Promise.all(
+      directories.slice(offset, offset + RECONCILE_STAT_CONCURRENCY).map(async (directory) => {
+        try {
+          const stats = await fs.promises.stat(directory.path);
+          return { directory, mtimeMs: stats.isDirectory() ? stats.mtimeMs : -1 };
+        } catch {
+          return { directory, mtimeMs: -1 };
+        }
+      })
+    );
+
+    for (const { directory, mtimeMs } of stated) {
+      if (mtimeMs < 0) {
+        changedPaths.add(directory.path);
+        continue;
+      }
+      if (mtimeMs < changedSince) continue;
+
+      let names: string[] = [];
+      try {
+        names = await fs.promises.readdir(directory.path);
+      } catch {
+        continue;
+      }
+      const presentNames = new Set(names);
+      for (const name of names) {
+        const existingId = findChildId(snapshot, directory.ref, name);
+        if (existingId < 0 || isEntryDeleted(snapshot, existingId)) {
+          changedPaths.add(path.join(directory.path, name));
+        }
+      }
+      for (let childId = getFirstChildId(snapshot, directory.ref); childId >= 0; childId = snapshot.nextSiblingIds.values[childId]) {
+        if (isEntryDeleted(snapshot, childId)) continue;
+        const childName = getEntryName(snapshot, childId);
+        if (!presentNames.has(childName)) changedPaths.add(path.join(directory.path, childName));
+      }
+    }
+  }
+  return changedPaths;
+}
+
+export function getIndexMemoryReport(snapshot: IndexSnapshot): FileSearchIndexMemoryReport {
+  const entryCount = getIndexEntryCount(snapshot);
+  const columnBytes = snapshot.nameIds.byteLength
+    + snapshot.normalizedNameIds.byteLength
+    + snapshot.parentRefs.byteLength
+    + snapshot.flags.byteLength
+    + snapshot.firstChildIds.byteLength
+    + snapshot.nextSiblingIds.byteLength
+    + snapshot.extensionIds.byteLength
+    + snapshot.sizeBuckets.byteLength
+    + snapshot.mtimes.byteLength;
+  const stringTableBytes = snapshot.strings.estimateBytes();
+  const postingBytes = snapshot.prefixIndex.byteLength + snapshot.trigramIndex.byteLength;
+  // Hash table slot plus a boxed double key per child.
+  const childIndexBytes = snapshot.childIndex.size * 40;
+  const totalBytes = columnBytes + stringTableBytes + postingBytes + childIndexBytes;
+
+  // Legacy layout: one object per entry holding path, normalizedPath, name,
+  // normalizedName and compactName strings plus token arrays, a path -> id
+  // map, and a Map<string, number[]> of prefix buckets holding 8-byte ids.
+  let legacyLayoutBytes = 0;
+  let liveEntryCount = 0;
+  const directoryPaths = new Map<number, { length: number; tokenCount: number; tokenBytes: number }>();
+  const rootPaths = snapshot.roots.map((root) => {
+    const tokens = tokenizeSearchText(root);
+    return {
+      length: root.length,
+      tokenCount: tokens.length,
+      tokenBytes: tokens.reduce((sum, token) => sum + estimateStringBytes(token), 0),
+    };
+  });
+  for (let entryId = 0; entryId < entryCount; entryId += 1) {
+    const parentRef = snapshot.parentRefs.values[entryId];
+    const parent = parentRef < 0 ? rootPaths[-1 - parentRef] : directoryPaths.get(parentRef);
+    if (!parent) continue;
+    const name = getEntryName(snapshot, entryId);
+    const normalizedName = getEntryNormalizedName(snapshot, entryId);
+    const tokens = normalizedName.split(' ');
+    const tokenBytes = tokens.reduce((sum, token) => sum + estimateStringBytes(token), 0);
+    const entryPath = {
+      length: parent.length + 1 + name.length,
+      tokenCount: parent.tokenCount + tokens.length,
+      tokenBytes: parent.tokenBytes + tokenBytes,
+    };
+    if (isEntryDirectory(snapshot, entryId)) directoryPaths.set(entryId, entryPath);
+    if (isEntryDeleted(snapshot, entryId)) continue;
+    liveEntryCount += 1;
+
+    const pathStringBytes = 16 + Math.ceil(entryPath.length / 8) * 8;
+    legacyLayoutBytes += 104
+      + pathStringBytes * 2
+      + estimateStringBytes(name)
+      + estimateStringBytes(normalizedName)
+      + estimateStringBytes(normalizedName.replace(/\s+/g, ''))
+      + 16 + tokens.length * 8 + tokenBytes
+      + 16 + entryPath.tokenCount * 8 + entryPath.tokenBytes
+      + 24;
+  }
+  let postingKeyCount = 0;
+  snapshot.prefixIndex.forEachKey((keyId, postingCount) => {
+    postingKeyCount += 1;
+    legacyLayoutBytes += estimateStringBytes(snapshot.strings.get(keyId)) + 24 + 16 + postingCount * 8;
+  });
+
+  return {
+    entryCount,
+    liveEntryCount,
+    stringCount: snapshot.strings.size,
+    postingKeyCount,
+    postingCount: snapshot.prefixIndex.postingCount,
+    trigramPostingCount: snapshot.trigramIndex.postingCount,
+    columnBytes,
+    stringTableBytes,
+    postingBytes,
+    childIndexBytes,
+    totalBytes,
+    bytesPerEntry: liveEntryCount > 0 ? Math.round(totalBytes / liveEntryCount) : 0,
+    legacyLayoutBytes,
+    legacyBytesPerEntry: liveEntryCount > 0 ? Math.round(legacyLayoutBytes / liveEntryCount) : 0,
+  };
+}
+
+type MatchCandidate = {
+  name: string;
+  normalizedName: string;
+  compactName: string;
+  tokens: string[];
+  isDirectory: boolean;
+};
+
+// Best path-level score for query term `termIndex` from the components above
+// the candidate itself (its own name is scored separately and ranks higher).
+type PathTermScorer = (termIndex: number) => number;
+
+function createMatchCandidate(name: string, normalizedName: string, isDirectory: boolean): MatchCandidate {
+  return {
+    name,
+    normalizedName,
+    compactName: normalizedName.replace(/\s+/g, ''),
+    tokens: normalizedName ? normalizedName.split(' ') : [],
+    isDirectory,
+  };
+}
+
+// Query terms are alphanumeric, so a match against the full normalized path
+// never spans a separator and can be evaluated one component at a time.
+function scorePathComponentTerm(normalizedComponent: string, term: string): number {
+  if (!normalizedComponent) return 0;
+  const tokens = normalizedComponent.split(' ');
+  if (tokens.includes(term)) return 64;
+  if (tokens.some((token) => token.startsWith(term))) return 58;
+  if (normalizedComponent.includes(term)) return 48;
+  return 0;
+}
+
+function createAncestorTermScorer(snapshot: IndexSnapshot, queryTerms: string[]): (termIndex: number, ref: number) => number {
+  const rootScores = snapshot.roots.map((root) => {
+    const normalizedRoot = normalizeSearchText(root);
+    return queryTerms.map((term) => scorePathComponentTerm(normalizedRoot, term));
+  });
+  const memo = queryTerms.map(() => new Map<number, number>());
+  const scoreRef = (termIndex: number, ref: number): number => {
+    if (ref < 0) return rootScores[-1 - ref]?.[termIndex] || 0;
+    const cached = memo[termIndex].get(ref);
+    if (cached !== undefined) return cached;
+    const ownScore = scorePathComponentTerm(getEntryNormalizedName(snapshot, ref), queryTerms[termIndex]);
+    const score = Math.max(ownScore, scoreRef(termIndex, snapshot.parentRefs.values[ref]));
+    memo[termIndex].set(ref, score);
+    return score;
+  };
+  return scoreRef;
+}
+
+function scoreEntryMatch(
+  entry: MatchCandidate,
+  normalizedQuery: string,
+  queryTerms: string[],
+  scorePathTerm: PathTermScorer
+): number {
+  if (queryTerms.length === 0) return 0;
+
+  let score = 0;
+
+  for (let termIndex = 0; termIndex < queryTerms.length; termIndex += 1) {
+    const term = queryTerms[termIndex];
+    let termScore = 0;
+    if (entry.normalizedName === term) {
+      termScore = 140;
+    } else if (entry.normalizedName.startsWith(term)) {
+      termScore = 118;
+    } else if (entry.compactName.startsWith(term)) {
+      termScore = 106;
+    } else if (entry.tokens.includes(term)) {
+      termScore = 102;
+    } else if (entry.tokens.some((token) => token.startsWith(term))) {
+      termScore = 88;
+    } else if (entry.normalizedName.includes(term)) {
+      termScore = 70;
+    } else {
+      termScore = scorePathTerm(termIndex);
+      if (termScore === 0 && isSubsequenceMatch(term, entry.compactName)) {
+        termScore = 44;
+      }
+      if (termScore === 0) return 0;
+    }
+    score += termScore;
+  }
+
+  if (entry.normalizedName === normalizedQuery) {
+    score += 240;
+  } else if (entry.normalizedName.startsWith(normalizedQuery)) {
+    score += 180;
+  } else if (entry.normalizedName.includes(normalizedQuery)) {
+    score += 122;
+  }
+
+  if (entry.isDirectory) {
+    score -= 10;
+  } else {
+    score += 8;
+  }
+
+  score += Math.max(0, 20 - Math.max(0, entry.name.length - normalizedQuery.length));
+  return score;
+}
+
+function getEntryMatchKind(
+  entry: MatchCandidate,
+  normalizedQuery: string,
+  queryTerms: string[],
+  scorePathTerm: PathTermScorer
+): string {
+  if (entry.normalizedName === normalizedQuery) return 'exact';
+  if (entry.normalizedName.startsWith(normalizedQuery)) return 'prefix';
+  if (entry.compactName.startsWith(normalizedQuery.replace(/\s+/g, ''))) return 'compact-prefix';
+  if (queryTerms.some((term) => entry.tokens.some((token) => token.startsWith(term)))) return 'token-prefix';
+  if (entry.normalizedName.includes(normalizedQuery)) return 'contains';
+  if (queryTerms.some((term, termIndex) => entry.normalizedName.includes(term) || scorePathTerm(termIndex) > 0)) return 'path';
+  return 'subsequence';
+}
+
+function getFilePathRankingMetadata(filePath: string, stats: fs.Stats | null, homeDir: string) {
+  const relative = path.relative(homeDir, filePath);
+  const segments = relative && !relative.startsWith('..') && !path.isAbsolute(relative)
+    ? relative.split(path.sep).filter(Boolean)
+    : filePath.split(path.sep).filter(Boolean);
+  const topLevelRoot = segments[0] || '';
+  const noisyPathSegmentCount = segments.reduce((count, segment) =>
+    count + (NOISY_DIRECTORY_NAME_SET.has(segment.toLowerCase()) ? 1 : 0), 0);
+  return {
+    depth: segments.length,
+    homeRelativeDepth: segments.length,
+    topLevelRoot,
+    noisyPathSegmentCount,
+    mtimeMs: stats?.mtimeMs,
+    birthtimeMs: stats?.birthtimeMs,
+    atimeMs: stats?.atimeMs,
+  };
+}
+
+async function statPathForMetadata(filePath: string): Promise<fs.Stats | null> {
+  try {
+    return await fs.promises.stat(filePath);
+  } catch {
+    return null;
+  }
+}
+
+// Results go out without stat metadata; readFileSearchMetadata fills in the
+// timestamps for the top of the list in a second pass.
+export function buildFileSearchResult(
+  entry: Pick<IndexedFileSearchResult, 'path' | 'name' | 'parentPath' | 'isDirectory'>,
+  score: number,
+  matchKind: string,
+  homeDir: string
+): IndexedFileSearchResult {
+  return {
+    path: entry.path,
+    name: entry.name,
+    parentPath: entry.parentPath,
+    displayPath: asTildePath(entry.parentPath, homeDir),
+    isDirectory: entry.isDirectory,
+    score,
+    matchKind,
+    ...getFilePathRankingMetadata(entry.path, null, homeDir),
+  };
+}
+
+export async function readFileSearchMetadata(
+  paths: string[],
+  options?: IndexJobOptions
+): Promise<IndexedFileSearchMetadata[]> {
+  const metadata = await Promise.all(paths.slice(0, MAX_FILE_METADATA_STAT_RESULTS).map(async (filePath) => {
+    const stats = await statPathForMetadata(filePath);
+    return {
+      path: filePath,
+      mtimeMs: stats?.mtimeMs,
+      birthtimeMs: stats?.birthtimeMs,
+      atimeMs: stats?.atimeMs,
+    };
+  }));
+  throwIfCancelled(options);
+  return metadata;
+}
+
+function lowerBound(values: Uint32Array, target: number, from: number): number {
+  let low = from;
+  let high = values.length;
+  while (low < high) {
+    const mid = (low + high) >>> 1;
+    if (values[mid] < target) low = mid + 1;
+    else high = mid;
+  }
+  return low;
+}
+
+// Posting lists are ascending, so intersect by walking the shortest list and
+// binary-searching forward through the longer ones.
+export function intersectCandidates(lists: Uint32Array[]): Uint32Array {
+  if (lists.length === 0) return new Uint32Array(0);
+  const [first, ...rest] = [...lists].sort((a, b) => a.length - b.length);
+  let candidates = first;
+  for (const list of rest) {
+    if (candidates.length === 0) break;
+    const next = new Uint32Array(candidates.length);
+    let nextLength = 0;
+    let cursor = 0;
+    for (let i = 0; i < candidates.length; i += 1) {
+      cursor = lowerBound(list, candidates[i], cursor);
+      if (cursor >= list.length) break;
+      if (list[cursor] === candidates[i]) {
+        next[nextLength] = candidates[i];
+        nextLength += 1;
+      }
+    }
+    candidates = next.subarray(0, nextLength);
+  }
+  return candidates;
+}
+
+function resolveCandidateIds(snapshot: IndexSnapshot, terms: string[], narrowTo?: Uint32Array): Uint32Array {
+  const indexedLists: Uint32Array[] = narrowTo ? [narrowTo] : [];
+  for (const term of terms) {
+    const key = term.slice(0, Math.min(MAX_PREFIX_LENGTH, term.length));
+    const matches = snapshot.prefixIndex.get(snapshot.strings.lookup(key));
+    if (matches.length === 0) return matches;
+    indexedLists.push(matches);
+  }
+  return intersectCandidates(indexedLists);
+}
+
+// When `terms` only extends the context's previous query (terms lengthened or
+// appended), returns the terms whose posting lists still need intersecting
+// with the previous matches; otherwise null. Both candidate lists and scores
+// are monotone under extension, so nothing outside the previous matches can
+// match now. Path-token keys start at two characters, so a one-character
+// term's list is not a superset of its extensions.
+function getRefinementTerms(context: FileSearchQueryContext, snapshot: IndexSnapshot, terms: string[]): string[] | null {
+  if (context.snapshot !== snapshot || context.generation !== snapshot.generation) return null;
+  const previousTerms = context.terms;
+  if (previousTerms.length === 0 || terms.length < previousTerms.length) return null;
+  const changedTerms: string[] = [];
+  for (let i = 0; i < terms.length; i += 1) {
+    const previousTerm = previousTerms[i];
+    if (previousTerm === terms[i]) continue;
+    if (previousTerm !== undefined && (previousTerm.length < 2 || !terms[i].startsWith(previousTerm))) return null;
+    changedTerms.push(terms[i]);
+  }
+  return changedTerms;
+}
+
+// Path segment as it appears inside normalizePathSearchText(fullPath); the
+// trim there only ever applies to the ends of the whole path.
+function normalizePathSegment(value: string): string {
+  return value.normalize('NFKD').toLowerCase().replace(/\\/g, '/');
+}
+
+// Entries whose path-normalized name can hold the end of a needle occurrence:
+// names containing `tail` (via trigrams), or starting with it when it is too
+// short for trigrams and must follow a separator. Null means "scan instead".
+function resolvePathCandidateIds(snapshot: IndexSnapshot, tail: string, tailFollowsSeparator: boolean): Uint32Array | null {
+  if (tail.length < PATH_TRIGRAM_LENGTH) {
+    if (!tail || !tailFollowsSeparator) return null;
+    return snapshot.trigramIndex.get(snapshot.strings.lookup(PATH_PREFIX_MARKER + tail));
+  }
+  const lists: Uint32Array[] = [];
+  const seen = new Set<string>();
+  for (let start = 0; start + PATH_TRIGRAM_LENGTH <= tail.length; start += 1) {
+    const trigram = tail.slice(start, start + PATH_TRIGRAM_LENGTH);
+    if (seen.has(trigram)) continue;
+    seen.add(trigram);
+    const matches = snapshot.trigramIndex.get(snapshot.strings.lookup(trigram));
+    if (matches.length === 0) return matches;
+    lists.push(matches);
+  }
+  if (tailFollowsSeparator) {
+    lists.push(snapshot.trigramIndex.get(snapshot.strings.lookup(PATH_PREFIX_MARKER + tail.slice(0, PATH_TRIGRAM_LENGTH - 1))));
+  }
+  return intersectCandidates(lists);
+}
+
+function getPathLikeScore(matchIndex: number, endsWithNeedle: boolean, isDirectory: boolean, pathLength: number): number {
+  let score = 1000 - Math.min(420, matchIndex);
+  if (endsWithNeedle) {
+    score += 180;
+  }
+  if (isDirectory) {
+    score -= 10;
+  } else {
+    score += 12;
+  }
+  score -= Math.min(120, Math.floor(pathLength / 4));
+  return score;
+}
+
+type PathLikeMatch = { entryId: number; score: number; pathLength: number; name: string };
+
+function createPathLikeSelector(limit: number): TopKSelector<PathLikeMatch> {
+  return new TopKSelector<PathLikeMatch>(limit, (a, b) => {
+    if (b.score !== a.score) return b.score - a.score;
+    if (a.pathLength !== b.pathLength) return a.pathLength - b.pathLength;
+    return a.name.localeCompare(b.name) || a.entryId - b.entryId;
+  });
+}
+
+function finishPathLikeSearch(
+  snapshot: IndexSnapshot,
+  homeDir: string,
+  selector: TopKSelector<PathLikeMatch>
+): IndexedFileSearchResult[] {
+  return selector.toSortedArray().map(({ entryId, score }) =>
+    buildFileSearchResult(describeEntry(snapshot, entryId), score, 'path', homeDir)
+  );
+}
+
+// Path-like queries match any entry whose normalized path contains the
+// needle. Every such entry sits under a "hit": the shallowest entry (or root)
+// whose own path already contains it. Hits are found by verifying trigram
+// candidates for the needle's last segment, then their subtrees are scored
+// without building per-entry path strings: the first occurrence is the hit's,
+// and only candidates can end with the needle.
+async function searchIndexByPath(
+  snapshot: IndexSnapshot,
+  homeDir: string,
+  trimmedQuery: string,
+  limit: number,
+  options?: FilteredQueryOptions
+): Promise<IndexedFileSearchResult[]> {
+  const entryFilter = options?.entryFilter;
+  const rawNeedle = normalizePathSearchText(trimmedQuery);
+  if (!rawNeedle) return [];
+  // A '~' past the start can only match through the tilde form of a path.
+  if (rawNeedle.indexOf('~', 1) >= 0) return scanIndexByPath(snapshot, homeDir, trimmedQuery, limit, options);
+  const needle = trimmedQuery.startsWith('~') && homeDir
+    ? normalizePathSearchText(`${homeDir}${trimmedQuery.slice(1)}`)
+    : rawNeedle;
+
+  // With a trailing separator the occurrence ends just before a child's name,
+  // so the hit covers that directory's descendants but not the directory.
+  const trailingSeparator = needle.endsWith('/');
+  const anchor = needle.replace(/\/+$/, '');
+  const tail = anchor.slice(anchor.lastIndexOf('/') + 1);
+  const candidateIds = resolvePathCandidateIds(snapshot, tail, anchor.includes('/'));
+  if (!candidateIds) return scanIndexByPath(snapshot, homeDir, trimmedQuery, limit, options);
+
+  const normalizedPaths = new Map<number, string>();
+  const rawPathLengths = new Map<number, number>();
+  const getNormalizedRefPath = (ref: number): string => {
+    const cached = normalizedPaths.get(ref);
+    if (cached !== undefined) return cached;
+    let value: string;
+    if (ref < 0) {
+      const normalizedRoot = normalizePathSearchText(snapshot.roots[-1 - ref] || '');
+      value = normalizedRoot.endsWith('/') ? normalizedRoot.slice(0, -1) : normalizedRoot;
+    } else {
+      value = `${getNormalizedRefPath(snapshot.parentRefs.values[ref])}/${normalizePathSegment(getEntryName(snapshot, ref))}`;
+    }
+    normalizedPaths.set(ref, value);
+    return value;
+  };
+  const getRawPathLength = (ref: number): number => {
+    const cached = rawPathLengths.get(ref);
+    if (cached !== undefined) return cached;
+    const root = ref < 0 ? snapshot.roots[-1 - ref] || '' : '';
+    const value = ref < 0
+      ? (root.endsWith(path.sep) ? root.length - 1 : root.length)
+      : getRawPathLength(snapshot.parentRefs.values[ref]) + 1 + getEntryName(snapshot, ref).length;
+    rawPathLengths.set(ref, value);
+    return value;
+  };
+
+  const hits: Array<{ ref: number; matchIndex: number; includesSelf: boolean }> = [];
+  for (let rootIndex = 0; rootIndex < snapshot.roots.length; rootIndex += 1) {
+    const rootPath = getNormalizedRefPath(-1 - rootIndex);
+    const matchIndex = (trailingSeparator ? `${rootPath}/` : rootPath).indexOf(needle);
+    if (matchIndex >= 0) hits.push({ ref: -1 - rootIndex, matchIndex, includesSelf: false });
+  }
+
+  const endingEntryIds = new Set<number>();
+  for (let i = 0; i < candidateIds.length; i += 1) {
+    if ((i + 1) % QUERY_YIELD_EVERY_ENTRIES === 0) {
+      await yieldToEventLoop();
+      throwIfCancelled(options);
+    }
+    const entryId = candidateIds[i];
+    if (isEntryDeleted(snapshot, entryId)) continue;
+    if (!normalizePathSegment(getEntryName(snapshot, entryId)).includes(tail)) continue;
+    const untrimmedPath = getNormalizedRefPath(entryId);
+    if (trailingSeparator) {
+      const matchIndex = `${untrimmedPath}/`.indexOf(needle);
+      if (matchIndex >= 0) hits.push({ ref: entryId, matchIndex, includesSelf: false });
+      continue;
+    }
+    const normalizedPath = untrimmedPath.trim();
+    const matchIndex = normalizedPath.indexOf(needle);
+    if (matchIndex < 0) continue;
+    hits.push({ ref: entryId, matchIndex, includesSelf: true });
+    if (normalizedPath.endsWith(needle)) endingEntryIds.add(entryId);
+  }
+
+  // Roots sort first and ancestors precede descendants, so the first hit to
+  // reach an entry is its shallowest one.
+  hits.sort((a, b) => a.ref - b.ref);
+  const covered = new Uint8Array(getIndexEntryCount(snapshot));
+  const selector = createPathLikeSelector(limit);
+  const stack: Array<{ entryId: number; pathLength: number }> = [];
+  let visited = 0;
+  for (const hit of hits) {
+    if (hit.ref >= 0 && covered[hit.ref]) continue;
+    const hitPathLength = getRawPathLength(hit.ref);
+    if (hit.includesSelf) {
+      stack.push({ entryId: hit.ref, pathLength: hitPathLength });
+    } else {
+      for (let childId = getFirstChildId(snapshot, hit.ref); childId >= 0; childId = snapshot.nextSiblingIds.values[childId]) {
+        stack.push({ entryId: childId, pathLength: hitPathLength + 1 + getEntryName(snapshot, childId).length });
+      }
+    }
+
+    while (stack.length > 0) {
+      const { entryId, pathLength } = stack.pop() as { entryId: number; pathLength: number };
+      visited += 1;
+      if (visited % QUERY_YIELD_EVERY_ENTRIES === 0) {
+        await yieldToEventLoop();
+        throwIfCancelled(options);
+      }
+      if (covered[entryId] || isEntryDeleted(snapshot, entryId)) continue;
+      covered[entryId] = 1;
+      if (!entryFilter || entryFilter(entryId)) {
+        const isDirectory = isEntryDirectory(snapshot, entryId);
+        const name = getEntryName(snapshot, entryId);
+        selector.push({
+          entryId,
+          score: getPathLikeScore(hit.matchIndex, endingEntryIds.has(entryId), isDirectory, pathLength),
+          pathLength,
+          name,
+        });
+      }
+      for (let childId = snapshot.firstChildIds.values[entryId]; childId >= 0; childId = snapshot.nextSiblingIds.values[childId]) {
+        stack.push({ entryId: childId, pathLength: pathLength + 1 + getEntryName(snapshot, childId).length });
+      }
+    }
+  }
+
+  return finishPathLikeSearch(snapshot, homeDir, selector);
+}
+
+// Full scan fallback for needles too short to narrow through the trigram index.
+async function scanIndexByPath(
+  snapshot: IndexSnapshot,
+  homeDir: string,
+  trimmedQuery: string,
+  limit: number,
+  options?: FilteredQueryOptions
+): Promise<IndexedFileSearchResult[]> {
+  const entryFilter = options?.entryFilter;
+  const rawNeedle = normalizePathSearchText(trimmedQuery);
+  if (!rawNeedle) return [];
+  const expandedNeedle = trimmedQuery.startsWith('~') && homeDir
+    ? normalizePathSearchText(`${homeDir}${trimmedQuery.slice(1)}`)
+    : rawNeedle;
+  const normalizedHome = homeDir ? normalizePathSearchText(homeDir) : '';
+
+  // Normalized paths and raw lengths are built incrementally from the parent
+  // directory, which always precedes its children in id order.
+  const rootPaths = snapshot.roots.map((root) => {
+    const normalized = normalizePathSearchText(root);
+    return {
+      normalized: normalized.endsWith('/') ? normalized.slice(0, -1) : normalized,
+      length: root.endsWith(path.sep) ? root.length - 1 : root.length,
+    };
+  });
+  const directoryPaths = new Map<number, { normalized: string; length: number }>();
+
+  const selector = createPathLikeSelector(limit);
+  for (let entryId = 0; entryId < getIndexEntryCount(snapshot); entryId += 1) {
+    if ((entryId + 1) % QUERY_YIELD_EVERY_ENTRIES === 0) {
+      await yieldToEventLoop();
+      throwIfCancelled(options);
+    }
+    if (isEntryDeleted(snapshot, entryId)) continue;
+    const parentRef = snapshot.parentRefs.values[entryId];
+    const parent = parentRef < 0 ? rootPaths[-1 - parentRef] : directoryPaths.get(parentRef);
+    if (!parent) continue;
+
+    const name = getEntryName(snapshot, entryId);
+    const isDirectory = isEntryDirectory(snapshot, entryId);
+    const untrimmedPath = `${parent.normalized}/${normalizePathSegment(name)}`;
+    const pathLength = parent.length + 1 + name.length;
+    if (isDirectory) directoryPaths.set(entryId, { normalized: untrimmedPath, length: pathLength });
+
+    const normalizedPath = untrimmedPath.trim();
+    const pathIndex = normalizedPath.indexOf(expandedNeedle);
+    let matchIndex = pathIndex;
+    if (matchIndex < 0 && rawNeedle.includes('~')) {
+      const tildePath = normalizedHome && normalizedPath.startsWith(`${normalizedHome}/`)
+        ? `~${normalizedPath.slice(normalizedHome.length)}`
+        : normalizedPath;
+      matchIndex = tildePath.indexOf(rawNeedle);
+    }
+    if (matchIndex < 0) continue;
+    if (entryFilter && !entryFilter(entryId)) continue;
+
+    const endsWithNeedle = normalizedPath.endsWith(`/${expandedNeedle}`) || normalizedPath.endsWith(expandedNeedle);
+    selector.push({ entryId, score: getPathLikeScore(matchIndex, endsWithNeedle, isDirectory, pathLength), pathLength, name });
+  }
+
+  return finishPathLikeSearch(snapshot, homeDir, selector);
+}
+
+async function searchIndexByTerms(
+  snapshot: IndexSnapshot,
+  homeDir: string,
+  normalizedQuery: string,
+  terms: string[],
+  limit: number,
+  options?: FilteredQueryOptions & { context?: FileSearchQueryContext }
+): Promise<IndexedFileSearchResult[]> {
+  const context = options?.context;
+  const entryFilter = options?.entryFilter;
+  const generation = snapshot.generation;
+  const refinementTerms = context ? getRefinementTerms(context, snapshot, terms) : null;
+  const candidateIds = context && refinementTerms
+    ? resolveCandidateIds(snapshot, refinementTerms, context.matchedIds)
+    : resolveCandidateIds(snapshot, terms);
+  const matchedIds: number[] = [];
+
+  const scoreAncestorTerm = createAncestorTermScorer(snapshot, terms);
+  const selector = new TopKSelector<{ entryId: number; score: number; candidate: MatchCandidate }>(limit, (a, b) => {
+    if (b.score !== a.score) return b.score - a.score;
+    return a.candidate.name.localeCompare(b.candidate.name) || a.entryId - b.entryId;
+  });
+  for (let i = 0; i < candidateIds.length; i += 1) {
+    if ((i + 1) % QUERY_YIELD_EVERY_ENTRIES === 0) {
+      await yieldToEventLoop();
+      throwIfCancelled(options);
+    }
+    const entryId = candidateIds[i];
+    if (isEntryDeleted(snapshot, entryId)) continue;
+    if (entryFilter && !entryFilter(entryId)) continue;
+    const candidate = createMatchCandidate(
+      getEntryName(snapshot, entryId),
+      getEntryNormalizedName(snapshot, entryId),
+      isEntryDirectory(snapshot, entryId)
+    );
+    const parentRef = snapshot.parentRefs.values[entryId];
+    const score = scoreEntryMatch(candidate, normalizedQuery, terms, (termIndex) => scoreAncestorTerm(termIndex, parentRef));
+    if (score <= 0) continue;
+    matchedIds.push(entryId);
+    selector.push({ entryId, score, candidate });
+  }
+
+  if (context) {
+    context.snapshot = snapshot;
+    // The generation read before scanning: a watch batch landing mid-scan
+    // leaves the context stale rather than wrongly current.
+    context.generation = generation;
+    context.terms = terms;
+    context.matchedIds = Uint32Array.from(matchedIds);
+  }
+
+  return selector.toSortedArray().map(({ entryId, score, candidate }) => {
+    const parentRef = snapshot.parentRefs.values[entryId];
+    return buildFileSearchResult(
+      describeEntry(snapshot, entryId),
+      score,
+      getEntryMatchKind(candidate, normalizedQuery, terms, (termIndex) => scoreAncestorTerm(termIndex, parentRef)),
+      homeDir
+    );
+  });
+}
+
+type EntryFilter = (entryId: number) => boolean;
+type FilteredQueryOptions = IndexJobOptions & { entryFilter?: EntryFilter };
+
+// Compiles parsed filters into a predicate over the attribute columns.
+// Entries whose attribute a filter needs but was never read do not match.
+function createEntryFilter(snapshot: IndexSnapshot, filters: FileSearchFilters): EntryFilter {
+  const resolveExtensionIds = (extensions: string[]): Set<number> => new Set(
+    extensions.map((extension) => snapshot.strings.lookup(extension)).filter((stringId) => stringId >= 0)
+  );
+  const extensionIds = filters.extensions ? resolveExtensionIds(filters.extensions) : null;
+  const kinds = filters.kinds;
+  const kindExtensionIds = kinds ? resolveExtensionIds(([] as string[]).concat(...kinds.map(getKindExtensions))) : null;
+  const matchesFolders = Boolean(kinds && kinds.indexOf('folder') >= 0);
+  const matchesAnyFile = Boolean(kinds && kinds.indexOf('file') >= 0);
+  const minSizeBucket = filters.minSize === null ? -1 : getSizeBucket(filters.minSize);
+  const maxSizeBucket = filters.maxSize === null ? -1 : getSizeBucket(filters.maxSize);
+  const modifiedAfter = filters.modifiedAfterMs === null ? -1 : Math.floor(filters.modifiedAfterMs / 1000);
+  const modifiedBefore = filters.modifiedBeforeMs === null ? -1 : Math.floor(filters.modifiedBeforeMs / 1000);
+
+  return (entryId) => {
+    const extensionId = snapshot.extensionIds.values[entryId];
+    if (extensionIds && !extensionIds.has(extensionId)) return false;
+    if (kindExtensionIds) {
+      const matchesKind = isEntryDirectory(snapshot, entryId)
+        ? matchesFolders
+        : matchesAnyFile || kindExtensionIds.has(extensionId);
+      if (!matchesKind) return false;
+    }
+    if (minSizeBucket >= 0 || maxSizeBucket >= 0) {
+      const sizeBucket = snapshot.sizeBuckets.values[entryId];
+      if (sizeBucket === SIZE_BUCKET_UNKNOWN) return false;
+      if (sizeBucket < minSizeBucket) return false;
+      if (maxSizeBucket >= 0 && sizeBucket > maxSizeBucket) return false;
+    }
+    if (modifiedAfter >= 0 || modifiedBefore >= 0) {
+      const mtime = snapshot.mtimes.values[entryId];
+      if (mtime === 0) return false;
+      if (mtime < modifiedAfter) return false;
+      if (modifiedBefore >= 0 && mtime > modifiedBefore) return false;
+    }
+    return true;
+  };
+}
+
+// A query made only of filters: every matching entry, newest first.
+async function searchIndexByFilters(
+  snapshot: IndexSnapshot,
+  homeDir: string,
+  entryFilter: EntryFilter,
+  limit: number,
+  options?: IndexJobOptions
+): Promise<IndexedFileSearchResult[]> {
+  const selector = new TopKSelector<{ entryId: number; mtime: number }>(limit, (a, b) =>
+    b.mtime - a.mtime || a.entryId - b.entryId
+  );
+  for (let entryId = 0; entryId < getIndexEntryCount(snapshot); entryId += 1) {
+    if ((entryId + 1) % QUERY_YIELD_EVERY_ENTRIES === 0) {
+      await yieldToEventLoop();
+      throwIfCancelled(options);
+    }
+    if (isEntryDeleted(snapshot, entryId) || !entryFilter(entryId)) continue;
+    selector.push({ entryId, mtime: snapshot.mtimes.values[entryId] });
+  }
+  return selector.toSortedArray().map(({ entryId }) =>
+    buildFileSearchResult(describeEntry(snapshot, entryId), FILTER_MATCH_SCORE, 'filter', homeDir)
+  );
+}
+
+// Merges the ranked results of several index shards by score. Ties keep each
+// shard's own order (filter-only listings are ranked by recency, not score)
+// and then alternate between shards.
+export function mergeFileSearchResults(
+  resultLists: IndexedFileSearchResult[][],
+  limit?: number
+): IndexedFileSearchResult[] {
+  const nonEmpty = resultLists.filter((results) => results.length > 0);
+  const maxResults = Math.max(1, Math.min(MAX_QUERY_RESULTS, Number(limit) || DEFAULT_MAX_RESULTS));
+  if (nonEmpty.length <= 1) return (nonEmpty[0] || []).slice(0, maxResults);
+  const ranked: Array<{ result: IndexedFileSearchResult; rank: number; shard: number }> = [];
+  nonEmpty.forEach((results, shard) => {
+    results.forEach((result, rank) => ranked.push({ result, rank, shard }));
+  });
+  ranked.sort((a, b) => {
+    const scoreDelta = (b.result.score || 0) - (a.result.score || 0);
+    if (scoreDelta !== 0) return scoreDelta;
+    if (a.rank !== b.rank) return a.rank - b.rank;
+    return a.shard - b.shard;
+  });
+  return ranked.slice(0, maxResults).map((entry) => entry.result);
+}
+
+export async function searchIndexSnapshot(
+  snapshot: IndexSnapshot | null,
+  config: FileSearchIndexConfig,
+  rawQuery: string,
+  options?: { limit?: number; context?: FileSearchQueryContext } & IndexJobOptions
+): Promise<IndexedFileSearchResult[]> {
+  const { homeDir } = config;
+  const { text: queryText, filters } = parseFileSearchFilters(rawQuery);
+  const trimmedQuery = queryText.trim();
+  const pathLikeQuery = isPathLikeQuery(trimmedQuery);
+  const normalizedQuery = normalizeSearchText(queryText);
+  const terms = tokenizeSearchText(queryText);
+  const filtersOnly = Boolean(filters) && !pathLikeQuery && terms.length === 0;
+  if (!pathLikeQuery && !filtersOnly && (!normalizedQuery || terms.length === 0)) return [];
+
+  const limit = Math.max(1, Math.min(MAX_QUERY_RESULTS, Number(options?.limit) || DEFAULT_MAX_RESULTS));
+
+  // Cached matches are only ever unfiltered, so filtered queries neither use
+  // nor update the session context.
+  if ((pathLikeQuery || filters) && options?.context) options.context.terms = [];
+  const queryOptions: FilteredQueryOptions & { context?: FileSearchQueryContext } = filters
+    ? { isCancelled: options?.isCancelled }
+    : { ...options };
+
+  const indexedResults: IndexedFileSearchResult[] = [];
+  if (snapshot) {
+    if (filters) queryOptions.entryFilter = createEntryFilter(snapshot, filters);
+    indexedResults.push(
+      ...(filtersOnly
+        ? await searchIndexByFilters(snapshot, homeDir, queryOptions.entryFilter as EntryFilter, limit, queryOptions)
+        : pathLikeQuery
+          ? await searchIndexByPath(snapshot, homeDir, trimmedQuery, limit, queryOptions)
+          : await searchIndexByTerms(snapshot, homeDir, normalizedQuery, terms, limit, queryOptions))
+    );
+  }
+  throwIfCancelled(options);
+
+  // Spotlight results carry no attributes to filter on.
+  if (process.platform !== 'darwin' || filters) {
+    return indexedResults;
+  }
+  // Only the shard that indexes the home folder falls back to Spotlight.
+  if (!homeDir || config.includeRoots.indexOf(homeDir) < 0) {
+    return indexedResults;
+  }
+  if (indexedResults.length >= limit) {
+    return indexedResults;
+  }
+
+  const existingPaths = new Set(indexedResults.map((entry) => entry.path));
+  const spotlightSearchTerm = pathLikeQuery
+    ? (() => {
+        const normalized = trimmedQuery
+          .replace(/\\/g, '/')
+          .replace(/^~\//, '')
+          .replace(/^~$/, '')
+          .replace(/\/+$/, '');
+        if (!normalized) return '';
+        return path.posix.basename(normalized);
+      })()
+    : trimmedQuery;
+
+  const spotlightTerm = String(spotlightSearchTerm || '').trim();
+  if (!spotlightTerm) return indexedResults;
+
+  let spotlightStdout = '';
+  try {
+    const { stdout } = await execFileAsync('/usr/bin/mdfind', ['-onlyin', homeDir, '-name', spotlightTerm], {
+      maxBuffer: 16 * 1024 * 1024,
+      timeout: SPOTLIGHT_SEARCH_TIMEOUT_MS,
+    });
+    spotlightStdout = String(stdout || '');
+  } catch (error: any) {
+    spotlightStdout = String(error?.stdout || '');
+  }
+  throwIfCancelled(options);
+
+  if (!spotlightStdout) return indexedResults;
+
+  const rawNeedle = pathLikeQuery ? normalizePathSearchText(trimmedQuery) : '';
+  const expandedNeedle = pathLikeQuery && trimmedQuery.startsWith('~') && homeDir
+    ? normalizePathSearchText(`${homeDir}${trimmedQuery.slice(1)}`)
+    : rawNeedle;
+  const spotlightScored: Array<{ path: string; score: number }> = [];
+  const spotlightCandidateLimit = Math.min(MAX_SPOTLIGHT_CANDIDATES, Math.max(320, limit * 8));
+
+  for (const line of spotlightStdout.split(/\r?\n/)) {
+    if (spotlightScored.length >= spotlightCandidateLimit) break;
+    const candidateRawPath = String(line || '').trim();
+    if (!candidateRawPath) continue;
+
+    const candidatePath = path.resolve(candidateRawPath);
+    if (existingPaths.has(candidatePath)) continue;
+    if (shouldSkipPathForSearch(candidatePath, config)) continue;
+
+    const candidateName = path.basename(candidatePath);
+    if (!candidateName) continue;
+    if (shouldSkipFile(candidateName)) continue;
+
+    let score = 0;
+    if (pathLikeQuery) {
+      const normalizedPath = normalizePathSearchText(candidatePath);
+      const tildePath = normalizePathSearchText(asTildePath(candidatePath, homeDir));
+      const pathIndex = expandedNeedle ? normalizedPath.indexOf(expandedNeedle) : -1;
+      const tildeIndex = rawNeedle ? tildePath.indexOf(rawNeedle) : -1;
+      const matchIndex = pathIndex >= 0 ? pathIndex : tildeIndex;
+      if (matchIndex < 0) continue;
+
+      score = 960 - Math.min(420, matchIndex);
+      if (normalizedPath.endsWith(`/${expandedNeedle}`) || normalizedPath.endsWith(expandedNeedle)) {
+        score += 140;
+      }
+      score -= Math.min(120, Math.floor(candidatePath.length / 4));
+    } else {
+      const normalizedName = normalizeSearchText(candidateName);
+      if (!normalizedName) continue;
+      const normalizedCandidatePath = normalizeSearchText(candidatePath);
+      score = scoreEntryMatch(
+        createMatchCandidate(candidateName, normalizedName, false),
+        normalizedQuery,
+        terms,
+        (termIndex) => scorePathComponentTerm(normalizedCandidatePath, terms[termIndex])
+      );
+      if (score <= 0) continue;
+      // Keep index-backed results ahead of Spotlight when ranking is similar.
+      score -= 5;
+    }
+
+    existingPaths.add(candidatePath);
+    spotlightScored.push({ path: candidatePath, score });
+  }
+
+  if (spotlightScored.length === 0) return indexedResults;
+
+  spotlightScored.sort((a, b) => {
+    if (b.score !== a.score) return b.score - a.score;
+    if (a.path.length !== b.path.length) return a.path.length - b.path.length;
+    return a.path.localeCompare(b.path);
+  });
+
+  const merged = [...indexedResults];
+  for (const candidate of spotlightScored) {
+    if (merged.length >= limit) break;
+    const parentPath = path.dirname(candidate.path);
+    merged.push(buildFileSearchResult({
+      path: candidate.path,
+      name: path.basename(candidate.path),
+      parentPath,
+      isDirectory: false,
+    }, candidate.score, pathLikeQuery ? 'path' : 'contains', homeDir));
+  }
+
+  return merged;
+}
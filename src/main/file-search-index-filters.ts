@@ -0,0 +1,182 @@
+// Filter facets for file search queries (`ext:pdf`, `kind:folder`,
+// `modified:<7d`, `size:>100mb`), evaluated against the attribute columns the
+// index fills in while walking, so filtering never stats at query time.
+//
+// Filter tokens can appear anywhere in the query; the remaining text is
+// searched as usual, and a query made only of filters lists every match,
+// most recently modified first. Repeating a facet ORs its values (`ext:pdf
+// ext:docx`, or `ext:pdf,docx`); different facets AND together. A token with
+// a known facet but an unparseable value is dropped rather than searched as text.
+
+export type FileSearchKindFilter = 'folder' | 'file' | keyof typeof KIND_EXTENSIONS;
+
+export type FileSearchFilters = {
+  // Lowercased extensions without the dot; null when not filtering.
+  extensions: string[] | null;
+  kinds: FileSearchKindFilter[] | null;
+  // Inclusive mtime bounds in milliseconds since the epoch.
+  modifiedAfterMs: number | null;
+  modifiedBeforeMs: number | null;
+  // Inclusive size bounds in bytes.
+  minSize: number | null;
+  maxSize: number | null;
+};
+
+const KIND_EXTENSIONS = {
+  image: ['png', 'jpg', 'jpeg', 'gif', 'webp', 'heic', 'heif', 'bmp', 'tif', 'tiff', 'svg', 'ico', 'raw', 'cr2', 'nef', 'psd'],
+  video: ['mp4', 'mov', 'm4v', 'mkv', 'avi', 'webm', 'wmv', 'flv', 'mpg', 'mpeg'],
+  audio: ['mp3', 'm4a', 'aac', 'wav', 'flac', 'ogg', 'opus', 'aiff', 'aif', 'wma'],
+  document: ['pdf', 'doc', 'docx', 'rtf', 'odt', 'pages', 'txt', 'md', 'xls', 'xlsx', 'csv', 'numbers', 'ods', 'ppt', 'pptx', 'key', 'odp', 'epub'],
+  archive: ['zip', 'tar', 'gz', 'tgz', 'bz2', 'xz', '7z', 'rar', 'dmg', 'iso', 'zst'],
+  code: ['js', 'jsx', 'ts', 'tsx', 'mjs', 'cjs', 'py', 'rb', 'go', 'rs', 'java', 'kt', 'swift', 'c', 'h', 'cc', 'cpp', 'hpp', 'm', 'cs', 'php', 'sh', 'json', 'yaml', 'yml', 'toml', 'html', 'css', 'scss', 'sql'],
+};
+
+const FILTER_TOKEN_REGEX = /^(ext|kind|modified|size):(.+)$/i;
+const RELATIVE_AGE_REGEX = /^(<=?|>=?)?(\d+(?:\.\d+)?)(h|d|w|mo|m|y)$/;
+const ABSOLUTE_DATE_REGEX = /^(<=?|>=?)?(\d{4}-\d{2}-\d{2})$/;
+const SIZE_REGEX = /^(<=?|>=?)?(\d+(?:\.\d+)?)(b|kb|mb|gb|tb)?$/;
+const MAX_EXTENSION_LENGTH = 16;
+
+const DAY_MS = 24 * 60 * 60 * 1000;
+const AGE_UNIT_MS: Record<string, number> = {
+  h: 60 * 60 * 1000,
+  d: DAY_MS,
+  w: 7 * DAY_MS,
+  m: 30 * DAY_MS,
+  mo: 30 * DAY_MS,
+  y: 365 * DAY_MS,
+};
+const SIZE_UNIT_BYTES: Record<string, number> = {
+  b: 1,
+  kb: 1024,
+  mb: 1024 ** 2,
+  gb: 1024 ** 3,
+  tb: 1024 ** 4,
+};
+
+// Sizes are kept as quarter-doubling buckets in one byte (about 19% wide), so
+// a size filter is exact only to within one bucket of its bound. Bucket 0 is
+// an empty file; SIZE_BUCKET_UNKNOWN marks directories and unread entries.
+const SIZE_BUCKETS_PER_DOUBLING = 4;
+const MAX_SIZE_BUCKET = 254;
+export const SIZE_BUCKET_UNKNOWN = 255;
+
+export function getSizeBucket(size: number): number {
+  if (!Number.isFinite(size) || size < 1) return 0;
+  return Math.min(MAX_SIZE_BUCKET, 1 + Math.floor(Math.log2(size) * SIZE_BUCKETS_PER_DOUBLING));
+}
+
+// Lowercased extension of a file name, or '' for names without one (including
+// dotfiles such as `.bashrc`).
+export function getFileNameExtension(name: string): string {
+  const dotIndex = name.lastIndexOf('.');
+  if (dotIndex <= 0 || dotIndex === name.length - 1) return '';
+  const extension = name.slice(dotIndex + 1).toLowerCase();
+  return extension.length <= MAX_EXTENSION_LENGTH ? extension : '';
+}
+
+export function getKindExtensions(kind: FileSearchKindFilter): string[] {
+  return kind === 'folder' || kind === 'file' ? [] : KIND_EXTENSIONS[kind];
+}
+
+export function isFileSearchFilterToken(token: string): boolean {
+  return FILTER_TOKEN_REGEX.test(token);
+}
+
+function parseKind(value: string): FileSearchKindFilter | null {
+  if (value === 'folder' || value === 'folders' || value === 'directory' || value === 'dir') return 'folder';
+  if (value === 'file' || value === 'files') return 'file';
+  const singular = value.endsWith('s') ? value.slice(0, -1) : value;
+  return singular in KIND_EXTENSIONS ? singular as FileSearchKindFilter : null;
+}
+
+function applyModifiedFilter(filters: FileSearchFilters, value: string, now: number): boolean {
+  const relative = RELATIVE_AGE_REGEX.exec(value);
+  if (relative) {
+    const threshold = now - Number(relative[2]) * AGE_UNIT_MS[relative[3]];
+    // `<7d` reads as "less than 7 days ago", i.e. newer than the threshold.
+    if (!relative[1] || relative[1].startsWith('<')) {
+      filters.modifiedAfterMs = Math.max(filters.modifiedAfterMs ?? -Infinity, threshold);
+    } else {
+      filters.modifiedBeforeMs = Math.min(filters.modifiedBeforeMs ?? Infinity, threshold);
+    }
+    return true;
+  }
+  const absolute = ABSOLUTE_DATE_REGEX.exec(value);
+  if (absolute) {
+    const [year, month, day] = absolute[2].split('-').map(Number);
+    const dayStart = new Date(year, month - 1, day).getTime();
+    if (!Number.isFinite(dayStart)) return false;
+    const operator = absolute[1] || '';
+    if (operator === '' || operator.startsWith('>')) {
+      const from = operator === '>' ? dayStart + DAY_MS : dayStart;
+      filters.modifiedAfterMs = Math.max(filters.modifiedAfterMs ?? -Infinity, from);
+    }
+    if (operator === '' || operator.startsWith('<')) {
+      const until = operator === '<' ? dayStart - 1 : dayStart + DAY_MS - 1;
+      filters.modifiedBeforeMs = Math.min(filters.modifiedBeforeMs ?? Infinity, until);
+    }
+    return true;
+  }
+  return false;
+}
+
+function applySizeFilter(filters: FileSearchFilters, value: string): boolean {
+  const match = SIZE_REGEX.exec(value);
+  if (!match) return false;
+  const bytes = Number(match[2]) * SIZE_UNIT_BYTES[match[3] || 'b'];
+  if (!Number.isFinite(bytes)) return false;
+  if (match[1] && match[1].startsWith('<')) {
+    filters.maxSize = Math.min(filters.maxSize ?? Infinity, bytes);
+  } else {
+    // `size:100mb` without an operator means at least that big.
+    filters.minSize = Math.max(filters.minSize ?? 0, bytes);
+  }
+  return true;
+}
+
+// Splits filter tokens out of `rawQuery`. Returns null filters when the query
+// has none, so plain queries take the unfiltered paths unchanged.
+export function parseFileSearchFilters(
+  rawQuery: string,
+  now = Date.now()
+): { text: string; filters: FileSearchFilters | null } {
+  const tokens = String(rawQuery || '').trim().split(/\s+/);
+  const filters: FileSearchFilters = {
+    extensions: null,
+    kinds: null,
+    modifiedAfterMs: null,
+    modifiedBeforeMs: null,
+    minSize: null,
+    maxSize: null,
+  };
+  const textTokens: string[] = [];
+  let hasFilter = false;
+
+  for (const token of tokens) {
+    const match = FILTER_TOKEN_REGEX.exec(token);
+    if (!match) {
+      if (token) textTokens.push(token);
+      continue;
+    }
+    const facet = match[1].toLowerCase();
+    const value = match[2].toLowerCase();
+    if (facet === 'ext') {
+      const extensions = value.split(',').map((part) => part.replace(/^\*?\./, '')).filter(Boolean);
+      if (extensions.length === 0) continue;
+      filters.extensions = [...(filters.extensions || []), ...extensions];
+      hasFilter = true;
+    } else if (facet === 'kind') {
+      const kinds = value.split(',').map(parseKind).filter((kind): kind is FileSearchKindFilter => kind !== null);
+      if (kinds.length === 0) continue;
+      filters.kinds = [...(filters.kinds || []), ...kinds];
+      hasFilter = true;
+    } else if (facet === 'modified') {
+      if (applyModifiedFilter(filters, value, now)) hasFilter = true;
+    } else if (facet === 'size') {
+      if (applySizeFilter(filters, value)) hasFilter = true;
+    }
+  }
+
+  return { text: textTokens.join(' '), filters: hasFilter ? filters : null };
+}
@@ -0,0 +1,298 @@
+import * as fs from 'fs';
+import * as path from 'path';
+
+// `.gitignore` / `.ignore` support for the file search index, so build
+// outputs a project only declares in its ignore files stay out of the index.
+//
+// Each directory with ignore files gets an IgnoreRules level chained to its
+// parent's, and the walk checks every entry against the chain of the directory
+// being listed. As in git, the deepest level with a matching rule decides and,
+// within a level, the last matching rule wins (`.ignore` is read after
+// `.gitignore`, so it overrides it). Ignored directories are never descended
+// into, so nothing below them can be re-included.
+//
+// Ignore files directly in the home folder, when it is an index root, are not
+// read: a home directory kept under git commonly ignores `*`. Any other root
+// (a project added as an extra root, say) honors its own.
+//
+// Rules compile to plain name sets and suffix lists where possible, leaving a
+// RegExp only for real globs, so checking a directory entry is a few hash
+// lookups per level.
+
+export const IGNORE_FILE_NAMES = ['.gitignore', '.ignore'] as const;
+
+const CASE_INSENSITIVE = process.platform === 'darwin' || process.platform === 'win32';
+const MAX_IGNORE_FILE_BYTES = 256 * 1024;
+const GLOB_SPECIAL_REGEX = /[*?[\\]/;
+
+type IgnoreRule = {
+  negated: boolean;
+  directoryOnly: boolean;
+  // Matched against the path relative to the rule's directory rather than the
+  // entry name, because the pattern contains a slash.
+  anchored: boolean;
+  // Exactly one of these is set.
+  literal: string | null;
+  suffix: string | null;
+  regex: RegExp | null;
+};
+
+function foldCase(value: string): string {
+  return CASE_INSENSITIVE ? value.toLowerCase() : value;
+}
+
+function escapeRegex(value: string): string {
+  return value.replace(/[.*+?^${}()|[\]\\]/g, '\\$&');
+}
+
+function globToRegexSource(glob: string): string {
+  let source = '';
+  for (let index = 0; index < glob.length; index += 1) {
+    const char = glob[index];
+    if (char === '*') {
+      if (glob[index + 1] === '*' && (index === 0 || glob[index - 1] === '/')) {
+        // `**/` matches any number of directories and a trailing `/**`
+        // everything inside; other double stars behave like one.
+        if (glob[index + 2] === '/') {
+          source += '(?:.*/)?';
+          index += 2;
+          continue;
+        }
+        if (index + 2 === glob.length) {
+          source += '.*';
+          index += 1;
+          continue;
+        }
+      }
+      while (glob[index + 1] === '*') index += 1;
+      source += '[^/]*';
+    } else if (char === '?') {
+      source += '[^/]';
+    } else if (char === '[') {
+      // A `]` right after the bracket (or `!`) is part of the set.
+      let end = index + 1;
+      if (glob[end] === '!' || glob[end] === '^') end += 1;
+      if (glob[end] === ']') end += 1;
+      end = glob.indexOf(']', end);
+      if (end < 0) {
+        source += '\\[';
+        continue;
+      }
+      let body = glob.slice(index + 1, end);
+      const negated = body.startsWith('!') || body.startsWith('^');
+      if (negated) body = body.slice(1);
+      source += `[${negated ? '^' : ''}${body.replace(/[\\\]^[]/g, '\\$&')}]`;
+      index = end;
+    } else if (char === '\\' && index + 1 < glob.length) {
+      index += 1;
+      source += escapeRegex(glob[index]);
+    } else {
+      source += escapeRegex(char);
+    }
+  }
+  return source;
+}
+
+function compileIgnoreRule(line: string): IgnoreRule | null {
+  let pattern = line;
+  // Trailing spaces are dropped unless escaped with a backslash.
+  while (pattern.endsWith(' ') && !pattern.endsWith('\\ ')) pattern = pattern.slice(0, -1);
+  if (!pattern || pattern.startsWith('#')) return null;
+
+  let negated = false;
+  if (pattern.startsWith('!')) {
+    negated = true;
+    pattern = pattern.slice(1);
+  } else if (pattern.startsWith('\\!') || pattern.startsWith('\\#')) {
+    pattern = pattern.slice(1);
+  }
+  let directoryOnly = false;
+  if (pattern.endsWith('/')) {
+    directoryOnly = true;
+    pattern = pattern.slice(0, -1);
+  }
+  // `**/name` is the same as a bare `name`.
+  while (pattern.startsWith('**/') && !pattern.slice(3).includes('/')) pattern = pattern.slice(3);
+  const anchored = pattern.includes('/');
+  if (pattern.startsWith('/')) pattern = pattern.slice(1);
+  if (!pattern || pattern === '**') return null;
+
+  const rule: IgnoreRule = { negated, directoryOnly, anchored, literal: null, suffix: null, regex: null };
+  if (!GLOB_SPECIAL_REGEX.test(pattern)) {
+    rule.literal = foldCase(pattern);
+  } else if (!anchored && pattern.startsWith('*') && !GLOB_SPECIAL_REGEX.test(pattern.slice(1))) {
+    rule.suffix = foldCase(pattern.slice(1));
+  } else {
+    rule.regex = new RegExp(`^${globToRegexSource(pattern)}$`, CASE_INSENSITIVE ? 'i' : '');
+  }
+  return rule;
+}
+
+function ruleMatches(rule: IgnoreRule, name: string, getRelativePath: () => string, isDirectory: boolean): boolean {
+  if (rule.directoryOnly && !isDirectory) return false;
+  const subject = rule.anchored ? getRelativePath() : name;
+  if (rule.literal !== null) return foldCase(subject) === rule.literal;
+  if (rule.suffix !== null) return foldCase(subject).endsWith(rule.suffix);
+  return (rule.regex as RegExp).test(subject);
+}
+
+export class IgnoreRules {
+  readonly baseDir: string;
+  readonly parent: IgnoreRules | null;
+  private readonly rules: IgnoreRule[];
+  // Without negations the order of rules does not matter, so bare names are
+  // looked up in sets and only the remaining rules are scanned.
+  private readonly hasNegation: boolean;
+  private readonly names = new Set<string>();
+  private readonly directoryNames = new Set<string>();
+  private readonly scannedRules: IgnoreRule[] = [];
+
+  private constructor(baseDir: string, rules: IgnoreRule[], parent: IgnoreRules | null) {
+    this.baseDir = baseDir;
+    this.parent = parent;
+    this.rules = rules;
+    this.hasNegation = rules.some((rule) => rule.negated);
+    for (const rule of rules) {
+      if (!this.hasNegation && rule.literal !== null && !rule.anchored) {
+        (rule.directoryOnly ? this.directoryNames : this.names).add(rule.literal);
+      } else {
+        this.scannedRules.push(rule);
+      }
+    }
+  }
+
+  // The level for `baseDir`, or `parent` itself when the sources hold no rules.
+  static compile(baseDir: string, sources: string[], parent: IgnoreRules | null): IgnoreRules | null {
+    const rules: IgnoreRule[] = [];
+    for (const source of sources) {
+      for (const line of source.split(/\r?\n/)) {
+        const rule = compileIgnoreRule(line);
+        if (rule) rules.push(rule);
+      }
+    }
+    return rules.length > 0 ? new IgnoreRules(baseDir, rules, parent) : parent;
+  }
+
+  // Whether an entry of a directory covered by this chain is ignored.
+  isIgnored(absolutePath: string, name: string, isDirectory: boolean): boolean {
+    for (let level: IgnoreRules | null = this; level; level = level.parent) {
+      const verdict = level.match(absolutePath, name, isDirectory);
+      if (verdict !== null) return verdict;
+    }
+    return false;
+  }
+
+  // True or false when a rule of this level decides, null otherwise.
+  private match(absolutePath: string, name: string, isDirectory: boolean): boolean | null {
+    let relativePath: string | null = null;
+    const getRelativePath = () => {
+      if (relativePath === null) {
+        relativePath = absolutePath.slice(this.baseDir.length + 1);
+        if (path.sep !== '/') relativePath = relativePath.split(path.sep).join('/');
+      }
+      return relativePath;
+    };
+
+    if (!this.hasNegation) {
+      const foldedName = foldCase(name);
+      if (this.names.has(foldedName) || (isDirectory && this.directoryNames.has(foldedName))) return true;
+      for (const rule of this.scannedRules) {
+        if (ruleMatches(rule, name, getRelativePath, isDirectory)) return true;
+      }
+      return null;
+    }
+    for (let index = this.rules.length - 1; index >= 0; index -= 1) {
+      const rule = this.rules[index];
+      if (ruleMatches(rule, name, getRelativePath, isDirectory)) return !rule.negated;
+    }
+    return null;
+  }
+}
+
+// Reads the ignore files of `dirPath` and chains them onto `parent`. When the
+// directory's listing is at hand, pass its names so absent files are not
+// opened at all.
+export async function loadDirectoryIgnoreRules(
+  dirPath: string,
+  parent: IgnoreRules | null,
+  listedNames?: readonly string[] | null
+): Promise<IgnoreRules | null> {
+  const fileNames = listedNames
+    ? IGNORE_FILE_NAMES.filter((fileName) => listedNames.indexOf(fileName) >= 0)
+    : IGNORE_FILE_NAMES;
+  if (fileNames.length === 0) return parent;
+  const sources = await Promise.all(fileNames.map(async (fileName) => {
+    try {
+      const filePath = path.join(dirPath, fileName);
+      const stats = await fs.promises.stat(filePath);
+      if (!stats.isFile() || stats.size > MAX_IGNORE_FILE_BYTES) return '';
+      return await fs.promises.readFile(filePath, 'utf8');
+    } catch {
+      return '';
+    }
+  }));
+  return IgnoreRules.compile(dirPath, sources, parent);
+}
+
+export function isIgnoreFileName(name: string): boolean {
+  return (IGNORE_FILE_NAMES as readonly string[]).indexOf(name) >= 0;
+}
+
+// Rule chains for arbitrary paths under one index root, loaded on demand and
+// kept for the lifetime of the cache (one watch batch), for callers that see
+// paths out of walk order.
+export class IgnoreRulesCache {
+  private readonly rootPath: string;
+  private readonly readsRootIgnoreFiles: boolean;
+  // Which ignore files `dirPath` is known to contain, or null when unknown.
+  private readonly listIgnoreFiles: (dirPath: string) => string[] | null;
+  private readonly rulesByDirectory = new Map<string, Promise<IgnoreRules | null>>();
+  private readonly ignoredByDirectory = new Map<string, Promise<boolean>>();
+
+  constructor(rootPath: string, readsRootIgnoreFiles: boolean, listIgnoreFiles?: (dirPath: string) => string[] | null) {
+    this.rootPath = rootPath;
+    this.readsRootIgnoreFiles = readsRootIgnoreFiles;
+    this.listIgnoreFiles = listIgnoreFiles || (() => null);
+  }
+
+  // The chain that applies to entries of `dirPath`, including its own files.
+  getRules(dirPath: string): Promise<IgnoreRules | null> {
+    let rules = this.rulesByDirectory.get(dirPath);
+    if (!rules) {
+      rules = this.loadRules(dirPath);
+      this.rulesByDirectory.set(dirPath, rules);
+    }
+    return rules;
+  }
+
+  // Whether `absolutePath`, or any directory between it and the root, is ignored.
+  async isIgnored(absolutePath: string, isDirectory: boolean): Promise<boolean> {
+    if (!this.isBelowRoot(absolutePath)) return false;
+    const parentPath = path.dirname(absolutePath);
+    if (await this.isDirectoryIgnored(parentPath)) return true;
+    const rules = await this.getRules(parentPath);
+    return Boolean(rules && rules.isIgnored(absolutePath, path.basename(absolutePath), isDirectory));
+  }
+
+  private isBelowRoot(candidatePath: string): boolean {
+    return candidatePath.startsWith(`${this.rootPath}${path.sep}`);
+  }
+
+  private async loadRules(dirPath: string): Promise<IgnoreRules | null> {
+    if (dirPath === this.rootPath) {
+      return this.readsRootIgnoreFiles ? loadDirectoryIgnoreRules(dirPath, null, this.listIgnoreFiles(dirPath)) : null;
+    }
+    if (!this.isBelowRoot(dirPath)) return null;
+    const parent = await this.getRules(path.dirname(dirPath));
+    return loadDirectoryIgnoreRules(dirPath, parent, this.listIgnoreFiles(dirPath));
+  }
+
+  private isDirectoryIgnored(dirPath: string): Promise<boolean> {
+    let ignored = this.ignoredByDirectory.get(dirPath);
+    if (!ignored) {
+      ignored = this.isBelowRoot(dirPath) ? this.isIgnored(dirPath, true) : Promise.resolve(false);
+      this.ignoredByDirectory.set(dirPath, ignored);
+    }
+    return ignored;
+  }
+}
@@ -0,0 +1,279 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { yieldToEventLoop } from './file-search-index-engine';
+
+// Linux watcher backend for the file search index. Recursive fs.watch is
+// emulated on Linux and silently drops events under load, so this registers
+// one inotify watch per indexed directory through the native file_watcher
+// addon and turns events into changed paths. When the kernel queue overflows
+// (IN_Q_OVERFLOW) the subtree that was busy at the time is reported for a
+// targeted rescan. Files edited in place arrive as IN_CLOSE_WRITE or
+// IN_ATTRIB and are reported like any other change.
+
+type InotifyEvent = { wd: number; mask: number; cookie: number; name: string };
+
+type NativeInotifyWatcher = {
+  add(dirPath: string): number;
+  remove(wd: number): boolean;
+  close(): void;
+};
+
+type FileWatcherAddon = {
+  // The callback gets null once the inotify descriptor fails.
+  InotifyWatcher: new (onEvents: (events: InotifyEvent[] | null) => void) => NativeInotifyWatcher;
+  constants: {
+    IN_MOVED_FROM: number;
+    IN_MOVED_TO: number;
+    IN_CREATE: number;
+    IN_DELETE: number;
+    IN_CLOSE_WRITE: number;
+    IN_ATTRIB: number;
+    IN_DELETE_SELF: number;
+    IN_MOVE_SELF: number;
+    IN_Q_OVERFLOW: number;
+    IN_IGNORED: number;
+    IN_ISDIR: number;
+    ENOSPC: number;
+  };
+};
+
+export type InotifyTreeWatcherOptions = {
+  shouldWatchDirectory: (dirPath: string, name: string) => boolean;
+  onChange: (absolutePath: string) => void;
+  onOverflow: (subtreePath: string) => void;
+  // The watcher has stopped for good; the caller should watch another way.
+  onLost: () => void;
+};
+
+const WATCH_REGISTRATION_YIELD_EVERY = 256;
+// Directories with events this recent count as busy when the queue overflows.
+const OVERFLOW_BUSY_WINDOW_MS = 5_000;
+const MAX_TRACKED_BUSY_DIRECTORIES = 4_096;
+
+let fileWatcherAddon: FileWatcherAddon | null = null;
+let fileWatcherAddonLoaded = false;
+
+function loadFileWatcherAddon(): FileWatcherAddon | null {
+  if (fileWatcherAddonLoaded) return fileWatcherAddon;
+  fileWatcherAddonLoaded = true;
+  if (process.platform !== 'linux') return null;
+  try {
+    fileWatcherAddon = require(path.join(__dirname, '..', 'native', 'file_watcher.node'));
+  } catch (error: any) {
+    console.warn('[FileIndex] inotify addon unavailable:', error?.message);
+    fileWatcherAddon = null;
+  }
+  return fileWatcherAddon;
+}
+
+function isSameOrDescendant(candidatePath: string, ancestorPath: string): boolean {
+  return candidatePath === ancestorPath || candidatePath.startsWith(`${ancestorPath}${path.sep}`);
+}
+
+export class InotifyTreeWatcher {
+  private readonly rootDir: string;
+  private readonly options: InotifyTreeWatcherOptions;
+  private addon: FileWatcherAddon | null = null;
+  private native: NativeInotifyWatcher | null = null;
+  private readonly pathByWatch = new Map<number, string>();
+  private readonly watchByPath = new Map<string, number>();
+  // Watched directories by parent path, so removing a subtree visits only the
+  // watches inside it.
+  private readonly watchedChildrenByPath = new Map<string, Set<string>>();
+  private readonly lastEventAtByDirectory = new Map<string, number>();
+  private watchLimitReached = false;
+
+  constructor(rootDir: string, options: InotifyTreeWatcherOptions) {
+    this.rootDir = rootDir;
+    this.options = options;
+  }
+
+  // False when inotify is unavailable, so the caller can fall back to fs.watch.
+  start(): boolean {
+    const addon = loadFileWatcherAddon();
+    if (!addon) return false;
+    try {
+      this.native = new addon.InotifyWatcher((events) => this.handleEvents(events));
+    } catch (error) {
+      console.warn('[FileIndex] failed to create inotify watcher:', error);
+      return false;
+    }
+    this.addon = addon;
+    if (!this.addWatch(this.rootDir)) {
+      this.close();
+      return false;
+    }
+    void this.watchSubtree(this.rootDir);
+    return true;
+  }
+
+  close(): void {
+    const native = this.native;
+    this.native = null;
+    this.pathByWatch.clear();
+    this.watchByPath.clear();
+    this.watchedChildrenByPath.clear();
+    this.lastEventAtByDirectory.clear();
+    if (!native) return;
+    try {
+      native.close();
+    } catch {}
+  }
+
+  get watchCount(): number {
+    return this.watchByPath.size;
+  }
+
+  private addWatch(dirPath: string): boolean {
+    if (!this.native || !this.addon) return false;
+    const wd = this.native.add(dirPath);
+    if (wd < 0) {
+      if (-wd === this.addon.constants.ENOSPC && !this.watchLimitReached) {
+        this.watchLimitReached = true;
+        console.warn(
+          `[FileIndex] inotify watch limit reached after ${this.watchByPath.size} directories; ` +
+          'raise fs.inotify.max_user_watches to watch the rest'
+        );
+      }
+      return false;
+    }
+    // Re-adding a watched directory returns its existing descriptor.
+    this.pathByWatch.set(wd, dirPath);
+    this.watchByPath.set(dirPath, wd);
+    const parentPath = path.dirname(dirPath);
+    let siblings = this.watchedChildrenByPath.get(parentPath);
+    if (!siblings) {
+      siblings = new Set();
+      this.watchedChildrenByPath.set(parentPath, siblings);
+    }
+    siblings.add(dirPath);
+    return true;
+  }
+
+  private unlinkWatchedPath(dirPath: string): void {
+    const parentPath = path.dirname(dirPath);
+    const siblings = this.watchedChildrenByPath.get(parentPath);
+    if (!siblings) return;
+    siblings.delete(dirPath);
+    if (siblings.size === 0) this.watchedChildrenByPath.delete(parentPath);
+  }
+
+  private async watchSubtree(dirPath: string): Promise<void> {
+    const queue = [dirPath];
+    let registered = 0;
+    for (let index = 0; index < queue.length; index += 1) {
+      if (!this.native || this.watchLimitReached) return;
+      let dirents: fs.Dirent[] = [];
+      try {
+        dirents = await fs.promises.readdir(queue[index], { withFileTypes: true });
+      } catch {
+        continue;
+      }
+      for (const dirent of dirents) {
+        if (!dirent.isDirectory()) continue;
+        const childPath = path.join(queue[index], dirent.name);
+        if (!this.options.shouldWatchDirectory(childPath, dirent.name)) continue;
+        if (!this.addWatch(childPath)) continue;
+        queue.push(childPath);
+        registered += 1;
+        if (registered % WATCH_REGISTRATION_YIELD_EVERY === 0) await yieldToEventLoop();
+      }
+    }
+  }
+
+  private unwatchSubtree(dirPath: string): void {
+    this.unlinkWatchedPath(dirPath);
+    const stack = [dirPath];
+    while (stack.length > 0) {
+      const watchedPath = stack.pop() as string;
+      const children = this.watchedChildrenByPath.get(watchedPath);
+      if (children) {
+        for (const childPath of children) stack.push(childPath);
+        this.watchedChildrenByPath.delete(watchedPath);
+      }
+      const wd = this.watchByPath.get(watchedPath);
+      if (wd === undefined) continue;
+      this.watchByPath.delete(watchedPath);
+      this.pathByWatch.delete(wd);
+      try {
+        this.native?.remove(wd);
+      } catch {}
+    }
+  }
+
+  private forgetWatch(wd: number): void {
+    const watchedPath = this.pathByWatch.get(wd);
+    this.pathByWatch.delete(wd);
+    if (watchedPath !== undefined && this.watchByPath.get(watchedPath) === wd) {
+      this.watchByPath.delete(watchedPath);
+      this.unlinkWatchedPath(watchedPath);
+    }
+  }
+
+  private handleEvents(events: InotifyEvent[] | null): void {
+    if (!this.native || !this.addon) return;
+    if (events === null) {
+      console.warn(`[FileIndex] inotify descriptor failed for ${this.rootDir}`);
+      this.close();
+      this.options.onLost();
+      return;
+    }
+    const constants = this.addon.constants;
+    const now = Date.now();
+    for (const event of events) {
+      if ((event.mask & constants.IN_Q_OVERFLOW) !== 0) {
+        const subtreePath = this.getBusySubtree(now);
+        this.lastEventAtByDirectory.clear();
+        // Directories created while events were being dropped have no watch yet.
+        void this.watchSubtree(subtreePath);
+        this.options.onOverflow(subtreePath);
+        continue;
+      }
+      if ((event.mask & constants.IN_IGNORED) !== 0) {
+        this.forgetWatch(event.wd);
+        continue;
+      }
+      const dirPath = this.pathByWatch.get(event.wd);
+      // Self events are mirrored by the parent's entry event.
+      if (dirPath === undefined || !event.name) continue;
+
+      const absolutePath = path.join(dirPath, event.name);
+      this.noteDirectoryEvent(dirPath, now);
+      if ((event.mask & constants.IN_ISDIR) !== 0) {
+        if ((event.mask & (constants.IN_CREATE | constants.IN_MOVED_TO)) !== 0) {
+          if (this.options.shouldWatchDirectory(absolutePath, event.name) && this.addWatch(absolutePath)) {
+            void this.watchSubtree(absolutePath);
+          }
+        } else if ((event.mask & (constants.IN_DELETE | constants.IN_MOVED_FROM)) !== 0) {
+          this.unwatchSubtree(absolutePath);
+        }
+      }
+      this.options.onChange(absolutePath);
+    }
+  }
+
+  private noteDirectoryEvent(dirPath: string, now: number): void {
+    this.lastEventAtByDirectory.delete(dirPath);
+    this.lastEventAtByDirectory.set(dirPath, now);
+    if (this.lastEventAtByDirectory.size <= MAX_TRACKED_BUSY_DIRECTORIES) return;
+    const oldest = this.lastEventAtByDirectory.keys().next().value;
+    if (oldest !== undefined) this.lastEventAtByDirectory.delete(oldest);
+  }
+
+  // Deepest common ancestor of the recently active directories; the whole
+  // tree when nothing was active.
+  private getBusySubtree(now: number): string {
+    let subtreePath: string | null = null;
+    for (const [dirPath, lastEventAt] of this.lastEventAtByDirectory) {
+      if (now - lastEventAt > OVERFLOW_BUSY_WINDOW_MS) continue;
+      if (subtreePath === null) {
+        subtreePath = dirPath;
+        continue;
+      }
+      while (!isSameOrDescendant(dirPath, subtreePath) && subtreePath !== this.rootDir) {
+        subtreePath = path.dirname(subtreePath);
+      }
+    }
+    return subtreePath === null || !isSameOrDescendant(subtreePath, this.rootDir) ? this.rootDir : subtreePath;
+  }
+}
@@ -0,0 +1,413 @@
+import * as fs from 'fs';
+import * as path from 'path';
+
+// On-disk snapshot of the file search index so a fresh launch can answer
+// queries from the previous session while a background reconcile catches up.
+//
+// Layout (little endian):
+//   magic 'SCFI' | u32 version | f64 builtAt | u32 flags | str homeDir
+//   u32 rootCount   | str root * rootCount
+//   u32 stringCount | str value * stringCount
+//   u32 entryCount  | u32 nameId[] | u32 normalizedNameId[] | i32 parentRef[] | u8 entryFlags[]
+//   u32 extensionId[] | u8 sizeBucket[] | u32 mtimeSeconds[]
+//   posting section for name/path prefixes, then one for path trigrams, each
+//   u32 offsetCount | u32 offset[] | u32 postingCount | u32 posting[]
+// where `str` is a u32 byte length followed by UTF-8 bytes. Typed sections are
+// padded to 4-byte alignment and stored in host byte order (every platform we
+// ship on is little endian), so they decode as views over the file buffer.
+//
+// The opt-in content index lives in its own file with the same primitives:
+//   magic 'SCCI' | u32 version | f64 builtAt | u32 rootCount | str root * rootCount
+//   u32 documentCount | str path * documentCount | f64 mtimeMs[] | f64 size[] | u8 documentFlags[]
+//   u32 termCount | str term * termCount | posting section keyed by term id
+// Float64 sections are padded to 8 bytes instead of 4.
+
+const SNAPSHOT_MAGIC = 0x49464353; // 'SCFI'
+export const FILE_SEARCH_SNAPSHOT_VERSION = 5;
+const CONTENT_INDEX_MAGIC = 0x49434353; // 'SCCI'
+export const FILE_SEARCH_CONTENT_INDEX_VERSION = 1;
+
+const SNAPSHOT_FLAG_PROTECTED_ROOTS = 1 << 0;
+// Extension id of folders and names without an extension.
+const NO_EXTENSION_ID = 0xffffffff;
+
+export type PersistedIndexSnapshot = {
+  homeDir: string;
+  includeProtectedHomeRoots: boolean;
+  builtAt: number;
+  roots: string[];
+  strings: readonly string[];
+  nameIds: Uint32Array;
+  normalizedNameIds: Uint32Array;
+  parentRefs: Int32Array;
+  entryFlags: Uint8Array;
+  extensionIds: Uint32Array;
+  sizeBuckets: Uint8Array;
+  mtimes: Uint32Array;
+  postingOffsets: Uint32Array;
+  postings: Uint32Array;
+  trigramOffsets: Uint32Array;
+  trigrams: Uint32Array;
+};
+
+export type PersistedContentIndex = {
+  builtAt: number;
+  roots: string[];
+  paths: readonly string[];
+  mtimes: Float64Array;
+  sizes: Float64Array;
+  documentFlags: Uint8Array;
+  terms: readonly string[];
+  postingOffsets: Uint32Array;
+  postings: Uint32Array;
+};
+
+type TypedArrayView = Uint8Array | Int32Array | Uint32Array | Float64Array;
+type TypedArrayViewConstructor<T extends TypedArrayView> = {
+  new (buffer: ArrayBufferLike, byteOffset: number, length: number): T;
+  readonly BYTES_PER_ELEMENT: number;
+};
+
+class SnapshotWriter {
+  private buffer = Buffer.allocUnsafe(1 << 20);
+  private offset = 0;
+
+  private ensure(extra: number): void {
+    if (this.offset + extra <= this.buffer.length) return;
+    let nextSize = this.buffer.length * 2;
+    while (nextSize < this.offset + extra) nextSize *= 2;
+    const next = Buffer.allocUnsafe(nextSize);
+    this.buffer.copy(next, 0, 0, this.offset);
+    this.buffer = next;
+  }
+
+  u8(value: number): void {
+    this.ensure(1);
+    this.buffer.writeUInt8(value, this.offset);
+    this.offset += 1;
+  }
+
+  u32(value: number): void {
+    this.ensure(4);
+    this.buffer.writeUInt32LE(value >>> 0, this.offset);
+    this.offset += 4;
+  }
+
+  f64(value: number): void {
+    this.ensure(8);
+    this.buffer.writeDoubleLE(value, this.offset);
+    this.offset += 8;
+  }
+
+  str(value: string): void {
+    const byteLength = Buffer.byteLength(value, 'utf8');
+    this.u32(byteLength);
+    this.ensure(byteLength);
+    this.buffer.write(value, this.offset, byteLength, 'utf8');
+    this.offset += byteLength;
+  }
+
+  align(alignment: number): void {
+    while (this.offset % alignment !== 0) this.u8(0);
+  }
+
+  typedArray(values: TypedArrayView): void {
+    this.align(Math.max(4, values.BYTES_PER_ELEMENT));
+    this.ensure(values.byteLength);
+    Buffer.from(values.buffer, values.byteOffset, values.byteLength).copy(this.buffer, this.offset);
+    this.offset += values.byteLength;
+  }
+
+  finish(): Buffer {
+    return this.buffer.subarray(0, this.offset);
+  }
+}
+
+class SnapshotReader {
+  private readonly buffer: Buffer;
+  private offset = 0;
+
+  constructor(buffer: Buffer) {
+    this.buffer = buffer;
+  }
+
+  private require(size: number): void {
+    if (this.offset + size > this.buffer.length) {
+      throw new Error('Truncated file search snapshot');
+    }
+  }
+
+  u8(): number {
+    this.require(1);
+    const value = this.buffer.readUInt8(this.offset);
+    this.offset += 1;
+    return value;
+  }
+
+  u32(): number {
+    this.require(4);
+    const value = this.buffer.readUInt32LE(this.offset);
+    this.offset += 4;
+    return value;
+  }
+
+  f64(): number {
+    this.require(8);
+    const value = this.buffer.readDoubleLE(this.offset);
+    this.offset += 8;
+    return value;
+  }
+
+  str(): string {
+    const byteLength = this.u32();
+    this.require(byteLength);
+    const value = this.buffer.toString('utf8', this.offset, this.offset + byteLength);
+    this.offset += byteLength;
+    return value;
+  }
+
+  align(alignment: number): void {
+    this.offset = Math.ceil(this.offset / alignment) * alignment;
+  }
+
+  typedArray<T extends TypedArrayView>(ArrayType: TypedArrayViewConstructor<T>, length: number): T {
+    this.align(Math.max(4, ArrayType.BYTES_PER_ELEMENT));
+    const byteLength = length * ArrayType.BYTES_PER_ELEMENT;
+    this.require(byteLength);
+    const start = this.buffer.byteOffset + this.offset;
+    this.offset += byteLength;
+    if (start % ArrayType.BYTES_PER_ELEMENT === 0) {
+      return new ArrayType(this.buffer.buffer, start, length);
+    }
+    // Unaligned backing buffer (pooled allocation): fall back to a copy.
+    return new ArrayType(this.buffer.buffer.slice(start, start + byteLength), 0, length);
+  }
+}
+
+export function encodeIndexSnapshot(snapshot: PersistedIndexSnapshot): Buffer {
+  const writer = new SnapshotWriter();
+  writer.u32(SNAPSHOT_MAGIC);
+  writer.u32(FILE_SEARCH_SNAPSHOT_VERSION);
+  writer.f64(snapshot.builtAt);
+  writer.u32(snapshot.includeProtectedHomeRoots ? SNAPSHOT_FLAG_PROTECTED_ROOTS : 0);
+  writer.str(snapshot.homeDir);
+
+  writer.u32(snapshot.roots.length);
+  for (const root of snapshot.roots) writer.str(root);
+
+  writer.u32(snapshot.strings.length);
+  for (const value of snapshot.strings) writer.str(value);
+
+  writer.u32(snapshot.nameIds.length);
+  writer.typedArray(snapshot.nameIds);
+  writer.typedArray(snapshot.normalizedNameIds);
+  writer.typedArray(snapshot.parentRefs);
+  writer.typedArray(snapshot.entryFlags);
+  writer.typedArray(snapshot.extensionIds);
+  writer.typedArray(snapshot.sizeBuckets);
+  writer.typedArray(snapshot.mtimes);
+
+  writePostingSection(writer, snapshot.postingOffsets, snapshot.postings);
+  writePostingSection(writer, snapshot.trigramOffsets, snapshot.trigrams);
+
+  return writer.finish();
+}
+
+function writePostingSection(writer: SnapshotWriter, offsets: Uint32Array, postings: Uint32Array): void {
+  writer.align(4);
+  writer.u32(offsets.length);
+  writer.typedArray(offsets);
+  writer.u32(postings.length);
+  writer.typedArray(postings);
+}
+
+function readPostingSection(
+  reader: SnapshotReader,
+  stringCount: number,
+  entryCount: number
+): { offsets: Uint32Array; postings: Uint32Array } {
+  reader.align(4);
+  const offsetCount = reader.u32();
+  const offsets = reader.typedArray(Uint32Array, offsetCount);
+  const postingCount = reader.u32();
+  const postings = reader.typedArray(Uint32Array, postingCount);
+  if (offsetCount > stringCount + 1 || (offsetCount > 0 && offsets[offsetCount - 1] !== postingCount)) {
+    throw new Error('Corrupt file search snapshot (posting offsets)');
+  }
+  for (let i = 1; i < offsetCount; i += 1) {
+    if (offsets[i] < offsets[i - 1]) {
+      throw new Error('Corrupt file search snapshot (posting offsets)');
+    }
+  }
+  for (let i = 0; i < postingCount; i += 1) {
+    if (postings[i] >= entryCount) {
+      throw new Error('Corrupt file search snapshot (entry id out of range)');
+    }
+  }
+  return { offsets, postings };
+}
+
+export function decodeIndexSnapshot(buffer: Buffer): PersistedIndexSnapshot {
+  const reader = new SnapshotReader(buffer);
+  if (reader.u32() !== SNAPSHOT_MAGIC) {
+    throw new Error('Not a file search snapshot');
+  }
+  const version = reader.u32();
+  if (version !== FILE_SEARCH_SNAPSHOT_VERSION) {
+    throw new Error(`Unsupported file search snapshot version ${version}`);
+  }
+  const builtAt = reader.f64();
+  const flags = reader.u32();
+  const homeDir = reader.str();
+
+  const rootCount = reader.u32();
+  const roots: string[] = new Array(rootCount);
+  for (let i = 0; i < rootCount; i += 1) roots[i] = reader.str();
+
+  const stringCount = reader.u32();
+  const strings: string[] = new Array(stringCount);
+  for (let i = 0; i < stringCount; i += 1) strings[i] = reader.str();
+
+  const entryCount = reader.u32();
+  const nameIds = reader.typedArray(Uint32Array, entryCount);
+  const normalizedNameIds = reader.typedArray(Uint32Array, entryCount);
+  const parentRefs = reader.typedArray(Int32Array, entryCount);
+  const entryFlags = reader.typedArray(Uint8Array, entryCount);
+  const extensionIds = reader.typedArray(Uint32Array, entryCount);
+  const sizeBuckets = reader.typedArray(Uint8Array, entryCount);
+  const mtimes = reader.typedArray(Uint32Array, entryCount);
+  for (let i = 0; i < entryCount; i += 1) {
+    if (nameIds[i] >= stringCount || normalizedNameIds[i] >= stringCount) {
+      throw new Error('Corrupt file search snapshot (string id out of range)');
+    }
+    if (extensionIds[i] >= stringCount && extensionIds[i] !== NO_EXTENSION_ID) {
+      throw new Error('Corrupt file search snapshot (string id out of range)');
+    }
+    // Parents are always indexed before their children.
+    if (parentRefs[i] >= i || parentRefs[i] < -rootCount) {
+      throw new Error('Corrupt file search snapshot (parent out of range)');
+    }
+  }
+
+  const prefixSection = readPostingSection(reader, stringCount, entryCount);
+  const trigramSection = readPostingSection(reader, stringCount, entryCount);
+
+  return {
+    homeDir,
+    includeProtectedHomeRoots: (flags & SNAPSHOT_FLAG_PROTECTED_ROOTS) !== 0,
+    builtAt,
+    roots,
+    strings,
+    nameIds,
+    normalizedNameIds,
+    parentRefs,
+    entryFlags,
+    extensionIds,
+    sizeBuckets,
+    mtimes,
+    postingOffsets: prefixSection.offsets,
+    postings: prefixSection.postings,
+    trigramOffsets: trigramSection.offsets,
+    trigrams: trigramSection.postings,
+  };
+}
+
+async function writeFileAtomically(filePath: string, encoded: Buffer): Promise<void> {
+  await fs.promises.mkdir(path.dirname(filePath), { recursive: true });
+  // Write-then-rename so a crash mid-write never leaves a torn snapshot behind.
+  const tempPath = `${filePath}.${process.pid}.tmp`;
+  await fs.promises.writeFile(tempPath, encoded);
+  await fs.promises.rename(tempPath, filePath);
+}
+
+export async function writeIndexSnapshotFile(filePath: string, snapshot: PersistedIndexSnapshot): Promise<void> {
+  await writeFileAtomically(filePath, encodeIndexSnapshot(snapshot));
+}
+
+export async function readIndexSnapshotFile(filePath: string): Promise<PersistedIndexSnapshot | null> {
+  let buffer: Buffer;
+  try {
+    buffer = await fs.promises.readFile(filePath);
+  } catch {
+    return null;
+  }
+  return decodeIndexSnapshot(buffer);
+}
+
+export function encodeContentIndex(index: PersistedContentIndex): Buffer {
+  const writer = new SnapshotWriter();
+  writer.u32(CONTENT_INDEX_MAGIC);
+  writer.u32(FILE_SEARCH_CONTENT_INDEX_VERSION);
+  writer.f64(index.builtAt);
+
+  writer.u32(index.roots.length);
+  for (const root of index.roots) writer.str(root);
+
+  writer.u32(index.paths.length);
+  for (const value of index.paths) writer.str(value);
+  writer.typedArray(index.mtimes);
+  writer.typedArray(index.sizes);
+  writer.typedArray(index.documentFlags);
+
+  writer.align(4);
+  writer.u32(index.terms.length);
+  for (const term of index.terms) writer.str(term);
+
+  writePostingSection(writer, index.postingOffsets, index.postings);
+  return writer.finish();
+}
+
+export function decodeContentIndex(buffer: Buffer): PersistedContentIndex {
+  const reader = new SnapshotReader(buffer);
+  if (reader.u32() !== CONTENT_INDEX_MAGIC) {
+    throw new Error('Not a file search content index');
+  }
+  const version = reader.u32();
+  if (version !== FILE_SEARCH_CONTENT_INDEX_VERSION) {
+    throw new Error(`Unsupported file search content index version ${version}`);
+  }
+  const builtAt = reader.f64();
+
+  const rootCount = reader.u32();
+  const roots: string[] = new Array(rootCount);
+  for (let i = 0; i < rootCount; i += 1) roots[i] = reader.str();
+
+  const documentCount = reader.u32();
+  const paths: string[] = new Array(documentCount);
+  for (let i = 0; i < documentCount; i += 1) paths[i] = reader.str();
+  const mtimes = reader.typedArray(Float64Array, documentCount);
+  const sizes = reader.typedArray(Float64Array, documentCount);
+  const documentFlags = reader.typedArray(Uint8Array, documentCount);
+
+  reader.align(4);
+  const termCount = reader.u32();
+  const terms: string[] = new Array(termCount);
+  for (let i = 0; i < termCount; i += 1) terms[i] = reader.str();
+
+  const section = readPostingSection(reader, termCount, documentCount);
+  return {
+    builtAt,
+    roots,
+    paths,
+    mtimes,
+    sizes,
+    documentFlags,
+    terms,
+    postingOffsets: section.offsets,
+    postings: section.postings,
+  };
+}
+
+export async function writeContentIndexFile(filePath: string, index: PersistedContentIndex): Promise<void> {
+  await writeFileAtomically(filePath, encodeContentIndex(index));
+}
+
+export async function readContentIndexFile(filePath: string): Promise<PersistedContentIndex | null> {
+  let buffer: Buffer;
+  try {
+    buffer = await fs.promises.readFile(filePath);
+  } catch {
+    return null;
+  }
+  return decodeContentIndex(buffer);
+}
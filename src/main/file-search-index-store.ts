@@ -0,0 +1,316 @@
+// Compact storage primitives for the file search index: growable typed-array
+// columns, a shared string intern table and sorted Uint32 posting lists.
+// Entry ids are only ever appended in increasing order, which keeps every
+// posting list sorted without an explicit sort step.
+
+type TypedArray = Uint8Array | Int32Array | Uint32Array | Float64Array;
+type TypedArrayConstructor<T extends TypedArray> = new (length: number) => T;
+
+const MIN_COLUMN_CAPACITY = 1024;
+// Pending (unsealed) postings are scanned linearly on lookup; past this many
+// pairs a lookup folds them into the sealed arrays first.
+const MAX_PENDING_POSTINGS_PER_LOOKUP = 16_384;
+const MIN_PENDING_POSTINGS_BEFORE_SEAL = 65_536;
+const EMPTY_POSTINGS = new Uint32Array(0);
+
+export class GrowableColumn<T extends TypedArray> {
+  private readonly ArrayType: TypedArrayConstructor<T>;
+  values: T;
+  length = 0;
+
+  constructor(ArrayType: TypedArrayConstructor<T>, initial?: T) {
+    this.ArrayType = ArrayType;
+    this.values = initial || new ArrayType(MIN_COLUMN_CAPACITY);
+    this.length = initial ? initial.length : 0;
+  }
+
+  push(value: number): number {
+    if (this.length === this.values.length) this.grow(this.length + 1);
+    this.values[this.length] = value;
+    this.length += 1;
+    return this.length - 1;
+  }
+
+  private grow(minCapacity: number): void {
+    const next = new this.ArrayType(Math.max(minCapacity, this.values.length * 2, MIN_COLUMN_CAPACITY));
+    next.set(this.values.subarray(0, this.length) as any);
+    this.values = next;
+  }
+
+  view(): T {
+    return this.values.subarray(0, this.length) as T;
+  }
+
+  trim(): void {
+    if (this.values.length === this.length) return;
+    const next = new this.ArrayType(this.length);
+    next.set(this.view() as any);
+    this.values = next;
+  }
+
+  get byteLength(): number {
+    return this.values.byteLength;
+  }
+}
+
+export function estimateStringBytes(value: string): number {
+  // V8 sequential one-byte string: 16-byte header, payload rounded to 8 bytes.
+  return 16 + Math.ceil(value.length / 8) * 8;
+}
+
+export class StringTable {
+  private readonly idByValue = new Map<string, number>();
+  private readonly values: string[] = [];
+
+  static fromValues(values: string[]): StringTable {
+    const table = new StringTable();
+    for (const value of values) table.intern(value);
+    return table;
+  }
+
+  get size(): number {
+    return this.values.length;
+  }
+
+  intern(value: string): number {
+    const existing = this.idByValue.get(value);
+    if (existing !== undefined) return existing;
+    const id = this.values.length;
+    this.values.push(value);
+    this.idByValue.set(value, id);
+    return id;
+  }
+
+  lookup(value: string): number {
+    const existing = this.idByValue.get(value);
+    return existing === undefined ? -1 : existing;
+  }
+
+  get(id: number): string {
+    return this.values[id] || '';
+  }
+
+  toArray(): readonly string[] {
+    return this.values;
+  }
+
+  estimateBytes(): number {
+    let bytes = this.values.length * 8 + this.idByValue.size * 24;
+    for (const value of this.values) bytes += estimateStringBytes(value);
+    return bytes;
+  }
+}
+
+// Posting lists keyed by interned string id, stored CSR-style: one Uint32Array
+// of entry ids plus per-key offsets. Additions land in a pending pair buffer
+// and are folded in by seal(), which is amortised by only sealing once the
+// pending buffer is a sizeable fraction of the sealed postings.
+export class PostingIndex {
+  private offsets: Uint32Array = new Uint32Array(1);
+  private postings: Uint32Array = EMPTY_POSTINGS;
+  private readonly pendingKeyIds = new GrowableColumn(Uint32Array);
+  private readonly pendingEntryIds = new GrowableColumn(Uint32Array);
+
+  static fromSealed(offsets: Uint32Array, postings: Uint32Array): PostingIndex {
+    const index = new PostingIndex();
+    index.offsets = offsets.length > 0 ? offsets : new Uint32Array(1);
+    index.postings = postings;
+    return index;
+  }
+
+  add(keyId: number, entryId: number): void {
+    this.pendingKeyIds.push(keyId);
+    this.pendingEntryIds.push(entryId);
+    if (this.pendingKeyIds.length >= Math.max(MIN_PENDING_POSTINGS_BEFORE_SEAL, this.postings.length / 4)) {
+      this.seal();
+    }
+  }
+
+  get(keyId: number): Uint32Array {
+    if (keyId < 0) return EMPTY_POSTINGS;
+    if (this.pendingKeyIds.length > MAX_PENDING_POSTINGS_PER_LOOKUP) this.seal();
+
+    const sealed = keyId + 1 < this.offsets.length
+      ? this.postings.subarray(this.offsets[keyId], this.offsets[keyId + 1])
+      : EMPTY_POSTINGS;
+    if (this.pendingKeyIds.length === 0) return sealed;
+
+    let extra: number[] | null = null;
+    const pendingKeys = this.pendingKeyIds.values;
+    const pendingIds = this.pendingEntryIds.values;
+    for (let i = 0; i < this.pendingKeyIds.length; i += 1) {
+      if (pendingKeys[i] !== keyId) continue;
+      if (!extra) extra = [];
+      extra.push(pendingIds[i]);
+    }
+    if (!extra) return sealed;
+    const merged = new Uint32Array(sealed.length + extra.length);
+    merged.set(sealed);
+    merged.set(extra, sealed.length);
+    return merged;
+  }
+
+  seal(): void {
+    const pendingCount = this.pendingKeyIds.length;
+    if (pendingCount === 0) return;
+    const pendingKeys = this.pendingKeyIds.values;
+    const pendingIds = this.pendingEntryIds.values;
+
+    let keyCapacity = this.offsets.length - 1;
+    for (let i = 0; i < pendingCount; i += 1) {
+      if (pendingKeys[i] + 1 > keyCapacity) keyCapacity = pendingKeys[i] + 1;
+    }
+
+    const nextOffsets = new Uint32Array(keyCapacity + 1);
+    const sealedKeyCount = this.offsets.length - 1;
+    for (let keyId = 0; keyId < sealedKeyCount; keyId += 1) {
+      nextOffsets[keyId + 1] = this.offsets[keyId + 1] - this.offsets[keyId];
+    }
+    for (let i = 0; i < pendingCount; i += 1) {
+      nextOffsets[pendingKeys[i] + 1] += 1;
+    }
+    for (let keyId = 0; keyId < keyCapacity; keyId += 1) {
+      nextOffsets[keyId + 1] += nextOffsets[keyId];
+    }
+
+    // Stable counting sort: sealed ids first, then pending ids in insertion
+    // order, so each list stays ascending.
+    const nextPostings = new Uint32Array(nextOffsets[keyCapacity]);
+    const cursors = nextOffsets.slice(0, keyCapacity);
+    for (let keyId = 0; keyId < sealedKeyCount; keyId += 1) {
+      const start = this.offsets[keyId];
+      const end = this.offsets[keyId + 1];
+      if (end === start) continue;
+      nextPostings.set(this.postings.subarray(start, end), cursors[keyId]);
+      cursors[keyId] += end - start;
+    }
+    for (let i = 0; i < pendingCount; i += 1) {
+      nextPostings[cursors[pendingKeys[i]]] = pendingIds[i];
+      cursors[pendingKeys[i]] += 1;
+    }
+
+    this.offsets = nextOffsets;
+    this.postings = nextPostings;
+    this.pendingKeyIds.length = 0;
+    this.pendingEntryIds.length = 0;
+    this.pendingKeyIds.trim();
+    this.pendingEntryIds.trim();
+  }
+
+  // Copy of the index under new key and entry numberings, where -1 drops a
+  // key or entry. Both remaps must preserve order so lists stay ascending.
+  remap(keyRemap: Int32Array, entryRemap: Int32Array, keyCount: number): PostingIndex {
+    this.seal();
+    const offsets = new Uint32Array(keyCount + 1);
+    const postings = new Uint32Array(this.postings.length);
+    let postingCount = 0;
+    let nextKeyId = 0;
+    for (let keyId = 0; keyId + 1 < this.offsets.length && keyId < keyRemap.length; keyId += 1) {
+      const nextId = keyRemap[keyId];
+      if (nextId < 0) continue;
+      while (nextKeyId <= nextId) {
+        offsets[nextKeyId] = postingCount;
+        nextKeyId += 1;
+      }
+      for (let i = this.offsets[keyId]; i < this.offsets[keyId + 1]; i += 1) {
+        const entryId = entryRemap[this.postings[i]];
+        if (entryId < 0) continue;
+        postings[postingCount] = entryId;
+        postingCount += 1;
+      }
+    }
+    while (nextKeyId <= keyCount) {
+      offsets[nextKeyId] = postingCount;
+      nextKeyId += 1;
+    }
+    return PostingIndex.fromSealed(offsets, postings.slice(0, postingCount));
+  }
+
+  // Sealed CSR arrays, for persistence.
+  sealedArrays(): { offsets: Uint32Array; postings: Uint32Array } {
+    this.seal();
+    return { offsets: this.offsets, postings: this.postings };
+  }
+
+  forEachKey(callback: (keyId: number, postingCount: number) => void): void {
+    this.seal();
+    for (let keyId = 0; keyId + 1 < this.offsets.length; keyId += 1) {
+      const postingCount = this.offsets[keyId + 1] - this.offsets[keyId];
+      if (postingCount > 0) callback(keyId, postingCount);
+    }
+  }
+
+  get keyCount(): number {
+    let count = 0;
+    for (let keyId = 0; keyId + 1 < this.offsets.length; keyId += 1) {
+      if (this.offsets[keyId + 1] > this.offsets[keyId]) count += 1;
+    }
+    return count;
+  }
+
+  get postingCount(): number {
+    return this.postings.length + this.pendingKeyIds.length;
+  }
+
+  get byteLength(): number {
+    return this.offsets.byteLength
+      + this.postings.byteLength
+      + this.pendingKeyIds.byteLength
+      + this.pendingEntryIds.byteLength;
+  }
+}
+
+// Keeps the `limit` best items under `compare` (negative when `a` ranks
+// first) in a bounded binary heap rooted at the worst kept item, so ranking n
+// candidates costs O(n log limit) rather than a full sort. `compare` must be
+// a total order for the result to be deterministic.
+export class TopKSelector<T> {
+  private readonly heap: T[] = [];
+  private readonly limit: number;
+  private readonly compare: (a: T, b: T) => number;
+
+  constructor(limit: number, compare: (a: T, b: T) => number) {
+    this.limit = Math.max(0, limit);
+    this.compare = compare;
+  }
+
+  get size(): number {
+    return this.heap.length;
+  }
+
+  push(item: T): void {
+    const heap = this.heap;
+    if (heap.length < this.limit) {
+      heap.push(item);
+      let index = heap.length - 1;
+      while (index > 0) {
+        const parent = (index - 1) >> 1;
+        if (this.compare(heap[index], heap[parent]) <= 0) break;
+        heap[index] = heap[parent];
+        heap[parent] = item;
+        index = parent;
+      }
+      return;
+    }
+    if (heap.length === 0 || this.compare(item, heap[0]) >= 0) return;
+
+    heap[0] = item;
+    let index = 0;
+    for (;;) {
+      const left = index * 2 + 1;
+      const right = left + 1;
+      let worst = index;
+      if (left < heap.length && this.compare(heap[left], heap[worst]) > 0) worst = left;
+      if (right < heap.length && this.compare(heap[right], heap[worst]) > 0) worst = right;
+      if (worst === index) break;
+      heap[index] = heap[worst];
+      heap[worst] = item;
+      index = worst;
+    }
+  }
+
+  // Kept items, best first.
+  toSortedArray(): T[] {
+    return this.heap.slice().sort(this.compare);
+  }
+}
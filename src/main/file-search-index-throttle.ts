@@ -0,0 +1,103 @@
+import * as os from 'os';
+
+// Paces directory walks (full builds and newly added subtrees) so a rebuild
+// backs off while the machine is busy instead of competing with it. The pause
+// taken every few dozen directories grows with three signals:
+//
+// - timer lag: how late our own pause timer fires, which rises when every core
+//   is contended (a large compile, a VM booting);
+// - the one-minute load average per core, where the platform reports one
+//   (Windows always reports 0);
+// - running on battery, which stretches every pause.
+//
+// On an idle machine this is the fixed 6ms-per-80-directories pause the walk
+// has always used.
+
+export type FileSearchScanConditions = {
+  onBattery: boolean;
+  // Whether the user has been away from the keyboard and mouse for a while.
+  userIdle: boolean;
+  // Background refreshes only run (and keep running) while the user is idle.
+  idleOnly: boolean;
+};
+
+export const DEFAULT_SCAN_CONDITIONS: FileSearchScanConditions = {
+  onBattery: false,
+  userIdle: false,
+  idleOnly: false,
+};
+
+const SCAN_PACE_EVERY_DIRECTORIES = 80;
+const MIN_SCAN_PAUSE_MS = 6;
+// A first index has nothing to serve yet, so it never slows down as far as a
+// refresh of an index that is already answering queries.
+const MAX_FOREGROUND_SCAN_PAUSE_MS = 60;
+const MAX_BACKGROUND_SCAN_PAUSE_MS = 400;
+const BATTERY_PAUSE_MULTIPLIER = 4;
+// Timer lag below this is scheduler noise; at LAG_FULL_PRESSURE_MS the walk is
+// fully backed off.
+const LAG_PRESSURE_FLOOR_MS = 4;
+const LAG_FULL_PRESSURE_MS = 50;
+const LAG_SMOOTHING = 0.3;
+const LOAD_PRESSURE_FLOOR = 0.6;
+const LOAD_FULL_PRESSURE = 1.2;
+const LOAD_SAMPLE_INTERVAL_MS = 2_000;
+
+function clampUnit(value: number): number {
+  if (!Number.isFinite(value)) return 0;
+  return Math.min(1, Math.max(0, value));
+}
+
+export class ScanThrottle {
+  private readonly background: boolean;
+  private readonly getConditions: () => FileSearchScanConditions;
+  private directoriesSincePause = 0;
+  private smoothedLagMs = 0;
+  private loadPerCore = 0;
+  private loadSampledAt = 0;
+
+  constructor(options?: {
+    // True for refreshes of an index that is already being served.
+    background?: boolean;
+    getConditions?: () => FileSearchScanConditions;
+  }) {
+    this.background = Boolean(options?.background);
+    this.getConditions = options?.getConditions || (() => DEFAULT_SCAN_CONDITIONS);
+  }
+
+  // Call once per directory walked; sleeps every SCAN_PACE_EVERY_DIRECTORIES.
+  async pace(): Promise<void> {
+    this.directoriesSincePause += 1;
+    if (this.directoriesSincePause < SCAN_PACE_EVERY_DIRECTORIES) return;
+    this.directoriesSincePause = 0;
+
+    const pauseMs = this.getPauseMs();
+    const startedAt = Date.now();
+    await new Promise<void>((resolve) => setTimeout(resolve, pauseMs));
+    const lagMs = Math.max(0, Date.now() - startedAt - pauseMs);
+    this.smoothedLagMs += (lagMs - this.smoothedLagMs) * LAG_SMOOTHING;
+  }
+
+  getPauseMs(): number {
+    const maxPauseMs = this.background ? MAX_BACKGROUND_SCAN_PAUSE_MS : MAX_FOREGROUND_SCAN_PAUSE_MS;
+    const pressure = Math.max(
+      clampUnit((this.smoothedLagMs - LAG_PRESSURE_FLOOR_MS) / (LAG_FULL_PRESSURE_MS - LAG_PRESSURE_FLOOR_MS)),
+      clampUnit((this.sampleLoadPerCore() - LOAD_PRESSURE_FLOOR) / (LOAD_FULL_PRESSURE - LOAD_PRESSURE_FLOOR))
+    );
+    let pauseMs = MIN_SCAN_PAUSE_MS + pressure * (maxPauseMs - MIN_SCAN_PAUSE_MS);
+    if (this.getConditions().onBattery) {
+      pauseMs = Math.min(maxPauseMs, pauseMs * BATTERY_PAUSE_MULTIPLIER);
+    }
+    return Math.round(pauseMs);
+  }
+
+  private sampleLoadPerCore(): number {
+    const now = Date.now();
+    if (now - this.loadSampledAt >= LOAD_SAMPLE_INTERVAL_MS) {
+      this.loadSampledAt = now;
+      const coreCount = Math.max(1, os.cpus().length);
+      this.loadPerCore = os.loadavg()[0] / coreCount;
+    }
+    return this.loadPerCore;
+  }
+}
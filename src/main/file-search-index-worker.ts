@@ -0,0 +1,601 @@
+import { parentPort } from 'worker_threads';
+import * as fs from 'fs';
+import * as v8 from 'v8';
+import {
+  FileSearchIndexCancelledError,
+  applyWatchEventBatch,
+  buildIndexSnapshot,
+  compactIndexSnapshot,
+  createFileSearchQueryContext,
+  getIndexEntryCount,
+  getIndexMemoryReport,
+  persistIndexSnapshot,
+  readFileSearchMetadata,
+  reconcileIndexSnapshot,
+  rescanIndexSubtree,
+  restoreIndexSnapshot,
+  searchIndexSnapshot,
+  shouldCompactIndexSnapshot,
+  type FileSearchIndexConfig,
+  type FileSearchIndexMemoryReport,
+  type FileSearchQueryContext,
+  type IndexSnapshot,
+} from './file-search-index-engine';
+import {
+  applyContentIndexBatch,
+  compactContentIndex,
+  createEmptyContentIndex,
+  getContentDocumentCount,
+  normalizeContentRoots,
+  parseContentQuery,
+  persistContentIndex,
+  refreshContentIndex,
+  restoreContentIndex,
+  searchContentIndex,
+  shouldCompactContentIndex,
+  type ContentIndex,
+} from './file-search-content-index';
+import {
+  DEFAULT_SCAN_CONDITIONS,
+  ScanThrottle,
+  type FileSearchScanConditions,
+} from './file-search-index-throttle';
+
+// Worker thread that owns the file search index. The main process keeps the
+// watcher and refresh timer, and talks to this thread through the request /
+// response protocol below; walking, watcher batch application and query
+// scoring all happen here so they never block launcher IPC.
+
+export type FileSearchWorkerRequest =
+  | {
+      id: number;
+      method: 'configure';
+      payload: {
+        config: FileSearchIndexConfig;
+        snapshotFilePath: string;
+        contentRoots: string[];
+        contentIndexFilePath: string;
+        scanConditions: FileSearchScanConditions;
+      };
+    }
+  | { id: number; method: 'set-scan-conditions'; payload: FileSearchScanConditions }
+  | { id: number; method: 'restore-or-rebuild' }
+  | { id: number; method: 'rebuild'; payload: { reason: string } }
+  | { id: number; method: 'apply-watch-batch'; payload: { paths: string[] } }
+  | { id: number; method: 'rescan-subtree'; payload: { path: string; changedSince: number } }
+  | { id: number; method: 'search'; payload: { query: string; limit?: number; sessionId?: string } }
+  | { id: number; method: 'read-metadata'; payload: { paths: string[] } }
+  | { id: number; method: 'memory-report' }
+  | { id: number; method: 'stop' }
+  // Fire-and-forget: marks an in-flight request as cancelled. No response.
+  | { id: number; method: 'cancel'; payload: { requestId: number } };
+
+export type FileSearchWorkerState = {
+  indexing: boolean;
+  ready: boolean;
+  indexedEntryCount: number;
+  tombstoneCount: number;
+  lastIndexedAt: number | null;
+  lastCompactedAt: number | null;
+  contentIndexedFileCount: number;
+  lastError: string | null;
+};
+
+export type FileSearchWorkerMemoryReport = FileSearchIndexMemoryReport & {
+  // V8 heap in use by the worker isolate, which holds nothing but the index.
+  workerHeapUsedBytes: number;
+};
+
+export type FileSearchWorkerMessage =
+  | { type: 'response'; id: number; ok: true; result: any }
+  | { type: 'response'; id: number; ok: false; error: string; cancelled?: boolean }
+  | { type: 'state'; state: FileSearchWorkerState };
+
+const MIN_REBUILD_GAP_MS = 45_000;
+const SNAPSHOT_PERSIST_DEBOUNCE_MS = 60_000;
+const MAX_QUERY_CONTEXTS = 8;
+// Periodic refreshes of an index that is already being served; these are the
+// rebuilds that idle-only mode holds back while the user is active.
+const BACKGROUND_REBUILD_REASONS = new Set(['interval']);
+
+let config: FileSearchIndexConfig = { homeDir: '', includeRoots: [], includeProtectedHomeRoots: false };
+let snapshotFilePath = '';
+let activeIndex: IndexSnapshot | null = null;
+let indexJob: Promise<void> | null = null;
+let indexJobCancelled = false;
+let indexing = false;
+let lastIndexError: string | null = null;
+let lastBuildStartedAt = 0;
+let lastCompactedAt: number | null = null;
+let snapshotRestoreAttempted = false;
+let snapshotPersistTimer: NodeJS.Timeout | null = null;
+let snapshotPersistPromise: Promise<void> | null = null;
+// Watch batches and subtree rescans, run one at a time (see runSnapshotUpdate).
+let snapshotUpdateQueue: Promise<void> = Promise.resolve();
+const inFlightRequestIds = new Set<number>();
+const cancelledRequestIds = new Set<number>();
+// Last term query per launcher session, so typing ahead narrows the previous
+// matches. Insertion order doubles as LRU order.
+const queryContextsBySession = new Map<string, FileSearchQueryContext>();
+// Opt-in content index; null while disabled or before its first refresh.
+let contentRoots: string[] = [];
+let contentIndexFilePath = '';
+let contentIndex: ContentIndex | null = null;
+let contentJob: Promise<void> | null = null;
+// Content refreshes and batches, run one at a time (see runContentUpdate).
+let contentUpdateQueue: Promise<void> = Promise.resolve();
+let contentJobCancelled = false;
+let contentPersistTimer: NodeJS.Timeout | null = null;
+// Reported by the main process (power source, user presence, idle-only mode).
+let scanConditions: FileSearchScanConditions = DEFAULT_SCAN_CONDITIONS;
+// Set while a background rebuild runs, so user activity can cancel it in
+// idle-only mode; deferredRefreshReason then retries it at the next idle.
+let backgroundRebuildRunning = false;
+let deferredRefreshReason: string | null = null;
+
+function post(message: FileSearchWorkerMessage): void {
+  try {
+    parentPort?.postMessage(message);
+  } catch {}
+}
+
+function postState(): void {
+  post({
+    type: 'state',
+    state: {
+      indexing,
+      ready: Boolean(activeIndex),
+      indexedEntryCount: activeIndex ? getIndexEntryCount(activeIndex) - activeIndex.tombstoneCount : 0,
+      tombstoneCount: activeIndex?.tombstoneCount || 0,
+      lastIndexedAt: activeIndex?.builtAt || null,
+      lastCompactedAt,
+      contentIndexedFileCount: contentIndex ? getContentDocumentCount(contentIndex) : 0,
+      lastError: lastIndexError,
+    },
+  });
+}
+
+function describeError(error: unknown, fallback: string): string {
+  return error instanceof Error ? error.message : String(error || fallback);
+}
+
+function runIndexJob(label: string, job: (isCancelled: () => boolean) => Promise<void>): Promise<void> {
+  indexJobCancelled = false;
+  indexing = true;
+  postState();
+  indexJob = (async () => {
+    try {
+      await job(() => indexJobCancelled);
+    } catch (error) {
+      if (error instanceof FileSearchIndexCancelledError) {
+        console.log(`[FileIndex] ${label} cancelled`);
+      } else {
+        lastIndexError = describeError(error, 'Unknown indexing error');
+        console.error(`[FileIndex] ${label} failed:`, error);
+      }
+    } finally {
+      indexing = false;
+      indexJob = null;
+      postState();
+    }
+  })();
+  return indexJob;
+}
+
+async function persistActiveSnapshot(): Promise<void> {
+  const snapshot = activeIndex;
+  if (!snapshotFilePath || !snapshot) return;
+  if (snapshotPersistPromise) {
+    schedulePersistActiveSnapshot();
+    return;
+  }
+
+  snapshotPersistPromise = (async () => {
+    try {
+      await persistIndexSnapshot(snapshotFilePath, snapshot, config);
+    } catch (error) {
+      console.warn('[FileIndex] Failed to persist snapshot:', error);
+    } finally {
+      snapshotPersistPromise = null;
+    }
+  })();
+  return snapshotPersistPromise;
+}
+
+function schedulePersistActiveSnapshot(): void {
+  if (!snapshotFilePath || snapshotPersistTimer) return;
+  snapshotPersistTimer = setTimeout(() => {
+    snapshotPersistTimer = null;
+    void persistActiveSnapshot();
+  }, SNAPSHOT_PERSIST_DEBOUNCE_MS);
+}
+
+function rebuild(reason: string): Promise<void> {
+  if (config.includeRoots.length === 0) return Promise.resolve();
+  if (indexJob) return indexJob;
+
+  const background = Boolean(activeIndex) && BACKGROUND_REBUILD_REASONS.has(reason);
+  if (background && isUserActiveInIdleOnlyMode()) {
+    deferredRefreshReason = reason;
+    return Promise.resolve();
+  }
+
+  const now = Date.now();
+  if (now - lastBuildStartedAt < MIN_REBUILD_GAP_MS) return Promise.resolve();
+  lastBuildStartedAt = now;
+  deferredRefreshReason = null;
+  backgroundRebuildRunning = background;
+
+  return runIndexJob('Rebuild', async (isCancelled) => {
+    // With nothing to serve yet, the partial snapshot is published at each
+    // checkpoint; a refresh keeps serving the complete previous index instead.
+    const publishPartial = !activeIndex;
+    const snapshot = await buildIndexSnapshot(config, {
+      isCancelled,
+      throttle: createScanThrottle(background),
+      onCheckpoint: (partial) => {
+        if (!publishPartial || isCancelled()) return;
+        activeIndex = partial;
+        postState();
+      },
+    }).finally(() => {
+      backgroundRebuildRunning = false;
+    });
+    activeIndex = snapshot;
+    lastIndexError = null;
+    void persistActiveSnapshot();
+    if (reason) {
+      console.log(`[FileIndex] Rebuilt (${reason}): ${getIndexEntryCount(snapshot)} entries under ${config.includeRoots.join(', ')}`);
+      const report = getIndexMemoryReport(snapshot);
+      console.log(`[FileIndex] Index memory: ${report.bytesPerEntry} bytes/entry (previous layout ~${report.legacyBytesPerEntry} bytes/entry)`);
+    }
+    void refreshContent(reason || 'rebuild');
+  });
+}
+
+function createScanThrottle(background: boolean): ScanThrottle {
+  return new ScanThrottle({ background, getConditions: () => scanConditions });
+}
+
+function isUserActiveInIdleOnlyMode(): boolean {
+  return scanConditions.idleOnly && !scanConditions.userIdle;
+}
+
+function setScanConditions(next: FileSearchScanConditions): void {
+  scanConditions = { ...DEFAULT_SCAN_CONDITIONS, ...next };
+  if (isUserActiveInIdleOnlyMode()) {
+    if (backgroundRebuildRunning && !indexJobCancelled) {
+      // The previous index keeps serving; the refresh starts over at the next idle.
+      indexJobCancelled = true;
+      deferredRefreshReason = 'interval';
+      lastBuildStartedAt = 0;
+    }
+    return;
+  }
+  if (deferredRefreshReason && !indexJob) {
+    const reason = deferredRefreshReason;
+    deferredRefreshReason = null;
+    void rebuild(reason);
+  }
+}
+
+function restoreOrRebuild(): Promise<void> {
+  if (snapshotRestoreAttempted || activeIndex || indexJob || !snapshotFilePath) {
+    return rebuild('startup');
+  }
+  snapshotRestoreAttempted = true;
+
+  let restored = false;
+  return runIndexJob('Snapshot restore', async (isCancelled) => {
+    const snapshot = await restoreIndexSnapshot(snapshotFilePath, config, { isCancelled });
+    if (!snapshot) return;
+    activeIndex = snapshot;
+    restored = true;
+    postState();
+    console.log(`[FileIndex] Restored snapshot: ${getIndexEntryCount(snapshot)} entries under ${config.includeRoots.join(', ')}`);
+    const changedCount = await reconcileIndexSnapshot(snapshot, config, {
+      isCancelled,
+      throttle: createScanThrottle(false),
+    });
+    lastIndexError = null;
+    console.log(`[FileIndex] Reconciled snapshot: ${changedCount} changed paths`);
+    compactActiveIndexIfNeeded(snapshot);
+  }).then(() => {
+    if (restored) {
+      void persistActiveSnapshot();
+      void refreshContent('startup');
+      return undefined;
+    }
+    return rebuild('startup');
+  });
+}
+
+// Swaps in a compacted copy rather than compacting in place: queries that are
+// mid-scan keep reading the old snapshot, whose entry ids stay valid.
+function compactActiveIndexIfNeeded(snapshot: IndexSnapshot): void {
+  if (activeIndex !== snapshot || !shouldCompactIndexSnapshot(snapshot)) return;
+  const startedAt = Date.now();
+  const tombstoneCount = snapshot.tombstoneCount;
+  activeIndex = compactIndexSnapshot(snapshot);
+  lastCompactedAt = Date.now();
+  console.log(`[FileIndex] Compacted ${tombstoneCount} tombstones in ${lastCompactedAt - startedAt}ms: ${getIndexEntryCount(activeIndex)} entries`);
+}
+
+// Runs `update` once every earlier watch batch and rescan has finished. They
+// write to the active snapshot in place, and one that compacts swaps in a copy:
+// an update still writing to the snapshot it replaced would be lost.
+function runSnapshotUpdate(update: () => Promise<void>): Promise<void> {
+  const run = snapshotUpdateQueue.then(async () => {
+    if (indexJob) {
+      // Let the in-progress build finish first; the update then lands on the fresh snapshot.
+      await indexJob;
+    }
+    await update();
+  });
+  snapshotUpdateQueue = run.catch(() => {});
+  return run;
+}
+
+async function applyBatch(paths: string[]): Promise<void> {
+  if (paths.length === 0) return;
+  await runSnapshotUpdate(async () => {
+    const snapshot = activeIndex;
+    if (!snapshot) return;
+    await applyWatchEventBatch(snapshot, config, paths, { throttle: createScanThrottle(false) });
+    compactActiveIndexIfNeeded(snapshot);
+    schedulePersistActiveSnapshot();
+  });
+  await applyContentBatch((index) => applyContentIndexBatch(index, config, paths));
+  postState();
+}
+
+// Walks the content roots after the name index is settled, starting from the
+// persisted content index when its roots still match.
+function refreshContent(reason: string): Promise<void> {
+  if (contentJob) return contentJob;
+  contentJobCancelled = false;
+  contentJob = runContentUpdate(async () => {
+    try {
+      if (indexJob) await indexJob;
+      const roots = contentRoots;
+      if (roots.length === 0) return;
+      const isCancelled = () => contentJobCancelled;
+      let index = contentIndex;
+      if (!index && contentIndexFilePath) {
+        index = await restoreContentIndex(contentIndexFilePath, roots, { isCancelled });
+        if (index && contentRoots === roots) contentIndex = index;
+      }
+      if (!index) index = createEmptyContentIndex(roots);
+      const startedAt = Date.now();
+      const changedCount = await refreshContentIndex(index, config, { isCancelled });
+      if (contentRoots !== roots) return;
+      contentIndex = index;
+      compactContentIndexIfNeeded(index);
+      console.log(
+        `[FileIndex] Content index refreshed (${reason}) in ${Date.now() - startedAt}ms: ` +
+        `${getContentDocumentCount(index)} files, ${changedCount} changed`
+      );
+      if (changedCount > 0) void persistContentIndexFile();
+    } catch (error) {
+      if (error instanceof FileSearchIndexCancelledError) {
+        console.log('[FileIndex] Content index refresh cancelled');
+      } else {
+        console.warn('[FileIndex] Content index refresh failed:', error);
+      }
+    } finally {
+      contentJob = null;
+      postState();
+    }
+  });
+  return contentJob;
+}
+
+// Runs `update` once every earlier content refresh and batch has finished, for
+// the same reason as runSnapshotUpdate: a compaction swaps in a copy of the
+// content index, and whatever was still writing to the old one would be lost
+// (a refresh would even put the old one back).
+function runContentUpdate(update: () => Promise<void>): Promise<void> {
+  const run = contentUpdateQueue.then(update);
+  contentUpdateQueue = run.catch(() => {});
+  return run;
+}
+
+function applyContentBatch(apply: (index: ContentIndex) => Promise<number>): Promise<void> {
+  return runContentUpdate(async () => {
+    const index = contentIndex;
+    if (!index) return;
+    try {
+      const changedCount = await apply(index);
+      if (changedCount === 0) return;
+      compactContentIndexIfNeeded(index);
+      scheduleContentIndexPersist();
+    } catch (error) {
+      console.warn('[FileIndex] Failed to apply content index batch:', error);
+    }
+  });
+}
+
+function compactContentIndexIfNeeded(index: ContentIndex): void {
+  if (contentIndex !== index || !shouldCompactContentIndex(index)) return;
+  contentIndex = compactContentIndex(index);
+}
+
+function setContentRoots(roots: string[], filePath: string): void {
+  const nextRoots = normalizeContentRoots(roots, config);
+  const rootsChanged = nextRoots.join('\0') !== contentRoots.join('\0');
+  contentIndexFilePath = filePath;
+  if (!rootsChanged) return;
+  contentRoots = nextRoots;
+  contentIndex = null;
+  contentJobCancelled = true;
+  if (nextRoots.length === 0) {
+    if (contentIndexFilePath) void fs.promises.rm(contentIndexFilePath, { force: true }).catch(() => {});
+    return;
+  }
+  // Before the first restore-or-rebuild the name index goes first.
+  if (!snapshotRestoreAttempted && !activeIndex) return;
+  void (contentJob || Promise.resolve()).then(() => refreshContent('configure'));
+}
+
+async function persistContentIndexFile(): Promise<void> {
+  const index = contentIndex;
+  if (!contentIndexFilePath || !index) return;
+  try {
+    await persistContentIndex(contentIndexFilePath, index);
+  } catch (error) {
+    console.warn('[FileIndex] Failed to persist content index:', error);
+  }
+}
+
+function scheduleContentIndexPersist(): void {
+  if (!contentIndexFilePath || contentPersistTimer) return;
+  contentPersistTimer = setTimeout(() => {
+    contentPersistTimer = null;
+    void persistContentIndexFile();
+  }, SNAPSHOT_PERSIST_DEBOUNCE_MS);
+}
+
+function getQueryContext(sessionId: string | undefined): FileSearchQueryContext | undefined {
+  if (!sessionId) return undefined;
+  const context = queryContextsBySession.get(sessionId) || createFileSearchQueryContext();
+  queryContextsBySession.delete(sessionId);
+  queryContextsBySession.set(sessionId, context);
+  while (queryContextsBySession.size > MAX_QUERY_CONTEXTS) {
+    const oldest = queryContextsBySession.keys().next().value;
+    if (oldest === undefined) break;
+    queryContextsBySession.delete(oldest);
+  }
+  return context;
+}
+
+async function rescanSubtree(dirPath: string, changedSince: number): Promise<void> {
+  await runSnapshotUpdate(async () => {
+    const snapshot = activeIndex;
+    if (!snapshot) return;
+    const changedCount = await rescanIndexSubtree(snapshot, config, dirPath, changedSince, {
+      throttle: createScanThrottle(false),
+    });
+    console.log(`[FileIndex] Rescanned ${dirPath}: ${changedCount} changed paths`);
+    compactActiveIndexIfNeeded(snapshot);
+    schedulePersistActiveSnapshot();
+  });
+  await applyContentBatch((index) => applyContentIndexBatch(index, config, [dirPath]));
+  postState();
+}
+
+function stop(): void {
+  indexJobCancelled = true;
+  contentJobCancelled = true;
+  if (snapshotPersistTimer) {
+    clearTimeout(snapshotPersistTimer);
+    snapshotPersistTimer = null;
+  }
+  if (contentPersistTimer) {
+    clearTimeout(contentPersistTimer);
+    contentPersistTimer = null;
+  }
+}
+
+async function handleRequest(request: FileSearchWorkerRequest): Promise<any> {
+  switch (request.method) {
+    case 'configure': {
+      config = request.payload.config;
+      snapshotFilePath = request.payload.snapshotFilePath;
+      setContentRoots(request.payload.contentRoots || [], request.payload.contentIndexFilePath || '');
+      setScanConditions(request.payload.scanConditions || DEFAULT_SCAN_CONDITIONS);
+      return true;
+    }
+    case 'set-scan-conditions': {
+      setScanConditions(request.payload);
+      return true;
+    }
+    case 'restore-or-rebuild': {
+      void restoreOrRebuild();
+      return true;
+    }
+    case 'rebuild': {
+      await rebuild(request.payload.reason);
+      return true;
+    }
+    case 'apply-watch-batch': {
+      await applyBatch(request.payload.paths);
+      return true;
+    }
+    case 'rescan-subtree': {
+      await rescanSubtree(request.payload.path, request.payload.changedSince);
+      return true;
+    }
+    case 'search': {
+      const contentQuery = parseContentQuery(request.payload.query);
+      if (contentQuery !== null) {
+        return searchContentIndex(contentIndex, config, contentQuery, {
+          limit: request.payload.limit,
+          isCancelled: () => cancelledRequestIds.has(request.id),
+        });
+      }
+      if (!activeIndex && !indexJob) {
+        void rebuild('query-bootstrap');
+      }
+      return await searchIndexSnapshot(activeIndex, config, request.payload.query, {
+        limit: request.payload.limit,
+        context: getQueryContext(request.payload.sessionId),
+        isCancelled: () => cancelledRequestIds.has(request.id),
+      });
+    }
+    case 'read-metadata': {
+      return await readFileSearchMetadata(request.payload.paths, {
+        isCancelled: () => cancelledRequestIds.has(request.id),
+      });
+    }
+    case 'memory-report': {
+      if (!activeIndex) return null;
+      const report: FileSearchWorkerMemoryReport = {
+        ...getIndexMemoryReport(activeIndex),
+        workerHeapUsedBytes: v8.getHeapStatistics().used_heap_size,
+      };
+      return report;
+    }
+    case 'stop': {
+      stop();
+      return true;
+    }
+  }
+  throw new Error('unknown method');
+}
+
+parentPort?.on('message', (message: FileSearchWorkerRequest) => {
+  if (!message || typeof message !== 'object') return;
+  if (typeof message.id !== 'number' || !message.method) return;
+  if (message.method === 'cancel') {
+    const requestId = Number(message.payload?.requestId);
+    if (inFlightRequestIds.has(requestId)) cancelledRequestIds.add(requestId);
+    return;
+  }
+
+  inFlightRequestIds.add(message.id);
+  void (async () => {
+    try {
+      const result = await handleRequest(message);
+      post({ type: 'response', id: message.id, ok: true, result });
+    } catch (error) {
+      post({
+        type: 'response',
+        id: message.id,
+        ok: false,
+        error: describeError(error, 'file search worker error'),
+        cancelled: error instanceof FileSearchIndexCancelledError,
+      });
+    } finally {
+      inFlightRequestIds.delete(message.id);
+      cancelledRequestIds.delete(message.id);
+    }
+  })();
+});
+
+process.on('uncaughtException', (error) => {
+  console.error('[FileIndexWorker] Uncaught exception:', error);
+});
+
+process.on('unhandledRejection', (reason) => {
+  console.error('[FileIndexWorker] Unhandled rejection:', reason);
+});
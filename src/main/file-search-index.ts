@@ -1,33 +1,62 @@
+import * as crypto from 'crypto';
 import * as fs from 'fs';
 import * as os from 'os';
 import * as path from 'path';
-import { execFile } from 'child_process';
-import { promisify } from 'util';
-
-export type IndexedFileSearchResult = {
-  path: string;
-  name: string;
-  parentPath: string;
-  displayPath: string;
-  isDirectory: boolean;
-  score?: number;
-  matchKind?: string;
-  depth?: number;
-  homeRelativeDepth?: number;
-  topLevelRoot?: string;
-  noisyPathSegmentCount?: number;
-  mtimeMs?: number;
-  birthtimeMs?: number;
-  atimeMs?: number;
+import { Worker } from 'worker_threads';
+import {
+  FILE_SEARCH_INDEX_EXCLUDED_DIRECTORY_NAMES,
+  FILE_SEARCH_INDEX_EXCLUDED_HOME_TOP_LEVEL_DIRECTORIES,
+  FILE_SEARCH_INDEX_PROTECTED_HOME_TOP_LEVEL_DIRECTORIES,
+  MAX_FILE_METADATA_STAT_RESULTS,
+  isWatchablePath,
+  mergeFileSearchResults,
+  shouldSkipDirectory,
+  type FileSearchIndexConfig,
+  type IndexedFileSearchMetadata,
+  type IndexedFileSearchResult,
+} from './file-search-index-engine';
+import type {
+  FileSearchWorkerMemoryReport,
+  FileSearchWorkerMessage,
+  FileSearchWorkerRequest,
+  FileSearchWorkerState,
+} from './file-search-index-worker';
+import { InotifyTreeWatcher } from './file-search-index-inotify';
+import type { FileSearchScanConditions } from './file-search-index-throttle';
+import { resolvePackagedUnpackedPath } from './native-binary';
+
+export {
+  FILE_SEARCH_INDEX_EXCLUDED_DIRECTORY_NAMES,
+  FILE_SEARCH_INDEX_EXCLUDED_HOME_TOP_LEVEL_DIRECTORIES,
+  FILE_SEARCH_INDEX_NOISY_DIRECTORY_NAMES,
+  FILE_SEARCH_INDEX_PROTECTED_HOME_TOP_LEVEL_DIRECTORIES,
+} from './file-search-index-engine';
+export type { IndexedFileSearchMetadata, IndexedFileSearchResult } from './file-search-index-engine';
+export type { FileSearchWorkerMemoryReport as FileSearchIndexMemoryReport } from './file-search-index-worker';
+
+export type FileSearchIndexShardStatus = {
+  root: string;
+  indexing: boolean;
+  ready: boolean;
+  indexedEntryCount: number;
+  lastIndexedAt: number | null;
+  // 0 when the shard is only kept current by its watcher.
+  refreshIntervalMs: number;
+  lastError: string | null;
 };
 
 export type FileSearchIndexStatus = {
   indexing: boolean;
   ready: boolean;
   indexedEntryCount: number;
+  tombstoneCount: number;
   lastIndexedAt: number | null;
+  lastCompactedAt: number | null;
+  contentIndexedFileCount: number;
+  contentRoots: string[];
   homeDirectory: string;
   includeRoots: string[];
+  shards: FileSearchIndexShardStatus[];
   excludedDirectoryNames: string[];
   excludedTopLevelDirectories: string[];
   protectedTopLevelDirectories: string[];
@@ -35,1064 +64,813 @@ export type FileSearchIndexStatus = {
   lastError: string | null;
 };
 
-type IndexedEntry = {
+export type FileSearchPowerState = {
+  onBattery: boolean;
+  idleSeconds: number;
+};
+
+// A folder outside the home directory (another volume, an external disk)
+// indexed as its own shard.
+export type FileSearchIndexRoot = {
   path: string;
-  name: string;
-  parentPath: string;
-  normalizedName: string;
-  normalizedPath: string;
-  compactName: string;
-  tokens: string[];
-  pathTokens: string[];
-  isDirectory: boolean;
-  deleted?: boolean;
+  // Minutes between full refreshes; 0 leaves the shard to its watcher.
+  refreshIntervalMinutes?: number;
+};
+
+type DistributiveOmit<T, K extends keyof any> = T extends any ? Omit<T, K> : never;
+type WorkerRequestPayload = DistributiveOmit<FileSearchWorkerRequest, 'id'>;
+
+type PendingWorkerRequest = {
+  resolve: (value: any) => void;
+  reject: (reason?: any) => void;
+  timer: NodeJS.Timeout | null;
 };
 
-type IndexSnapshot = {
-  entries: IndexedEntry[];
-  prefixToEntryIds: Map<string, number[]>;
-  pathToEntryId: Map<string, number>;
-  builtAt: number;
+// The index is split into one shard per root: the home folder plus any extra
+// roots from settings. Each shard has its own worker, snapshot, watcher and
+// refresh timer, so adding or rebuilding one root never touches the others,
+// and queries run on all shards in parallel.
+type FileSearchIndexShard = {
+  root: string;
+  refreshIntervalMs: number;
+  worker: Worker | null;
+  workerRestartTimer: NodeJS.Timeout | null;
+  pending: Map<number, PendingWorkerRequest>;
+  state: FileSearchWorkerState;
+  // The index config of the last restore-or-rebuild, so settings changes
+  // that leave it alone do not rebuild the shard.
+  indexedConfigKey: string;
+  refreshTimer: NodeJS.Timeout | null;
+  watcher: fs.FSWatcher | null;
+  inotifyWatcher: InotifyTreeWatcher | null;
+  watching: boolean;
+  pendingWatchEvents: Set<string>;
+  watchDebounceTimer: NodeJS.Timeout | null;
+  activeSearchRequestBySession: Map<string, number>;
 };
 
-const SEARCH_TOKEN_SPLIT_REGEX = /[^a-z0-9]+/g;
-const MAX_PREFIX_LENGTH = 12;
-const MAX_INDEX_ENTRIES = 1_200_000;
-const DEFAULT_MAX_RESULTS = 80;
-const MAX_QUERY_RESULTS = 5_000;
-const MAX_FILE_METADATA_STAT_RESULTS = 240;
-const MIN_REBUILD_GAP_MS = 45_000;
 const DEFAULT_REFRESH_INTERVAL_MS = 8 * 60_000;
+// Extra roots are usually large and change less often than the home folder.
+const DEFAULT_EXTRA_ROOT_REFRESH_INTERVAL_MINUTES = 30;
+const MIN_REFRESH_INTERVAL_MS = 30_000;
+const MAX_EXTRA_ROOTS = 16;
 const WATCH_EVENT_DEBOUNCE_MS = 500;
-const MAX_SPOTLIGHT_CANDIDATES = 10_000;
-const SPOTLIGHT_SEARCH_TIMEOUT_MS = 2_400;
-const INDEX_SCAN_YIELD_EVERY_DIRECTORIES = 80;
-const INDEX_SCAN_PAUSE_MS = 6;
-
-const execFileAsync = promisify(execFile);
-
-export const FILE_SEARCH_INDEX_NOISY_DIRECTORY_NAMES = [
-  'node_modules',
-  'dist',
-  'build',
-  'out',
-  '.next',
-  '.nuxt',
-  '.turbo',
-  '.cache',
-  'coverage',
-  'target',
-  'vendor',
-  '__pycache__',
-  '.venv',
-  'venv',
-  'tmp',
-  'temp',
-  'logs',
-  'log',
-  'deriveddata',
-  '.terraform',
-  '.pnpm-store',
-  '.npm',
-] as const;
-
-// Skip VCS internals and high-churn generated/dependency trees. The file
-// search index starts at launch, so walking node_modules/build output can pin
-// the Electron main process on developer machines.
-export const FILE_SEARCH_INDEX_EXCLUDED_DIRECTORY_NAMES = [
-  '.git',
-  '.hg',
-  '.svn',
-] as const;
-
-// Keep indexing inside user content areas and avoid macOS/system-heavy trees.
-export const FILE_SEARCH_INDEX_EXCLUDED_HOME_TOP_LEVEL_DIRECTORIES = [
-  '.Trash',
-  'Library',
-  'Music',
-  'Pictures',
-] as const;
-export const FILE_SEARCH_INDEX_PROTECTED_HOME_TOP_LEVEL_DIRECTORIES = [
-  'Desktop',
-  'Documents',
-  'Downloads',
-  'Movies',
-] as const;
-
-const EXCLUDED_DIRECTORY_NAME_SET = new Set(
-  FILE_SEARCH_INDEX_EXCLUDED_DIRECTORY_NAMES.map((name) => name.toLowerCase())
-);
-const NOISY_DIRECTORY_NAME_SET = new Set(
-  FILE_SEARCH_INDEX_NOISY_DIRECTORY_NAMES.map((name) => name.toLowerCase())
-);
-const EXCLUDED_TOP_LEVEL_SET = new Set(
-  FILE_SEARCH_INDEX_EXCLUDED_HOME_TOP_LEVEL_DIRECTORIES.map((name) => name.toLowerCase())
-);
-const PROTECTED_TOP_LEVEL_SET = new Set(
-  FILE_SEARCH_INDEX_PROTECTED_HOME_TOP_LEVEL_DIRECTORIES.map((name) => name.toLowerCase())
-);
-const EXCLUDED_FILE_EXTENSIONS = new Set(['.tmp', '.temp', '.log', '.cache', '.crdownload', '.download']);
-
-let activeIndex: IndexSnapshot | null = null;
-let rebuildPromise: Promise<void> | null = null;
-let refreshTimer: NodeJS.Timeout | null = null;
+const SNAPSHOT_FILE_NAME = 'snapshot.bin';
+const CONTENT_INDEX_FILE_NAME = 'content-index.bin';
+// Extra root shards persist under roots/<hash of the root path>/.
+const SHARD_CACHE_DIRECTORY_NAME = 'roots';
+const WORKER_SEARCH_TIMEOUT_MS = 10_000;
+const METADATA_STREAM_CHUNK_SIZE = 40;
+// Events dropped by an inotify overflow may predate the overflow itself.
+const OVERFLOW_RESCAN_LOOKBACK_MS = 60_000;
+const WORKER_RESTART_BACKOFF_MS = 1_000;
+const SCAN_CONDITIONS_POLL_MS = 15_000;
+// Seconds without keyboard or mouse input before the user counts as away.
+const USER_IDLE_THRESHOLD_SECONDS = 120;
+
+const EMPTY_WORKER_STATE: FileSearchWorkerState = {
+  indexing: false,
+  ready: false,
+  indexedEntryCount: 0,
+  tombstoneCount: 0,
+  lastIndexedAt: null,
+  lastCompactedAt: null,
+  contentIndexedFileCount: 0,
+  lastError: null,
+};
+
+let shards: FileSearchIndexShard[] = [];
+let indexWorkerReqSeq = 0;
+const searchGenerationBySession = new Map<string, number>();
+
 let configuredHomeDir = '';
-let includeRoots: string[] = [];
 let refreshIntervalMs = DEFAULT_REFRESH_INTERVAL_MS;
+let extraRoots: FileSearchIndexRoot[] = [];
 let includeProtectedHomeRoots = false;
-let indexing = false;
-let lastIndexError: string | null = null;
-let lastBuildStartedAt = 0;
-let activeWatcher: fs.FSWatcher | null = null;
-let pendingWatchEvents: Set<string> = new Set();
-let watchDebounceTimer: NodeJS.Timeout | null = null;
-let watchedHomeDir = '';
-
-type DirectoryQueueEntry = {
-  scanPath: string;
-  displayPath: string;
-  resolvedPath?: string;
-};
+let contentRoots: string[] = [];
+let indexingStarted = false;
+let snapshotDirectory = '';
+let idleOnlyRefresh = false;
+let readPowerState: (() => FileSearchPowerState) | null = null;
+let scanConditions: FileSearchScanConditions = { onBattery: false, userIdle: false, idleOnly: false };
+let scanConditionsTimer: NodeJS.Timeout | null = null;
+
+class FileSearchWorkerCancelledError extends Error {}
 
-function normalizeSearchText(value: string): string {
-  return String(value || '')
-    .normalize('NFKD')
-    .toLowerCase()
-    .replace(SEARCH_TOKEN_SPLIT_REGEX, ' ')
-    .trim();
+function resolveHomeDir(inputHomeDir?: string): string {
+  const candidate = String(inputHomeDir || '').trim();
+  if (candidate) return path.resolve(candidate);
+  return path.resolve(os.homedir());
 }
 
-function normalizePathSearchText(value: string): string {
-  return String(value || '')
-    .normalize('NFKD')
-    .toLowerCase()
-    .replace(/\\/g, '/')
-    .trim();
+function isPathWithin(candidatePath: string, rootDir: string): boolean {
+  const relative = path.relative(rootDir, candidatePath);
+  return relative === '' || (!relative.startsWith('..') && !path.isAbsolute(relative));
 }
 
-function isPathLikeQuery(rawQuery: string): boolean {
-  const trimmed = String(rawQuery || '').trim();
-  return trimmed.includes('/') || trimmed.startsWith('~');
+function isExistingDirectory(candidatePath: string): boolean {
+  try {
+    return fs.statSync(candidatePath).isDirectory();
+  } catch {
+    return false;
+  }
 }
 
-function tokenizeSearchText(value: string): string[] {
-  const normalized = normalizeSearchText(value);
-  return normalized ? normalized.split(/\s+/).filter(Boolean) : [];
+function resolveExtraRootPath(homeDir: string, value: string): string {
+  const trimmed = String(value || '').trim();
+  if (!trimmed) return '';
+  if (trimmed === '~' || trimmed.startsWith('~/')) return path.join(homeDir, trimmed.slice(1));
+  return path.isAbsolute(trimmed) ? path.resolve(trimmed) : '';
 }
 
-function asTildePath(value: string, homeDir: string): string {
-  if (!homeDir) return value;
-  if (value === homeDir) return '~';
-  if (value.startsWith(`${homeDir}${path.sep}`)) {
-    return `~${value.slice(homeDir.length)}`;
+// The home folder first, then the extra roots that exist right now. Roots
+// that overlap the home folder or an earlier root would index the same files
+// twice, so they are left out.
+function resolveIncludeRoots(homeDir: string): Array<{ root: string; refreshIntervalMs: number }> {
+  if (!homeDir) return [];
+  const roots: Array<{ root: string; refreshIntervalMs: number }> = [];
+  if (fs.existsSync(homeDir)) roots.push({ root: homeDir, refreshIntervalMs });
+
+  const candidates = extraRoots
+    .map((entry) => ({ ...entry, path: resolveExtraRootPath(homeDir, entry.path) }))
+    .filter((entry) => entry.path)
+    .sort((a, b) => a.path.length - b.path.length);
+  for (const entry of candidates) {
+    if (roots.length > MAX_EXTRA_ROOTS) break;
+    if (isPathWithin(entry.path, homeDir) || isPathWithin(homeDir, entry.path)) {
+      console.warn(`[FileIndex] Skipping extra root ${entry.path}: it overlaps the home folder`);
+      continue;
+    }
+    if (roots.some(({ root }) => isPathWithin(entry.path, root))) continue;
+    if (!isExistingDirectory(entry.path)) continue;
+    const minutes = entry.refreshIntervalMinutes ?? DEFAULT_EXTRA_ROOT_REFRESH_INTERVAL_MINUTES;
+    roots.push({
+      root: entry.path,
+      refreshIntervalMs: Number.isFinite(minutes) && minutes > 0
+        ? Math.max(MIN_REFRESH_INTERVAL_MS, Math.floor(minutes * 60_000))
+        : 0,
+    });
   }
-  return value;
+  return roots;
 }
 
-function isPathWithinRoot(candidatePath: string, rootDir: string): boolean {
-  const relative = path.relative(rootDir, candidatePath);
-  return Boolean(relative === '' || (!relative.startsWith('..') && !path.isAbsolute(relative)));
+function createShard(root: string, shardRefreshIntervalMs: number): FileSearchIndexShard {
+  return {
+    root,
+    refreshIntervalMs: shardRefreshIntervalMs,
+    worker: null,
+    workerRestartTimer: null,
+    pending: new Map(),
+    state: { ...EMPTY_WORKER_STATE },
+    indexedConfigKey: '',
+    refreshTimer: null,
+    watcher: null,
+    inotifyWatcher: null,
+    watching: false,
+    pendingWatchEvents: new Set(),
+    watchDebounceTimer: null,
+    activeSearchRequestBySession: new Map(),
+  };
 }
 
-function isSubsequenceMatch(needle: string, haystack: string): boolean {
-  if (!needle) return true;
-  if (!haystack) return false;
-  let needleIndex = 0;
-  for (let i = 0; i < haystack.length && needleIndex < needle.length; i += 1) {
-    if (haystack[i] === needle[needleIndex]) needleIndex += 1;
+// Matches the shard list to the configured roots, keeping shards whose root
+// is unchanged and stopping the rest.
+function syncShards(): void {
+  const next = resolveIncludeRoots(configuredHomeDir).map(({ root, refreshIntervalMs: shardInterval }) => {
+    const shard = shards.find((candidate) => candidate.root === root) || createShard(root, shardInterval);
+    shard.refreshIntervalMs = shardInterval;
+    return shard;
+  });
+  for (const shard of shards) {
+    if (next.indexOf(shard) < 0) stopShard(shard);
   }
-  return needleIndex === needle.length;
+  shards = next;
 }
 
-function shouldSkipDirectory(absolutePath: string, dirName: string, homeDir: string): boolean {
-  const trimmedName = String(dirName || '').trim();
-  if (!trimmedName) return true;
-
-  const lowerName = trimmedName.toLowerCase();
-  if (EXCLUDED_DIRECTORY_NAME_SET.has(lowerName)) return true;
-  if (NOISY_DIRECTORY_NAME_SET.has(lowerName)) return true;
-  if (lowerName === '.trash') return true;
-  if (trimmedName.startsWith('.')) return true;
-
-  const relative = path.relative(homeDir, absolutePath);
-  if (!relative || relative.startsWith('..')) return true;
+function ensureConfigured(inputHomeDir?: string): void {
+  const nextHome = resolveHomeDir(inputHomeDir || configuredHomeDir);
+  if (!nextHome) return;
+  if (configuredHomeDir && configuredHomeDir === nextHome && shards.length > 0) return;
 
-  const segments = relative.split(path.sep).filter(Boolean);
-  if (segments.length > 0 && EXCLUDED_TOP_LEVEL_SET.has(segments[0].toLowerCase())) return true;
-  if (segments.length > 0 && PROTECTED_TOP_LEVEL_SET.has(segments[0].toLowerCase()) && !includeProtectedHomeRoots) {
-    return true;
-  }
-  return false;
+  configuredHomeDir = nextHome;
+  syncShards();
 }
 
-function shouldSkipFile(fileName: string): boolean {
-  const trimmedName = String(fileName || '').trim();
-  if (!trimmedName) return true;
-  if (trimmedName === '.DS_Store') return true;
-  const extension = path.extname(trimmedName).toLowerCase();
-  if (EXCLUDED_FILE_EXTENSIONS.has(extension)) return true;
-  return false;
+function getShardConfig(shard: FileSearchIndexShard): FileSearchIndexConfig {
+  return {
+    homeDir: configuredHomeDir,
+    includeRoots: [shard.root],
+    includeProtectedHomeRoots,
+  };
 }
 
-function shouldSkipPathForSearch(candidatePath: string, homeDir: string): boolean {
-  if (!isPathWithinRoot(candidatePath, homeDir)) return true;
-  const relative = path.relative(homeDir, candidatePath);
-  if (!relative || relative.startsWith('..') || path.isAbsolute(relative)) return true;
-  const segments = relative.split(path.sep).filter(Boolean);
-  if (segments.length === 0) return true;
-  if (EXCLUDED_TOP_LEVEL_SET.has(segments[0].toLowerCase())) return true;
-  if (PROTECTED_TOP_LEVEL_SET.has(segments[0].toLowerCase()) && !includeProtectedHomeRoots) return true;
-  for (const segment of segments) {
-    const lowerSegment = segment.toLowerCase();
-    if (EXCLUDED_DIRECTORY_NAME_SET.has(lowerSegment)) return true;
-    if (NOISY_DIRECTORY_NAME_SET.has(lowerSegment)) return true;
-    if (segment.startsWith('.')) return true;
-  }
-  return false;
+function getShardCacheName(root: string): string {
+  return crypto.createHash('sha1').update(root).digest('hex').slice(0, 16);
 }
 
-function addPrefixIndexValue(prefixToEntryIds: Map<string, number[]>, key: string, entryId: number): void {
-  if (!key) return;
-  const bucket = prefixToEntryIds.get(key);
-  if (!bucket) {
-    prefixToEntryIds.set(key, [entryId]);
-    return;
-  }
-  bucket.push(entryId);
+function getShardCacheDirectory(shard: FileSearchIndexShard): string {
+  if (!snapshotDirectory) return '';
+  // The home shard keeps the cache layout from before roots were sharded.
+  if (shard.root === configuredHomeDir) return snapshotDirectory;
+  return path.join(snapshotDirectory, SHARD_CACHE_DIRECTORY_NAME, getShardCacheName(shard.root));
 }
 
-function indexEntry(
-  snapshot: IndexSnapshot,
-  entry: Omit<IndexedEntry, 'normalizedName' | 'normalizedPath' | 'compactName' | 'tokens' | 'pathTokens' | 'deleted'>
-): void {
-  const normalizedName = normalizeSearchText(entry.name);
-  if (!normalizedName) return;
-  const normalizedPath = normalizePathSearchText(entry.path);
-  if (!normalizedPath) return;
-
-  const existingId = snapshot.pathToEntryId.get(entry.path);
-  if (existingId !== undefined) {
-    const existing = snapshot.entries[existingId];
-    if (existing) {
-      existing.deleted = false;
-      existing.isDirectory = entry.isDirectory;
-      existing.parentPath = entry.parentPath;
-      return;
-    }
-  }
-
-  if (snapshot.entries.length >= MAX_INDEX_ENTRIES) return;
-
-  const tokens = tokenizeSearchText(entry.name);
-  const pathTokens = tokenizeSearchText(entry.path);
-  const compactName = normalizedName.replace(/\s+/g, '');
-  const entryId = snapshot.entries.length;
-
-  const nextEntry: IndexedEntry = {
-    ...entry,
-    normalizedName,
-    normalizedPath,
-    compactName,
-    tokens,
-    pathTokens,
+function getConfigurePayload(shard: FileSearchIndexShard): Extract<FileSearchWorkerRequest, { method: 'configure' }>['payload'] {
+  const cacheDirectory = getShardCacheDirectory(shard);
+  return {
+    config: getShardConfig(shard),
+    snapshotFilePath: cacheDirectory ? path.join(cacheDirectory, SNAPSHOT_FILE_NAME) : '',
+    // The worker keeps only the content roots inside its own root.
+    contentRoots: [...contentRoots],
+    contentIndexFilePath: cacheDirectory ? path.join(cacheDirectory, CONTENT_INDEX_FILE_NAME) : '',
+    scanConditions: { ...scanConditions },
   };
-  snapshot.entries.push(nextEntry);
-  snapshot.pathToEntryId.set(entry.path, entryId);
-
-  const seenIndexKeys = new Set<string>();
-  for (const token of tokens) {
-    if (!token) continue;
-    const maxLen = Math.min(MAX_PREFIX_LENGTH, token.length);
-    for (let length = 1; length <= maxLen; length += 1) {
-      seenIndexKeys.add(token.slice(0, length));
-    }
-  }
-  for (const token of pathTokens) {
-    if (!token) continue;
-    const maxLen = Math.min(MAX_PREFIX_LENGTH, token.length);
-    for (let length = 2; length <= maxLen; length += 1) {
-      seenIndexKeys.add(token.slice(0, length));
-    }
-  }
-  seenIndexKeys.add(compactName.slice(0, Math.min(MAX_PREFIX_LENGTH, compactName.length)));
-
-  for (const key of seenIndexKeys) {
-    addPrefixIndexValue(snapshot.prefixToEntryIds, key, entryId);
-  }
 }
 
-async function resolveRealPath(candidatePath: string): Promise<string | null> {
+function sampleScanConditions(): FileSearchScanConditions {
+  let powerState: FileSearchPowerState = { onBattery: false, idleSeconds: 0 };
   try {
-    return await fs.promises.realpath(candidatePath);
-  } catch {
-    return null;
-  }
-}
-
-async function buildIndexSnapshot(homeDir: string): Promise<IndexSnapshot> {
-  const snapshot: IndexSnapshot = {
-    entries: [],
-    prefixToEntryIds: new Map<string, number[]>(),
-    pathToEntryId: new Map<string, number>(),
-    builtAt: Date.now(),
+    if (readPowerState) powerState = readPowerState();
+  } catch {}
+  return {
+    onBattery: Boolean(powerState.onBattery),
+    userIdle: powerState.idleSeconds >= USER_IDLE_THRESHOLD_SECONDS,
+    idleOnly: idleOnlyRefresh,
   };
+}
 
-  const walkQueue: DirectoryQueueEntry[] = includeRoots.map((root) => ({
-    scanPath: root,
-    displayPath: root,
-  }));
-  const visitedRealDirectories = new Set<string>();
-  let queueIndex = 0;
-  let scannedDirectories = 0;
-
-  while (queueIndex < walkQueue.length) {
-    if (snapshot.entries.length >= MAX_INDEX_ENTRIES) {
-      break;
-    }
-
-    const currentEntry = walkQueue[queueIndex];
-    queueIndex += 1;
-    if (!currentEntry?.scanPath) break;
-
-    const currentDir = currentEntry.scanPath;
-    const currentDisplayPath = currentEntry.displayPath || currentDir;
-    const currentRealPath = currentEntry.resolvedPath || (await resolveRealPath(currentDir)) || currentDir;
-    if (!isPathWithinRoot(currentRealPath, homeDir)) {
-      continue;
-    }
-    if (visitedRealDirectories.has(currentRealPath)) {
-      continue;
-    }
-    visitedRealDirectories.add(currentRealPath);
-
-    let dirents: fs.Dirent[] = [];
-    try {
-      dirents = await fs.promises.readdir(currentDir, { withFileTypes: true });
-    } catch {
-      continue;
-    }
-
-    for (const dirent of dirents) {
-      const name = dirent.name;
-      const absoluteScanPath = path.join(currentDir, name);
-      const absoluteDisplayPath = path.join(currentDisplayPath, name);
-
-      if (dirent.isDirectory()) {
-        if (shouldSkipDirectory(absoluteDisplayPath, name, homeDir)) continue;
-        indexEntry(snapshot, {
-          path: absoluteDisplayPath,
-          name,
-          parentPath: currentDisplayPath,
-          isDirectory: true,
-        });
-        walkQueue.push({ scanPath: absoluteScanPath, displayPath: absoluteDisplayPath });
-        continue;
-      }
-
-      if (dirent.isSymbolicLink()) {
-        const resolvedPath = await resolveRealPath(absoluteScanPath);
-        if (!resolvedPath || !isPathWithinRoot(resolvedPath, homeDir)) {
-          continue;
-        }
-
-        let stats: fs.Stats | null = null;
-        try {
-          stats = await fs.promises.stat(absoluteScanPath);
-        } catch {
-          continue;
-        }
-
-        if (stats.isDirectory()) {
-          if (shouldSkipDirectory(absoluteDisplayPath, name, homeDir)) continue;
-          indexEntry(snapshot, {
-            path: absoluteDisplayPath,
-            name,
-            parentPath: currentDisplayPath,
-            isDirectory: true,
-          });
-          walkQueue.push({
-            scanPath: absoluteScanPath,
-            displayPath: absoluteDisplayPath,
-            resolvedPath,
-          });
-          continue;
-        }
-
-        if (stats.isFile()) {
-          if (shouldSkipFile(name)) continue;
-          indexEntry(snapshot, {
-            path: absoluteDisplayPath,
-            name,
-            parentPath: currentDisplayPath,
-            isDirectory: false,
-          });
-        }
-        continue;
-      }
-
-      if (!dirent.isFile()) {
-        continue;
-      }
-
-      if (shouldSkipFile(name)) continue;
-      indexEntry(snapshot, {
-        path: absoluteDisplayPath,
-        name,
-        parentPath: currentDisplayPath,
-        isDirectory: false,
-      });
-    }
-
-    scannedDirectories += 1;
-    if (scannedDirectories % INDEX_SCAN_YIELD_EVERY_DIRECTORIES === 0) {
-      await new Promise<void>((resolve) => setTimeout(resolve, INDEX_SCAN_PAUSE_MS));
-    }
+// Forwards power source and user presence to the workers' scan throttles
+// whenever they change.
+function updateScanConditions(): void {
+  const next = sampleScanConditions();
+  if (
+    next.onBattery === scanConditions.onBattery
+    && next.userIdle === scanConditions.userIdle
+    && next.idleOnly === scanConditions.idleOnly
+  ) {
+    return;
+  }
+  scanConditions = next;
+  for (const shard of shards) {
+    if (!shard.worker) continue;
+    void sendIndexWorkerRequest(shard, { method: 'set-scan-conditions', payload: { ...next } }).catch(() => {});
   }
+}
 
-  snapshot.builtAt = Date.now();
-  return snapshot;
+function getIndexWorkerPath(): string {
+  return resolvePackagedUnpackedPath(path.join(__dirname, 'file-search-index-worker.js'));
 }
 
-function scoreEntryMatch(entry: IndexedEntry, normalizedQuery: string, queryTerms: string[]): number {
-  if (queryTerms.length === 0) return 0;
-
-  let score = 0;
-
-  for (const term of queryTerms) {
-    let termScore = 0;
-    if (entry.normalizedName === term) {
-      termScore = 140;
-    } else if (entry.normalizedName.startsWith(term)) {
-      termScore = 118;
-    } else if (entry.compactName.startsWith(term)) {
-      termScore = 106;
-    } else if (entry.tokens.includes(term)) {
-      termScore = 102;
-    } else if (entry.tokens.some((token) => token.startsWith(term))) {
-      termScore = 88;
-    } else if (entry.normalizedName.includes(term)) {
-      termScore = 70;
-    } else if (entry.pathTokens.includes(term)) {
-      termScore = 64;
-    } else if (entry.pathTokens.some((token) => token.startsWith(term))) {
-      termScore = 58;
-    } else if (entry.normalizedPath.includes(term)) {
-      termScore = 48;
-    } else if (isSubsequenceMatch(term, entry.compactName)) {
-      termScore = 44;
-    } else {
-      return 0;
-    }
-    score += termScore;
+function rejectAllIndexWorkerPending(shard: FileSearchIndexShard, errorMessage: string): void {
+  for (const [id, pending] of shard.pending.entries()) {
+    if (pending.timer) clearTimeout(pending.timer);
+    pending.reject(new Error(errorMessage));
+    shard.pending.delete(id);
   }
+}
 
-  if (entry.normalizedName === normalizedQuery) {
-    score += 240;
-  } else if (entry.normalizedName.startsWith(normalizedQuery)) {
-    score += 180;
-  } else if (entry.normalizedName.includes(normalizedQuery)) {
-    score += 122;
+function handleIndexWorkerMessage(shard: FileSearchIndexShard, message: FileSearchWorkerMessage): void {
+  if (!message || typeof message !== 'object') return;
+  if (message.type === 'state') {
+    shard.state = message.state;
+    return;
   }
 
-  if (entry.isDirectory) {
-    score -= 10;
-  } else {
-    score += 8;
+  const pending = shard.pending.get(Number(message.id));
+  if (!pending) return;
+  if (pending.timer) clearTimeout(pending.timer);
+  shard.pending.delete(Number(message.id));
+  if (message.ok) {
+    pending.resolve(message.result);
+    return;
   }
+  pending.reject(
+    message.cancelled
+      ? new FileSearchWorkerCancelledError(message.error)
+      : new Error(String(message.error || 'file search worker request failed'))
+  );
+}
 
-  score += Math.max(0, 20 - Math.max(0, entry.name.length - normalizedQuery.length));
-  return score;
+function isShardActive(shard: FileSearchIndexShard): boolean {
+  return shards.indexOf(shard) >= 0;
 }
 
-function getEntryMatchKind(entry: IndexedEntry, normalizedQuery: string, queryTerms: string[]): string {
-  if (entry.normalizedName === normalizedQuery) return 'exact';
-  if (entry.normalizedName.startsWith(normalizedQuery)) return 'prefix';
-  if (entry.compactName.startsWith(normalizedQuery.replace(/\s+/g, ''))) return 'compact-prefix';
-  if (queryTerms.some((term) => entry.tokens.some((token) => token.startsWith(term)))) return 'token-prefix';
-  if (entry.normalizedName.includes(normalizedQuery)) return 'contains';
-  if (queryTerms.some((term) => entry.pathTokens.some((token) => token.startsWith(term)) || entry.normalizedPath.includes(term))) return 'path';
-  return 'subsequence';
+function scheduleIndexWorkerRestart(shard: FileSearchIndexShard): void {
+  if (shard.workerRestartTimer || !indexingStarted || !isShardActive(shard)) return;
+  shard.workerRestartTimer = setTimeout(() => {
+    shard.workerRestartTimer = null;
+    if (!indexingStarted || !isShardActive(shard)) return;
+    void sendIndexWorkerRequest(shard, { method: 'restore-or-rebuild' }).catch(() => {});
+  }, WORKER_RESTART_BACKOFF_MS);
 }
 
-function getFilePathRankingMetadata(filePath: string, stats: fs.Stats | null, homeDir: string) {
-  const relative = path.relative(homeDir, filePath);
-  const segments = relative && !relative.startsWith('..') && !path.isAbsolute(relative)
-    ? relative.split(path.sep).filter(Boolean)
-    : filePath.split(path.sep).filter(Boolean);
-  const topLevelRoot = segments[0] || '';
-  const noisyPathSegmentCount = segments.reduce((count, segment) =>
-    count + (NOISY_DIRECTORY_NAME_SET.has(segment.toLowerCase()) ? 1 : 0), 0);
-  return {
-    depth: segments.length,
-    homeRelativeDepth: segments.length,
-    topLevelRoot,
-    noisyPathSegmentCount,
-    mtimeMs: stats?.mtimeMs,
-    birthtimeMs: stats?.birthtimeMs,
-    atimeMs: stats?.atimeMs,
-  };
+function postIndexWorkerRequest(worker: Worker, request: FileSearchWorkerRequest): void {
+  worker.postMessage(request);
 }
 
-async function statPathForMetadata(filePath: string): Promise<fs.Stats | null> {
+function ensureIndexWorker(shard: FileSearchIndexShard): Worker | null {
+  if (shard.worker) return shard.worker;
+  if (!isShardActive(shard)) return null;
   try {
-    return await fs.promises.stat(filePath);
-  } catch {
+    const worker = new Worker(getIndexWorkerPath());
+    shard.worker = worker;
+    worker.on('message', (message: FileSearchWorkerMessage) => handleIndexWorkerMessage(shard, message));
+    worker.on('error', (error) => {
+      console.error(`[FileIndex] Worker error (${shard.root}):`, error);
+    });
+    worker.on('exit', (code) => {
+      if (shard.worker !== worker) return;
+      shard.worker = null;
+      shard.state = { ...shard.state, indexing: false, ready: false, indexedEntryCount: 0, tombstoneCount: 0, contentIndexedFileCount: 0 };
+      rejectAllIndexWorkerPending(shard, `[FileIndex] Worker exited (code ${code}).`);
+      scheduleIndexWorkerRestart(shard);
+    });
+    // The worker must never keep the app alive on quit.
+    worker.unref();
+    postIndexWorkerRequest(worker, {
+      id: ++indexWorkerReqSeq,
+      method: 'configure',
+      payload: getConfigurePayload(shard),
+    });
+    return worker;
+  } catch (error) {
+    console.error('[FileIndex] Failed to start worker:', error);
     return null;
   }
 }
 
-async function buildFileSearchResult(
-  entry: Pick<IndexedEntry, 'path' | 'name' | 'parentPath' | 'isDirectory'>,
-  score: number,
-  matchKind: string,
-  includeStatMetadata = true
-): Promise<IndexedFileSearchResult> {
-  const stats = includeStatMetadata ? await statPathForMetadata(entry.path) : null;
-  return {
-    path: entry.path,
-    name: entry.name,
-    parentPath: entry.parentPath,
-    displayPath: asTildePath(entry.parentPath, configuredHomeDir),
-    isDirectory: entry.isDirectory,
-    score,
-    matchKind,
-    ...getFilePathRankingMetadata(entry.path, stats, configuredHomeDir),
-  };
-}
-
-function intersectCandidates(lists: number[][]): number[] {
-  if (lists.length === 0) return [];
-  if (lists.length === 1) return [...lists[0]];
-
-  const [first, ...rest] = [...lists].sort((a, b) => a.length - b.length);
-  const candidates = new Set(first);
-  for (const list of rest) {
-    if (candidates.size === 0) break;
-    const allowed = new Set(list);
-    for (const entryId of candidates) {
-      if (!allowed.has(entryId)) {
-        candidates.delete(entryId);
-      }
+function startIndexWorkerRequest<T>(
+  shard: FileSearchIndexShard,
+  request: WorkerRequestPayload,
+  timeoutMs = 0
+): { id: number; promise: Promise<T> } {
+  const id = ++indexWorkerReqSeq;
+  const promise = new Promise<T>((resolve, reject) => {
+    const worker = ensureIndexWorker(shard);
+    if (!worker) {
+      reject(new Error('file search worker unavailable'));
+      return;
     }
-  }
-  return [...candidates];
+    const timer = timeoutMs > 0
+      ? setTimeout(() => {
+          shard.pending.delete(id);
+          cancelIndexWorkerRequest(shard, id);
+          reject(new Error(`[FileIndex] Worker request timed out (${request.method}).`));
+        }, timeoutMs)
+      : null;
+    shard.pending.set(id, { resolve, reject, timer });
+    try {
+      postIndexWorkerRequest(worker, { ...request, id } as FileSearchWorkerRequest);
+    } catch (error) {
+      if (timer) clearTimeout(timer);
+      shard.pending.delete(id);
+      reject(error);
+    }
+  });
+  return { id, promise };
 }
 
-function resolveCandidateIds(snapshot: IndexSnapshot, terms: string[]): number[] {
-  const indexedLists: number[][] = [];
-  for (const term of terms) {
-    const key = term.slice(0, Math.min(MAX_PREFIX_LENGTH, term.length));
-    const matches = snapshot.prefixToEntryIds.get(key);
-    if (!matches || matches.length === 0) return [];
-    indexedLists.push(matches);
-  }
-  return intersectCandidates(indexedLists);
+function sendIndexWorkerRequest<T>(shard: FileSearchIndexShard, request: WorkerRequestPayload, timeoutMs = 0): Promise<T> {
+  return startIndexWorkerRequest<T>(shard, request, timeoutMs).promise;
 }
 
-function resolveHomeDir(inputHomeDir?: string): string {
-  const candidate = String(inputHomeDir || '').trim();
-  if (candidate) return path.resolve(candidate);
-  return path.resolve(os.homedir());
+function cancelIndexWorkerRequest(shard: FileSearchIndexShard, requestId: number): void {
+  if (!shard.worker) return;
+  try {
+    postIndexWorkerRequest(shard.worker, { id: ++indexWorkerReqSeq, method: 'cancel', payload: { requestId } });
+  } catch {}
 }
 
-function resolveIncludeRoots(homeDir: string): string[] {
-  if (!homeDir) return [];
-  if (fs.existsSync(homeDir)) return [homeDir];
-  return [];
-}
-
-function ensureConfigured(inputHomeDir?: string): void {
-  const nextHome = resolveHomeDir(inputHomeDir || configuredHomeDir);
-  if (!nextHome) return;
-  if (configuredHomeDir && configuredHomeDir === nextHome && includeRoots.length > 0) return;
-
-  configuredHomeDir = nextHome;
-  includeRoots = resolveIncludeRoots(configuredHomeDir);
+function configureIndexWorker(shard: FileSearchIndexShard): void {
+  void sendIndexWorkerRequest(shard, {
+    method: 'configure',
+    payload: getConfigurePayload(shard),
+  }).catch(() => {});
 }
 
 export function getFileSearchIndexStatus(): FileSearchIndexStatus {
+  const states = shards.map((shard) => shard.state);
+  const sum = (read: (state: FileSearchWorkerState) => number) => states.reduce((total, state) => total + read(state), 0);
+  const latest = (read: (state: FileSearchWorkerState) => number | null) => states.reduce<number | null>((current, state) => {
+    const value = read(state);
+    return value !== null && (current === null || value > current) ? value : current;
+  }, null);
+  const firstError = states.find((state) => state.lastError);
   return {
-    indexing,
-    ready: Boolean(activeIndex),
-    indexedEntryCount: activeIndex?.entries.length || 0,
-    lastIndexedAt: activeIndex?.builtAt || null,
+    indexing: states.some((state) => state.indexing),
+    ready: states.some((state) => state.ready),
+    indexedEntryCount: sum((state) => state.indexedEntryCount),
+    tombstoneCount: sum((state) => state.tombstoneCount),
+    lastIndexedAt: latest((state) => state.lastIndexedAt),
+    lastCompactedAt: latest((state) => state.lastCompactedAt),
+    contentIndexedFileCount: sum((state) => state.contentIndexedFileCount),
+    contentRoots: [...contentRoots],
     homeDirectory: configuredHomeDir,
-    includeRoots: [...includeRoots],
+    includeRoots: shards.map((shard) => shard.root),
+    shards: shards.map((shard) => ({
+      root: shard.root,
+      indexing: shard.state.indexing,
+      ready: shard.state.ready,
+      indexedEntryCount: shard.state.indexedEntryCount,
+      lastIndexedAt: shard.state.lastIndexedAt,
+      refreshIntervalMs: shard.refreshIntervalMs,
+      lastError: shard.state.lastError,
+    })),
     excludedDirectoryNames: [...FILE_SEARCH_INDEX_EXCLUDED_DIRECTORY_NAMES],
     excludedTopLevelDirectories: [...FILE_SEARCH_INDEX_EXCLUDED_HOME_TOP_LEVEL_DIRECTORIES],
     protectedTopLevelDirectories: [...FILE_SEARCH_INDEX_PROTECTED_HOME_TOP_LEVEL_DIRECTORIES],
     includeProtectedHomeRoots,
-    lastError: lastIndexError,
+    lastError: firstError ? firstError.lastError : null,
   };
 }
 
-export async function rebuildFileSearchIndex(reason = 'manual'): Promise<void> {
-  ensureConfigured();
-  if (includeRoots.length === 0) return;
-  if (rebuildPromise) return rebuildPromise;
-
-  const now = Date.now();
-  if (now - lastBuildStartedAt < MIN_REBUILD_GAP_MS) return;
-  lastBuildStartedAt = now;
-
-  rebuildPromise = (async () => {
-    indexing = true;
+// Bytes held by the index structures (and the previous layout's estimate for
+// the same tree) across all shards, for diagnostics. Null until a worker has
+// an index.
+export async function getFileSearchIndexMemoryReport(): Promise<FileSearchWorkerMemoryReport | null> {
+  const reports = await Promise.all(shards.filter((shard) => shard.worker).map(async (shard) => {
     try {
-      const snapshot = await buildIndexSnapshot(configuredHomeDir);
-      activeIndex = snapshot;
-      lastIndexError = null;
-      if (reason) {
-        console.log(
-          `[FileIndex] Rebuilt (${reason}): ${snapshot.entries.length} entries under ${configuredHomeDir}`
-        );
-      }
+      return await sendIndexWorkerRequest<FileSearchWorkerMemoryReport | null>(shard, { method: 'memory-report' });
     } catch (error) {
-      lastIndexError = error instanceof Error ? error.message : String(error || 'Unknown indexing error');
-      console.error('[FileIndex] Rebuild failed:', error);
-    } finally {
-      indexing = false;
-      rebuildPromise = null;
+      console.warn('[FileIndex] Memory report request failed:', error);
+      return null;
     }
-  })();
-
-  return rebuildPromise;
+  }));
+  const present = reports.filter((report): report is FileSearchWorkerMemoryReport => Boolean(report));
+  if (present.length === 0) return null;
+  if (present.length === 1) return present[0];
+  const total = { ...present[0] };
+  for (const report of present.slice(1)) {
+    for (const key of Object.keys(total) as Array<keyof FileSearchWorkerMemoryReport>) {
+      total[key] += report[key];
+    }
+  }
+  total.bytesPerEntry = total.liveEntryCount > 0 ? Math.round(total.totalBytes / total.liveEntryCount) : 0;
+  total.legacyBytesPerEntry = total.liveEntryCount > 0 ? Math.round(total.legacyLayoutBytes / total.liveEntryCount) : 0;
+  return total;
 }
 
-export function requestFileSearchIndexRefresh(reason = 'manual'): void {
-  if (rebuildPromise) return;
-  void rebuildFileSearchIndex(reason);
+async function rebuildShard(shard: FileSearchIndexShard, reason: string): Promise<void> {
+  try {
+    await sendIndexWorkerRequest(shard, { method: 'rebuild', payload: { reason } });
+  } catch (error) {
+    console.error(`[FileIndex] Rebuild request failed (${shard.root}):`, error);
+  }
 }
 
-function isWatchablePath(absolutePath: string): boolean {
-  if (!configuredHomeDir) return false;
-  if (!isPathWithinRoot(absolutePath, configuredHomeDir)) return false;
-
-  const relative = path.relative(configuredHomeDir, absolutePath);
-  if (!relative || relative.startsWith('..')) return false;
-
-  const segments = relative.split(path.sep).filter(Boolean);
-  if (segments.length === 0) return false;
-
-  const topLevel = segments[0].toLowerCase();
-  if (EXCLUDED_TOP_LEVEL_SET.has(topLevel)) return false;
-  if (PROTECTED_TOP_LEVEL_SET.has(topLevel) && !includeProtectedHomeRoots) return false;
+export async function rebuildFileSearchIndex(reason = 'manual'): Promise<void> {
+  ensureConfigured();
+  await Promise.all(shards.map((shard) => rebuildShard(shard, reason)));
+}
 
-  for (const segment of segments) {
-    if (!segment) continue;
-    const lowerSegment = segment.toLowerCase();
-    if (EXCLUDED_DIRECTORY_NAME_SET.has(lowerSegment)) return false;
-    if (NOISY_DIRECTORY_NAME_SET.has(lowerSegment)) return false;
-    if (segment.startsWith('.')) return false;
-  }
+export function requestFileSearchIndexRefresh(reason = 'manual'): void {
+  ensureConfigured();
+  for (const shard of shards) requestShardRefresh(shard, reason);
+}
+
+function requestShardRefresh(shard: FileSearchIndexShard, reason: string): void {
+  if (shard.state.indexing) return;
+  void rebuildShard(shard, reason);
+}
+
+function scheduleShardRefresh(shard: FileSearchIndexShard): void {
+  if (shard.refreshTimer) {
+    clearInterval(shard.refreshTimer);
+    shard.refreshTimer = null;
+  }
+  if (shard.refreshIntervalMs <= 0) return;
+  shard.refreshTimer = setInterval(() => {
+    requestShardRefresh(shard, 'interval');
+  }, shard.refreshIntervalMs);
+}
+
+function queueWatchEvent(shard: FileSearchIndexShard, absolutePath: string): void {
+  if (!isWatchablePath(absolutePath, getShardConfig(shard))) return;
+  shard.pendingWatchEvents.add(absolutePath);
+  if (!shard.watchDebounceTimer) {
+    shard.watchDebounceTimer = setTimeout(() => flushWatchEvents(shard), WATCH_EVENT_DEBOUNCE_MS);
+  }
+}
+
+// Linux: per-directory inotify watches instead of recursive fs.watch, which
+// is emulated there and drops events under load.
+function startInotifyWatcher(shard: FileSearchIndexShard): boolean {
+  const watcher = new InotifyTreeWatcher(shard.root, {
+    shouldWatchDirectory: (dirPath, name) => {
+      const config = getShardConfig(shard);
+      return isWatchablePath(dirPath, config) && !shouldSkipDirectory(dirPath, name, config);
+    },
+    onChange: (absolutePath) => queueWatchEvent(shard, absolutePath),
+    onOverflow: (subtreePath) => {
+      console.warn(`[FileIndex] inotify queue overflowed; rescanning ${subtreePath}`);
+      flushWatchEvents(shard);
+      void sendIndexWorkerRequest(shard, {
+        method: 'rescan-subtree',
+        payload: { path: subtreePath, changedSince: Date.now() - OVERFLOW_RESCAN_LOOKBACK_MS },
+      }).catch((error) => {
+        console.warn('[FileIndex] Failed to rescan after inotify overflow:', error);
+      });
+    },
+    onLost: () => {
+      if (shard.inotifyWatcher !== watcher) return;
+      stopFileSearchWatcher(shard);
+      startRecursiveWatcher(shard);
+      // Changes since the descriptor failed were never reported.
+      requestShardRefresh(shard, 'watcher-lost');
+    },
+  });
+  if (!watcher.start()) return false;
+  shard.inotifyWatcher = watcher;
+  shard.watching = true;
+  console.log(`[FileIndex] inotify watcher started on ${shard.root}`);
   return true;
 }
 
-function startFileSearchWatcher(): void {
-  stopFileSearchWatcher();
-  if (!configuredHomeDir) return;
+function startFileSearchWatcher(shard: FileSearchIndexShard): void {
+  stopFileSearchWatcher(shard);
+  if (process.platform === 'linux' && startInotifyWatcher(shard)) return;
+  startRecursiveWatcher(shard);
+}
 
+function startRecursiveWatcher(shard: FileSearchIndexShard): void {
   try {
-    activeWatcher = fs.watch(
-      configuredHomeDir,
+    shard.watcher = fs.watch(
+      shard.root,
       { recursive: true, persistent: false },
       (_eventType, filename) => {
         if (!filename) return;
-        const absolutePath = path.resolve(configuredHomeDir, filename);
-        if (!isWatchablePath(absolutePath)) return;
-        pendingWatchEvents.add(absolutePath);
-        if (!watchDebounceTimer) {
-          watchDebounceTimer = setTimeout(flushWatchEvents, WATCH_EVENT_DEBOUNCE_MS);
-        }
+        queueWatchEvent(shard, path.resolve(shard.root, filename));
       }
     );
-    watchedHomeDir = configuredHomeDir;
-    activeWatcher.on('error', (error) => {
+    shard.watching = true;
+    shard.watcher.on('error', (error) => {
       console.warn('[FileIndex] watcher error:', error);
     });
-    console.log(`[FileIndex] watcher started on ${configuredHomeDir}`);
+    console.log(`[FileIndex] watcher started on ${shard.root}`);
   } catch (error) {
     console.warn('[FileIndex] failed to start watcher:', error);
-    activeWatcher = null;
-    watchedHomeDir = '';
+    shard.watcher = null;
+    shard.watching = false;
   }
 }
 
-function stopFileSearchWatcher(): void {
-  if (activeWatcher) {
+function stopFileSearchWatcher(shard: FileSearchIndexShard): void {
+  if (shard.watcher) {
     try {
-      activeWatcher.close();
+      shard.watcher.close();
     } catch {
       // ignore
     }
-    activeWatcher = null;
+    shard.watcher = null;
   }
-  watchedHomeDir = '';
-  if (watchDebounceTimer) {
-    clearTimeout(watchDebounceTimer);
-    watchDebounceTimer = null;
+  if (shard.inotifyWatcher) {
+    shard.inotifyWatcher.close();
+    shard.inotifyWatcher = null;
   }
-  pendingWatchEvents.clear();
-}
-
-function flushWatchEvents(): void {
-  watchDebounceTimer = null;
-  if (rebuildPromise) {
-    // Defer until the in-progress rebuild completes — it will refresh state wholesale.
-    watchDebounceTimer = setTimeout(flushWatchEvents, WATCH_EVENT_DEBOUNCE_MS * 2);
-    return;
+  shard.watching = false;
+  if (shard.watchDebounceTimer) {
+    clearTimeout(shard.watchDebounceTimer);
+    shard.watchDebounceTimer = null;
   }
-  if (pendingWatchEvents.size === 0) return;
-  const batch = [...pendingWatchEvents];
-  pendingWatchEvents.clear();
-  void applyWatchEventBatch(batch);
+  shard.pendingWatchEvents.clear();
 }
 
-async function applyWatchEventBatch(paths: string[]): Promise<void> {
-  const snapshot = activeIndex;
-  if (!snapshot) return;
-
-  const stated = await Promise.all(
-    paths.map(async (absolutePath) => {
-      try {
-        const stats = await fs.promises.stat(absolutePath);
-        return { absolutePath, stats, exists: true as const };
-      } catch {
-        return { absolutePath, exists: false as const };
-      }
-    })
-  );
-
-  const deletePaths: string[] = [];
-  const newDirectoriesToWalk: string[] = [];
-
-  for (const result of stated) {
-    if (!result.exists) {
-      deletePaths.push(result.absolutePath);
-      continue;
-    }
-    const { absolutePath, stats } = result;
-    const name = path.basename(absolutePath);
-    const parentPath = path.dirname(absolutePath);
-
-    if (stats.isDirectory()) {
-      if (shouldSkipDirectory(absolutePath, name, configuredHomeDir)) continue;
-      const existingId = snapshot.pathToEntryId.get(absolutePath);
-      const isFresh = existingId === undefined || Boolean(snapshot.entries[existingId]?.deleted);
-      indexEntry(snapshot, { path: absolutePath, name, parentPath, isDirectory: true });
-      if (isFresh) newDirectoriesToWalk.push(absolutePath);
-    } else if (stats.isFile()) {
-      if (shouldSkipFile(name)) continue;
-      indexEntry(snapshot, { path: absolutePath, name, parentPath, isDirectory: false });
-    }
-  }
-
-  if (deletePaths.length > 0) {
-    tombstoneDeletedPaths(snapshot, deletePaths);
-  }
-
-  for (const dirPath of newDirectoriesToWalk) {
-    if (snapshot.entries.length >= MAX_INDEX_ENTRIES) break;
-    await walkAddedDirectory(snapshot, dirPath);
-  }
+function flushWatchEvents(shard: FileSearchIndexShard): void {
+  shard.watchDebounceTimer = null;
+  if (shard.pendingWatchEvents.size === 0) return;
+  const batch = [...shard.pendingWatchEvents];
+  shard.pendingWatchEvents.clear();
+  // The worker queues the batch behind any in-progress rebuild.
+  void sendIndexWorkerRequest(shard, { method: 'apply-watch-batch', payload: { paths: batch } }).catch((error) => {
+    console.warn('[FileIndex] Failed to apply watch batch:', error);
+  });
 }
 
-function tombstoneDeletedPaths(snapshot: IndexSnapshot, deletePaths: string[]): void {
-  const directIds = new Set<number>();
-  for (const deletedPath of deletePaths) {
-    const id = snapshot.pathToEntryId.get(deletedPath);
-    if (id !== undefined) directIds.add(id);
+function stopShard(shard: FileSearchIndexShard): void {
+  if (shard.refreshTimer) {
+    clearInterval(shard.refreshTimer);
+    shard.refreshTimer = null;
+  }
+  if (shard.workerRestartTimer) {
+    clearTimeout(shard.workerRestartTimer);
+    shard.workerRestartTimer = null;
   }
-  const prefixes = deletePaths.map((p) => p + path.sep);
+  stopFileSearchWatcher(shard);
 
-  for (let i = 0; i < snapshot.entries.length; i += 1) {
-    const entry = snapshot.entries[i];
-    if (entry.deleted) continue;
-    if (directIds.has(i)) {
-      entry.deleted = true;
-      continue;
-    }
-    for (const prefix of prefixes) {
-      if (entry.path.startsWith(prefix)) {
-        entry.deleted = true;
-        break;
-      }
-    }
+  const worker = shard.worker;
+  if (worker) {
+    shard.worker = null;
+    rejectAllIndexWorkerPending(shard, '[FileIndex] Worker stopped.');
+    try {
+      postIndexWorkerRequest(worker, { id: ++indexWorkerReqSeq, method: 'stop' });
+    } catch {}
+    void worker.terminate().catch(() => {});
   }
+  shard.indexedConfigKey = '';
+  shard.state = { ...shard.state, indexing: false, ready: false, indexedEntryCount: 0, tombstoneCount: 0, contentIndexedFileCount: 0 };
 }
 
-async function walkAddedDirectory(snapshot: IndexSnapshot, dirPath: string): Promise<void> {
-  let dirents: fs.Dirent[] = [];
+// Drops the persisted snapshots of extra roots that were removed from the
+// settings. Roots that are only missing right now (an unplugged disk) keep
+// theirs for when they come back.
+async function pruneRemovedShardCaches(): Promise<void> {
+  if (!snapshotDirectory) return;
+  const shardCacheRoot = path.join(snapshotDirectory, SHARD_CACHE_DIRECTORY_NAME);
+  let cacheNames: string[];
   try {
-    dirents = await fs.promises.readdir(dirPath, { withFileTypes: true });
+    cacheNames = await fs.promises.readdir(shardCacheRoot);
   } catch {
     return;
   }
-
-  for (const dirent of dirents) {
-    if (snapshot.entries.length >= MAX_INDEX_ENTRIES) return;
-    const name = dirent.name;
-    const childPath = path.join(dirPath, name);
-    if (!isWatchablePath(childPath)) continue;
-
-    if (dirent.isDirectory()) {
-      if (shouldSkipDirectory(childPath, name, configuredHomeDir)) continue;
-      indexEntry(snapshot, { path: childPath, name, parentPath: dirPath, isDirectory: true });
-      await walkAddedDirectory(snapshot, childPath);
-    } else if (dirent.isFile()) {
-      if (shouldSkipFile(name)) continue;
-      indexEntry(snapshot, { path: childPath, name, parentPath: dirPath, isDirectory: false });
-    }
-  }
+  const configured = new Set(extraRoots
+    .map((entry) => resolveExtraRootPath(configuredHomeDir, entry.path))
+    .filter(Boolean)
+    .map(getShardCacheName));
+  await Promise.all(cacheNames
+    .filter((name) => !configured.has(name))
+    .map((name) => fs.promises.rm(path.join(shardCacheRoot, name), { recursive: true, force: true }).catch(() => {})));
 }
 
 export function startFileSearchIndexing(options?: {
   homeDir?: string;
   refreshIntervalMs?: number;
   includeProtectedHomeRoots?: boolean;
+  // Folders outside the home directory to index, each as its own shard.
+  extraRoots?: FileSearchIndexRoot[];
+  // Folders whose text files are indexed for `content:` queries.
+  contentRoots?: string[];
+  // Run the periodic refresh only while the user is away from the machine.
+  idleOnlyRefresh?: boolean;
+  // Power source and seconds since the last user input; walks slow down on
+  // battery, and idle-only refreshes wait for the user to step away.
+  getPowerState?: () => FileSearchPowerState;
+  cacheDirectory?: string;
 }): void {
-  ensureConfigured(options?.homeDir);
+  if (typeof options?.cacheDirectory === 'string' && options.cacheDirectory.trim()) {
+    snapshotDirectory = path.resolve(options.cacheDirectory.trim());
+  }
   if (typeof options?.refreshIntervalMs === 'number' && Number.isFinite(options.refreshIntervalMs)) {
-    refreshIntervalMs = Math.max(30_000, Math.floor(options.refreshIntervalMs));
+    refreshIntervalMs = Math.max(MIN_REFRESH_INTERVAL_MS, Math.floor(options.refreshIntervalMs));
+  }
+  if (Array.isArray(options?.extraRoots)) {
+    extraRoots = options.extraRoots
+      .map((entry) => ({
+        path: String(entry?.path || '').trim(),
+        refreshIntervalMinutes: typeof entry?.refreshIntervalMinutes === 'number' ? entry.refreshIntervalMinutes : undefined,
+      }))
+      .filter((entry) => entry.path);
   }
   if (typeof options?.includeProtectedHomeRoots === 'boolean') {
     includeProtectedHomeRoots = options.includeProtectedHomeRoots;
   }
-
-  if (refreshTimer) {
-    clearInterval(refreshTimer);
-    refreshTimer = null;
+  if (Array.isArray(options?.contentRoots)) {
+    contentRoots = options.contentRoots.map((root) => String(root || '').trim()).filter(Boolean);
   }
+  if (typeof options?.idleOnlyRefresh === 'boolean') {
+    idleOnlyRefresh = options.idleOnlyRefresh;
+  }
+  if (typeof options?.getPowerState === 'function') {
+    readPowerState = options.getPowerState;
+  }
+  configuredHomeDir = resolveHomeDir(options?.homeDir || configuredHomeDir);
+  syncShards();
+  scanConditions = sampleScanConditions();
+  indexingStarted = true;
 
-  refreshTimer = setInterval(() => {
-    requestFileSearchIndexRefresh('interval');
-  }, refreshIntervalMs);
-
-  requestFileSearchIndexRefresh('startup');
-
-  if (watchedHomeDir !== configuredHomeDir) {
-    startFileSearchWatcher();
+  if (!scanConditionsTimer) {
+    scanConditionsTimer = setInterval(updateScanConditions, SCAN_CONDITIONS_POLL_MS);
   }
-}
 
-export function stopFileSearchIndexing(): void {
-  if (refreshTimer) {
-    clearInterval(refreshTimer);
-    refreshTimer = null;
+  for (const shard of shards) {
+    scheduleShardRefresh(shard);
+    configureIndexWorker(shard);
+    // Only shards whose index config changed (or that are new) restore or
+    // rebuild; content root and refresh changes are picked up as they are.
+    const configKey = JSON.stringify(getShardConfig(shard));
+    if (shard.indexedConfigKey !== configKey) {
+      shard.indexedConfigKey = configKey;
+      void sendIndexWorkerRequest(shard, { method: 'restore-or-rebuild' }).catch((error) => {
+        console.error('[FileIndex] Startup indexing request failed:', error);
+      });
+    }
+    if (!shard.watching) startFileSearchWatcher(shard);
   }
-  stopFileSearchWatcher();
+  void pruneRemovedShardCaches();
 }
 
+export function stopFileSearchIndexing(): void {
+  indexingStarted = false;
+  if (scanConditionsTimer) {
+    clearInterval(scanConditionsTimer);
+    scanConditionsTimer = null;
+  }
+  for (const shard of shards) stopShard(shard);
+}
+
+// A `content:` prefix searches file contents under the configured content
+// roots instead of names. Results come back ranked but without timestamps.
+// Filter tokens (`ext:pdf`, `kind:folder`, `modified:<7d`, `size:>100mb`)
+// narrow name and path queries, or list matches on their own; see
+// file-search-index-filters.ts.
+// Every shard is queried in parallel and the results merged by score; a shard
+// that fails or times out only drops its own results.
+// When `onMetadata` is given, the top results are then stat'ed in rank order
+// and each chunk is delivered as it lands, until a newer query from the same
+// session arrives.
 export async function searchIndexedFiles(
   rawQuery: string,
-  options?: { limit?: number }
-): Promise<IndexedFileSearchResult[]> {
-  const trimmedQuery = String(rawQuery || '').trim();
-  const pathLikeQuery = isPathLikeQuery(trimmedQuery);
-  const normalizedQuery = normalizeSearchText(rawQuery);
-  const terms = tokenizeSearchText(rawQuery);
-  if (!pathLikeQuery && (!normalizedQuery || terms.length === 0)) return [];
-
-  const limit = Math.max(1, Math.min(MAX_QUERY_RESULTS, Number(options?.limit) || DEFAULT_MAX_RESULTS));
-
-  if (!activeIndex && !rebuildPromise) {
-    requestFileSearchIndexRefresh('query-bootstrap');
+  options?: {
+    limit?: number;
+    sessionId?: string;
+    onMetadata?: (entries: IndexedFileSearchMetadata[]) => void;
   }
+): Promise<IndexedFileSearchResult[]> {
+  if (!String(rawQuery || '').trim()) return [];
+  ensureConfigured();
 
-  const indexedResults: IndexedFileSearchResult[] = [];
-  const snapshot = activeIndex;
-  if (snapshot) {
-    if (pathLikeQuery) {
-      const rawNeedle = normalizePathSearchText(trimmedQuery);
-      if (rawNeedle) {
-        const expandedNeedle = trimmedQuery.startsWith('~') && configuredHomeDir
-          ? normalizePathSearchText(`${configuredHomeDir}${trimmedQuery.slice(1)}`)
-          : rawNeedle;
-
-        const scored: Array<{ entry: IndexedEntry; score: number }> = [];
-        for (const entry of snapshot.entries) {
-          if (entry.deleted) continue;
-          const pathIndex = entry.normalizedPath.indexOf(expandedNeedle);
-          const tildePath = normalizePathSearchText(asTildePath(entry.path, configuredHomeDir));
-          const tildeIndex = tildePath.indexOf(rawNeedle);
-          const matchIndex = pathIndex >= 0 ? pathIndex : tildeIndex;
-          if (matchIndex < 0) continue;
-
-          let score = 1000 - Math.min(420, matchIndex);
-          if (entry.normalizedPath.endsWith(`/${expandedNeedle}`) || entry.normalizedPath.endsWith(expandedNeedle)) {
-            score += 180;
-          }
-          if (entry.isDirectory) {
-            score -= 10;
-          } else {
-            score += 12;
-          }
-          score -= Math.min(120, Math.floor(entry.path.length / 4));
-          scored.push({ entry, score });
-        }
-
-        scored.sort((a, b) => {
-          if (b.score !== a.score) return b.score - a.score;
-          if (a.entry.path.length !== b.entry.path.length) return a.entry.path.length - b.entry.path.length;
-          return a.entry.name.localeCompare(b.entry.name);
-        });
-
-        indexedResults.push(
-          ...(await Promise.all(
-            scored.slice(0, limit).map(({ entry, score }, index) =>
-              buildFileSearchResult(entry, score, 'path', index < MAX_FILE_METADATA_STAT_RESULTS)
-            )
-          ))
-        );
-      }
-    } else {
-      const candidateIds = resolveCandidateIds(snapshot, terms);
-      if (candidateIds.length > 0) {
-        const scored: Array<{ entry: IndexedEntry; score: number }> = [];
-        for (const entryId of candidateIds) {
-          const entry = snapshot.entries[entryId];
-          if (!entry || entry.deleted) continue;
-          const score = scoreEntryMatch(entry, normalizedQuery, terms);
-          if (score <= 0) continue;
-          scored.push({ entry, score });
-        }
-
-        scored.sort((a, b) => {
-          if (b.score !== a.score) return b.score - a.score;
-          return a.entry.name.localeCompare(b.entry.name);
-        });
-
-        indexedResults.push(
-          ...(await Promise.all(
-            scored.slice(0, limit).map(({ entry, score }, index) =>
-              buildFileSearchResult(
-                entry,
-                score,
-                getEntryMatchKind(entry, normalizedQuery, terms),
-                index < MAX_FILE_METADATA_STAT_RESULTS
-              )
-            )
-          ))
-        );
-      }
+  // A newer query from the same caller supersedes the previous one; the
+  // workers drop it at their next yield point instead of finishing the scan.
+  const sessionId = String(options?.sessionId || '');
+  let generation = 0;
+  if (sessionId) {
+    for (const shard of shards) {
+      const previousRequestId = shard.activeSearchRequestBySession.get(sessionId);
+      if (previousRequestId !== undefined) cancelIndexWorkerRequest(shard, previousRequestId);
     }
+    generation = (searchGenerationBySession.get(sessionId) || 0) + 1;
+    searchGenerationBySession.set(sessionId, generation);
   }
 
-  if (process.platform !== 'darwin') {
-    return indexedResults;
-  }
-  if (!configuredHomeDir) {
-    return indexedResults;
-  }
-  if (indexedResults.length >= limit) {
-    return indexedResults;
+  const resultLists = await Promise.all(shards.map((shard) => searchShard(shard, rawQuery, options?.limit, sessionId)));
+  if (sessionId && searchGenerationBySession.get(sessionId) !== generation) return [];
+  const results = mergeFileSearchResults(resultLists, options?.limit);
+
+  if (options?.onMetadata && results.length > 0) {
+    void streamSearchMetadata(results, sessionId, generation, options.onMetadata);
   }
+  return results;
+}
 
-  const existingPaths = new Set(indexedResults.map((entry) => entry.path));
-  const spotlightSearchTerm = pathLikeQuery
-    ? (() => {
-        const normalized = trimmedQuery
-          .replace(/\\/g, '/')
-          .replace(/^~\//, '')
-          .replace(/^~$/, '')
-          .replace(/\/+$/, '');
-        if (!normalized) return '';
-        return path.posix.basename(normalized);
-      })()
-    : trimmedQuery;
-
-  const spotlightTerm = String(spotlightSearchTerm || '').trim();
-  if (!spotlightTerm) return indexedResults;
-
-  let spotlightStdout = '';
+async function searchShard(
+  shard: FileSearchIndexShard,
+  rawQuery: string,
+  limit: number | undefined,
+  sessionId: string
+): Promise<IndexedFileSearchResult[]> {
+  const { id, promise } = startIndexWorkerRequest<IndexedFileSearchResult[]>(
+    shard,
+    { method: 'search', payload: { query: String(rawQuery || ''), limit, sessionId: sessionId || undefined } },
+    WORKER_SEARCH_TIMEOUT_MS
+  );
+  if (sessionId) shard.activeSearchRequestBySession.set(sessionId, id);
   try {
-    const { stdout } = await execFileAsync('/usr/bin/mdfind', ['-onlyin', configuredHomeDir, '-name', spotlightTerm], {
-      maxBuffer: 16 * 1024 * 1024,
-      timeout: SPOTLIGHT_SEARCH_TIMEOUT_MS,
-    });
-    spotlightStdout = String(stdout || '');
-  } catch (error: any) {
-    spotlightStdout = String(error?.stdout || '');
+    return await promise;
+  } catch (error) {
+    if (!(error instanceof FileSearchWorkerCancelledError)) {
+      console.warn(`[FileIndex] Search request failed (${shard.root}):`, error);
+    }
+    return [];
+  } finally {
+    if (sessionId && shard.activeSearchRequestBySession.get(sessionId) === id) {
+      shard.activeSearchRequestBySession.delete(sessionId);
+    }
   }
+}
 
-  if (!spotlightStdout) return indexedResults;
-
-  const rawNeedle = pathLikeQuery ? normalizePathSearchText(trimmedQuery) : '';
-  const expandedNeedle = pathLikeQuery && trimmedQuery.startsWith('~') && configuredHomeDir
-    ? normalizePathSearchText(`${configuredHomeDir}${trimmedQuery.slice(1)}`)
-    : rawNeedle;
-  const spotlightScored: Array<{ path: string; score: number }> = [];
-  const spotlightCandidateLimit = Math.min(MAX_SPOTLIGHT_CANDIDATES, Math.max(320, limit * 8));
-
-  for (const line of spotlightStdout.split(/\r?\n/)) {
-    if (spotlightScored.length >= spotlightCandidateLimit) break;
-    const candidateRawPath = String(line || '').trim();
-    if (!candidateRawPath) continue;
-
-    const candidatePath = path.resolve(candidateRawPath);
-    if (existingPaths.has(candidatePath)) continue;
-    if (shouldSkipPathForSearch(candidatePath, configuredHomeDir)) continue;
-
-    const candidateName = path.basename(candidatePath);
-    if (!candidateName) continue;
-    if (shouldSkipFile(candidateName)) continue;
-
-    let score = 0;
-    if (pathLikeQuery) {
-      const normalizedPath = normalizePathSearchText(candidatePath);
-      const tildePath = normalizePathSearchText(asTildePath(candidatePath, configuredHomeDir));
-      const pathIndex = expandedNeedle ? normalizedPath.indexOf(expandedNeedle) : -1;
-      const tildeIndex = rawNeedle ? tildePath.indexOf(rawNeedle) : -1;
-      const matchIndex = pathIndex >= 0 ? pathIndex : tildeIndex;
-      if (matchIndex < 0) continue;
-
-      score = 960 - Math.min(420, matchIndex);
-      if (normalizedPath.endsWith(`/${expandedNeedle}`) || normalizedPath.endsWith(expandedNeedle)) {
-        score += 140;
+async function streamSearchMetadata(
+  results: IndexedFileSearchResult[],
+  sessionId: string,
+  generation: number,
+  onMetadata: (entries: IndexedFileSearchMetadata[]) => void
+): Promise<void> {
+  // Stat'ing does not depend on the index, so the home shard's worker reads
+  // metadata for every shard's results.
+  const shard = shards[0];
+  if (!shard) return;
+  const isSuperseded = () => Boolean(sessionId) && searchGenerationBySession.get(sessionId) !== generation;
+  const paths = results.slice(0, MAX_FILE_METADATA_STAT_RESULTS).map((result) => result.path);
+  for (let start = 0; start < paths.length; start += METADATA_STREAM_CHUNK_SIZE) {
+    if (isSuperseded()) return;
+    const { id, promise } = startIndexWorkerRequest<IndexedFileSearchMetadata[]>(
+      shard,
+      { method: 'read-metadata', payload: { paths: paths.slice(start, start + METADATA_STREAM_CHUNK_SIZE) } },
+      WORKER_SEARCH_TIMEOUT_MS
+    );
+    // Registered like a search so the next query from this session cancels it.
+    if (sessionId) shard.activeSearchRequestBySession.set(sessionId, id);
+    try {
+      const entries = await promise;
+      if (isSuperseded()) return;
+      onMetadata(entries);
+    } catch (error) {
+      if (!(error instanceof FileSearchWorkerCancelledError)) {
+        console.warn('[FileIndex] Metadata request failed:', error);
+      }
+      return;
+    } finally {
+      if (sessionId && shard.activeSearchRequestBySession.get(sessionId) === id) {
+        shard.activeSearchRequestBySession.delete(sessionId);
       }
-      score -= Math.min(120, Math.floor(candidatePath.length / 4));
-    } else {
-      const normalizedName = normalizeSearchText(candidateName);
-      if (!normalizedName) continue;
-      const pseudoEntry: IndexedEntry = {
-        path: candidatePath,
-        name: candidateName,
-        parentPath: path.dirname(candidatePath),
-        normalizedName,
-        normalizedPath: normalizePathSearchText(candidatePath),
-        compactName: normalizedName.replace(/\s+/g, ''),
-        tokens: tokenizeSearchText(candidateName),
-        pathTokens: tokenizeSearchText(candidatePath),
-        isDirectory: false,
-      };
-      score = scoreEntryMatch(pseudoEntry, normalizedQuery, terms);
-      if (score <= 0) continue;
-      // Keep index-backed results ahead of Spotlight when ranking is similar.
-      score -= 5;
     }
-
-    existingPaths.add(candidatePath);
-    spotlightScored.push({ path: candidatePath, score });
   }
-
-  if (spotlightScored.length === 0) return indexedResults;
-
-  spotlightScored.sort((a, b) => {
-    if (b.score !== a.score) return b.score - a.score;
-    if (a.path.length !== b.path.length) return a.path.length - b.path.length;
-    return a.path.localeCompare(b.path);
-  });
-
-  const merged = [...indexedResults];
-  for (const candidate of spotlightScored) {
-    if (merged.length >= limit) break;
-    const parentPath = path.dirname(candidate.path);
-    merged.push(await buildFileSearchResult({
-      path: candidate.path,
-      name: path.basename(candidate.path),
-      parentPath,
-      isDirectory: false,
-    }, candidate.score, pathLikeQuery ? 'path' : 'contains', merged.length < MAX_FILE_METADATA_STAT_RESULTS));
-  }
-
-  return merged;
 }
@@ -94,12 +94,14 @@ import {
   deleteClipboardItem,
   copyItemToClipboard,
   getClipboardItemById,
+  getClipboardHistoryPage,
+  getClipboardHistoryRevision,
   searchClipboardHistory,
   setClipboardMonitorEnabled,
   setClipboardAppBlacklist,
   togglePinClipboardItem,
   moveClipboardPinnedItem,
-  pruneClipboardHistoryOlderThan,
+  setClipboardHistoryRetentionDays,
 } from './clipboard-manager';
 import {
   initSnippetStore,
@@ -1965,8 +1967,11 @@ function syncNativeLiquidGlassClassOnWindow(win: any, enabled: boolean): void {
 // Shared loader for the native-helpers N-API addon. Currently exposes:
 //   - activateApp / postPaste / activateAndPaste (paste flow)
 //   - setWindowAnimationBehaviorNone (disable NSWindow show/hide animation)
-// Lazy + cached so a single missing/broken build doesn't spam warnings, and
-// non-darwin platforms simply get null.
+// Lazy + cached so a single missing/broken build doesn't spam warnings. The
+// Linux build has none of the above: it carries the file index directory
+// walker (loaded by the index worker), plus ClipboardWatcher and the
+// hashBuffer / imageDifferenceHash content hashes for the clipboard history, so
+// callers here must treat every export as optional.
 let cachedNativeHelpersAddon: any | null = null;
 let nativeHelpersAddonLoadFailed = false;
 function getNativeHelpersAddon(): any | null {
@@ -13769,6 +13774,14 @@ app.whenReady().then(async () => {
   startFileSearchIndexing({
     homeDir: app.getPath('home'),
     includeProtectedHomeRoots: Boolean(settings.fileSearchProtectedRootsEnabled),
+    extraRoots: settings.fileSearchExtraRoots,
+    contentRoots: settings.fileSearchContentRoots,
+    idleOnlyRefresh: Boolean(settings.fileSearchIdleOnlyRefresh),
+    getPowerState: () => ({
+      onBattery: electron.powerMonitor.isOnBatteryPower(),
+      idleSeconds: electron.powerMonitor.getSystemIdleTime(),
+    }),
+    cacheDirectory: path.join(app.getPath('userData'), 'file-search-index'),
   });
   // Daily background update check (once every 24h).
   void runBackgroundAppUpdaterCheck();
@@ -13780,18 +13793,10 @@ app.whenReady().then(async () => {
   if (settings.hasSeenOnboarding) {
     startClipboardMonitor();
     setClipboardAppBlacklist(settings.clipboardAppBlacklist);
-    pruneClipboardHistoryOlderThan(settings.clipboardHistoryRetentionDays);
+    // Also keeps dropping items as they expire while the app runs.
+    setClipboardHistoryRetentionDays(settings.clipboardHistoryRetentionDays);
   }
 
-  // Daily re-prune so long-running sessions also drop expired clipboard items.
-  setInterval(() => {
-    try {
-      pruneClipboardHistoryOlderThan(loadSettings().clipboardHistoryRetentionDays);
-    } catch (e) {
-      console.error('Clipboard prune tick failed:', e);
-    }
-  }, 24 * 60 * 60 * 1000);
-
   // Initialize snippet store
   initSnippetStore();
   initNoteStore();
@@ -14547,10 +14552,18 @@ app.whenReady().then(async () => {
       ) {
         refreshEmojiTriggerMonitor();
       }
-      if (patch.fileSearchProtectedRootsEnabled !== undefined) {
+      if (
+        patch.fileSearchProtectedRootsEnabled !== undefined ||
+        patch.fileSearchContentRoots !== undefined ||
+        patch.fileSearchIdleOnlyRefresh !== undefined ||
+        patch.fileSearchExtraRoots !== undefined
+      ) {
         startFileSearchIndexing({
           homeDir: app.getPath('home'),
           includeProtectedHomeRoots: Boolean(result.fileSearchProtectedRootsEnabled),
+          extraRoots: result.fileSearchExtraRoots,
+          contentRoots: result.fileSearchContentRoots,
+          idleOnlyRefresh: Boolean(result.fileSearchIdleOnlyRefresh),
         });
       }
       if (patch.openAtLogin !== undefined) {
@@ -14563,6 +14576,7 @@ app.whenReady().then(async () => {
         enterOverlayMacActivationPolicy();
         startClipboardMonitor();
         setClipboardAppBlacklist(loadSettings().clipboardAppBlacklist);
+        setClipboardHistoryRetentionDays(loadSettings().clipboardHistoryRetentionDays);
         syncFnSpeakToggleWatcher(loadSettings().commandHotkeys);
         syncFnCommandWatchers(loadSettings().commandHotkeys);
       }
@@ -14587,7 +14601,7 @@ app.whenReady().then(async () => {
         syncHyperKeyMonitor();
       }
       if (patch.clipboardHistoryRetentionDays !== undefined) {
-        pruneClipboardHistoryOlderThan(result.clipboardHistoryRetentionDays);
+        setClipboardHistoryRetentionDays(result.clipboardHistoryRetentionDays);
       }
       if (patch.clipboardAppBlacklist !== undefined) {
         setClipboardAppBlacklist(result.clipboardAppBlacklist);
@@ -16348,7 +16362,16 @@ return appURL's |path|() as text`,
   });
 
   ipcMain.handle('file-search-query', async (_event: any, query: string, options?: { limit?: number }) => {
-    return await searchIndexedFiles(query, { limit: Number(options?.limit) || undefined });
+    const sender = _event?.sender;
+    return await searchIndexedFiles(query, {
+      limit: Number(options?.limit) || undefined,
+      sessionId: String(sender?.id ?? ''),
+      // Timestamps follow the ranked reply in chunks; the renderer merges them by path.
+      onMetadata: (entries) => {
+        if (!sender || sender.isDestroyed()) return;
+        sender.send('file-search-metadata', entries);
+      },
+    });
   });
 
   ipcMain.handle('file-search-status', () => {
@@ -16527,8 +16550,22 @@ return appURL's |path|() as text`,
     return getClipboardHistory();
   });
 
-  ipcMain.handle('clipboard-search', (_event: any, query: string) => {
-    return searchClipboardHistory(query);
+  // The clipboard view lists summaries page by page and fetches one full item
+  // when it is selected; the revision tells it when its pages are stale.
+  ipcMain.handle('clipboard-get-history-page', (_event: any, options?: Parameters<typeof getClipboardHistoryPage>[0]) => {
+    return getClipboardHistoryPage(options);
+  });
+
+  ipcMain.handle('clipboard-get-history-revision', () => {
+    return getClipboardHistoryRevision();
+  });
+
+  ipcMain.handle('clipboard-get-item', (_event: any, id: string) => {
+    return getClipboardItemById(id);
+  });
+
+  ipcMain.handle('clipboard-search', (_event: any, query: string, options?: { limit?: number }) => {
+    return searchClipboardHistory(query, options);
   });
 
   ipcMain.handle('clipboard-clear-history', () => {
@@ -602,13 +602,35 @@ const electronAPI = {
     options?: { limit?: number }
   ): Promise<Array<{ path: string; name: string; parentPath: string; displayPath: string; isDirectory: boolean }>> =>
     ipcRenderer.invoke('file-search-query', query, options),
+  onFileSearchMetadata: (
+    callback: (entries: Array<{ path: string; mtimeMs?: number; birthtimeMs?: number; atimeMs?: number }>) => void
+  ) => {
+    const listener = (_event: any, entries: any) => callback(Array.isArray(entries) ? entries : []);
+    ipcRenderer.on('file-search-metadata', listener);
+    return () => {
+      ipcRenderer.removeListener('file-search-metadata', listener);
+    };
+  },
   getFileSearchIndexStatus: (): Promise<{
     indexing: boolean;
     ready: boolean;
     indexedEntryCount: number;
+    tombstoneCount: number;
     lastIndexedAt: number | null;
+    lastCompactedAt: number | null;
+    contentIndexedFileCount: number;
+    contentRoots: string[];
     homeDirectory: string;
     includeRoots: string[];
+    shards: Array<{
+      root: string;
+      indexing: boolean;
+      ready: boolean;
+      indexedEntryCount: number;
+      lastIndexedAt: number | null;
+      refreshIntervalMs: number;
+      lastError: string | null;
+    }>;
     excludedDirectoryNames: string[];
     excludedTopLevelDirectories: string[];
     protectedTopLevelDirectories: string[];
@@ -619,9 +641,22 @@ const electronAPI = {
     indexing: boolean;
     ready: boolean;
     indexedEntryCount: number;
+    tombstoneCount: number;
     lastIndexedAt: number | null;
+    lastCompactedAt: number | null;
+    contentIndexedFileCount: number;
+    contentRoots: string[];
     homeDirectory: string;
     includeRoots: string[];
+    shards: Array<{
+      root: string;
+      indexing: boolean;
+      ready: boolean;
+      indexedEntryCount: number;
+      lastIndexedAt: number | null;
+      refreshIntervalMs: number;
+      lastError: string | null;
+    }>;
     excludedDirectoryNames: string[];
     excludedTopLevelDirectories: string[];
     protectedTopLevelDirectories: string[];
@@ -640,8 +675,19 @@ const electronAPI = {
   // ─── Clipboard Manager ────────────────────────────────────────────
   clipboardGetHistory: (): Promise<any[]> =>
     ipcRenderer.invoke('clipboard-get-history'),
-  clipboardSearch: (query: string): Promise<any[]> =>
-    ipcRenderer.invoke('clipboard-search', query),
+  clipboardGetHistoryPage: (options?: {
+    cursor?: string | null;
+    limit?: number;
+    type?: 'all' | 'text' | 'image' | 'url' | 'file';
+    query?: string;
+  }): Promise<{ items: any[]; nextCursor: string | null; revision: number }> =>
+    ipcRenderer.invoke('clipboard-get-history-page', options),
+  clipboardGetHistoryRevision: (): Promise<number> =>
+    ipcRenderer.invoke('clipboard-get-history-revision'),
+  clipboardGetItem: (id: string): Promise<any | null> =>
+    ipcRenderer.invoke('clipboard-get-item', id),
+  clipboardSearch: (query: string, options?: { limit?: number }): Promise<any[]> =>
+    ipcRenderer.invoke('clipboard-search', query, options),
   clipboardClearHistory: (): Promise<void> =>
     ipcRenderer.invoke('clipboard-clear-history'),
   clipboardDeleteItem: (id: string): Promise<boolean> =>
@@ -228,6 +228,13 @@ export interface AppSettings {
   hasSeenOnboarding: boolean;
   hasSeenWhisperOnboarding: boolean;
   fileSearchProtectedRootsEnabled: boolean;
+  // Folders whose text files are indexed for `content:` queries; empty disables it.
+  fileSearchContentRoots: string[];
+  // Hold periodic file index refreshes until the user is away from the machine.
+  fileSearchIdleOnlyRefresh: boolean;
+  // Folders outside home (other volumes, external disks) indexed as separate
+  // shards; refreshIntervalMinutes 0 relies on the file watcher alone.
+  fileSearchExtraRoots: Array<{ path: string; refreshIntervalMinutes: number }>;
   disableFileSearchResults: boolean;
   showMenuBarIcon: boolean;
   ai: AISettings;
@@ -374,6 +381,9 @@ const DEFAULT_SETTINGS: AppSettings = {
   hasSeenOnboarding: false,
   hasSeenWhisperOnboarding: false,
   fileSearchProtectedRootsEnabled: false,
+  fileSearchContentRoots: [],
+  fileSearchIdleOnlyRefresh: false,
+  fileSearchExtraRoots: [],
   disableFileSearchResults: false,
   showMenuBarIcon: true,
   ai: { ...DEFAULT_AI_SETTINGS },
@@ -1007,6 +1017,8 @@ const NEVER_SYNC: ReadonlySet<keyof AppSettings> = new Set<keyof AppSettings>([
   'customExtensionFolders',
   'pinnedFiles',
   'launcherBackgroundImagePath',
+  'fileSearchContentRoots',
+  'fileSearchExtraRoots',
   // Tied to a per-machine TCC (macOS file-access) permission grant.
   'fileSearchProtectedRootsEnabled',
   // Per-machine timing / dismissal state.
@@ -1274,6 +1286,25 @@ export function loadSettings(): AppSettings {
         parsed.hasSeenWhisperOnboarding ?? false,
       fileSearchProtectedRootsEnabled:
         parsed.fileSearchProtectedRootsEnabled ?? DEFAULT_SETTINGS.fileSearchProtectedRootsEnabled,
+      fileSearchContentRoots: Array.isArray(parsed.fileSearchContentRoots)
+        ? parsed.fileSearchContentRoots
+            .map((value: any) => String(value || '').trim())
+            .filter(Boolean)
+        : DEFAULT_SETTINGS.fileSearchContentRoots,
+      fileSearchIdleOnlyRefresh: normalizeBoolean(
+        parsed.fileSearchIdleOnlyRefresh,
+        DEFAULT_SETTINGS.fileSearchIdleOnlyRefresh
+      ),
+      fileSearchExtraRoots: Array.isArray(parsed.fileSearchExtraRoots)
+        ? parsed.fileSearchExtraRoots
+            .map((value: any) => ({
+              path: String(value?.path || '').trim(),
+              refreshIntervalMinutes: Number.isFinite(Number(value?.refreshIntervalMinutes))
+                ? Math.max(0, Math.floor(Number(value.refreshIntervalMinutes)))
+                : 30,
+            }))
+            .filter((value: { path: string }) => Boolean(value.path))
+        : DEFAULT_SETTINGS.fileSearchExtraRoots,
       disableFileSearchResults: normalizeBoolean(
         parsed.disableFileSearchResults,
         DEFAULT_SETTINGS.disableFileSearchResults
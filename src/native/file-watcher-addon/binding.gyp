@@ -0,0 +1,17 @@
+{
+  "targets": [
+    {
+      "target_name": "file_watcher",
+      "conditions": [
+        ["OS=='linux'", {
+          "sources": ["inotify_watcher.cc"]
+        }]
+      ],
+      "include_dirs": [
+        "<!@(node -p \"require('node-addon-api').include\")"
+      ],
+      "defines": ["NAPI_DISABLE_CPP_EXCEPTIONS"],
+      "cflags_cc": ["-std=c++17"]
+    }
+  ]
+}
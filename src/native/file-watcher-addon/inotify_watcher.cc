@@ -0,0 +1,218 @@
+#include <napi.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+// inotify backend for the file search index watcher. One watcher owns an
+// inotify descriptor plus a reader thread that blocks in poll() and hands
+// drained event batches to JS through a thread-safe function. Watches are
+// registered per directory from JS, which decides what to skip. The callback
+// gets null once the descriptor fails, so JS can fall back to fs.watch.
+
+namespace {
+
+// IN_CLOSE_WRITE and IN_ATTRIB report files edited in place (content, mtime,
+// size) without the per-write noise of IN_MODIFY.
+constexpr uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF |
+                                IN_MOVE_SELF | IN_ONLYDIR | IN_DONT_FOLLOW |
+                                IN_EXCL_UNLINK;
+constexpr size_t kReadBufferSize = 64 * 1024;
+// Cap a single JS callback so one burst cannot stall the main thread.
+constexpr size_t kMaxEventsPerBatch = 4096;
+
+struct WatchEvent {
+  int32_t wd;
+  uint32_t mask;
+  uint32_t cookie;
+  std::string name;
+};
+
+using EventBatch = std::vector<WatchEvent>;
+
+// A null batch reports that the inotify descriptor failed.
+void DeliverEvents(Napi::Env env, Napi::Function callback, EventBatch* batch) {
+  if (env != nullptr && callback != nullptr && batch == nullptr) {
+    callback.Call({env.Null()});
+    return;
+  }
+  if (env != nullptr && callback != nullptr) {
+    Napi::Array events = Napi::Array::New(env, batch->size());
+    for (size_t i = 0; i < batch->size(); i++) {
+      const WatchEvent& source = (*batch)[i];
+      Napi::Object event = Napi::Object::New(env);
+      event.Set("wd", Napi::Number::New(env, source.wd));
+      event.Set("mask", Napi::Number::New(env, source.mask));
+      event.Set("cookie", Napi::Number::New(env, source.cookie));
+      event.Set("name", Napi::String::New(env, source.name));
+      events.Set(static_cast<uint32_t>(i), event);
+    }
+    callback.Call({events});
+  }
+  delete batch;
+}
+
+class InotifyWatcher : public Napi::ObjectWrap<InotifyWatcher> {
+ public:
+  static Napi::Function Define(Napi::Env env) {
+    return DefineClass(env, "InotifyWatcher", {
+      InstanceMethod("add", &InotifyWatcher::Add),
+      InstanceMethod("remove", &InotifyWatcher::Remove),
+      InstanceMethod("close", &InotifyWatcher::Close),
+    });
+  }
+
+  explicit InotifyWatcher(const Napi::CallbackInfo& info) : Napi::ObjectWrap<InotifyWatcher>(info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsFunction()) {
+      Napi::TypeError::New(env, "Expected an event callback").ThrowAsJavaScriptException();
+      return;
+    }
+
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0) {
+      Napi::Error::New(env, std::string("inotify_init1 failed: ") + strerror(errno)).ThrowAsJavaScriptException();
+      return;
+    }
+    if (pipe2(wake_fds_, O_NONBLOCK | O_CLOEXEC) != 0) {
+      Napi::Error::New(env, std::string("pipe2 failed: ") + strerror(errno)).ThrowAsJavaScriptException();
+      CloseDescriptors();
+      return;
+    }
+
+    on_events_ = Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(), "inotify-watcher", 0, 1);
+    // Keep the process exit path free of a pending watcher.
+    on_events_.Unref(env);
+    reader_ = std::thread(&InotifyWatcher::ReadLoop, this);
+    running_ = true;
+  }
+
+  ~InotifyWatcher() override { Shutdown(); }
+
+ private:
+  // Returns the watch descriptor, or -errno (ENOSPC once
+  // fs.inotify.max_user_watches is exhausted).
+  Napi::Value Add(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+      Napi::TypeError::New(env, "Expected a directory path").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    if (!running_) return Napi::Number::New(env, -EBADF);
+    std::string dir_path = info[0].As<Napi::String>().Utf8Value();
+    int wd = inotify_add_watch(inotify_fd_, dir_path.c_str(), kWatchMask);
+    return Napi::Number::New(env, wd < 0 ? -errno : wd);
+  }
+
+  Napi::Value Remove(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+      Napi::TypeError::New(env, "Expected a watch descriptor").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    if (!running_) return Napi::Boolean::New(env, false);
+    int wd = info[0].As<Napi::Number>().Int32Value();
+    return Napi::Boolean::New(env, inotify_rm_watch(inotify_fd_, wd) == 0);
+  }
+
+  Napi::Value Close(const Napi::CallbackInfo& info) {
+    Shutdown();
+    return info.Env().Undefined();
+  }
+
+  void ReadLoop() {
+    alignas(struct inotify_event) char buffer[kReadBufferSize];
+    pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wake_fds_[0], POLLIN, 0}};
+    for (;;) {
+      int ready = poll(fds, 2, -1);
+      if (ready < 0) {
+        if (errno == EINTR) continue;
+        return;
+      }
+      if (fds[1].revents != 0) return;
+      // Would otherwise wake poll() forever without anything to read.
+      if ((fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0) {
+        on_events_.NonBlockingCall(static_cast<EventBatch*>(nullptr), DeliverEvents);
+        return;
+      }
+      if ((fds[0].revents & POLLIN) == 0) continue;
+
+      auto* batch = new EventBatch();
+      while (batch->size() < kMaxEventsPerBatch) {
+        ssize_t length = read(inotify_fd_, buffer, sizeof(buffer));
+        if (length <= 0) break;  // EAGAIN: queue drained.
+        for (char* cursor = buffer; cursor < buffer + length;) {
+          const auto* event = reinterpret_cast<const struct inotify_event*>(cursor);
+          batch->push_back({event->wd, event->mask, event->cookie, event->len > 0 ? std::string(event->name) : std::string()});
+          cursor += sizeof(struct inotify_event) + event->len;
+        }
+      }
+      if (batch->empty()) {
+        delete batch;
+        continue;
+      }
+      if (on_events_.NonBlockingCall(batch, DeliverEvents) != napi_ok) {
+        delete batch;
+        return;
+      }
+    }
+  }
+
+  void Shutdown() {
+    if (!running_) return;
+    running_ = false;
+    char wake = 1;
+    ssize_t ignored = write(wake_fds_[1], &wake, 1);
+    (void)ignored;
+    if (reader_.joinable()) reader_.join();
+    on_events_.Release();
+    CloseDescriptors();
+  }
+
+  void CloseDescriptors() {
+    if (inotify_fd_ >= 0) close(inotify_fd_);
+    if (wake_fds_[0] >= 0) close(wake_fds_[0]);
+    if (wake_fds_[1] >= 0) close(wake_fds_[1]);
+    inotify_fd_ = -1;
+    wake_fds_[0] = -1;
+    wake_fds_[1] = -1;
+  }
+
+  int inotify_fd_ = -1;
+  int wake_fds_[2] = {-1, -1};
+  bool running_ = false;
+  std::thread reader_;
+  Napi::ThreadSafeFunction on_events_;
+};
+
+Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("InotifyWatcher", InotifyWatcher::Define(env));
+
+  Napi::Object constants = Napi::Object::New(env);
+  constants.Set("IN_MOVED_FROM", Napi::Number::New(env, IN_MOVED_FROM));
+  constants.Set("IN_MOVED_TO", Napi::Number::New(env, IN_MOVED_TO));
+  constants.Set("IN_CREATE", Napi::Number::New(env, IN_CREATE));
+  constants.Set("IN_DELETE", Napi::Number::New(env, IN_DELETE));
+  constants.Set("IN_CLOSE_WRITE", Napi::Number::New(env, IN_CLOSE_WRITE));
+  constants.Set("IN_ATTRIB", Napi::Number::New(env, IN_ATTRIB));
+  constants.Set("IN_DELETE_SELF", Napi::Number::New(env, IN_DELETE_SELF));
+  constants.Set("IN_MOVE_SELF", Napi::Number::New(env, IN_MOVE_SELF));
+  constants.Set("IN_Q_OVERFLOW", Napi::Number::New(env, IN_Q_OVERFLOW));
+  constants.Set("IN_IGNORED", Napi::Number::New(env, IN_IGNORED));
+  constants.Set("IN_ISDIR", Napi::Number::New(env, IN_ISDIR));
+  constants.Set("ENOSPC", Napi::Number::New(env, ENOSPC));
+  exports.Set("constants", constants);
+  return exports;
+}
+
+}  // namespace
+
+NODE_API_MODULE(file_watcher, Init)
@@ -0,0 +1,19 @@
+#include <napi.h>
+
+#include "native_helpers.h"
+
+// The AppKit helpers only exist on macOS and the X11 clipboard watcher only
+// on Linux; the directory walker and content hashes are built on both.
+Napi::Object Init(Napi::Env env, Napi::Object exports) {
+#if defined(__APPLE__)
+  RegisterMacHelpers(env, exports);
+#endif
+#if defined(__linux__)
+  RegisterClipboardWatcher(env, exports);
+#endif
+  RegisterDirectoryWalker(env, exports);
+  RegisterContentHash(env, exports);
+  return exports;
+}
+
+NODE_API_MODULE(native_helpers, Init)
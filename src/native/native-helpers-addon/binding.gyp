@@ -2,18 +2,29 @@
   "targets": [
     {
       "target_name": "native_helpers",
-      "sources": ["native_helpers.mm"],
+      "sources": ["addon.cc", "directory_walker.cc", "content_hash.cc"],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")"
       ],
       "defines": ["NAPI_DISABLE_CPP_EXCEPTIONS"],
-      "xcode_settings": {
-        "OTHER_CPLUSPLUSFLAGS": ["-ObjC++"],
-        "OTHER_LDFLAGS": [
-          "-framework AppKit",
-          "-framework CoreGraphics"
-        ]
-      }
+      "cflags_cc": ["-std=c++17"],
+      "conditions": [
+        ["OS=='linux'", {
+          "sources": ["clipboard_watcher_linux.cc"],
+          "libraries": ["-ldl"]
+        }],
+        ["OS=='mac'", {
+          "sources": ["native_helpers.mm"],
+          "xcode_settings": {
+            "CLANG_CXX_LANGUAGE_STANDARD": "c++17",
+            "OTHER_CPLUSPLUSFLAGS": ["-ObjC++"],
+            "OTHER_LDFLAGS": [
+              "-framework AppKit",
+              "-framework CoreGraphics"
+            ]
+          }
+        }]
+      ]
     }
   ]
 }
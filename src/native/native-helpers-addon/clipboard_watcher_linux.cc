@@ -0,0 +1,243 @@
+#include <napi.h>
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+
+#include "native_helpers.h"
+
+// X11 clipboard change notifications for the clipboard manager, so it reads
+// the clipboard when its owner changes instead of polling it every second.
+//
+// The watcher opens its own display connection, asks XFixes for
+// selection-owner events on CLIPBOARD, and a reader thread blocks in poll()
+// on that connection and hands each burst of events to JS through a
+// thread-safe function. libX11 and libXfixes are loaded with dlopen, so the
+// addon neither needs their headers to build nor fails to load on a machine
+// without them; the constructor throws instead and JS falls back.
+
+namespace {
+
+// The few Xlib / XFixes declarations used here, from Xlib.h and Xfixes.h.
+// Both libraries are ABI-stable.
+struct XDisplay;
+using XWindow = unsigned long;
+using XAtom = unsigned long;
+using XTime = unsigned long;
+
+struct XFixesSelectionNotifyEvent {
+  int type;
+  unsigned long serial;
+  int send_event;
+  XDisplay* display;
+  XWindow window;
+  int subtype;
+  XWindow owner;
+  XAtom selection;
+  XTime timestamp;
+  XTime selection_timestamp;
+};
+
+union XEvent {
+  int type;
+  XFixesSelectionNotifyEvent selection;
+  long pad[24];
+};
+
+constexpr int kXFixesSelectionNotify = 0;
+constexpr unsigned long kXFixesSetSelectionOwnerNotifyMask = 1L << 0;
+constexpr unsigned long kXFixesSelectionWindowDestroyNotifyMask = 1L << 1;
+constexpr unsigned long kXFixesSelectionClientCloseNotifyMask = 1L << 2;
+
+struct XLibrary {
+  void* x11 = nullptr;
+  void* xfixes = nullptr;
+  XDisplay* (*OpenDisplay)(const char*) = nullptr;
+  int (*CloseDisplay)(XDisplay*) = nullptr;
+  XWindow (*DefaultRootWindow)(XDisplay*) = nullptr;
+  XAtom (*InternAtom)(XDisplay*, const char*, int) = nullptr;
+  int (*ConnectionNumber)(XDisplay*) = nullptr;
+  int (*Pending)(XDisplay*) = nullptr;
+  int (*NextEvent)(XDisplay*, XEvent*) = nullptr;
+  int (*Flush)(XDisplay*) = nullptr;
+  int (*FixesQueryExtension)(XDisplay*, int*, int*) = nullptr;
+  void (*FixesSelectSelectionInput)(XDisplay*, XWindow, XAtom, unsigned long) = nullptr;
+};
+
+template <typename T>
+bool LoadSymbol(void* library, const char* name, T* target) {
+  *target = reinterpret_cast<T>(dlsym(library, name));
+  return *target != nullptr;
+}
+
+// Loaded once and kept for the life of the process; null when unavailable.
+const XLibrary* LoadXLibrary(std::string* error) {
+  static XLibrary library;
+  static bool attempted = false;
+  static bool loaded = false;
+  static std::string load_error;
+  if (!attempted) {
+    attempted = true;
+    library.x11 = dlopen("libX11.so.6", RTLD_NOW | RTLD_LOCAL);
+    library.xfixes = library.x11 ? dlopen("libXfixes.so.3", RTLD_NOW | RTLD_LOCAL) : nullptr;
+    if (!library.x11 || !library.xfixes) {
+      load_error = std::string("X11 libraries unavailable: ") + dlerror();
+    } else if (!LoadSymbol(library.x11, "XOpenDisplay", &library.OpenDisplay) ||
+               !LoadSymbol(library.x11, "XCloseDisplay", &library.CloseDisplay) ||
+               !LoadSymbol(library.x11, "XDefaultRootWindow", &library.DefaultRootWindow) ||
+               !LoadSymbol(library.x11, "XInternAtom", &library.InternAtom) ||
+               !LoadSymbol(library.x11, "XConnectionNumber", &library.ConnectionNumber) ||
+               !LoadSymbol(library.x11, "XPending", &library.Pending) ||
+               !LoadSymbol(library.x11, "XNextEvent", &library.NextEvent) ||
+               !LoadSymbol(library.x11, "XFlush", &library.Flush) ||
+               !LoadSymbol(library.xfixes, "XFixesQueryExtension", &library.FixesQueryExtension) ||
+               !LoadSymbol(library.xfixes, "XFixesSelectSelectionInput", &library.FixesSelectSelectionInput)) {
+      load_error = "X11 libraries lack the XFixes selection API";
+    } else {
+      loaded = true;
+    }
+  }
+  if (!loaded) *error = load_error;
+  return loaded ? &library : nullptr;
+}
+
+void DeliverChange(Napi::Env env, Napi::Function callback, int* count) {
+  if (env != nullptr && callback != nullptr) callback.Call({Napi::Number::New(env, *count)});
+  delete count;
+}
+
+class ClipboardWatcher : public Napi::ObjectWrap<ClipboardWatcher> {
+ public:
+  static Napi::Function Define(Napi::Env env) {
+    return DefineClass(env, "ClipboardWatcher", {
+      InstanceMethod("close", &ClipboardWatcher::Close),
+    });
+  }
+
+  explicit ClipboardWatcher(const Napi::CallbackInfo& info) : Napi::ObjectWrap<ClipboardWatcher>(info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsFunction()) {
+      Napi::TypeError::New(env, "Expected a change callback").ThrowAsJavaScriptException();
+      return;
+    }
+
+    std::string error;
+    x_ = LoadXLibrary(&error);
+    if (!x_) {
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+      return;
+    }
+    // Null uses $DISPLAY, as the rest of the app does.
+    display_ = x_->OpenDisplay(nullptr);
+    if (!display_) {
+      Napi::Error::New(env, "Cannot open the X display").ThrowAsJavaScriptException();
+      return;
+    }
+    int error_base = 0;
+    if (!x_->FixesQueryExtension(display_, &event_base_, &error_base)) {
+      Napi::Error::New(env, "The X server lacks the XFixes extension").ThrowAsJavaScriptException();
+      CloseDisplay();
+      return;
+    }
+    if (pipe2(wake_fds_, O_NONBLOCK | O_CLOEXEC) != 0) {
+      Napi::Error::New(env, std::string("pipe2 failed: ") + strerror(errno)).ThrowAsJavaScriptException();
+      CloseDisplay();
+      return;
+    }
+
+    XAtom clipboard = x_->InternAtom(display_, "CLIPBOARD", 0);
+    // A crashed or exited owner also changes what the clipboard holds.
+    x_->FixesSelectSelectionInput(display_, x_->DefaultRootWindow(display_), clipboard,
+                                  kXFixesSetSelectionOwnerNotifyMask |
+                                      kXFixesSelectionWindowDestroyNotifyMask |
+                                      kXFixesSelectionClientCloseNotifyMask);
+    x_->Flush(display_);
+
+    on_change_ = Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(), "clipboard-watcher", 0, 1);
+    // Keep the process exit path free of a pending watcher.
+    on_change_.Unref(env);
+    // From here on only the reader thread touches the display.
+    reader_ = std::thread(&ClipboardWatcher::ReadLoop, this);
+    running_ = true;
+  }
+
+  ~ClipboardWatcher() override { Shutdown(); }
+
+ private:
+  Napi::Value Close(const Napi::CallbackInfo& info) {
+    Shutdown();
+    return info.Env().Undefined();
+  }
+
+  void ReadLoop() {
+    pollfd fds[2] = {{x_->ConnectionNumber(display_), POLLIN, 0}, {wake_fds_[0], POLLIN, 0}};
+    for (;;) {
+      // Drain what Xlib has already buffered before blocking on the socket.
+      int changes = 0;
+      while (x_->Pending(display_) > 0) {
+        XEvent event;
+        x_->NextEvent(display_, &event);
+        if (event.type == event_base_ + kXFixesSelectionNotify) changes += 1;
+      }
+      if (changes > 0) {
+        if (on_change_.NonBlockingCall(new int(changes), DeliverChange) != napi_ok) return;
+      }
+
+      int ready = poll(fds, 2, -1);
+      if (ready < 0) {
+        if (errno == EINTR) continue;
+        return;
+      }
+      if (fds[1].revents != 0) return;
+      // Stop before Xlib sees a dead connection: its I/O error handler
+      // exits the process.
+      if ((fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0) {
+        connection_lost_ = true;
+        on_change_.NonBlockingCall(new int(-1), DeliverChange);
+        return;
+      }
+    }
+  }
+
+  void Shutdown() {
+    if (!running_) return;
+    running_ = false;
+    char wake = 1;
+    ssize_t ignored = write(wake_fds_[1], &wake, 1);
+    (void)ignored;
+    if (reader_.joinable()) reader_.join();
+    on_change_.Release();
+    // Closing a lost connection would run into the same I/O error handler.
+    if (!connection_lost_) CloseDisplay();
+    close(wake_fds_[0]);
+    close(wake_fds_[1]);
+    wake_fds_[0] = -1;
+    wake_fds_[1] = -1;
+  }
+
+  void CloseDisplay() {
+    if (display_) x_->CloseDisplay(display_);
+    display_ = nullptr;
+  }
+
+  const XLibrary* x_ = nullptr;
+  XDisplay* display_ = nullptr;
+  int event_base_ = 0;
+  int wake_fds_[2] = {-1, -1};
+  bool running_ = false;
+  bool connection_lost_ = false;
+  std::thread reader_;
+  Napi::ThreadSafeFunction on_change_;
+};
+
+}  // namespace
+
+void RegisterClipboardWatcher(Napi::Env env, Napi::Object exports) {
+  exports.Set("ClipboardWatcher", ClipboardWatcher::Define(env));
+}
@@ -0,0 +1,321 @@
+#include <napi.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "native_helpers.h"
+
+// Content hashes for clipboard dedupe.
+//
+// hashBuffer is XXH3-64 (seed 0, default secret) over every byte of a buffer,
+// so the clipboard manager can fingerprint a 40 MB screenshot on each change
+// without sampling it. It is a plain scalar implementation of the reference
+// algorithm and produces the same values as xxHash's XXH3_64bits.
+//
+// imageDifferenceHash is a 256-bit difference hash (dHash) of a decoded
+// bitmap: the image is averaged down to a 17x16 grayscale grid and each bit
+// records whether a cell is brighter than its right neighbour. Re-encoding,
+// colour profile rounding and scaling noise leave it unchanged, so two copies
+// of the same picture hash equal even when their bytes differ. It runs on a
+// libuv worker thread since it reads the whole bitmap.
+
+namespace {
+
+constexpr uint64_t kPrime32_1 = 0x9E3779B1U;
+constexpr uint64_t kPrime32_2 = 0x85EBCA77U;
+constexpr uint64_t kPrime32_3 = 0xC2B2AE3DU;
+constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime64_5 = 0x27D4EB2F165667C5ULL;
+constexpr uint64_t kPrimeMx1 = 0x165667919E3779F9ULL;
+constexpr uint64_t kPrimeMx2 = 0x9FB21C651E98DF25ULL;
+
+constexpr size_t kSecretSize = 192;
+constexpr size_t kStripeLength = 64;
+constexpr size_t kSecretConsumeRate = 8;
+constexpr size_t kStripesPerBlock = (kSecretSize - kStripeLength) / kSecretConsumeRate;
+constexpr size_t kBlockLength = kStripeLength * kStripesPerBlock;
+constexpr size_t kMidsizeMax = 240;
+
+const uint8_t kSecret[kSecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+// Both supported targets (x86-64 and arm64) are little-endian.
+inline uint32_t Read32(const uint8_t* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline uint64_t Read64(const uint8_t* p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline uint64_t Rotl64(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+inline uint64_t Mul128Fold64(uint64_t lhs, uint64_t rhs) {
+  const unsigned __int128 product = static_cast<unsigned __int128>(lhs) * rhs;
+  return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+inline uint64_t XorShift(uint64_t value, int shift) { return value ^ (value >> shift); }
+
+uint64_t Xxh64Avalanche(uint64_t hash) {
+  hash = XorShift(hash, 33) * kPrime64_2;
+  hash = XorShift(hash, 29) * kPrime64_3;
+  return XorShift(hash, 32);
+}
+
+uint64_t Xxh3Avalanche(uint64_t hash) {
+  hash = XorShift(hash, 37) * kPrimeMx1;
+  return XorShift(hash, 32);
+}
+
+uint64_t Rrmxmx(uint64_t hash, uint64_t length) {
+  hash ^= Rotl64(hash, 49) ^ Rotl64(hash, 24);
+  hash *= kPrimeMx2;
+  hash ^= (hash >> 35) + length;
+  hash *= kPrimeMx2;
+  return XorShift(hash, 28);
+}
+
+inline uint64_t Mix16(const uint8_t* input, const uint8_t* secret) {
+  return Mul128Fold64(Read64(input) ^ Read64(secret), Read64(input + 8) ^ Read64(secret + 8));
+}
+
+uint64_t HashUpTo16(const uint8_t* input, size_t length) {
+  if (length > 8) {
+    const uint64_t lo = Read64(input) ^ (Read64(kSecret + 24) ^ Read64(kSecret + 32));
+    const uint64_t hi = Read64(input + length - 8) ^ (Read64(kSecret + 40) ^ Read64(kSecret + 48));
+    return Xxh3Avalanche(length + __builtin_bswap64(lo) + hi + Mul128Fold64(lo, hi));
+  }
+  if (length >= 4) {
+    const uint64_t combined = Read32(input + length - 4) + (static_cast<uint64_t>(Read32(input)) << 32);
+    return Rrmxmx(combined ^ (Read64(kSecret + 8) ^ Read64(kSecret + 16)), length);
+  }
+  if (length > 0) {
+    const uint32_t combined = (static_cast<uint32_t>(input[0]) << 16) |
+                              (static_cast<uint32_t>(input[length >> 1]) << 24) |
+                              static_cast<uint32_t>(input[length - 1]) | (static_cast<uint32_t>(length) << 8);
+    return Xxh64Avalanche(combined ^ static_cast<uint64_t>(Read32(kSecret) ^ Read32(kSecret + 4)));
+  }
+  return Xxh64Avalanche(Read64(kSecret + 56) ^ Read64(kSecret + 64));
+}
+
+uint64_t HashUpTo128(const uint8_t* input, size_t length) {
+  uint64_t acc = length * kPrime64_1;
+  if (length > 32) {
+    if (length > 64) {
+      if (length > 96) {
+        acc += Mix16(input + 48, kSecret + 96);
+        acc += Mix16(input + length - 64, kSecret + 112);
+      }
+      acc += Mix16(input + 32, kSecret + 64);
+      acc += Mix16(input + length - 48, kSecret + 80);
+    }
+    acc += Mix16(input + 16, kSecret + 32);
+    acc += Mix16(input + length - 32, kSecret + 48);
+  }
+  acc += Mix16(input, kSecret);
+  acc += Mix16(input + length - 16, kSecret + 16);
+  return Xxh3Avalanche(acc);
+}
+
+uint64_t HashUpTo240(const uint8_t* input, size_t length) {
+  uint64_t acc = length * kPrime64_1;
+  const size_t rounds = length / 16;
+  for (size_t i = 0; i < 8; i++) acc += Mix16(input + 16 * i, kSecret + 16 * i);
+  acc = Xxh3Avalanche(acc);
+  for (size_t i = 8; i < rounds; i++) acc += Mix16(input + 16 * i, kSecret + 16 * (i - 8) + 3);
+  // The last 16 bytes use the end of the minimum-size secret (136 bytes).
+  acc += Mix16(input + length - 16, kSecret + 136 - 17);
+  return Xxh3Avalanche(acc);
+}
+
+inline uint64_t Mix16Accs(const uint64_t* acc, const uint8_t* secret) {
+  return Mul128Fold64(acc[0] ^ Read64(secret), acc[1] ^ Read64(secret + 8));
+}
+
+inline void AccumulateStripe(uint64_t* acc, const uint8_t* input, const uint8_t* secret) {
+  for (size_t i = 0; i < 8; i++) {
+    const uint64_t data = Read64(input + 8 * i);
+    const uint64_t key = data ^ Read64(secret + 8 * i);
+    acc[i ^ 1] += data;
+    acc[i] += (key & 0xFFFFFFFFULL) * (key >> 32);
+  }
+}
+
+inline void Accumulate(uint64_t* acc, const uint8_t* input, size_t stripes) {
+  for (size_t n = 0; n < stripes; n++) {
+    AccumulateStripe(acc, input + n * kStripeLength, kSecret + n * kSecretConsumeRate);
+  }
+}
+
+inline void Scramble(uint64_t* acc) {
+  const uint8_t* secret = kSecret + kSecretSize - kStripeLength;
+  for (size_t i = 0; i < 8; i++) {
+    acc[i] = (XorShift(acc[i], 47) ^ Read64(secret + 8 * i)) * kPrime32_1;
+  }
+}
+
+uint64_t HashLong(const uint8_t* input, size_t length) {
+  uint64_t acc[8] = {kPrime32_3, kPrime64_1, kPrime64_2, kPrime64_3,
+                     kPrime64_4, kPrime32_2, kPrime64_5, kPrime32_1};
+  const size_t blocks = (length - 1) / kBlockLength;
+  for (size_t n = 0; n < blocks; n++) {
+    Accumulate(acc, input + n * kBlockLength, kStripesPerBlock);
+    Scramble(acc);
+  }
+  const size_t stripes = ((length - 1) - kBlockLength * blocks) / kStripeLength;
+  Accumulate(acc, input + blocks * kBlockLength, stripes);
+  AccumulateStripe(acc, input + length - kStripeLength, kSecret + kSecretSize - kStripeLength - 7);
+
+  uint64_t result = length * kPrime64_1;
+  for (size_t i = 0; i < 4; i++) result += Mix16Accs(acc + 2 * i, kSecret + 11 + 16 * i);
+  return Xxh3Avalanche(result);
+}
+
+uint64_t Xxh3Hash64(const uint8_t* input, size_t length) {
+  if (length <= 16) return HashUpTo16(input, length);
+  if (length <= 128) return HashUpTo128(input, length);
+  if (length <= kMidsizeMax) return HashUpTo240(input, length);
+  return HashLong(input, length);
+}
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+std::string ToHex(const uint64_t* words, size_t count) {
+  std::string hex(count * 16, '0');
+  for (size_t w = 0; w < count; w++) {
+    for (int i = 0; i < 16; i++) hex[w * 16 + i] = kHexDigits[(words[w] >> (60 - 4 * i)) & 0xF];
+  }
+  return hex;
+}
+
+// The dHash grid: one column more than bits per row, since each bit compares
+// two neighbours.
+constexpr uint32_t kDHashColumns = 17;
+constexpr uint32_t kDHashRows = 16;
+
+class ImageDifferenceHashWorker : public Napi::AsyncWorker {
+ public:
+  ImageDifferenceHashWorker(Napi::Env env, Napi::Buffer<uint8_t> bitmap, uint32_t width, uint32_t height)
+      : Napi::AsyncWorker(env, "SuperCmdImageDifferenceHash"),
+        deferred_(Napi::Promise::Deferred::New(env)),
+        bitmap_ref_(Napi::Persistent(bitmap)),
+        pixels_(bitmap.Data()),
+        width_(width),
+        height_(height) {}
+
+  Napi::Promise Promise() { return deferred_.Promise(); }
+
+ protected:
+  void Execute() override {
+    // Box-average BGRA pixels into the grid in a single pass over the bitmap.
+    std::vector<uint32_t> column_cells(width_);
+    uint64_t column_counts[kDHashColumns] = {};
+    uint64_t row_counts[kDHashRows] = {};
+    for (uint32_t x = 0; x < width_; x++) {
+      column_cells[x] = static_cast<uint32_t>(static_cast<uint64_t>(x) * kDHashColumns / width_);
+      column_counts[column_cells[x]] += 1;
+    }
+    double sums[kDHashRows][kDHashColumns] = {};
+    for (uint32_t y = 0; y < height_; y++) {
+      const uint32_t row = static_cast<uint32_t>(static_cast<uint64_t>(y) * kDHashRows / height_);
+      row_counts[row] += 1;
+      const uint8_t* pixel = pixels_ + static_cast<size_t>(y) * width_ * 4;
+      uint64_t row_sums[kDHashColumns] = {};
+      for (uint32_t x = 0; x < width_; x++, pixel += 4) {
+        // Integer Rec. 601 luma; channels are in B, G, R, A order.
+        row_sums[column_cells[x]] += 29u * pixel[0] + 150u * pixel[1] + 77u * pixel[2];
+      }
+      for (uint32_t column = 0; column < kDHashColumns; column++) sums[row][column] += row_sums[column];
+    }
+
+    uint64_t bits[kDHashRows * (kDHashColumns - 1) / 64] = {};
+    size_t bit = 0;
+    for (uint32_t row = 0; row < kDHashRows; row++) {
+      for (uint32_t column = 0; column + 1 < kDHashColumns; column++, bit++) {
+        const double left = sums[row][column] / static_cast<double>(row_counts[row] * column_counts[column]);
+        const double right = sums[row][column + 1] / static_cast<double>(row_counts[row] * column_counts[column + 1]);
+        if (left > right) bits[bit / 64] |= 1ULL << (63 - bit % 64);
+      }
+    }
+    hash_ = ToHex(bits, sizeof(bits) / sizeof(bits[0]));
+  }
+
+  void OnOK() override { deferred_.Resolve(Napi::String::New(Env(), hash_)); }
+
+  void OnError(const Napi::Error& error) override { deferred_.Reject(error.Value()); }
+
+ private:
+  Napi::Promise::Deferred deferred_;
+  // Keeps the bitmap alive while the worker reads it.
+  Napi::Reference<Napi::Buffer<uint8_t>> bitmap_ref_;
+  const uint8_t* pixels_;
+  uint32_t width_;
+  uint32_t height_;
+  std::string hash_;
+};
+
+// hashBuffer(buffer) -> 16 hex digits of XXH3-64.
+Napi::Value HashBuffer(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsBuffer()) {
+    Napi::TypeError::New(env, "Expected a buffer").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Buffer<uint8_t> buffer = info[0].As<Napi::Buffer<uint8_t>>();
+  const uint64_t hash = Xxh3Hash64(buffer.Data(), buffer.Length());
+  return Napi::String::New(env, ToHex(&hash, 1));
+}
+
+// imageDifferenceHash(bitmap, width, height) -> Promise<64 hex digits>, for a
+// BGRA bitmap such as nativeImage.toBitmap() returns. The buffer must not be
+// written to until the promise settles.
+Napi::Value ImageDifferenceHash(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 3 || !info[0].IsBuffer() || !info[1].IsNumber() || !info[2].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a bitmap buffer, width and height").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Buffer<uint8_t> bitmap = info[0].As<Napi::Buffer<uint8_t>>();
+  const int64_t width = info[1].As<Napi::Number>().Int64Value();
+  const int64_t height = info[2].As<Napi::Number>().Int64Value();
+  if (width < kDHashColumns || height < kDHashRows || width > 65536 || height > 65536 ||
+      static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * 4 > bitmap.Length()) {
+    Napi::RangeError::New(env, "Bitmap size does not match its dimensions").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  auto* worker = new ImageDifferenceHashWorker(env, bitmap, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
+  return promise;
+}
+
+}  // namespace
+
+void RegisterContentHash(Napi::Env env, Napi::Object exports) {
+  exports.Set("hashBuffer", Napi::Function::New(env, HashBuffer));
+  exports.Set("imageDifferenceHash", Napi::Function::New(env, ImageDifferenceHash));
+}
@@ -0,0 +1,356 @@
+#include <napi.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "native_helpers.h"
+
+// Batched directory listing for the file search index walk. One call lists a
+// batch of directories on a libuv worker thread (getdents64 on Linux, readdir
+// on macOS), drops entries the index never keeps, stats the rest and returns
+// the whole batch as a few typed arrays. A full build then crosses into native
+// code once per batch instead of once per readdir and once per stat.
+//
+// Filtering here is only a shortcut: JS applies the same rules again, so an
+// entry must only be dropped when JS would drop it too.
+
+namespace {
+
+// Entry types reported to JS; sockets, FIFOs and devices are left out.
+constexpr uint8_t kEntryFile = 1;
+constexpr uint8_t kEntryDirectory = 2;
+constexpr uint8_t kEntrySymlink = 3;
+constexpr uint8_t kEntrySkipped = 0;
+constexpr size_t kDirentBufferSize = 64 * 1024;
+constexpr uint32_t kMaxDirectoriesPerCall = 1024;
+
+#if defined(__linux__)
+struct LinuxDirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[];
+};
+#endif
+
+struct ListingFilter {
+  // Lowercased names and extensions (with the dot); file names match exactly.
+  std::unordered_set<std::string> excluded_directory_names;
+  std::unordered_set<std::string> excluded_file_names;
+  std::unordered_set<std::string> excluded_file_extensions;
+  bool skip_hidden_directories = false;
+};
+
+struct DirectoryResult {
+  int error = 0;
+  uint32_t entry_count = 0;
+  std::string identity;
+};
+
+struct ListingBatch {
+  std::vector<DirectoryResult> directories;
+  // Entry names, each terminated by a NUL byte.
+  std::string names;
+  std::vector<uint8_t> types;
+  // Following symlinks; -1 where the stat failed.
+  std::vector<double> sizes;
+  std::vector<double> mtimes_ms;
+};
+
+std::string ToLowerAscii(const char* value, size_t length) {
+  std::string lower(value, length);
+  for (char& c : lower) {
+    if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+  }
+  return lower;
+}
+
+uint8_t ToEntryType(mode_t mode) {
+  if (S_ISREG(mode)) return kEntryFile;
+  if (S_ISDIR(mode)) return kEntryDirectory;
+  if (S_ISLNK(mode)) return kEntrySymlink;
+  return kEntrySkipped;
+}
+
+double GetMtimeMs(const struct stat& st) {
+#if defined(__APPLE__)
+  return static_cast<double>(st.st_mtimespec.tv_sec) * 1000.0 + st.st_mtimespec.tv_nsec / 1e6;
+#else
+  return static_cast<double>(st.st_mtim.tv_sec) * 1000.0 + st.st_mtim.tv_nsec / 1e6;
+#endif
+}
+
+bool IsExcluded(const ListingFilter& filter, const char* name, size_t length, uint8_t type) {
+  if (type == kEntryDirectory) {
+    if (filter.skip_hidden_directories && name[0] == '.') return true;
+    return filter.excluded_directory_names.count(ToLowerAscii(name, length)) > 0;
+  }
+  if (type != kEntryFile) return false;
+  if (filter.excluded_file_names.count(std::string(name, length)) > 0) return true;
+  // Same as path.extname: a leading dot does not start an extension.
+  const char* dot = strrchr(name, '.');
+  if (dot == nullptr || dot == name) return false;
+  return filter.excluded_file_extensions.count(ToLowerAscii(dot, length - (dot - name))) > 0;
+}
+
+class DirectoryReader {
+ public:
+  DirectoryReader(const ListingFilter& filter, bool stat_entries, ListingBatch* batch)
+      : filter_(filter), stat_entries_(stat_entries), batch_(batch) {}
+
+  void List(const std::string& path) {
+    DirectoryResult result;
+    const size_t names_start = batch_->names.size();
+    const size_t entries_start = batch_->types.size();
+
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+      result.error = errno;
+      batch_->directories.push_back(std::move(result));
+      return;
+    }
+    struct stat dir_stat;
+    if (fstat(fd, &dir_stat) == 0) {
+      result.identity = std::to_string(static_cast<uint64_t>(dir_stat.st_dev)) + ":" +
+                        std::to_string(static_cast<uint64_t>(dir_stat.st_ino));
+    }
+
+    result.error = ReadEntries(fd);
+    if (result.error != 0) {
+      // Like a failed readdir: the directory contributes nothing.
+      batch_->names.resize(names_start);
+      batch_->types.resize(entries_start);
+      batch_->sizes.resize(entries_start);
+      batch_->mtimes_ms.resize(entries_start);
+    }
+    result.entry_count = static_cast<uint32_t>(batch_->types.size() - entries_start);
+    batch_->directories.push_back(std::move(result));
+  }
+
+ private:
+#if defined(__linux__)
+  // Takes ownership of fd.
+  int ReadEntries(int fd) {
+    if (buffer_.empty()) buffer_.resize(kDirentBufferSize);
+    int error = 0;
+    for (;;) {
+      long read = syscall(SYS_getdents64, fd, buffer_.data(), buffer_.size());
+      if (read < 0) {
+        if (errno == EINTR) continue;
+        error = errno;
+        break;
+      }
+      if (read == 0) break;
+      for (long offset = 0; offset < read;) {
+        const auto* entry = reinterpret_cast<const LinuxDirent64*>(buffer_.data() + offset);
+        offset += entry->d_reclen;
+        AddEntry(fd, entry->d_name, entry->d_type);
+      }
+    }
+    close(fd);
+    return error;
+  }
+#else
+  // Takes ownership of fd. readdir already reads entries in large batches
+  // through getdirentries.
+  int ReadEntries(int fd) {
+    DIR* dir = fdopendir(fd);
+    if (dir == nullptr) {
+      int error = errno;
+      close(fd);
+      return error;
+    }
+    int error = 0;
+    for (;;) {
+      errno = 0;
+      struct dirent* entry = readdir(dir);
+      if (entry == nullptr) {
+        error = errno;
+        break;
+      }
+      AddEntry(fd, entry->d_name, entry->d_type);
+    }
+    closedir(dir);
+    return error;
+  }
+#endif
+
+  void AddEntry(int dir_fd, const char* name, unsigned char d_type) {
+    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) return;
+
+    uint8_t type = kEntrySkipped;
+    switch (d_type) {
+      case DT_REG: type = kEntryFile; break;
+      case DT_DIR: type = kEntryDirectory; break;
+      case DT_LNK: type = kEntrySymlink; break;
+      case DT_UNKNOWN: {
+        // Some filesystems (older XFS, some network mounts) leave the type out.
+        struct stat st;
+        if (fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) type = ToEntryType(st.st_mode);
+        break;
+      }
+      default: break;
+    }
+    if (type == kEntrySkipped) return;
+
+    const size_t length = strlen(name);
+    if (IsExcluded(filter_, name, length, type)) return;
+
+    double size = -1;
+    double mtime_ms = -1;
+    struct stat st;
+    if (stat_entries_ && fstatat(dir_fd, name, &st, 0) == 0) {
+      size = static_cast<double>(st.st_size);
+      mtime_ms = GetMtimeMs(st);
+    }
+    batch_->names.append(name, length + 1);
+    batch_->types.push_back(type);
+    batch_->sizes.push_back(size);
+    batch_->mtimes_ms.push_back(mtime_ms);
+  }
+
+  const ListingFilter& filter_;
+  const bool stat_entries_;
+  ListingBatch* batch_;
+  std::vector<char> buffer_;
+};
+
+template <typename TypedArray, typename T>
+TypedArray CopyToTypedArray(Napi::Env env, const std::vector<T>& values) {
+  // Copied rather than wrapped: Electron does not allow external buffers.
+  Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, values.size() * sizeof(T));
+  if (!values.empty()) memcpy(buffer.Data(), values.data(), values.size() * sizeof(T));
+  return TypedArray::New(env, values.size(), buffer, 0);
+}
+
+class ListDirectoriesWorker : public Napi::AsyncWorker {
+ public:
+  ListDirectoriesWorker(Napi::Env env, std::vector<std::string> paths, ListingFilter filter, bool stat_entries)
+      : Napi::AsyncWorker(env, "SuperCmdListDirectories"),
+        deferred_(Napi::Promise::Deferred::New(env)),
+        paths_(std::move(paths)),
+        filter_(std::move(filter)),
+        stat_entries_(stat_entries) {}
+
+  Napi::Promise Promise() { return deferred_.Promise(); }
+
+ protected:
+  void Execute() override {
+    batch_.directories.reserve(paths_.size());
+    DirectoryReader reader(filter_, stat_entries_, &batch_);
+    for (const std::string& path : paths_) reader.List(path);
+  }
+
+  void OnOK() override {
+    Napi::Env env = Env();
+    const size_t directory_count = batch_.directories.size();
+    std::vector<uint32_t> entry_counts(directory_count);
+    std::vector<int32_t> errors(directory_count);
+    Napi::Array identities = Napi::Array::New(env, directory_count);
+    for (size_t i = 0; i < directory_count; i++) {
+      const DirectoryResult& directory = batch_.directories[i];
+      entry_counts[i] = directory.entry_count;
+      errors[i] = directory.error;
+      identities.Set(static_cast<uint32_t>(i), Napi::String::New(env, directory.identity));
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("entryCounts", CopyToTypedArray<Napi::Uint32Array>(env, entry_counts));
+    result.Set("errors", CopyToTypedArray<Napi::Int32Array>(env, errors));
+    result.Set("identities", identities);
+    result.Set("names", Napi::Buffer<char>::Copy(env, batch_.names.data(), batch_.names.size()));
+    result.Set("types", CopyToTypedArray<Napi::Uint8Array>(env, batch_.types));
+    result.Set("sizes", CopyToTypedArray<Napi::Float64Array>(env, batch_.sizes));
+    result.Set("mtimesMs", CopyToTypedArray<Napi::Float64Array>(env, batch_.mtimes_ms));
+    deferred_.Resolve(result);
+  }
+
+  void OnError(const Napi::Error& error) override { deferred_.Reject(error.Value()); }
+
+ private:
+  Napi::Promise::Deferred deferred_;
+  std::vector<std::string> paths_;
+  ListingFilter filter_;
+  bool stat_entries_;
+  ListingBatch batch_;
+};
+
+bool ReadStringSet(Napi::Object options, const char* key, bool lowercase, std::unordered_set<std::string>* out) {
+  Napi::Value value = options.Get(key);
+  if (value.IsUndefined()) return true;
+  if (!value.IsArray()) return false;
+  Napi::Array values = value.As<Napi::Array>();
+  for (uint32_t i = 0; i < values.Length(); i++) {
+    Napi::Value item = values.Get(i);
+    if (!item.IsString()) return false;
+    std::string name = item.As<Napi::String>().Utf8Value();
+    out->insert(lowercase ? ToLowerAscii(name.data(), name.size()) : name);
+  }
+  return true;
+}
+
+// listDirectories(paths, options?) -> Promise<{ entryCounts, errors,
+// identities, names, types, sizes, mtimesMs }>. Entries of paths[i] follow
+// those of paths[i - 1]; a directory that cannot be read has a non-zero errno
+// in `errors` and no entries.
+Napi::Value ListDirectories(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "Expected an array of directory paths").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Array path_values = info[0].As<Napi::Array>();
+  if (path_values.Length() > kMaxDirectoriesPerCall) {
+    Napi::RangeError::New(env, "Too many directories in one call").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::vector<std::string> paths;
+  paths.reserve(path_values.Length());
+  for (uint32_t i = 0; i < path_values.Length(); i++) {
+    Napi::Value value = path_values.Get(i);
+    if (!value.IsString()) {
+      Napi::TypeError::New(env, "Directory paths must be strings").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    paths.push_back(value.As<Napi::String>().Utf8Value());
+  }
+
+  ListingFilter filter;
+  bool stat_entries = true;
+  if (info.Length() > 1 && info[1].IsObject()) {
+    Napi::Object options = info[1].As<Napi::Object>();
+    if (!ReadStringSet(options, "excludedDirectoryNames", true, &filter.excluded_directory_names) ||
+        !ReadStringSet(options, "excludedFileNames", false, &filter.excluded_file_names) ||
+        !ReadStringSet(options, "excludedFileExtensions", true, &filter.excluded_file_extensions)) {
+      Napi::TypeError::New(env, "Excluded names must be arrays of strings").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    filter.skip_hidden_directories = options.Get("skipHiddenDirectories").ToBoolean().Value();
+    Napi::Value stat_value = options.Get("statEntries");
+    if (!stat_value.IsUndefined()) stat_entries = stat_value.ToBoolean().Value();
+  }
+
+  auto* worker = new ListDirectoriesWorker(env, std::move(paths), std::move(filter), stat_entries);
+  Napi::Promise promise = worker->Promise();
+  worker->Queue();
+  return promise;
+}
+
+}  // namespace
+
+void RegisterDirectoryWalker(Napi::Env env, Napi::Object exports) {
+  exports.Set("listDirectories", Napi::Function::New(env, ListDirectories));
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <napi.h>
+
+// Each source file registers its own exports; addon.cc is the module entry.
+
+// activateApp, postPaste, activateAndPaste, getPasteboardChangeCount and
+// setWindowAnimationBehaviorNone (native_helpers.mm, macOS only).
+void RegisterMacHelpers(Napi::Env env, Napi::Object exports);
+
+// listDirectories, used by the file search index walk (directory_walker.cc).
+void RegisterDirectoryWalker(Napi::Env env, Napi::Object exports);
+
+// hashBuffer and imageDifferenceHash, content hashes for clipboard dedupe
+// (content_hash.cc).
+void RegisterContentHash(Napi::Env env, Napi::Object exports);
+
+// ClipboardWatcher, XFixes clipboard owner notifications for the clipboard
+// manager (clipboard_watcher_linux.cc, Linux only).
+void RegisterClipboardWatcher(Napi::Env env, Napi::Object exports);
@@ -2,6 +2,8 @@
 #import <Cocoa/Cocoa.h>
 #import <CoreGraphics/CoreGraphics.h>
 
+#include "native_helpers.h"
+
 // Activate an app by bundle ID or name, poll until frontmost (up to 500ms).
 // Returns true if the app was successfully activated.
 Napi::Value ActivateApp(const Napi::CallbackInfo& info) {
@@ -155,14 +157,11 @@ Napi::Value GetPasteboardChangeCount(const Napi::CallbackInfo& info) {
   return Napi::Number::New(env, (double)count);
 }
 
-Napi::Object Init(Napi::Env env, Napi::Object exports) {
+void RegisterMacHelpers(Napi::Env env, Napi::Object exports) {
   exports.Set("activateApp", Napi::Function::New(env, ActivateApp));
   exports.Set("postPaste", Napi::Function::New(env, PostPaste));
   exports.Set("activateAndPaste", Napi::Function::New(env, ActivateAndPaste));
   exports.Set("getPasteboardChangeCount", Napi::Function::New(env, GetPasteboardChangeCount));
   exports.Set("setWindowAnimationBehaviorNone",
               Napi::Function::New(env, SetWindowAnimationBehaviorNone));
-  return exports;
 }
-
-NODE_API_MODULE(native_helpers, Init)
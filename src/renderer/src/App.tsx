@@ -12,6 +12,7 @@ import type {
   ExtensionBundle,
   AppSettings,
   IndexedFileSearchResult,
+  IndexedFileSearchMetadata,
   BrowserSearchSource,
   BrowserSearchResultGroupSetting,
 } from '../types/electron';
@@ -85,9 +86,11 @@ import {
   getFileBasename,
   getFileResultPathFromCommand,
   getLauncherFileSearchTerms,
+  isContentLauncherFileQuery,
   isPathLikeLauncherFileQuery,
   matchesLauncherFileNameTerms,
   matchesLauncherPathQuery,
+  stripLauncherFileFilterTokens,
   MAX_LAUNCHER_FILE_CANDIDATE_RESULTS,
   MAX_LAUNCHER_FILE_RESULTS,
   MAX_LAUNCHER_FILE_RESULT_ICONS,
@@ -291,6 +294,9 @@ const App: React.FC = () => {
   >(() => Promise.resolve(false));
   const isLauncherModeActiveRef = useRef(false);
   const fileSearchRequestSeqRef = useRef(0);
+  // Timestamps stream in after the ranked file results; chunks can land before
+  // the results they belong to are committed, so they are kept here too.
+  const launcherFileMetadataRef = useRef<Map<string, IndexedFileSearchMetadata>>(new Map());
   const commandsRef = useRef<CommandInfo[]>([]);
   const lastCommandsFetchAtRef = useRef(0);
   const executingCommandRef = useRef(false);
@@ -705,6 +711,21 @@ const App: React.FC = () => {
     loadLauncherPreferences();
   }, []); // eslint-disable-line react-hooks/exhaustive-deps
 
+  useEffect(() => {
+    const cleanup = window.electron.onFileSearchMetadata((entries) => {
+      const metadataByPath = launcherFileMetadataRef.current;
+      for (const entry of entries) metadataByPath.set(entry.path, entry);
+      setLauncherFileResults((prev) => {
+        if (!prev.some((result) => metadataByPath.has(result.path))) return prev;
+        return prev.map((result) => {
+          const metadata = metadataByPath.get(result.path);
+          return metadata ? { ...result, ...metadata } : result;
+        });
+      });
+    });
+    return cleanup;
+  }, []);
+
   useEffect(() => {
     const cleanupWindowHidden = window.electron.onWindowHidden(() => {
       lastWindowHiddenAtRef.current = Date.now();
@@ -1274,9 +1295,12 @@ const App: React.FC = () => {
   useEffect(() => {
     fileSearchRequestSeqRef.current += 1;
     const requestSeq = fileSearchRequestSeqRef.current;
+    launcherFileMetadataRef.current.clear();
     const trimmed = searchQuery.trim();
-    const pathLikeQuery = isPathLikeLauncherFileQuery(trimmed);
-    const terms = pathLikeQuery ? [] : getLauncherFileSearchTerms(trimmed);
+    const contentQuery = isContentLauncherFileQuery(trimmed);
+    const matchText = contentQuery ? '' : stripLauncherFileFilterTokens(trimmed);
+    const pathLikeQuery = !contentQuery && isPathLikeLauncherFileQuery(matchText);
+    const terms = pathLikeQuery || contentQuery ? [] : getLauncherFileSearchTerms(matchText);
     const minimumQueryLength = pathLikeQuery ? 1 : MIN_LAUNCHER_FILE_QUERY_LENGTH;
 
     if (disableFileSearchResults || !shouldKeepLauncherSearchResults || trimmed.length < minimumQueryLength) {
@@ -1311,8 +1335,8 @@ const App: React.FC = () => {
             const candidatePath = String(candidate?.path || '').trim();
             if (!candidatePath || seenPaths.has(candidatePath)) continue;
             if (pathLikeQuery) {
-              if (!matchesLauncherPathQuery(candidatePath, trimmed, homeDir)) continue;
-            } else {
+              if (!matchesLauncherPathQuery(candidatePath, matchText, homeDir)) continue;
+            } else if (!contentQuery) {
               const candidateName = String(candidate?.name || '');
               if (!matchesLauncherFileNameTerms(candidateName, terms)) {
                 const normalizedCandidateText = normalizeLauncherFileSearchText([
@@ -1325,7 +1349,8 @@ const App: React.FC = () => {
               }
             }
             seenPaths.add(candidatePath);
-            results.push(candidate);
+            const metadata = launcherFileMetadataRef.current.get(candidatePath);
+            results.push(metadata ? { ...candidate, ...metadata } : candidate);
             if (results.length >= MAX_LAUNCHER_FILE_RESULTS) break;
           }
 
@@ -9,7 +9,7 @@
 
 import React, { useState, useEffect, useRef, useCallback } from 'react';
 import { Search, X, Trash2, Copy, Clipboard, Image as ImageIcon, Link, FileText, ArrowLeft, ArrowUp, ArrowDown, Pin, Save, FileDown } from 'lucide-react';
-import type { ClipboardItem } from '../types/electron';
+import type { ClipboardItem, ClipboardItemSummary } from '../types/electron';
 import ExtensionActionFooter from './components/ExtensionActionFooter';
 
 interface ClipboardManagerProps {
@@ -36,23 +36,22 @@ type ClipboardStatus = {
   text: string;
 };
 
-function getSearchableText(item: ClipboardItem): string {
-  if (item.type === 'image') {
-    const title = item.metadata?.filename || 'Image';
-    const width = item.metadata?.width;
-    const height = item.metadata?.height;
-    const dimensions = width && height ? `${width}×${height} ${width} ${height}` : '';
-    return `${title} ${dimensions}`;
-  }
-  return item.content;
-}
+type ClipboardFilterType = 'all' | 'text' | 'image' | 'url' | 'file';
+
+// The list holds summaries and grows a page at a time as it is scrolled;
+// search and the type filter run in the main process.
+const PAGE_SIZE = 50;
+// Rows left below the selection before the next page is fetched.
+const LOAD_MORE_THRESHOLD = 10;
 
 const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
-  const [items, setItems] = useState<ClipboardItem[]>([]);
-  const [filteredItems, setFilteredItems] = useState<ClipboardItem[]>([]);
+  const [filteredItems, setFilteredItems] = useState<ClipboardItemSummary[]>([]);
+  const [nextCursor, setNextCursor] = useState<string | null>(null);
+  // Full content of the selected entry, fetched when it is selected.
+  const [selectedDetail, setSelectedDetail] = useState<ClipboardItem | null>(null);
   const [searchQuery, setSearchQuery] = useState('');
   const [selectedIndex, setSelectedIndex] = useState(0);
-  const [filterType, setFilterType] = useState<'all' | 'text' | 'image' | 'url' | 'file'>('all');
+  const [filterType, setFilterType] = useState<ClipboardFilterType>('all');
   const [isLoading, setIsLoading] = useState(true);
   const [showActions, setShowActions] = useState(false);
   const [selectedActionIndex, setSelectedActionIndex] = useState(0);
@@ -63,6 +62,13 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
   const itemRefs = useRef<(HTMLDivElement | null)[]>([]);
   const actionsOverlayRef = useRef<HTMLDivElement>(null);
   const statusTimerRef = useRef<number | null>(null);
+  const viewRef = useRef<{ searchQuery: string; filterType: ClipboardFilterType }>({ searchQuery: '', filterType: 'all' });
+  const loadedCountRef = useRef(PAGE_SIZE);
+  const revisionRef = useRef(-1);
+  // Responses to superseded requests (an older query, a reload racing a
+  // page fetch) are dropped.
+  const requestSeqRef = useRef(0);
+  const loadingMoreRef = useRef(false);
   const isGlassyTheme =
     document.documentElement.classList.contains('sc-glassy') ||
     document.body.classList.contains('sc-glassy');
@@ -97,11 +103,22 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
     }, durationMs);
   }, []);
 
+  // (Re)loads the list from the top, as many rows as are currently loaded.
   const loadHistory = useCallback(async (withLoading = false) => {
     if (withLoading) setIsLoading(true);
+    const requestSeq = ++requestSeqRef.current;
     try {
-      const history = await window.electron.clipboardGetHistory();
-      setItems((prev) => {
+      const { searchQuery: query, filterType: type } = viewRef.current;
+      const page = await window.electron.clipboardGetHistoryPage({
+        query,
+        type,
+        limit: Math.max(PAGE_SIZE, loadedCountRef.current),
+      });
+      if (requestSeq !== requestSeqRef.current) return;
+      revisionRef.current = page.revision;
+      setNextCursor(page.nextCursor);
+      setFilteredItems((prev) => {
+        const history = page.items;
         if (
           prev.length === history.length &&
           prev.every((item, idx) =>
@@ -116,10 +133,34 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
       });
     } catch (e) {
       console.error('Failed to load clipboard history:', e);
+    } finally {
+      if (withLoading) setIsLoading(false);
     }
-    if (withLoading) setIsLoading(false);
   }, []);
 
+  const loadMore = useCallback(async () => {
+    if (!nextCursor || loadingMoreRef.current) return;
+    loadingMoreRef.current = true;
+    const requestSeq = ++requestSeqRef.current;
+    try {
+      const { searchQuery: query, filterType: type } = viewRef.current;
+      const page = await window.electron.clipboardGetHistoryPage({ query, type, cursor: nextCursor, limit: PAGE_SIZE });
+      if (requestSeq !== requestSeqRef.current) return;
+      revisionRef.current = page.revision;
+      setNextCursor(page.nextCursor);
+      setFilteredItems((prev) => {
+        const seen = new Set(prev.map((item) => item.id));
+        const next = [...prev, ...page.items.filter((item) => !seen.has(item.id))];
+        loadedCountRef.current = next.length;
+        return next;
+      });
+    } catch (e) {
+      console.error('Failed to load more clipboard history:', e);
+    } finally {
+      loadingMoreRef.current = false;
+    }
+  }, [nextCursor]);
+
   useEffect(() => {
     loadHistory(true);
     focusSearchInput();
@@ -149,31 +190,32 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
     };
   }, []);
 
+  // Polls only the revision; pages are refetched once the history changed.
   useEffect(() => {
-    const timer = window.setInterval(() => {
-      void loadHistory(false);
+    const timer = window.setInterval(async () => {
+      try {
+        const revision = await window.electron.clipboardGetHistoryRevision();
+        if (revision !== revisionRef.current) void loadHistory(false);
+      } catch (e) {
+        console.error('Failed to check clipboard history:', e);
+      }
     }, 750);
     return () => {
       window.clearInterval(timer);
     };
   }, [loadHistory]);
 
+  const isFirstViewRef = useRef(true);
   useEffect(() => {
-    let filtered = items;
-
-    if (filterType !== 'all') {
-      filtered = filtered.filter((item) => item.type === filterType);
-    }
-
-    if (searchQuery.trim()) {
-      const lowerQuery = searchQuery.toLowerCase();
-      filtered = filtered.filter((item) =>
-        getSearchableText(item).toLowerCase().includes(lowerQuery)
-      );
+    viewRef.current = { searchQuery: searchQuery.trim(), filterType };
+    // The initial load happens on mount.
+    if (isFirstViewRef.current) {
+      isFirstViewRef.current = false;
+      return;
     }
-
-    setFilteredItems(filtered);
-  }, [items, filterType, searchQuery]);
+    loadedCountRef.current = PAGE_SIZE;
+    void loadHistory(false);
+  }, [filterType, searchQuery, loadHistory]);
 
   useEffect(() => {
     setSelectedIndex(0);
@@ -213,13 +255,25 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
     scrollToSelected();
   }, [selectedIndex, scrollToSelected]);
 
+  useEffect(() => {
+    if (nextCursor && selectedIndex >= filteredItems.length - LOAD_MORE_THRESHOLD) void loadMore();
+  }, [selectedIndex, filteredItems.length, nextCursor, loadMore]);
+
+  const handleListScroll = useCallback(() => {
+    const scrollContainer = listRef.current;
+    if (!scrollContainer || !nextCursor) return;
+    if (scrollContainer.scrollTop + scrollContainer.clientHeight >= scrollContainer.scrollHeight - 200) {
+      void loadMore();
+    }
+  }, [nextCursor, loadMore]);
+
   useEffect(() => {
     if (!showActions) return;
     setSelectedActionIndex(0);
     setTimeout(() => actionsOverlayRef.current?.focus(), 0);
   }, [showActions]);
 
-  const handlePasteItem = async (item?: ClipboardItem) => {
+  const handlePasteItem = async (item?: ClipboardItemSummary) => {
     const itemToPaste = item || filteredItems[selectedIndex];
     if (!itemToPaste) return;
     
@@ -241,7 +295,7 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
     }
   };
 
-  const handleDeleteItem = async (item?: ClipboardItem) => {
+  const handleDeleteItem = async (item?: ClipboardItemSummary) => {
     const itemToDelete = item || filteredItems[selectedIndex];
     if (!itemToDelete) return;
     
@@ -253,7 +307,7 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
     }
   };
 
-  const handleTogglePinItem = async (item?: ClipboardItem) => {
+  const handleTogglePinItem = async (item?: ClipboardItemSummary) => {
     const itemToPin = item || filteredItems[selectedIndex];
     if (!itemToPin) return;
 
@@ -269,7 +323,7 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
   // order matches the real pinned order one-to-one.
   const canReorderPinned = !searchQuery.trim() && filterType === 'all';
 
-  const handleMovePinnedItem = async (direction: 'up' | 'down', item?: ClipboardItem) => {
+  const handleMovePinnedItem = async (direction: 'up' | 'down', item?: ClipboardItemSummary) => {
     if (!canReorderPinned) return;
     const itemToMove = item || filteredItems[selectedIndex];
     if (!itemToMove?.pinned) return;
@@ -287,7 +341,7 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
     }
   };
 
-  const handleSaveAsSnippet = async (item?: ClipboardItem) => {
+  const handleSaveAsSnippet = async (item?: ClipboardItemSummary) => {
     const itemToSave = item || filteredItems[selectedIndex];
     if (!itemToSave || (itemToSave.type !== 'text' && itemToSave.type !== 'url')) return;
 
@@ -304,7 +358,7 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
     }
   };
 
-  const handleSaveAsFile = async (item?: ClipboardItem) => {
+  const handleSaveAsFile = async (item?: ClipboardItemSummary) => {
     const itemToSave = item || filteredItems[selectedIndex];
     if (!itemToSave) return;
 
@@ -327,6 +381,26 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
   };
 
   const selectedItem = filteredItems[selectedIndex];
+  const selectedItemId = selectedItem?.id;
+  const selectedItemTimestamp = selectedItem?.timestamp;
+  const selectedItemType = selectedItem?.type;
+  useEffect(() => {
+    if (!selectedItemId || selectedItemType === 'image') {
+      setSelectedDetail(null);
+      return;
+    }
+    let cancelled = false;
+    window.electron.clipboardGetItem(selectedItemId)
+      .then((item) => {
+        if (!cancelled) setSelectedDetail(item);
+      })
+      .catch((e) => console.error('Failed to load clipboard entry:', e));
+    return () => {
+      cancelled = true;
+    };
+  }, [selectedItemId, selectedItemTimestamp, selectedItemType]);
+  const selectedText =
+    selectedDetail && selectedDetail.id === selectedItemId ? selectedDetail.content : selectedItem?.preview;
   const canSaveAsSnippet = selectedItem?.type === 'text' || selectedItem?.type === 'url';
 
   const pasteLabel = frontmostAppName ? `Paste in ${frontmostAppName}` : 'Paste';
@@ -627,6 +701,7 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
         {/* Left: List (40%) */}
         <div
           ref={listRef}
+          onScroll={handleListScroll}
           className="flex-[0_0_40%] min-w-0 overflow-y-auto custom-scrollbar border-r border-[var(--ui-divider)]"
         >
           {isLoading ? (
@@ -655,7 +730,7 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
                     {item.type === 'image' ? (
                       <>
                         <img
-                          src={clipboardImageUrl(item.content)}
+                          src={clipboardImageUrl(item.imagePath || '')}
                           alt="Clipboard"
                           className="w-7 h-7 object-cover rounded flex-shrink-0"
                           onError={(e) => {
@@ -686,7 +761,7 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
                         </div>
                         <div className="flex-1 min-w-0">
                           <div className="text-[var(--text-secondary)] text-[13px] truncate">
-                            {item.preview || item.content}
+                            {item.preview}
                           </div>
                         </div>
                         {item.pinned ? (
@@ -714,7 +789,7 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
               <div className="flex-1 min-h-0 overflow-auto custom-scrollbar p-3.5 flex items-center justify-center">
                 {selectedItem.type === 'image' ? (
                   <img
-                    src={clipboardImageUrl(selectedItem.content)}
+                    src={clipboardImageUrl(selectedItem.imagePath || '')}
                     alt="Clipboard"
                     className="max-w-full max-h-full object-contain"
                     onError={(e) => {
@@ -728,7 +803,7 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
                   />
                 ) : (
                   <pre className="w-full self-start text-[var(--text-secondary)] text-xs whitespace-pre-wrap break-words font-mono leading-normal">
-                    {selectedItem.content}
+                    {selectedText}
                   </pre>
                 )}
               </div>
@@ -775,7 +850,7 @@ const ClipboardManager: React.FC<ClipboardManagerProps> = ({ onClose }) => {
               <span className="truncate text-[var(--text-secondary)]">{statusMessage.text}</span>
             </span>
           ) : (
-            <span className="truncate">{filteredItems.length} items</span>
+            <span className="truncate">{filteredItems.length}{nextCursor ? '+' : ''} items</span>
           )
         }
         primaryAction={
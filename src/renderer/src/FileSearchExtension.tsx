@@ -138,6 +138,20 @@ function normalizePathForMatch(value: string): string {
   return String(value || '').normalize('NFKD').toLowerCase().replace(/\\/g, '/');
 }
 
+function isContentQuery(rawQuery: string): boolean {
+  return /^content:/i.test(String(rawQuery || '').trim());
+}
+
+// `ext:`, `kind:`, `modified:` and `size:` tokens are applied by the index
+// itself; only the remaining text needs to match names or paths.
+function stripFilterTokens(rawQuery: string): string {
+  return String(rawQuery || '')
+    .trim()
+    .split(/\s+/)
+    .filter((token) => !/^(ext|kind|modified|size):\S+$/i.test(token))
+    .join(' ');
+}
+
 function isPathLikeQuery(rawQuery: string): boolean {
   const trimmed = String(rawQuery || '').trim();
   return trimmed.includes('/') || trimmed.startsWith('~');
@@ -238,7 +252,8 @@ const FileSearchExtension: React.FC<FileSearchExtensionProps> = ({ onClose, init
   );
 
   const visibleResults = useMemo(() => {
-    const trimmedQuery = query.trim();
+    if (isContentQuery(query)) return results;
+    const trimmedQuery = stripFilterTokens(query);
     if (!trimmedQuery) return results;
     if (isPathLikeQuery(trimmedQuery)) {
       return results.filter((filePath) => matchesPathQuery(filePath, trimmedQuery, selectedScope?.path || ''));
@@ -363,16 +378,19 @@ const FileSearchExtension: React.FC<FileSearchExtensionProps> = ({ onClose, init
           }
         }
 
-        const pathLikeQuery = isPathLikeQuery(trimmed);
-        const terms = pathLikeQuery ? [] : getNormalizedTerms(trimmed);
+        const contentQuery = isContentQuery(trimmed);
+        const matchText = contentQuery ? '' : stripFilterTokens(trimmed);
+        const pathLikeQuery = !contentQuery && isPathLikeQuery(matchText);
+        const terms = pathLikeQuery || contentQuery ? [] : getNormalizedTerms(matchText);
         const scopePrefix = `${currentScope.path.replace(/\/$/, '')}/`;
         const strictNameMatches = indexed
           .map((entry) => entry.path)
           .filter((filePath) => filePath.startsWith(scopePrefix) || filePath === currentScope.path)
           .filter((filePath) =>
-            pathLikeQuery
-              ? matchesPathQuery(filePath, trimmed, currentScope.path)
-              : matchesFileNameTerms(filePath, terms)
+            contentQuery
+              || (pathLikeQuery
+                ? matchesPathQuery(filePath, matchText, currentScope.path)
+                : matchesFileNameTerms(filePath, terms))
           );
 
         let deduped = Array.from(new Set(strictNameMatches));
@@ -51,6 +51,25 @@ export function isPathLikeLauncherFileQuery(rawQuery: string): boolean {
   return trimmed.includes('/') || trimmed.startsWith('~');
 }
 
+// `content:` queries match file contents in the main process, so their
+// results need not match the query by name.
+export function isContentLauncherFileQuery(rawQuery: string): boolean {
+  return /^content:/i.test(String(rawQuery || '').trim());
+}
+
+// Filter tokens (`ext:pdf`, `kind:folder`, `modified:<7d`, `size:>100mb`) are
+// evaluated in the main process against indexed attributes; only the rest of
+// the query has to match by name or path.
+const LAUNCHER_FILE_FILTER_TOKEN_REGEX = /^(ext|kind|modified|size):\S+$/i;
+
+export function stripLauncherFileFilterTokens(rawQuery: string): string {
+  return String(rawQuery || '')
+    .trim()
+    .split(/\s+/)
+    .filter((token) => !LAUNCHER_FILE_FILTER_TOKEN_REGEX.test(token))
+    .join(' ');
+}
+
 export function matchesLauncherPathQuery(filePath: string, rawQuery: string, homeDir: string): boolean {
   const trimmed = String(rawQuery || '').trim();
   if (!trimmed) return true;
@@ -82,13 +82,30 @@ export interface IndexedFileSearchResult {
   atimeMs?: number;
 }
 
+export type IndexedFileSearchMetadata = Pick<IndexedFileSearchResult, 'path' | 'mtimeMs' | 'birthtimeMs' | 'atimeMs'>;
+
+export interface FileSearchIndexShardStatus {
+  root: string;
+  indexing: boolean;
+  ready: boolean;
+  indexedEntryCount: number;
+  lastIndexedAt: number | null;
+  refreshIntervalMs: number;
+  lastError: string | null;
+}
+
 export interface FileSearchIndexStatus {
   indexing: boolean;
   ready: boolean;
   indexedEntryCount: number;
+  tombstoneCount: number;
   lastIndexedAt: number | null;
+  lastCompactedAt: number | null;
+  contentIndexedFileCount: number;
+  contentRoots: string[];
   homeDirectory: string;
   includeRoots: string[];
+  shards: FileSearchIndexShardStatus[];
   excludedDirectoryNames: string[];
   excludedTopLevelDirectories: string[];
   protectedTopLevelDirectories: string[];
@@ -644,6 +661,9 @@ export interface AppSettings {
   hasSeenOnboarding: boolean;
   hasSeenWhisperOnboarding: boolean;
   fileSearchProtectedRootsEnabled: boolean;
+  fileSearchContentRoots: string[];
+  fileSearchIdleOnlyRefresh: boolean;
+  fileSearchExtraRoots: Array<{ path: string; refreshIntervalMinutes: number }>;
   disableFileSearchResults: boolean;
   showMenuBarIcon: boolean;
   ai: AISettings;
@@ -714,6 +734,26 @@ export interface ClipboardItem {
   };
 }
 
+/** A clipboard history row without its payload. */
+export interface ClipboardItemSummary {
+  id: string;
+  type: ClipboardItem['type'];
+  preview: string;
+  size: number;
+  timestamp: number;
+  pinned: boolean;
+  pinnedOrder?: number;
+  source?: string;
+  imagePath?: string;
+  metadata?: ClipboardItem['metadata'];
+}
+
+export interface ClipboardHistoryPage {
+  items: ClipboardItemSummary[];
+  nextCursor: string | null;
+  revision: number;
+}
+
 export interface Snippet {
   id: string;
   name: string;
@@ -1093,6 +1133,7 @@ export interface ElectronAPI {
   getFileIconDataUrl: (filePath: string, size?: number) => Promise<string | null>;
   getAppIconDataUrl: (appPath: string, size?: number) => Promise<string | null>;
   searchIndexedFiles: (query: string, options?: { limit?: number }) => Promise<IndexedFileSearchResult[]>;
+  onFileSearchMetadata: (callback: (entries: IndexedFileSearchMetadata[]) => void) => (() => void);
   getFileSearchIndexStatus: () => Promise<FileSearchIndexStatus>;
   refreshFileSearchIndex: (reason?: string) => Promise<FileSearchIndexStatus>;
   getAppearance: () => Promise<'dark' | 'light'>;
@@ -1107,7 +1148,15 @@ export interface ElectronAPI {
 
   // Clipboard Manager
   clipboardGetHistory: () => Promise<ClipboardItem[]>;
-  clipboardSearch: (query: string) => Promise<ClipboardItem[]>;
+  clipboardGetHistoryPage: (options?: {
+    cursor?: string | null;
+    limit?: number;
+    type?: 'all' | ClipboardItem['type'];
+    query?: string;
+  }) => Promise<ClipboardHistoryPage>;
+  clipboardGetHistoryRevision: () => Promise<number>;
+  clipboardGetItem: (id: string) => Promise<ClipboardItem | null>;
+  clipboardSearch: (query: string, options?: { limit?: number }) => Promise<ClipboardItem[]>;
   clipboardClearHistory: () => Promise<void>;
   clipboardDeleteItem: (id: string) => Promise<boolean>;
   clipboardCopyItem: (id: string) => Promise<boolean>;